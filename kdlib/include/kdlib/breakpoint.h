@@ -1,5 +1,7 @@
 #pragma once 
 
+#include <string>
+
 #include <boost/smart_ptr.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/enable_shared_from_this.hpp>
@@ -51,6 +53,12 @@ public:
 BreakpointPtr softwareBreakPointSet(MEMOFFSET_64 offset, BreakpointCallback *callback =0);
 BreakpointPtr hardwareBreakPointSet(MEMOFFSET_64 offset, size_t size, ACCESS_TYPE accessType, BreakpointCallback *callback =0);
 
+// Conditional breakpoints: the condition is compiled once ( as compileExpr ) and evaluated on
+// each hit before the callback and the events. If it is false the target goes on. Registers
+// are accessed by name: "rcx == 0x10 && rdx != 0"
+BreakpointPtr softwareBreakPointSet(MEMOFFSET_64 offset, const std::wstring& condition, BreakpointCallback *callback =0);
+BreakpointPtr hardwareBreakPointSet(MEMOFFSET_64 offset, size_t size, ACCESS_TYPE accessType, const std::wstring& condition, BreakpointCallback *callback =0);
+
 unsigned long getNumberBreakpoints();
 BreakpointPtr getBreakpointByIndex(unsigned long index);
 
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "kdlib/dbgtypedef.h"
+#include "kdlib/peimage.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum CodeFunctionSource {
+    CodeFromSymbol = 0x01,
+    CodeFromUnwind = 0x02,      // .pdata entry
+    CodeFromExport = 0x04,
+    CodeFromEntry = 0x08,       // image entry point
+    CodeFromCall = 0x10         // target of a direct call
+};
+
+struct CodeFunction {
+    MEMOFFSET_32  rva;
+    MEMOFFSET_32  size;             // from the entry to the end of the highest block
+    unsigned long  sources;         // CodeFunctionSource bits
+    unsigned long  firstBlock;      // the function blocks are [firstBlock, firstBlock + blockCount)
+    unsigned long  blockCount;
+};
+
+struct CodeBlock {
+    MEMOFFSET_32  rva;
+    MEMOFFSET_32  size;
+    unsigned long  function;        // index of the owner function
+};
+
+enum CodeRefType : unsigned char {
+    CodeRefCall,
+    CodeRefJump,                    // branch to a block or a tail call
+    CodeRefData                     // static address of a memory operand or an address immediate
+};
+
+struct CodeRef {
+    MEMOFFSET_32  from;             // rva of the instruction
+    MEMOFFSET_32  to;
+    CodeRefType  type;
+};
+
+// A symbol function range: a seed for the analysis
+struct CodeRange {
+    MEMOFFSET_32  rva;
+    MEMOFFSET_32  size;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class CodeIndex;
+typedef boost::shared_ptr<CodeIndex>  CodeIndexPtr;
+
+// Functions, basic blocks and references of a module image. All the offsets are RVA,
+// so the index does not depend on the load address and is shared by all the modules
+// loaded from the same image ( the same timestamp and checksum )
+
+class CodeIndex : private boost::noncopyable
+{
+public:
+
+    // the vectors are taken by swap
+    CodeIndex(
+        unsigned long timeDataStamp,
+        unsigned long checkSum,
+        std::vector<CodeFunction>& functions,
+        std::vector<CodeBlock>& blocks,
+        std::vector<CodeRef>& refs );
+
+    unsigned long getTimeDataStamp() const {
+        return m_timeDataStamp;
+    }
+
+    unsigned long getCheckSum() const {
+        return m_checkSum;
+    }
+
+    // sorted by rva
+    const std::vector<CodeFunction>& getFunctions() const {
+        return m_functions;
+    }
+
+    // grouped by functions
+    const std::vector<CodeBlock>& getBlocks() const {
+        return m_blocks;
+    }
+
+    // sorted by the instruction rva
+    const std::vector<CodeRef>& getRefs() const {
+        return m_refs;
+    }
+
+    // null if the rva is out of the analyzed code
+    const CodeBlock* findBlock(MEMOFFSET_32 rva) const;
+    const CodeFunction* findFunction(MEMOFFSET_32 rva) const;
+
+    // references from the instructions of the function: calls, branches and data
+    std::vector<CodeRef> getRefsFrom(const CodeFunction& function) const;
+
+    // who calls, jumps or reads the address
+    std::vector<CodeRef> getRefsTo(MEMOFFSET_32 rva) const;
+
+    // compact binary form of the index
+    void save(std::vector<unsigned char>& data) const;
+    static CodeIndexPtr load(const void* data, size_t size);
+
+private:
+
+    void buildLookup();
+
+    unsigned long  m_timeDataStamp;
+    unsigned long  m_checkSum;
+
+    std::vector<CodeFunction>  m_functions;
+    std::vector<CodeBlock>  m_blocks;
+    std::vector<CodeRef>  m_refs;
+
+    // lookup tables built on load: block indices sorted by rva, ref indices sorted by target
+    std::vector<unsigned long>  m_blockOrder;
+    std::vector<unsigned long>  m_refTargets;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Analyzes x86 and x64 code of a mapped image: the reader gets the image by RVA, imageBase
+// is the load address ( absolute addresses of the x86 code are relocated to it ).
+// Functions come from the symbols, .pdata, exports, the entry point and direct calls;
+// each one is traced by its branches and split into basic blocks. Jump tables are not
+// resolved, the code reached only through them is not in the index
+CodeIndexPtr analyzeCode(const PEImageReader& reader, MEMOFFSET_64 imageBase, const std::vector<CodeRange>& symbolFunctions);
+
+// Cache of the indices of the loaded modules by the process, the module base and whether the
+// symbols were loaded for the analysis ( the index built from the exports only is poorer ).
+// The entries are dropped on the module unload and the process exit. If the directory is set,
+// indices are also saved there by the image name, timestamp and checksum and loaded back
+// for the same image in the other processes and the next sessions
+void setCodeIndexDirectory(const std::wstring& path);
+
+CodeIndexPtr findCodeIndex(PROCESS_DEBUG_ID processId, MEMOFFSET_64 moduleBase, const std::wstring& imageName,
+    unsigned long timeDataStamp, unsigned long checkSum, bool symbolsLoaded);
+void insertCodeIndex(PROCESS_DEBUG_ID processId, MEMOFFSET_64 moduleBase, const std::wstring& imageName,
+    const CodeIndexPtr& codeIndex, bool symbolsLoaded);
+
+void removeCodeIndex(PROCESS_DEBUG_ID processId, MEMOFFSET_64 moduleBase);
+void removeProcessCodeIndices(PROCESS_DEBUG_ID processId);
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
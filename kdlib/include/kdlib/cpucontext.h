@@ -1,5 +1,7 @@
 #pragma once
 
+#include <vector>
+
 #include <boost/shared_ptr.hpp>
 #include <boost/noncopyable.hpp>
 
@@ -29,6 +31,11 @@ public:
     virtual std::wstring getRegisterName( unsigned long index ) = 0;
     virtual unsigned long getRegisterNumber() = 0;
 
+    // all the scalar registers of the context: CodeView indices and values in the same order.
+    // The default scans the indices with getRegisterName and getRegisterByIndex,
+    // a context with a register table exports it in one pass
+    virtual void getRegisters(std::vector<unsigned long>& indices, std::vector<NumVariant>& values);
+
     virtual MEMOFFSET_64 getIP() = 0;
     virtual void setIP(MEMOFFSET_64 ip) = 0;
 
@@ -43,6 +50,10 @@ public:
 
 CPUContextPtr loadCPUContext();
 
+// a context from a raw CONTEXT structure of the CPU ( I386 or AMD64 ), the engine is not used.
+// restore() still writes it to the current thread
+CPUContextPtr loadCPUContext(CPUType cpuType, const void* rawContext, size_t rawContextSize);
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class CPUContextAutoRestore
@@ -66,9 +77,74 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Register values of several threads. The values are kept by columns: a register
+// column is a contiguous array with a value for each thread, so a search over all
+// threads ( "whose rip is in the module" ) is a loop over a plain array.
+// Integer registers are zero extended, float registers are kept as raw bits
+
+class RegisterSnapshot
+{
+public:
+
+    RegisterSnapshot()
+    {}
+
+    RegisterSnapshot(const std::vector<THREAD_DEBUG_ID>& threads, const std::vector<std::wstring>& registers) :
+        m_threads(threads),
+        m_registers(registers),
+        m_values(threads.size() * registers.size(), 0)
+    {}
+
+    size_t getThreadCount() const {
+        return m_threads.size();
+    }
+
+    size_t getRegisterCount() const {
+        return m_registers.size();
+    }
+
+    const std::vector<THREAD_DEBUG_ID>& getThreads() const {
+        return m_threads;
+    }
+
+    const std::vector<std::wstring>& getRegisterNames() const {
+        return m_registers;
+    }
+
+    size_t getRegisterPosition(const std::wstring& regName) const;
+
+    const unsigned long long* getColumn(size_t regPos) const {
+        return m_values.data() + regPos * m_threads.size();
+    }
+
+    const unsigned long long* getColumn(const std::wstring& regName) const {
+        return getColumn(getRegisterPosition(regName));
+    }
+
+    unsigned long long getValue(size_t threadPos, size_t regPos) const {
+        return m_values[regPos * m_threads.size() + threadPos];
+    }
+
+    void setValue(size_t threadPos, size_t regPos, const NumVariant& value);
+
+private:
+
+    std::vector<THREAD_DEBUG_ID>  m_threads;
+    std::vector<std::wstring>  m_registers;
+    std::vector<unsigned long long>  m_values;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 NumVariant getRegisterByName(const std::wstring& regName);
 NumVariant getRegisterByIndex(unsigned long regIndex);
 
+// one context read per thread: empty lists mean all the threads of the current process
+// and all the scalar registers
+RegisterSnapshot getRegisterSnapshot(
+    const std::vector<std::wstring>& registers = std::vector<std::wstring>(),
+    const std::vector<THREAD_DEBUG_ID>& threads = std::vector<THREAD_DEBUG_ID>() );
+
 void setRegisterByName(const std::wstring& regName, const NumVariant& value);
 void setRegisterByIndex(unsigned long regIndex, const NumVariant& value);
 
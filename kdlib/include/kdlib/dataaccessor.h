@@ -6,6 +6,7 @@
 
 #include <kdlib/dbgtypedef.h>
 #include <kdlib/variant.h>
+#include <kdlib/cpucontext.h>
 
 namespace kdlib {
 
@@ -94,6 +95,7 @@ public:
 DataAccessorPtr getEmptyAccessor();
 DataAccessorPtr getMemoryAccessor( MEMOFFSET_64  offset, size_t length);
 DataAccessorPtr getRegisterAccessor(const std::wstring& registerName);
+DataAccessorPtr getRegisterAccessor(const CPUContextPtr& cpuContext, unsigned long registerIndex);
 
 DataAccessorPtr getCacheAccessor(const std::vector<char>& buffer, const std::wstring&  location=L"");
 DataAccessorPtr getCacheAccessor(size_t bufferSize, const std::wstring&  location=L"");
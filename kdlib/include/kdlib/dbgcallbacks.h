@@ -8,6 +8,26 @@ namespace kdlib {
 
 //////////////////////////////////////////////////////////////////////////////
 
+// Events a callback is interested in: the other events are not dispatched to it
+enum DebugEventsMask {
+    DebugEventBreakpoint = 0x0001,
+    DebugEventException = 0x0002,
+    DebugEventExecutionStatus = 0x0004,
+    DebugEventModuleLoad = 0x0008,
+    DebugEventModuleUnload = 0x0010,
+    DebugEventProcessStart = 0x0020,
+    DebugEventProcessExit = 0x0040,
+    DebugEventThreadStart = 0x0080,
+    DebugEventThreadStop = 0x0100,
+    DebugEventCurrentThread = 0x0200,
+    DebugEventLocalScope = 0x0400,
+    DebugEventSymbolPaths = 0x0800,
+    DebugEventBreakpoints = 0x1000,
+    DebugEventOutput = 0x2000,
+    DebugEventInput = 0x4000,               // onStartInput and onStopInput
+    DebugEventAll = 0xFFFFFFFF
+};
+
 struct DebugEventsCallback {
 
     virtual DebugCallbackResult onBreakpoint( BREAKPOINT_ID bpId ) = 0;
@@ -29,7 +49,7 @@ struct DebugEventsCallback {
 
 };
 
-void registerEventsCallback( DebugEventsCallback *callback );
+void registerEventsCallback( DebugEventsCallback *callback, unsigned long eventsMask = DebugEventAll );
 void removeEventsCallback( DebugEventsCallback *callback );
 
 //////////////////////////////////////////////////////////////////////////////
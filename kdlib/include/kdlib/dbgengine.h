@@ -5,6 +5,7 @@
 
 #include "kdlib/dbgtypedef.h"
 #include "kdlib/variant.h"
+#include "kdlib/outputsink.h"
 
 namespace kdlib {
 
@@ -39,6 +40,8 @@ DumpFormatFlagsSet getDumpFormat();
 bool isKernelDebugging();
 
 std::wstring debugCommand(const std::wstring &command, bool suppressOutput = false, const OutputFlagsSet& captureFlags = OutputFlag::Normal);
+// the output is passed to the sink while the command is running and is not kept
+void debugCommand(const std::wstring &command, OutputSink& sink, const OutputFlagsSet& captureFlags = OutputFlag::Normal);
 NumVariant evaluate( const std::wstring  &expression, bool cplusplus=false );
 
 DebugOptionsSet getDebugOptions();
@@ -172,6 +175,8 @@ std::wstring getRegisterName(unsigned long index );
 size_t getRegisterSize(unsigned long index);
 void getRegisterValue(unsigned long index, void* buffer, size_t bufferSize );
 void setRegisterValue(unsigned long index, void* buffer, size_t bufferSize );
+// integer registers only: one read of the register types and one write for all the values
+void setRegisterValues(const std::vector<unsigned long>& indices, const std::vector<unsigned long long>& values);
 CPUType getCPUType();
 CPUType getCPUMode();
 void setCPUMode(CPUType mode );
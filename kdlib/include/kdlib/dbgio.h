@@ -23,6 +23,11 @@ public:
     virtual void write( const std::wstring& str) = 0;
 
     virtual void writedml( const std::wstring& str) = 0;
+
+    // a writer may put the line end without a concatenation
+    virtual void writeln( const std::wstring& str) {
+        write( str + L"\r\n" );
+    }
 };
 
 ///////////////////////////////////////////////////////////////////////////////
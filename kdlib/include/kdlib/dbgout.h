@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "kdlib/dbgio.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// When the buffered text goes to the target: always when the buffer is full and on flush,
+// and also by the flags
+enum DbgOutFlushPolicy {
+    DbgOutFlushBySize = 0,
+    DbgOutFlushByNewline = 1,       // after each write with a line end
+    DbgOutFlushByTime = 2           // by a write coming the flush interval after the last flush
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Collects the text of many writes and passes it to the target by one write. Any thread
+// appends without a lock: a write reserves its place in the current buffer by an atomic
+// counter and copies the text, the full buffer is swapped with the spare one under the flush
+// lock and is written when its writers are done. A DML text and a text longer than the
+// buffer are written to the target directly after the buffered text.
+// The time is checked by the writes only, so the target is called from the writing threads.
+//
+// A text without a line end ( a prompt, a progress mark ) stays in the buffer until the next
+// write or flush: the owner must call flush() before it waits for the user or goes idle.
+// The default policy passes every complete line at once
+
+class BufferedDbgOut : public DbgOut, private boost::noncopyable
+{
+public:
+
+    explicit BufferedDbgOut(
+        DbgOut* target,
+        unsigned long flushPolicy = DbgOutFlushByNewline | DbgOutFlushByTime,
+        size_t bufferSize = 0x4000,
+        unsigned long flushInterval = 100 );      // milliseconds
+
+    // the rest of the text is flushed
+    ~BufferedDbgOut();
+
+    virtual void write( const std::wstring& str );
+
+    virtual void writedml( const std::wstring& str );
+
+    virtual void writeln( const std::wstring& str );
+
+    // passes the buffered text to the target
+    void flush();
+
+private:
+
+    struct Buffer {
+        boost::scoped_array<wchar_t>  data;
+        boost::atomic<size_t>  reserved;
+        boost::atomic<size_t>  end;         // the place of the first write over the buffer end
+        boost::atomic<size_t>  writers;
+    };
+
+    void append( const std::wstring& str, bool newLine );
+
+    void flushBuffer( Buffer* buffer );
+
+    // under the flush lock
+    void drain( Buffer* buffer );
+
+    static unsigned long long getTickCount();
+
+    DbgOut*  m_target;
+    unsigned long  m_flushPolicy;
+    size_t  m_bufferSize;
+    unsigned long  m_flushInterval;
+
+    Buffer  m_buffers[2];
+    boost::atomic<Buffer*>  m_current;
+    boost::atomic<unsigned long long>  m_lastFlush;
+
+    boost::mutex  m_flushLock;
+    std::wstring  m_text;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Writes the text to a byte stream as UTF-8: a run of ASCII characters is copied as is
+
+class Utf8DbgOut : public DbgOut, private boost::noncopyable
+{
+public:
+
+    explicit Utf8DbgOut( FILE* file ) :
+        m_file( file )
+    {}
+
+    virtual void write( const std::wstring& str );
+
+    virtual void writedml( const std::wstring& str ) {
+        write( str );
+    }
+
+    virtual void writeln( const std::wstring& str );
+
+private:
+
+    void put( const std::wstring& str, bool newLine );
+
+    FILE*  m_file;
+
+    boost::mutex  m_lock;
+    std::string  m_text;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum DemangleMode {
+    DemangleNameOnly,       // "?bar@Foo@@QAEXPBD@Z" -> "Foo::bar"
+    DemangleFull            // "?bar@Foo@@QAEXPBD@Z" -> "public: void __thiscall Foo::bar(char const *)"
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// MSVC decorated names demangler. It keeps the backreference tables and the scratch
+// strings between calls, so one object should be used to demangle names in bulk
+// ( all exports of a module ). Not thread safe
+
+class MsvcDemangler
+{
+public:
+
+    MsvcDemangler();
+
+    // returns false if the name is not a MSVC decorated name or it is not supported
+    // ( undecorateMsvcName is the fallback ), the result is valid only if true is returned. The names come from the target memory:
+    // a name longer than maxNameLength or nested deeper than maxDepth is not demangled
+    bool demangle(const char* decoratedName, size_t length, std::string& result, DemangleMode mode = DemangleNameOnly);
+
+    bool demangle(const std::string& decoratedName, std::string& result, DemangleMode mode = DemangleNameOnly) {
+        return demangle(decoratedName.c_str(), decoratedName.size(), result, mode);
+    }
+
+private:
+
+    enum SpecialName {
+        SpecialNone,
+        SpecialCtor,
+        SpecialDtor,
+        SpecialConversion
+    };
+
+    struct TypeText {
+        std::string  left;
+        std::string  right;
+    };
+
+    static const size_t  backrefCount = 10;
+
+    // the compiler hashes the names longer than 4096 characters
+    static const size_t  maxNameLength = 0x1000;
+
+    // nesting of the types, every recursion of the grammar goes through a type
+    static const size_t  maxDepth = 256;
+
+    struct BackrefTable {
+        std::string  names[backrefCount];
+        size_t  nameCount;
+        std::string  types[backrefCount];
+        size_t  typeCount;
+    };
+
+    bool parseSymbol(std::string& result, DemangleMode mode);
+    bool parseFunction(const std::string& name, SpecialName special, std::string& result, DemangleMode mode);
+    bool parseVariable(const std::string& name, std::string& result);
+    bool parseVTable(const std::string& name, std::string& result);
+
+    bool parseQualifiedName(std::string& name, SpecialName* special);
+    bool parseNameFragment(std::string& fragment);
+    bool parseSimpleName(std::string& name, bool memorize);
+    bool parseTemplateName(std::string& name);
+    bool parseTemplateArg(std::string& arg, bool& empty);
+    bool parseSpecialName(std::string& name, SpecialName& special);
+    bool parseNumber(long long& number);
+
+    bool parseType(TypeText& type);
+    bool parseTypeCode(TypeText& type);
+    bool parsePointer(char pointerCode, TypeText& type);
+    bool parseClass(const char* keyword, TypeText& type);
+    bool parseArray(TypeText& type);
+    bool parseFunctionType(TypeText& type, const std::string* pointer);
+    bool parseParameters(std::string& params);
+    bool parseCallingConvention(const char*& callConv);
+    bool parseCvQualifiers(std::string& qualifiers);
+    void parsePointerModifiers(std::string& modifiers);
+
+    void memorizeName(const std::string& name);
+
+    BackrefTable& backrefs() {
+        return m_backrefs[m_backrefDepth];
+    }
+
+    bool peek(char c) const {
+        return m_pos < m_end && *m_pos == c;
+    }
+
+    bool consume(char c) {
+        if (!peek(c))
+            return false;
+        ++m_pos;
+        return true;
+    }
+
+    bool consume(const char* str);
+
+    const char*  m_pos;
+    const char*  m_end;
+
+    std::vector<BackrefTable>  m_backrefs;
+    size_t  m_backrefDepth;
+
+    size_t  m_depth;
+
+    std::string  m_name;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// DbgHelp UnDecorateSymbolName: much slower than MsvcDemangler, but it knows all the encodings
+// ( RTTI descriptors, string literals, thunks, local statics ). It is the fallback for the names
+// MsvcDemangler::demangle rejects, false if the name is not undecorated either
+bool undecorateMsvcName(const std::string& decoratedName, std::string& result, DemangleMode mode = DemangleNameOnly);
+
+// MsvcDemangler with the undecorateMsvcName fallback,
+// returns the decorated name itself if it can not be demangled
+std::string demangleMsvcName(const std::string& decoratedName, DemangleMode mode = DemangleNameOnly);
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -4,6 +4,7 @@
 #include <vector>
 
 #include "kdlib\dbgtypedef.h"
+#include "kdlib\x86decoder.h"
 
 namespace kdlib {
 
@@ -80,5 +81,12 @@ private:
 
 /////////////////////////////////////////////////////////////////////////////////
 
+// Decodes instructions of [begin, end) without the engine disassembler: the memory is
+// read by large blocks and the instructions are appended to the vector. The last
+// instruction may cross the end. Text is made by formatX86Instruction on demand
+void decodeRange( MEMOFFSET_64 begin, MEMOFFSET_64 end, std::vector<X86Instruction>& instructions );
+
+/////////////////////////////////////////////////////////////////////////////////
+
 } ; // end pykd namespace
 
@@ -67,8 +67,8 @@ public:
     {}
 
 
-    EventHandler() {
-       registerEventsCallback(this);
+    explicit EventHandler(unsigned long eventsMask = DebugEventAll) {
+       registerEventsCallback(this, eventsMask);
     }
 
     virtual ~EventHandler() {
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include "kdlib/dbgtypedef.h"
+#include "kdlib/dbgcallbacks.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// What to do with an event when the queue is full
+enum EventQueueOverflow {
+    EventQueueDrop,         // the event is lost and counted
+    EventQueueWait          // the engine thread waits for the consumer
+};
+
+struct EventQueueStatistics {
+    size_t  capacity;
+    size_t  depth;                  // events not delivered yet, with the batch in the delivery
+    size_t  maxDepth;
+    unsigned long long  queued;
+    unsigned long long  delivered;
+    unsigned long long  dropped;
+    unsigned long long  batches;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Asynchronous delivery of the events that do not need a DebugCallbackResult decision:
+// output, module load and unload, thread start and stop, local scope change. The engine
+// thread puts them into a bounded lock-free ring and returns DebugCallbackNoChange, a
+// consumer thread takes them by batches and calls the callback. The other events are
+// called on the engine thread as usual, so their order with the queued events is not kept.
+// The callback is called on the consumer thread: it must not use the debug engine
+//
+//     AsyncEventsCallback  asyncCallback(&tracer);
+//     registerEventsCallback(&asyncCallback, AsyncEventsCallback::queuedEvents);
+
+class AsyncEventsCallback : public DebugEventsCallback, private boost::noncopyable
+{
+public:
+
+    static const unsigned long  queuedEvents = DebugEventOutput | DebugEventModuleLoad | DebugEventModuleUnload |
+        DebugEventThreadStart | DebugEventThreadStop | DebugEventLocalScope;
+
+    // the capacity is rounded up to a power of two
+    explicit AsyncEventsCallback(
+        DebugEventsCallback* callback,
+        size_t capacity = 0x1000,
+        EventQueueOverflow overflow = EventQueueDrop );
+
+    // removes the callback from the engine if it is registered; the queued events are
+    // delivered before the consumer thread stops
+    virtual ~AsyncEventsCallback();
+
+    // waits until all the queued events are delivered
+    void flush();
+
+    EventQueueStatistics getStatistics() const;
+
+public:
+
+    virtual DebugCallbackResult onBreakpoint( BREAKPOINT_ID bpId );
+    virtual DebugCallbackResult onException( const ExceptionInfo &exceptionInfo );
+    virtual void onExecutionStatusChange( ExecutionStatus executionStatus );
+    virtual DebugCallbackResult onModuleLoad( MEMOFFSET_64 offset, const std::wstring &name );
+    virtual DebugCallbackResult onModuleUnload( MEMOFFSET_64 offset, const std::wstring &name );
+    virtual DebugCallbackResult onProcessStart(PROCESS_DEBUG_ID processid);
+    virtual DebugCallbackResult onProcessExit( PROCESS_DEBUG_ID processid, ProcessExitReason  reason, unsigned long exitCode );
+    virtual DebugCallbackResult onThreadStart();
+    virtual DebugCallbackResult onThreadStop();
+    virtual void onCurrentThreadChange(THREAD_DEBUG_ID threadid);
+    virtual void onChangeLocalScope();
+    virtual void onChangeSymbolPaths();
+    virtual void onChangeBreakpoints();
+    virtual void onDebugOutput(const std::wstring& text, OutputFlag flag);
+    virtual void onStartInput();
+    virtual void onStopInput();
+
+private:
+
+    struct QueuedEvent {
+        unsigned long  eventId;     // DebugEventsMask bit
+        MEMOFFSET_64  offset;
+        std::wstring  text;
+        OutputFlag  flag;
+    };
+
+    // a slot is free for the push at the position equal to its sequence and is ready
+    // for the pop at the sequence equal to the position + 1
+    struct Slot {
+        boost::atomic<size_t>  sequence;
+        QueuedEvent  event;
+    };
+
+    void push(QueuedEvent& event);
+    bool tryPush(QueuedEvent& event);
+    bool tryPop(QueuedEvent& event);
+
+    void consumerThread();
+    void deliver(const QueuedEvent& event);
+    void notifyDelivery();
+
+    DebugEventsCallback*  m_callback;
+    EventQueueOverflow  m_overflow;
+
+    size_t  m_capacity;
+    boost::scoped_array<Slot>  m_slots;
+
+    boost::atomic<size_t>  m_pushPos;
+    size_t  m_popPos;       // the consumer thread only
+
+    boost::atomic<size_t>  m_maxDepth;
+    boost::atomic<unsigned long long>  m_queued;
+    boost::atomic<unsigned long long>  m_delivered;
+    boost::atomic<unsigned long long>  m_dropped;
+    boost::atomic<unsigned long long>  m_batches;
+
+    boost::atomic<bool>  m_consumerWaiting;
+    boost::atomic<bool>  m_stop;
+    boost::mutex  m_waitLock;
+    boost::condition_variable  m_waitEvent;
+
+    // the producers waiting for a free slot ( EventQueueWait ) and flush waiting for the delivery
+    boost::atomic<size_t>  m_deliveryWaiters;
+    boost::condition_variable  m_deliveryEvent;
+
+    boost::thread  m_consumer;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
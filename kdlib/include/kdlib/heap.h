@@ -1,6 +1,11 @@
 #pragma once
 
+#include <map>
+#include <vector>
+#include <functional>
+
 #include <boost/smart_ptr.hpp>
+#include <boost/thread/recursive_mutex.hpp>
 
 #include "kdlib/dbgtypedef.h"
 #include "kdlib/typedvar.h"
@@ -15,6 +20,41 @@ typedef boost::shared_ptr<TargetHeap>  TargetHeapPtr;
 class TargetHeapEnum;
 typedef boost::shared_ptr<TargetHeapEnum>  TargetHeapEnumPtr;
 
+class FnMatcher;
+
+// Type of a heap object as the runtime identifies it ( COR_TYPEID for the CLR heap )
+
+struct HeapTypeId {
+    unsigned long long  token1;
+    unsigned long long  token2;
+};
+
+inline bool operator< (const HeapTypeId& id1, const HeapTypeId& id2)
+{
+    if (id1.token1 != id2.token1)
+        return id1.token1 < id2.token1;
+    return id1.token2 < id2.token2;
+}
+
+struct HeapObject {
+    MEMOFFSET_64  address;
+    size_t  size;
+    HeapTypeId  typeId;
+};
+
+// objects by one read of the heap walk
+const size_t  HeapObjectBatchSize = 0x1000;
+
+// "!dumpheap -stat": objects count and size by types
+struct HeapTypeStatistics {
+    std::wstring  typeName;
+    size_t  count;
+    unsigned long long  totalSize;
+};
+
+// sorted by the total size
+typedef std::vector<HeapTypeStatistics>  HeapStatistics;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class TargetHeap  
@@ -24,6 +64,8 @@ public:
     virtual size_t  getCount(const std::wstring&  typeName=L"", size_t minSize = 0, size_t maxSize = -1) const = 0;
 
     virtual TargetHeapEnumPtr  getEnum(const std::wstring&  typeName=L"", size_t minSize = 0, size_t maxSize = -1)  = 0;
+
+    virtual HeapStatistics  getStatistics(const std::wstring&  typeName=L"", size_t minSize = 0, size_t maxSize = -1) const = 0;
 };
 
 class TargetHeapEnum
@@ -32,9 +74,140 @@ public:
 
     virtual bool next(MEMOFFSET_64& addr, std::wstring& typeName, size_t&  typeSize) = 0;
 
+    // the next block of the matched objects without the type names, false at the end of the heap
+    virtual bool nextBatch(std::vector<HeapObject>& objects) = 0;
+
     virtual size_t getCount() const = 0;
 };
 
+// Raw objects of a heap walk
+class HeapObjectSource;
+typedef boost::shared_ptr<HeapObjectSource>  HeapObjectSourcePtr;
+typedef std::function<HeapObjectSourcePtr()>  HeapObjectSourceFactory;
+
+class HeapObjectSource
+{
+public:
+
+    virtual ~HeapObjectSource()
+    {}
+
+    // reads up to maxCount objects, returns 0 at the end of the heap
+    virtual size_t read(HeapObject* objects, size_t maxCount) = 0;
+
+    bool next(HeapObject& heapObject) {
+        return read(&heapObject, 1) == 1;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Types of the heap objects by id: a heap has a lot of objects but few types, so a type
+// is built once and shared by all the enumerations of the process. Thread safe
+
+class HeapTypeCache;
+typedef boost::shared_ptr<HeapTypeCache>  HeapTypeCachePtr;
+
+class HeapTypeCache
+{
+public:
+
+    typedef std::function<TypeInfoPtr(const HeapTypeId&)>  TypeResolver;
+
+    explicit HeapTypeCache(const TypeResolver& resolver) :
+        m_resolver(resolver)
+    {}
+
+    TypeInfoPtr getType(const HeapTypeId& typeId);
+
+    std::wstring getTypeName(const HeapTypeId& typeId);
+
+    size_t getSize() const;
+
+    void clear();
+
+private:
+
+    struct TypeEntry {
+        TypeInfoPtr  typeInfo;
+        std::wstring  typeName;
+    };
+
+    const TypeEntry& getEntry(const HeapTypeId& typeId);
+
+    TypeResolver  m_resolver;
+
+    mutable boost::recursive_mutex  m_lock;
+    std::map<HeapTypeId, TypeEntry>  m_types;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Enumeration of a heap walk with a filter by the type name mask and the object size.
+// Objects are read by blocks of batchSize and filtered by the block: the size first,
+// then the type id. The mask is compiled once and matched once per type, not once per object
+
+class HeapObjectEnum : public TargetHeapEnum
+{
+public:
+
+    HeapObjectEnum(
+        const HeapObjectSourceFactory& sourceFactory,
+        const HeapTypeCachePtr& typeCache,
+        const std::wstring& typeMask = L"",
+        size_t minSize = 0,
+        size_t maxSize = -1,
+        size_t batchSize = HeapObjectBatchSize );
+
+    virtual bool next(MEMOFFSET_64& addr, std::wstring& typeName, size_t&  typeSize);
+
+    virtual bool nextBatch(std::vector<HeapObject>& objects);
+
+    virtual size_t getCount() const;
+
+private:
+
+    bool matchSize(const HeapObject& heapObject) const {
+        return (m_minSize == 0 || heapObject.size >= m_minSize) && (m_maxSize == -1 || heapObject.size <= m_maxSize);
+    }
+
+    bool matchType(const HeapTypeId& typeId, std::map<HeapTypeId, bool>& matchedTypes) const;
+
+    // removes the unmatched objects from the block, returns the new count
+    size_t filterBatch(HeapObject* objects, size_t count, std::map<HeapTypeId, bool>& matchedTypes) const;
+
+    bool readBatch();
+
+    // the heap walk starts on the first next(): getCount makes its own walk
+    HeapObjectSourceFactory  m_sourceFactory;
+    HeapObjectSourcePtr  m_source;
+    HeapTypeCachePtr  m_typeCache;
+
+    boost::shared_ptr<FnMatcher>  m_typeMask;
+    size_t  m_minSize;
+    size_t  m_maxSize;
+
+    // matched objects of the last block, next() takes them from m_batchPos
+    size_t  m_batchSize;
+    std::vector<HeapObject>  m_batch;
+    size_t  m_batchPos;
+
+    std::map<HeapTypeId, bool>  m_matchedTypes;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// One walk of the heap by large blocks: objects are filtered by size and summed up by
+// type ids, the names are resolved and matched with the mask only for the found types
+HeapStatistics getHeapStatistics(
+    const HeapObjectSourcePtr& source,
+    const HeapTypeCachePtr& typeCache,
+    const std::wstring& typeMask = L"",
+    size_t minSize = 0,
+    size_t maxSize = -1 );
+
+///////////////////////////////////////////////////////////////////////////////
+
 TargetHeapPtr getManagedHeap();
 
 TypedVarPtr getManagedVar(MEMOFFSET_64 addr);
@@ -12,6 +12,7 @@
 #include "kdlib/typeinfo.h"
 #include "kdlib/variant.h"
 #include "kdlib/typedvar.h"
+#include "kdlib/codeanalysis.h"
 
 namespace kdlib {
 
@@ -117,6 +118,9 @@ public:
     virtual void getFixedFileInfo( FixedFileInfo &fixedFileInfo ) = 0;
 
     virtual ScopePtr getScope() = 0;
+
+    // functions, basic blocks and references of the module code: built on the first call
+    virtual CodeIndexPtr getCodeIndex() = 0;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
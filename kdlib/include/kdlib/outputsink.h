@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Receiver of the captured output of a debug command: the text comes by the chunks as the
+// engine prints it while the command is running, flush is called when the command is done
+
+class OutputSink
+{
+public:
+
+    virtual void write( const wchar_t* text, size_t length ) = 0;
+
+    virtual void flush()
+    {}
+
+protected:
+
+    virtual ~OutputSink()
+    {}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Splits the output into the lines: onLine gets each line without its end as soon as the line
+// is complete, the last line without an end comes on flush
+
+class OutputLineSink : public OutputSink
+{
+public:
+
+    virtual void onLine( const wchar_t* line, size_t length ) = 0;
+
+    virtual void write( const wchar_t* text, size_t length );
+
+    virtual void flush();
+
+private:
+
+    void putLine( const wchar_t* line, size_t length );
+
+    std::wstring  m_tail;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Keeps the output in the chunks of a fixed capacity: a chunk is never reallocated, so a large
+// output is neither copied while it grows nor takes the doubled memory of a growing string
+
+class OutputChunks : public OutputSink, private boost::noncopyable
+{
+public:
+
+    explicit OutputChunks( size_t chunkSize = 0x10000 );
+
+    virtual void write( const wchar_t* text, size_t length );
+
+    size_t size() const {
+        return m_size;
+    }
+
+    size_t getChunkCount() const {
+        return m_chunks.size();
+    }
+
+    const std::wstring& getChunk( size_t index ) const {
+        return m_chunks[index];
+    }
+
+    // joins the chunks with one allocation
+    std::wstring str() const;
+
+    void clear();
+
+private:
+
+    size_t  m_chunkSize;
+    size_t  m_size;
+    std::vector<std::wstring>  m_chunks;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "kdlib/dbgtypedef.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum PEImageLayout {
+    PEImageMapped,      // sections are placed at their RVA ( a loaded module )
+    PEImageFile         // sections are placed at their raw data offset ( a file on disk )
+};
+
+struct PEExport {
+    std::string  name;
+    MEMOFFSET_32  rva;
+    unsigned short  ordinal;    // index in the address table, without the directory ordinal base
+    bool  forwarded;            // rva points to a forwarder string ( "NTDLL.RtlAllocateHeap" )
+};
+
+struct PEExportDirectory {
+    unsigned short  machine;
+    std::vector<PEExport>  exports;
+};
+
+struct PESection {
+    std::string  name;
+    MEMOFFSET_32  rva;
+    MEMOFFSET_32  size;
+    unsigned long  characteristics;     // IMAGE_SCN_XXX
+
+    bool isExecutable() const {
+        return (characteristics & 0x20000000) != 0;   // IMAGE_SCN_MEM_EXECUTE
+    }
+};
+
+struct PERuntimeFunction {
+    MEMOFFSET_32  begin;
+    MEMOFFSET_32  end;
+};
+
+struct PECodeDirectory {
+    unsigned short  machine;
+    unsigned long  timeDataStamp;
+    unsigned long  checkSum;
+    MEMOFFSET_32  imageSize;
+    MEMOFFSET_32  entryPoint;           // 0 for an image without an entry point
+    std::vector<PESection>  sections;
+    std::vector<PERuntimeFunction>  runtimeFunctions;   // .pdata of an x64 image
+};
+
+// reads a block of the image at the offset given in the image layout, throws on failure
+typedef std::function<void(MEMOFFSET_32 offset, void* buffer, size_t length)>  PEImageReader;
+
+PEExportDirectory getPEExports(const PEImageReader& reader, PEImageLayout layout = PEImageMapped);
+PEExportDirectory getPEExports(const void* image, size_t imageSize, PEImageLayout layout = PEImageFile);
+
+PECodeDirectory getPECode(const PEImageReader& reader, PEImageLayout layout = PEImageMapped);
+PECodeDirectory getPECode(const void* image, size_t imageSize, PEImageLayout layout = PEImageFile);
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
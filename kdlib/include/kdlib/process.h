@@ -8,6 +8,7 @@
 #include "kdlib/stack.h"
 #include "kdlib/variant.h"
 #include "kdlib/heap.h"
+#include "kdlib/cpucontext.h"
 
 namespace kdlib {
 
@@ -83,6 +84,10 @@ public:
     virtual TargetThreadPtr getThreadBySystemId(THREAD_ID tid) = 0;
     virtual TargetThreadPtr getCurrentThread() = 0;
 
+    virtual RegisterSnapshot getRegisterSnapshot(
+        const std::vector<std::wstring>& registers = std::vector<std::wstring>(),
+        const std::vector<THREAD_DEBUG_ID>& threads = std::vector<THREAD_DEBUG_ID>() ) = 0;
+
     virtual unsigned long getNumberModules() = 0;
     virtual ModulePtr getModuleByIndex(unsigned long index) = 0;
     virtual ModulePtr getModuleByOffset(MEMOFFSET_64  offset) = 0;
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <string>
+
+#include "kdlib/typedvar.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum SerializerFormat {
+    SerializerJson,
+    SerializerCbor                  // RFC 7049 with definite lengths
+};
+
+enum SerializerPointers {
+    SerializerPointerValue,         // a pointer is a number
+    SerializerPointerFollowUdt,     // pointers to structures and classes are followed
+    SerializerPointerFollowAll      // all the typed pointers are followed
+};
+
+struct SerializerOptions {
+
+    SerializerOptions() :
+        format(SerializerJson),
+        pointers(SerializerPointerValue),
+        maxDepth(8),
+        maxArrayElements(0x10000)
+    {}
+
+    SerializerFormat  format;
+    SerializerPointers  pointers;
+    size_t  maxDepth;
+    size_t  maxArrayElements;
+};
+
+// Output of the serializer: the bytes come by chunks as they are produced
+class SerializerSink {
+
+public:
+
+    virtual void write(const char* data, size_t length) = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Writes a typed variable as a tree of values, each object is taken from the target with
+// one memory read and its fields are decoded from the buffer:
+//   base types - numbers and booleans, Char and WChar arrays - strings up to the first zero
+//   structures - maps of the field names, static and constant members are skipped
+//   arrays - arrays with maxArrayElements elements at most
+//   pointers - numbers, a followed pointer is the map { "address": ..., "value": ... }
+// A pointer is not followed deeper than maxDepth, to an object which is already written
+// or to the invalid memory. Structures and arrays deeper than maxDepth are nulls
+
+void serializeTypedVar(const TypedVarPtr& var, SerializerSink& sink, const SerializerOptions& options = SerializerOptions());
+
+std::string serializeTypedVar(const TypedVarPtr& var, const SerializerOptions& options = SerializerOptions());
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <string>
+#include <type_traits>
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Integers are written to a buffer on the stack from its end without a locale, the functions
+// return the first character. maxNumberChars is enough for any 64-bit number with a sign or a base
+const size_t  maxNumberChars = 24;
+
+template<typename T, typename CharT>
+CharT* formatDec(T value, CharT* end)
+{
+    static_assert(std::is_integral<T>::value, "integer type is expected");
+
+    bool  negative = value < 0;
+    unsigned long long  absValue = negative ? 0ULL - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+
+    do {
+        *--end = static_cast<CharT>('0' + absValue % 10);
+        absValue /= 10;
+    } while (absValue != 0);
+
+    if (negative)
+        *--end = static_cast<CharT>('-');
+
+    return end;
+}
+
+// a negative number is written as its two's complement of the same size, as std::hex does
+template<typename T, typename CharT>
+CharT* formatHex(T value, CharT* end, size_t width = 0)
+{
+    static_assert(std::is_integral<T>::value, "integer type is expected");
+
+    unsigned long long  unsignedValue = static_cast<typename std::make_unsigned<T>::type>(value);
+    CharT*  begin = end;
+
+    do {
+        *--begin = static_cast<CharT>("0123456789abcdef"[unsignedValue & 0xF]);
+        unsignedValue >>= 4;
+    } while (unsignedValue != 0);
+
+    while (static_cast<size_t>(end - begin) < width)
+        *--begin = static_cast<CharT>('0');
+
+    return begin;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Output buffer for the text descriptions: the same buffer is passed through the nested calls
+// and may be cleared and reused for the next description without a new allocation
+
+class StrBuffer
+{
+public:
+
+    explicit StrBuffer(size_t capacity = 0x100) {
+        m_buffer.reserve(capacity);
+    }
+
+    StrBuffer& append(wchar_t ch) {
+        m_buffer.push_back(ch);
+        return *this;
+    }
+
+    StrBuffer& append(const wchar_t* str) {
+        m_buffer.append(str);
+        return *this;
+    }
+
+    StrBuffer& append(const std::wstring& str) {
+        m_buffer.append(str);
+        return *this;
+    }
+
+    StrBuffer& append(const wchar_t* begin, const wchar_t* end) {
+        m_buffer.append(begin, end);
+        return *this;
+    }
+
+    template<typename T>
+    StrBuffer& appendDec(T value) {
+        wchar_t  buffer[maxNumberChars];
+        return append(formatDec(value, buffer + maxNumberChars), buffer + maxNumberChars);
+    }
+
+    // as std::showbase: "0x" before a non-zero value
+    template<typename T>
+    StrBuffer& appendHex(T value) {
+        wchar_t  buffer[maxNumberChars];
+        wchar_t*  begin = formatHex(value, buffer + maxNumberChars);
+        if (value != 0)
+        {
+            *--begin = L'x';
+            *--begin = L'0';
+        }
+        return append(begin, buffer + maxNumberChars);
+    }
+
+    // without a base, padded by zeros on the left up to the width
+    template<typename T>
+    StrBuffer& appendHex(T value, size_t width) {
+        wchar_t  buffer[maxNumberChars];
+        if (width > maxNumberChars)
+        {
+            m_buffer.append(width - maxNumberChars, L'0');
+            width = maxNumberChars;
+        }
+        return append(formatHex(value, buffer + maxNumberChars, width), buffer + maxNumberChars);
+    }
+
+    // left aligned, padded by spaces on the right up to the width
+    StrBuffer& appendPadded(const std::wstring& str, size_t width) {
+        m_buffer.append(str);
+        if (str.size() < width)
+            m_buffer.append(width - str.size(), L' ');
+        return *this;
+    }
+
+    const std::wstring& str() const {
+        return m_buffer;
+    }
+
+    size_t size() const {
+        return m_buffer.size();
+    }
+
+    // keeps the capacity
+    void clear() {
+        m_buffer.clear();
+    }
+
+private:
+
+    std::wstring  m_buffer;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
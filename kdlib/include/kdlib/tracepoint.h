@@ -0,0 +1,96 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/smart_ptr.hpp>
+#include <boost/noncopyable.hpp>
+
+#include "kdlib/dbgtypedef.h"
+#include "kdlib/breakpoint.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+const size_t  maxTracepointRegisters = 4;
+
+struct TracepointSample {
+    unsigned long long  timestamp;      // microseconds of the steady clock
+    size_t  tracepoint;                 // index in the set
+    THREAD_DEBUG_ID  threadId;
+    MEMOFFSET_64  ip;
+    unsigned long long  registers[maxTracepointRegisters];     // in the order of the set register names
+};
+
+struct TracepointHits {
+    MEMOFFSET_64  offset;
+    unsigned long long  hitCount;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Breakpoints that never stop the target and never leave the native code: each hit is
+// counted by its breakpoint, each sampleRate-th hit of a breakpoint is recorded into a
+// lock-free ring of samples shared by the set. A script polls the counters and takes the
+// samples from time to time, the samples are dropped while the ring is full. A sample which
+// can not be captured ( the registers are not read ) is counted as failed and not recorded
+
+class TracepointSet : private boost::noncopyable
+{
+public:
+
+    // the registers are resolved by name here, the capacity is rounded up to a power of two
+    explicit TracepointSet(
+        const std::vector<std::wstring>& registerNames = std::vector<std::wstring>(),
+        unsigned long sampleRate = 1,
+        size_t capacity = 0x1000 );
+
+    // removes the breakpoints
+    ~TracepointSet();
+
+    // returns the index of the tracepoint in the set
+    size_t add(MEMOFFSET_64 offset);
+
+    size_t getCount() const {
+        return m_tracepoints.size();
+    }
+
+    std::vector<TracepointHits> getHits() const;
+
+    // appends all the recorded samples
+    void readSamples(std::vector<TracepointSample>& samples);
+
+    unsigned long long getDroppedSamples() const {
+        return m_dropped;
+    }
+
+    unsigned long long getFailedSamples() const {
+        return m_failed;
+    }
+
+private:
+
+    class Tracepoint;
+    friend class Tracepoint;
+
+    void record(size_t tracepoint);
+
+    std::vector<boost::shared_ptr<Tracepoint> >  m_tracepoints;
+
+    std::vector<unsigned long>  m_registers;
+    unsigned long  m_sampleRate;
+
+    // single producer ( the engine thread ) and single consumer ring
+    size_t  m_capacity;
+    boost::scoped_array<TracepointSample>  m_samples;
+    boost::atomic<size_t>  m_writePos;
+    boost::atomic<size_t>  m_readPos;
+    boost::atomic<unsigned long long>  m_dropped;
+    boost::atomic<unsigned long long>  m_failed;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -5,6 +5,7 @@
 
 #include <boost/utility.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "kdlib/typeinfo.h"
 #include "kdlib/variant.h"
@@ -26,6 +27,9 @@ typedef boost::shared_ptr<StackFrame>  StackFramePtr;
 class Scope;
 typedef boost::shared_ptr<Scope>  ScopePtr;
 
+class CompiledExpr;
+typedef boost::shared_ptr<CompiledExpr>  CompiledExprPtr;
+
 ///////////////////////////////////////////////////////////////////////////////
 
 TypedVarPtr loadTypedVar( const std::wstring &varName );
@@ -138,6 +142,16 @@ public:
     virtual TypedVarList getInlineFunctions(MEMOFFSET_64 offset) = 0;
     virtual void getSourceLine(MEMOFFSET_64 offset, std::wstring& fileName, unsigned long& lineno) = 0;
 
+    // the same as str() and printValue() but append the text to the buffer: a dump of many
+    // variables passes one buffer through all the nested calls
+    virtual void str(StrBuffer& buffer) {
+        buffer.append(str());
+    }
+
+    virtual void printValue(StrBuffer& buffer) const {
+        buffer.append(printValue());
+    }
+
 protected:
 
     TypedVar() 
@@ -415,6 +429,27 @@ ScopePtr getDefaultScope();
 
 TypedValue callRaw(MEMOFFSET_64 addr, CallingConventionType callingConvention, const TypedValueList& arglst);
 
+class FunctionCallContext;
+
+// Repeated calls of a target function from the current instruction. The CPU context is saved
+// and the return breakpoint is set by the constructor, the destructor removes the breakpoint
+// and restores the context. Between the calls the target keeps the registers of the last call
+class FunctionCallSite : private boost::noncopyable
+{
+public:
+
+    explicit FunctionCallSite(const TypedVarPtr& function);
+
+    ~FunctionCallSite();
+
+    TypedValue call(const TypedValueList& arglst);
+
+private:
+
+    TypedVarPtr  m_function;
+    boost::scoped_ptr<FunctionCallContext>  m_context;
+};
+
 TypedValue evalExpr(
     const std::wstring& expr,
     const ScopePtr& scope = getDefaultScope(),
@@ -427,4 +462,28 @@ TypedValue evalExpr(
 
 ///////////////////////////////////////////////////////////////////////////////
 
+class CompiledExpr : private boost::noncopyable
+{
+public:
+
+    virtual TypedValue eval(const ScopePtr& scope = getDefaultScope()) = 0;
+
+    virtual std::wstring getExpr() const = 0;
+
+protected:
+
+    virtual ~CompiledExpr()
+    {}
+};
+
+CompiledExprPtr compileExpr(
+    const std::wstring& expr,
+    const TypeInfoProviderPtr& typeInfoProvider = getDefaultTypeInfoProvider());
+
+CompiledExprPtr compileExpr(
+    const std::string& expr,
+    const TypeInfoProviderPtr& typeInfoProvider = getDefaultTypeInfoProvider());
+
+///////////////////////////////////////////////////////////////////////////////
+
 } // end kdlib namespace
@@ -214,6 +214,14 @@ TypeInfoProviderPtr  getTypeInfoProviderFromSource(const std::string&  source, c
 TypeInfoProviderPtr  getTypeInfoProviderFromPdb( const std::wstring&  pdbFile, MEMOFFSET_64  loadBase = 0 );
 TypeInfoProviderPtr  getDefaultTypeInfoProvider();
 
+struct TypeInfoProviderStatistics {
+    double  compileTime;        // clang frontend: preprocessing, parsing and semantic analysis ( seconds )
+    double  typeCollectTime;    // building the provider's type table ( seconds )
+    size_t  precompiledSize;    // length of the source prefix taken from a precompiled header, 0 if none
+};
+
+TypeInfoProviderStatistics  getTypeInfoProviderStatistics( const TypeInfoProviderPtr&  typeInfoProvider );
+
 SymbolProviderPtr  getSymbolProviderFromSource(const std::wstring& source, const std::wstring&  opts = L"");
 SymbolProviderPtr  getSymbolProviderFromSource(const std::string& source, const std::string&  opts = "");
 
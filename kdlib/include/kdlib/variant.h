@@ -6,6 +6,8 @@
 
 #include <boost/operators.hpp>
 
+#include "kdlib/strformat.h"
+
 namespace kdlib {
 
 
@@ -278,10 +280,19 @@ public:
     }
 
     std::wstring asStr() const {
+        StrBuffer  buffer(maxNumberChars);
+        printStr(buffer);
+        return buffer.str();
+    }
 
-        std::wstringstream sstr;
+    std::wstring asHex() const {
+        StrBuffer  buffer(maxNumberChars);
+        printHex(buffer);
+        return buffer.str();
+    }
 
-        sstr << std::dec;
+    // the integers are formatted without a stream, the floats still go through a stream
+    void printStr(StrBuffer& buffer) const {
 
         switch (m_numType)
         {
@@ -289,43 +300,39 @@ public:
         case shortT:
         case longT:
         case intT:
-            sstr << asInt();
-            return sstr.str();
+            buffer.appendDec(asInt());
+            return;
 
         case ucharT:
         case ushortT:
         case ulongT:
         case uintT:
-            sstr << asUInt();
-            return sstr.str();
+            buffer.appendDec(asUInt());
+            return;
 
         case longlongT:
-            sstr << m_longlongVal;
-            return sstr.str();
+            buffer.appendDec(m_longlongVal);
+            return;
 
         case ulonglongT:
-            sstr << m_ulonglongVal;
-            return sstr.str();
+            buffer.appendDec(m_ulonglongVal);
+            return;
 
         case floatT:
-            sstr.precision(8);
-            sstr << std::defaultfloat << m_floatVal;
-            return sstr.str();
-
         case doubleT:
-            sstr.precision(16);
-            sstr << std::defaultfloat << m_doubleVal;
-            return sstr.str();
+            {
+                std::wstringstream sstr;
+                sstr.precision(m_numType == floatT ? 8 : 16);
+                sstr << std::defaultfloat << asDouble();
+                buffer.append(sstr.str());
+            }
+            return;
         }
 
         throw NumVariantError();
     }
 
-    std::wstring asHex() const {
-
-        std::wstringstream sstr;
-
-        sstr << std::hex << std::showbase;
+    void printHex(StrBuffer& buffer) const {
 
         switch (m_numType)
         {
@@ -333,33 +340,33 @@ public:
         case shortT:
         case longT:
         case intT:
-            sstr << asInt();
-            return sstr.str();
+            buffer.appendHex(asInt());
+            return;
 
         case ucharT:
         case ushortT:
         case ulongT:
         case uintT:
-            sstr << asUInt();
-            return sstr.str();
+            buffer.appendHex(asUInt());
+            return;
 
         case longlongT:
-            sstr << m_longlongVal;
-            return sstr.str();
+            buffer.appendHex(m_longlongVal);
+            return;
 
         case ulonglongT:
-            sstr << m_ulonglongVal;
-            return sstr.str();
+            buffer.appendHex(m_ulonglongVal);
+            return;
 
         case floatT:
-            sstr.precision(8);
-            sstr << std::hexfloat << m_floatVal;
-            return sstr.str();
-
         case doubleT:
-            sstr.precision(8);
-            sstr << std::hexfloat << m_doubleVal;
-            return sstr.str();
+            {
+                std::wstringstream sstr;
+                sstr.precision(8);
+                sstr << std::showbase << std::hexfloat << asDouble();
+                buffer.append(sstr.str());
+            }
+            return;
         }
 
         throw NumVariantError();
@@ -0,0 +1,266 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "kdlib/dbgtypedef.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+#define X86_MNEMONICS(X) \
+    X(Invalid, "(bad)") \
+    X(Unknown, "(unknown)") \
+    X(Aaa, "aaa") X(Aad, "aad") X(Aam, "aam") X(Aas, "aas") \
+    X(Adc, "adc") X(Add, "add") X(And, "and") X(Arpl, "arpl") \
+    X(Bound, "bound") X(Bsf, "bsf") X(Bsr, "bsr") X(Bswap, "bswap") \
+    X(Bt, "bt") X(Btc, "btc") X(Btr, "btr") X(Bts, "bts") \
+    X(Call, "call") X(CallFar, "call far") \
+    X(Cbw, "cbw") X(Cwde, "cwde") X(Cdqe, "cdqe") \
+    X(Cwd, "cwd") X(Cdq, "cdq") X(Cqo, "cqo") \
+    X(Clc, "clc") X(Cld, "cld") X(Cli, "cli") X(Clts, "clts") X(Cmc, "cmc") X(Cmp, "cmp") \
+    X(Cmps, "cmps") X(Cmpxchg, "cmpxchg") X(Cmpxchg8b, "cmpxchg8b") X(Cmpxchg16b, "cmpxchg16b") \
+    X(Cpuid, "cpuid") X(Daa, "daa") X(Das, "das") X(Dec, "dec") X(Div, "div") \
+    X(Enter, "enter") X(Hlt, "hlt") X(Idiv, "idiv") X(Imul, "imul") X(In, "in") X(Inc, "inc") \
+    X(Ins, "ins") X(Int, "int") X(Int1, "int1") X(Int3, "int 3") X(Into, "into") X(Invd, "invd") X(Invlpg, "invlpg") \
+    X(Iret, "iret") X(Iretd, "iretd") X(Iretq, "iretq") \
+    X(Jo, "jo") X(Jno, "jno") X(Jb, "jb") X(Jae, "jae") X(Je, "je") X(Jne, "jne") X(Jbe, "jbe") X(Ja, "ja") \
+    X(Js, "js") X(Jns, "jns") X(Jp, "jp") X(Jnp, "jnp") X(Jl, "jl") X(Jge, "jge") X(Jle, "jle") X(Jg, "jg") \
+    X(Jcxz, "jcxz") X(Jecxz, "jecxz") X(Jrcxz, "jrcxz") \
+    X(Jmp, "jmp") X(JmpFar, "jmp far") \
+    X(Lahf, "lahf") X(Lar, "lar") X(Lds, "lds") X(Lea, "lea") X(Leave, "leave") X(Les, "les") \
+    X(Lfs, "lfs") X(Lgs, "lgs") X(Lss, "lss") X(Lgdt, "lgdt") X(Lidt, "lidt") X(Lldt, "lldt") X(Lmsw, "lmsw") \
+    X(Lods, "lods") X(Loopne, "loopne") X(Loope, "loope") X(Loop, "loop") X(Lsl, "lsl") X(Ltr, "ltr") \
+    X(Mov, "mov") X(Movs, "movs") X(Movsx, "movsx") X(Movsxd, "movsxd") X(Movzx, "movzx") X(Movbe, "movbe") \
+    X(Mul, "mul") X(Neg, "neg") X(Nop, "nop") X(Not, "not") X(Or, "or") X(Out, "out") X(Outs, "outs") \
+    X(Pause, "pause") X(Pop, "pop") X(Popa, "popa") X(Popad, "popad") \
+    X(Popf, "popf") X(Popfd, "popfd") X(Popfq, "popfq") \
+    X(Push, "push") X(Pusha, "pusha") X(Pushad, "pushad") \
+    X(Pushf, "pushf") X(Pushfd, "pushfd") X(Pushfq, "pushfq") \
+    X(Rcl, "rcl") X(Rcr, "rcr") X(Rol, "rol") X(Ror, "ror") \
+    X(Rdmsr, "rdmsr") X(Rdpmc, "rdpmc") X(Rdtsc, "rdtsc") X(Rdtscp, "rdtscp") X(Rdrand, "rdrand") X(Rdseed, "rdseed") \
+    X(Ret, "ret") X(Retf, "retf") X(Rsm, "rsm") X(Sahf, "sahf") X(Salc, "salc") \
+    X(Sal, "sal") X(Sar, "sar") X(Shl, "shl") X(Shr, "shr") X(Shld, "shld") X(Shrd, "shrd") \
+    X(Sbb, "sbb") X(Scas, "scas") \
+    X(Seto, "seto") X(Setno, "setno") X(Setb, "setb") X(Setae, "setae") X(Sete, "sete") X(Setne, "setne") X(Setbe, "setbe") X(Seta, "seta") \
+    X(Sets, "sets") X(Setns, "setns") X(Setp, "setp") X(Setnp, "setnp") X(Setl, "setl") X(Setge, "setge") X(Setle, "setle") X(Setg, "setg") \
+    X(Cmovo, "cmovo") X(Cmovno, "cmovno") X(Cmovb, "cmovb") X(Cmovae, "cmovae") X(Cmove, "cmove") X(Cmovne, "cmovne") X(Cmovbe, "cmovbe") X(Cmova, "cmova") \
+    X(Cmovs, "cmovs") X(Cmovns, "cmovns") X(Cmovp, "cmovp") X(Cmovnp, "cmovnp") X(Cmovl, "cmovl") X(Cmovge, "cmovge") X(Cmovle, "cmovle") X(Cmovg, "cmovg") \
+    X(Sgdt, "sgdt") X(Sidt, "sidt") X(Sldt, "sldt") X(Smsw, "smsw") X(Str, "str") \
+    X(Stc, "stc") X(Std, "std") X(Sti, "sti") X(Stos, "stos") X(Sub, "sub") \
+    X(Swapgs, "swapgs") X(Syscall, "syscall") X(Sysenter, "sysenter") X(Sysexit, "sysexit") X(Sysret, "sysret") \
+    X(Test, "test") X(Ud0, "ud0") X(Ud1, "ud1") X(Ud2, "ud2") X(Verr, "verr") X(Verw, "verw") \
+    X(Wait, "wait") X(Wbinvd, "wbinvd") X(Wrmsr, "wrmsr") X(Xadd, "xadd") X(Xchg, "xchg") X(Xlat, "xlat") X(Xor, "xor") \
+    X(Popcnt, "popcnt") X(Tzcnt, "tzcnt") X(Lzcnt, "lzcnt") X(Crc32, "crc32") X(Adcx, "adcx") X(Adox, "adox") \
+    X(Endbr32, "endbr32") X(Endbr64, "endbr64") X(Xabort, "xabort") X(Xbegin, "xbegin") X(Xend, "xend") X(Xtest, "xtest") \
+    X(Xgetbv, "xgetbv") X(Xsetbv, "xsetbv") X(Monitor, "monitor") X(Mwait, "mwait") X(Clac, "clac") X(Stac, "stac") \
+    X(Vmcall, "vmcall") X(Vmlaunch, "vmlaunch") X(Vmresume, "vmresume") X(Vmxoff, "vmxoff") X(Vmread, "vmread") X(Vmwrite, "vmwrite") \
+    X(Vmptrld, "vmptrld") X(Vmptrst, "vmptrst") X(Vmclear, "vmclear") X(Vmxon, "vmxon") \
+    X(Prefetch, "prefetch") X(Prefetchw, "prefetchw") X(Prefetchnta, "prefetchnta") \
+    X(Prefetcht0, "prefetcht0") X(Prefetcht1, "prefetcht1") X(Prefetcht2, "prefetcht2") \
+    X(Fxsave, "fxsave") X(Fxrstor, "fxrstor") X(Ldmxcsr, "ldmxcsr") X(Stmxcsr, "stmxcsr") \
+    X(Xsave, "xsave") X(Xrstor, "xrstor") X(Xsaveopt, "xsaveopt") X(Clflush, "clflush") \
+    X(Lfence, "lfence") X(Mfence, "mfence") X(Sfence, "sfence") X(Emms, "emms") X(Femms, "femms") \
+    X(Movups, "movups") X(Movupd, "movupd") X(Movss, "movss") X(Movsd, "movsd") \
+    X(Movaps, "movaps") X(Movapd, "movapd") X(Movlps, "movlps") X(Movlpd, "movlpd") X(Movhps, "movhps") X(Movhpd, "movhpd") \
+    X(Movhlps, "movhlps") X(Movlhps, "movlhps") X(Movsldup, "movsldup") X(Movshdup, "movshdup") X(Movddup, "movddup") \
+    X(Movntps, "movntps") X(Movntpd, "movntpd") X(Movnti, "movnti") X(Movntq, "movntq") X(Movntdq, "movntdq") X(Movntdqa, "movntdqa") \
+    X(Movd, "movd") X(Movq, "movq") X(Movdqa, "movdqa") X(Movdqu, "movdqu") X(Movq2dq, "movq2dq") X(Movdq2q, "movdq2q") \
+    X(Movmskps, "movmskps") X(Movmskpd, "movmskpd") X(Pmovmskb, "pmovmskb") X(Maskmovq, "maskmovq") X(Maskmovdqu, "maskmovdqu") \
+    X(Lddqu, "lddqu") \
+    X(Unpcklps, "unpcklps") X(Unpcklpd, "unpcklpd") X(Unpckhps, "unpckhps") X(Unpckhpd, "unpckhpd") \
+    X(Cvtpi2ps, "cvtpi2ps") X(Cvtpi2pd, "cvtpi2pd") X(Cvtsi2ss, "cvtsi2ss") X(Cvtsi2sd, "cvtsi2sd") \
+    X(Cvttps2pi, "cvttps2pi") X(Cvttpd2pi, "cvttpd2pi") X(Cvttss2si, "cvttss2si") X(Cvttsd2si, "cvttsd2si") \
+    X(Cvtps2pi, "cvtps2pi") X(Cvtpd2pi, "cvtpd2pi") X(Cvtss2si, "cvtss2si") X(Cvtsd2si, "cvtsd2si") \
+    X(Cvtps2pd, "cvtps2pd") X(Cvtpd2ps, "cvtpd2ps") X(Cvtss2sd, "cvtss2sd") X(Cvtsd2ss, "cvtsd2ss") \
+    X(Cvtdq2ps, "cvtdq2ps") X(Cvtps2dq, "cvtps2dq") X(Cvttps2dq, "cvttps2dq") \
+    X(Cvttpd2dq, "cvttpd2dq") X(Cvtdq2pd, "cvtdq2pd") X(Cvtpd2dq, "cvtpd2dq") \
+    X(Ucomiss, "ucomiss") X(Ucomisd, "ucomisd") X(Comiss, "comiss") X(Comisd, "comisd") \
+    X(Sqrtps, "sqrtps") X(Sqrtpd, "sqrtpd") X(Sqrtss, "sqrtss") X(Sqrtsd, "sqrtsd") \
+    X(Rsqrtps, "rsqrtps") X(Rsqrtss, "rsqrtss") X(Rcpps, "rcpps") X(Rcpss, "rcpss") \
+    X(Andps, "andps") X(Andpd, "andpd") X(Andnps, "andnps") X(Andnpd, "andnpd") \
+    X(Orps, "orps") X(Orpd, "orpd") X(Xorps, "xorps") X(Xorpd, "xorpd") \
+    X(Addps, "addps") X(Addpd, "addpd") X(Addss, "addss") X(Addsd, "addsd") \
+    X(Mulps, "mulps") X(Mulpd, "mulpd") X(Mulss, "mulss") X(Mulsd, "mulsd") \
+    X(Subps, "subps") X(Subpd, "subpd") X(Subss, "subss") X(Subsd, "subsd") \
+    X(Minps, "minps") X(Minpd, "minpd") X(Minss, "minss") X(Minsd, "minsd") \
+    X(Divps, "divps") X(Divpd, "divpd") X(Divss, "divss") X(Divsd, "divsd") \
+    X(Maxps, "maxps") X(Maxpd, "maxpd") X(Maxss, "maxss") X(Maxsd, "maxsd") \
+    X(Cmpps, "cmpps") X(Cmppd, "cmppd") X(Cmpss, "cmpss") X(Cmpsd, "cmpsd") \
+    X(Shufps, "shufps") X(Shufpd, "shufpd") \
+    X(Haddpd, "haddpd") X(Haddps, "haddps") X(Hsubpd, "hsubpd") X(Hsubps, "hsubps") X(Addsubpd, "addsubpd") X(Addsubps, "addsubps") \
+    X(Punpcklbw, "punpcklbw") X(Punpcklwd, "punpcklwd") X(Punpckldq, "punpckldq") X(Packsswb, "packsswb") \
+    X(Pcmpgtb, "pcmpgtb") X(Pcmpgtw, "pcmpgtw") X(Pcmpgtd, "pcmpgtd") X(Packuswb, "packuswb") \
+    X(Punpckhbw, "punpckhbw") X(Punpckhwd, "punpckhwd") X(Punpckhdq, "punpckhdq") X(Packssdw, "packssdw") \
+    X(Punpcklqdq, "punpcklqdq") X(Punpckhqdq, "punpckhqdq") \
+    X(Pshufw, "pshufw") X(Pshufd, "pshufd") X(Pshufhw, "pshufhw") X(Pshuflw, "pshuflw") \
+    X(Pcmpeqb, "pcmpeqb") X(Pcmpeqw, "pcmpeqw") X(Pcmpeqd, "pcmpeqd") \
+    X(Psrlw, "psrlw") X(Psrld, "psrld") X(Psrlq, "psrlq") X(Psrldq, "psrldq") \
+    X(Psraw, "psraw") X(Psrad, "psrad") X(Psllw, "psllw") X(Pslld, "pslld") X(Psllq, "psllq") X(Pslldq, "pslldq") \
+    X(Pinsrw, "pinsrw") X(Pextrw, "pextrw") \
+    X(Paddq, "paddq") X(Pmullw, "pmullw") X(Psubusb, "psubusb") X(Psubusw, "psubusw") X(Pminub, "pminub") X(Pand, "pand") \
+    X(Paddusb, "paddusb") X(Paddusw, "paddusw") X(Pmaxub, "pmaxub") X(Pandn, "pandn") \
+    X(Pavgb, "pavgb") X(Pavgw, "pavgw") X(Pmulhuw, "pmulhuw") X(Pmulhw, "pmulhw") \
+    X(Psubsb, "psubsb") X(Psubsw, "psubsw") X(Pminsw, "pminsw") X(Por, "por") \
+    X(Paddsb, "paddsb") X(Paddsw, "paddsw") X(Pmaxsw, "pmaxsw") X(Pxor, "pxor") \
+    X(Pmuludq, "pmuludq") X(Pmaddwd, "pmaddwd") X(Psadbw, "psadbw") \
+    X(Psubb, "psubb") X(Psubw, "psubw") X(Psubd, "psubd") X(Psubq, "psubq") \
+    X(Paddb, "paddb") X(Paddw, "paddw") X(Paddd, "paddd") \
+    X(Pshufb, "pshufb") X(Phaddw, "phaddw") X(Phaddd, "phaddd") X(Phaddsw, "phaddsw") X(Pmaddubsw, "pmaddubsw") \
+    X(Phsubw, "phsubw") X(Phsubd, "phsubd") X(Phsubsw, "phsubsw") X(Psignb, "psignb") X(Psignw, "psignw") X(Psignd, "psignd") \
+    X(Pmulhrsw, "pmulhrsw") X(Pabsb, "pabsb") X(Pabsw, "pabsw") X(Pabsd, "pabsd") X(Palignr, "palignr") \
+    X(Pblendvb, "pblendvb") X(Blendvps, "blendvps") X(Blendvpd, "blendvpd") X(Ptest, "ptest") \
+    X(Pmovsxbw, "pmovsxbw") X(Pmovsxbd, "pmovsxbd") X(Pmovsxbq, "pmovsxbq") X(Pmovsxwd, "pmovsxwd") X(Pmovsxwq, "pmovsxwq") X(Pmovsxdq, "pmovsxdq") \
+    X(Pmovzxbw, "pmovzxbw") X(Pmovzxbd, "pmovzxbd") X(Pmovzxbq, "pmovzxbq") X(Pmovzxwd, "pmovzxwd") X(Pmovzxwq, "pmovzxwq") X(Pmovzxdq, "pmovzxdq") \
+    X(Pmuldq, "pmuldq") X(Pcmpeqq, "pcmpeqq") X(Packusdw, "packusdw") X(Pcmpgtq, "pcmpgtq") \
+    X(Pminsb, "pminsb") X(Pminsd, "pminsd") X(Pminuw, "pminuw") X(Pminud, "pminud") \
+    X(Pmaxsb, "pmaxsb") X(Pmaxsd, "pmaxsd") X(Pmaxuw, "pmaxuw") X(Pmaxud, "pmaxud") \
+    X(Pmulld, "pmulld") X(Phminposuw, "phminposuw") \
+    X(Aesimc, "aesimc") X(Aesenc, "aesenc") X(Aesenclast, "aesenclast") X(Aesdec, "aesdec") X(Aesdeclast, "aesdeclast") \
+    X(Aeskeygenassist, "aeskeygenassist") X(Pclmulqdq, "pclmulqdq") \
+    X(Roundps, "roundps") X(Roundpd, "roundpd") X(Roundss, "roundss") X(Roundsd, "roundsd") \
+    X(Blendps, "blendps") X(Blendpd, "blendpd") X(Pblendw, "pblendw") \
+    X(Pextrb, "pextrb") X(Pextrd, "pextrd") X(Pextrq, "pextrq") X(Extractps, "extractps") \
+    X(Pinsrb, "pinsrb") X(Insertps, "insertps") X(Pinsrd, "pinsrd") X(Pinsrq, "pinsrq") \
+    X(Dpps, "dpps") X(Dppd, "dppd") X(Mpsadbw, "mpsadbw") \
+    X(Pcmpestrm, "pcmpestrm") X(Pcmpestri, "pcmpestri") X(Pcmpistrm, "pcmpistrm") X(Pcmpistri, "pcmpistri") \
+    X(Vzeroupper, "vzeroupper") X(Vzeroall, "vzeroall") \
+    X(Fadd, "fadd") X(Fmul, "fmul") X(Fcom, "fcom") X(Fcomp, "fcomp") X(Fsub, "fsub") X(Fsubr, "fsubr") X(Fdiv, "fdiv") X(Fdivr, "fdivr") \
+    X(Fiadd, "fiadd") X(Fimul, "fimul") X(Ficom, "ficom") X(Ficomp, "ficomp") X(Fisub, "fisub") X(Fisubr, "fisubr") X(Fidiv, "fidiv") X(Fidivr, "fidivr") \
+    X(Faddp, "faddp") X(Fmulp, "fmulp") X(Fcompp, "fcompp") X(Fsubrp, "fsubrp") X(Fsubp, "fsubp") X(Fdivrp, "fdivrp") X(Fdivp, "fdivp") \
+    X(Fld, "fld") X(Fst, "fst") X(Fstp, "fstp") X(Fild, "fild") X(Fisttp, "fisttp") X(Fist, "fist") X(Fistp, "fistp") \
+    X(Fbld, "fbld") X(Fbstp, "fbstp") X(Fldenv, "fldenv") X(Fldcw, "fldcw") X(Fnstenv, "fnstenv") X(Fnstcw, "fnstcw") \
+    X(Frstor, "frstor") X(Fnsave, "fnsave") X(Fnstsw, "fnstsw") X(Fxch, "fxch") X(Fnop, "fnop") X(Ffree, "ffree") X(Ffreep, "ffreep") \
+    X(Fchs, "fchs") X(Fabs, "fabs") X(Ftst, "ftst") X(Fxam, "fxam") \
+    X(Fld1, "fld1") X(Fldl2t, "fldl2t") X(Fldl2e, "fldl2e") X(Fldpi, "fldpi") X(Fldlg2, "fldlg2") X(Fldln2, "fldln2") X(Fldz, "fldz") \
+    X(F2xm1, "f2xm1") X(Fyl2x, "fyl2x") X(Fptan, "fptan") X(Fpatan, "fpatan") X(Fxtract, "fxtract") X(Fprem1, "fprem1") \
+    X(Fdecstp, "fdecstp") X(Fincstp, "fincstp") X(Fprem, "fprem") X(Fyl2xp1, "fyl2xp1") X(Fsqrt, "fsqrt") X(Fsincos, "fsincos") \
+    X(Frndint, "frndint") X(Fscale, "fscale") X(Fsin, "fsin") X(Fcos, "fcos") \
+    X(Fcmovb, "fcmovb") X(Fcmove, "fcmove") X(Fcmovbe, "fcmovbe") X(Fcmovu, "fcmovu") \
+    X(Fcmovnb, "fcmovnb") X(Fcmovne, "fcmovne") X(Fcmovnbe, "fcmovnbe") X(Fcmovnu, "fcmovnu") \
+    X(Fucompp, "fucompp") X(Fnclex, "fnclex") X(Fninit, "fninit") X(Fucomi, "fucomi") X(Fcomi, "fcomi") \
+    X(Fucom, "fucom") X(Fucomp, "fucomp") X(Fucomip, "fucomip") X(Fcomip, "fcomip")
+
+enum X86Mnemonic : unsigned short {
+#define X86_MNEMONIC_ID(id, name) X86##id,
+    X86_MNEMONICS(X86_MNEMONIC_ID)
+#undef X86_MNEMONIC_ID
+    X86MnemonicCount
+};
+
+const char* getX86MnemonicName(X86Mnemonic mnemonic);
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum X86RegisterClass : unsigned char {
+    X86RegNone,
+    X86RegGpr8,         // al, cl, dl, bl, spl, bpl, sil, dil, r8b .. r15b
+    X86RegGpr8High,     // ah, ch, dh, bh
+    X86RegGpr16,
+    X86RegGpr32,
+    X86RegGpr64,
+    X86RegIp,           // rip relative base: 0 - rip, 1 - eip
+    X86RegSegment,      // es, cs, ss, ds, fs, gs
+    X86RegControl,
+    X86RegDebug,
+    X86RegX87,
+    X86RegMmx,
+    X86RegXmm,
+    X86RegYmm,
+    X86RegZmm,
+    X86RegMask
+};
+
+struct X86Register {
+    X86RegisterClass  regClass;
+    unsigned char  number;
+};
+
+enum X86OperandType : unsigned char {
+    X86OpNone,
+    X86OpRegister,
+    X86OpMemory,
+    X86OpImmediate,
+    X86OpRelative,      // direct branch: value is the target address
+    X86OpFar            // ptr16:32 immediate: selector and value
+};
+
+struct X86Operand {
+    X86OperandType  type;
+    unsigned char  size;            // in bytes, 0 if the size is not defined ( lea, prefetch .. )
+    X86Register  reg;               // register operand or the base of a memory operand
+    X86Register  index;
+    unsigned char  scale;
+    X86Register  segment;           // segment override of a memory operand
+    unsigned short  selector;
+    long long  value;               // immediate, displacement or branch target
+};
+
+enum X86InstructionFlags {
+    X86InstrBranch = 0x0001,        // jmp, jcc, loop, jcxz
+    X86InstrCall = 0x0002,
+    X86InstrReturn = 0x0004,
+    X86InstrConditional = 0x0008,
+    X86InstrIndirect = 0x0010,      // target is taken from a register or memory
+    X86InstrRipRelative = 0x0020,
+    X86InstrLock = 0x0040,
+    X86InstrRep = 0x0080,
+    X86InstrRepne = 0x0100,
+    X86InstrVex = 0x0200,
+    X86InstrEvex = 0x0400
+};
+
+struct X86Instruction {
+    MEMOFFSET_64  offset;
+    MEMOFFSET_64  target;           // target of a direct branch or call, 0 for others
+    X86Mnemonic  mnemonic;
+    unsigned short  flags;
+    unsigned char  length;
+    unsigned char  operandCount;
+    X86Operand  operands[4];
+};
+
+// address of a memory operand if it does not depend on registers ( absolute or rip relative )
+bool getX86StaticAddress(const X86Instruction& instruction, const X86Operand& operand, MEMOFFSET_64& address);
+
+///////////////////////////////////////////////////////////////////////////////
+
+const size_t  maxX86InstructionLength = 15;
+
+enum X86DecodeResult {
+    X86DecodeOk,
+    X86DecodeInvalid,
+    X86DecodeTruncated      // the buffer ends inside the instruction
+};
+
+// Table driven x86/x64 decoder. It works on a byte buffer and does not access the
+// target, so a range is decoded by one memory read
+
+class X86Decoder
+{
+public:
+
+    explicit X86Decoder(CPUType cpuMode);
+
+    X86DecodeResult decode(const unsigned char* code, size_t size, MEMOFFSET_64 offset, X86Instruction& instruction) const;
+
+    // decodes the whole buffer, an invalid byte becomes an one byte X86Invalid instruction.
+    // Stops before an instruction truncated by the buffer end, returns the number of decoded bytes
+    size_t decode(const unsigned char* code, size_t size, MEMOFFSET_64 offset, std::vector<X86Instruction>& instructions) const;
+
+private:
+
+    bool  m_x64;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Intel syntax text: "mov     eax,dword ptr [ebp+8]"
+void formatX86Instruction(const X86Instruction& instruction, std::wstring& text);
+
+std::wstring formatX86Instruction(const X86Instruction& instruction);
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -2,6 +2,10 @@
 
 #pragma warning( disable : 4141 4244 4291 4624 4800 4996 4267)
 
+#include <chrono>
+#include <list>
+#include <mutex>
+
 #include "boost/tokenizer.hpp"
 
 #include "clang/AST/ASTConsumer.h"
@@ -14,6 +18,7 @@
 #include "clang/Parse/ParseAST.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "clang/Driver/Driver.h"
+#include "llvm/ADT/SmallString.h"
 
 #include "kdlib/typeinfo.h"
 #include "kdlib/exceptions.h"
@@ -770,9 +775,10 @@ TypeInfoPtr compileType( const std::wstring& sourceCode, const std::wstring& typ
 class ASTBuilderAction : public clang::tooling::ToolAction
 {
     std::vector<std::unique_ptr<ASTUnit>> &ASTs;
+    TranslationUnitKind  TUKind;
 
 public:
-    ASTBuilderAction(std::vector<std::unique_ptr<ASTUnit>> &ASTs) : ASTs(ASTs) {}
+    ASTBuilderAction(std::vector<std::unique_ptr<ASTUnit>> &ASTs, TranslationUnitKind TUKind = TU_Complete) : ASTs(ASTs), TUKind(TUKind) {}
 
     bool runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
         FileManager *Files,
@@ -783,7 +789,11 @@ public:
             CompilerInstance::createDiagnostics(&Invocation->getDiagnosticOpts(),
                 DiagConsumer,
                 /*ShouldOwnClient=*/false),
-            Files);
+            Files,
+            /*OnlyLocalDecls=*/false,
+            /*CaptureDiagnostics=*/false,
+            /*PrecompilePreambleAfterNParses=*/0,
+            TUKind);
 
         if (!AST)
             return false;
@@ -793,10 +803,28 @@ public:
     }
 };
 
-TypeInfoProviderClang::TypeInfoProviderClang( const std::string& sourceCode, const std::string& compileOptions)
+///////////////////////////////////////////////////////////////////////////////
+
+struct ClangPrecompiledHeader
+{
+    std::string  sourceCode;
+    std::string  data;
+};
+
+static const char  precompiledSourceName[] = "base.cc";
+static const char  precompiledHeaderName[] = "base.pch";
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::unique_ptr<ASTUnit> buildASTUnit(
+    const std::string&  sourceCode,
+    const std::string&  compileOptions,
+    TranslationUnitKind  tuKind = TU_Complete,
+    const ClangPrecompiledHeaderPtr&  precompiledHeader = ClangPrecompiledHeaderPtr()
+    )
 {
     std::vector<std::unique_ptr<ASTUnit>> ASTs;
-    ASTBuilderAction Action(ASTs);
+    ASTBuilderAction Action(ASTs, tuKind);
     llvm::IntrusiveRefCntPtr<vfs::OverlayFileSystem> OverlayFileSystem(
         new vfs::OverlayFileSystem(vfs::getRealFileSystem()));
     llvm::IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
@@ -817,7 +845,24 @@ TypeInfoProviderClang::TypeInfoProviderClang( const std::string& sourceCode, con
 
     std::copy(tok.begin(), tok.end(), std::inserter(args, args.end()));
 
-    args.push_back("input.cc");
+    if (precompiledHeader)
+    {
+        args.push_back("-include-pch");
+        args.push_back(precompiledHeaderName);
+        args.push_back("-Xclang");
+        args.push_back("-fno-validate-pch");
+
+        // the AST unit refers to the sources while it lives, the cache may drop the header before
+        InMemoryFileSystem->addFile(precompiledSourceName, 0,
+            llvm::MemoryBuffer::getMemBufferCopy(precompiledHeader->sourceCode, precompiledSourceName));
+
+        InMemoryFileSystem->addFile(precompiledHeaderName, 0,
+            llvm::MemoryBuffer::getMemBufferCopy(precompiledHeader->data, precompiledHeaderName));
+    }
+
+    const char*  inputName = tuKind == TU_Prefix ? precompiledSourceName : "input.cc";
+
+    args.push_back(inputName);
 
     ToolInvocation toolInvocation(
         args,
@@ -826,7 +871,7 @@ TypeInfoProviderClang::TypeInfoProviderClang( const std::string& sourceCode, con
         std::move(std::make_shared< PCHContainerOperations >())
     );
 
-    InMemoryFileSystem->addFile("input.cc", 0, llvm::MemoryBuffer::getMemBuffer(sourceCode.c_str()));
+    InMemoryFileSystem->addFile(inputName, 0, llvm::MemoryBuffer::getMemBufferCopy(sourceCode, inputName));
 
 #ifndef _DEBUG
 
@@ -838,13 +883,312 @@ TypeInfoProviderClang::TypeInfoProviderClang( const std::string& sourceCode, con
 
     toolInvocation.run();
 
-    std::unique_ptr<ASTUnit>  ast = std::move(ASTs[0]);
+    if (ASTs.empty())
+        throw TypeException(L"failed to compile source");
+
+    return std::move(ASTs[0]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ClangPrecompiledHeaderPtr buildPrecompiledHeader(const std::string&  sourceCode, const std::string&  compileOptions)
+{
+    std::unique_ptr<ASTUnit>  ast = buildASTUnit(sourceCode, compileOptions, TU_Prefix);
+
+    if (ast->getDiagnostics().hasErrorOccurred())
+        return ClangPrecompiledHeaderPtr();
+
+    auto  precompiledHeader = std::make_shared<ClangPrecompiledHeader>();
+    precompiledHeader->sourceCode = sourceCode;
+
+    llvm::SmallString<0>  buffer;
+    llvm::raw_svector_ostream  stream(buffer);
+
+    if (ast->serialize(stream))
+        return ClangPrecompiledHeaderPtr();
+
+    precompiledHeader->data.assign(buffer.begin(), buffer.end());
+
+    return precompiledHeader;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// A source may be a precompiled prefix only if it ends a top level declaration: the next
+// source must not continue its last declaration ( "struct A {int x;}" and " y;" ).
+// The comments, the literals and the preprocessor lines are skipped, the last token
+// out of them must be a ';' out of any braces
+
+bool isDeclarationBoundary(const std::string&  sourceCode)
+{
+    int  depth = 0;
+    char  last = 0;
+    bool  lineStart = true;
+
+    for (size_t i = 0; i < sourceCode.size(); ++i)
+    {
+        char  c = sourceCode[i];
+        char  next = i + 1 < sourceCode.size() ? sourceCode[i + 1] : 0;
+
+        if (c == '\n')
+        {
+            lineStart = true;
+            continue;
+        }
+
+        if (isspace(static_cast<unsigned char>(c)))
+            continue;
+
+        if (c == '#' && lineStart)
+        {
+            // a directive goes on after an escaped end of line
+            for (; i < sourceCode.size() && sourceCode[i] != '\n'; ++i)
+            {
+                if (sourceCode[i] == '\\' && i + 1 < sourceCode.size())
+                    ++i;
+            }
+            lineStart = true;
+            continue;
+        }
+
+        lineStart = false;
+
+        if (c == '/' && next == '/')
+        {
+            i = sourceCode.find('\n', i);
+            if (i == std::string::npos)
+                break;
+            lineStart = true;
+            continue;
+        }
+
+        if (c == '/' && next == '*')
+        {
+            i = sourceCode.find("*/", i + 2);
+            if (i == std::string::npos)
+                return false;
+            i += 1;
+            continue;
+        }
+
+        if (c == '"' || c == '\'')
+        {
+            for (++i; i < sourceCode.size() && sourceCode[i] != c; ++i)
+            {
+                if (sourceCode[i] == '\\')
+                    ++i;
+            }
+            if (i >= sourceCode.size())
+                return false;
+            last = c;
+            continue;
+        }
+
+        if (c == '{' || c == '(' || c == '[')
+            depth++;
+        else if (c == '}' || c == ')' || c == ']')
+            depth--;
+
+        last = c;
+    }
+
+    return depth == 0 && last == ';';
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Providers are kept by their source and options: scripts call compileType for
+// every structure of one big header. A new source which extends a cached one
+// ( the same header plus a few declarations ) is compiled on top of a
+// precompiled header built from the cached source, so only the tail is parsed.
+// The cached source must end a declaration, and a tail with errors is compiled
+// again with the whole source
+class ClangProviderCache
+{
+public:
+
+    // never destroyed: the cached providers hold the clang objects, they must not be
+    // released after the LLVM globals on the process exit
+    static ClangProviderCache& get()
+    {
+        static ClangProviderCache*  providerCache = new ClangProviderCache();
+        return *providerCache;
+    }
+
+    TypeInfoProviderPtr getProvider(const std::string&  sourceCode, const std::string&  compileOptions);
+
+private:
+
+    struct Entry 
+    {
+        size_t  hash;
+        std::string  sourceCode;
+        std::string  compileOptions;
+        TypeInfoProviderPtr  provider;
+
+        bool  declarationBoundary;      // the source may be a prefix of another one
+        bool  precompiled;
+        ClangPrecompiledHeaderPtr  precompiledHeader;
+    };
+
+    typedef std::shared_ptr<Entry>  EntryPtr;
+
+    static size_t getHash(const std::string&  sourceCode, const std::string&  compileOptions)
+    {
+        std::hash<std::string>  hasher;
+        size_t  hash = hasher(sourceCode);
+        return hash ^ (hasher(compileOptions) + 0x9e3779b9 + (hash << 6) + (hash >> 2));
+    }
+
+    ClangPrecompiledHeaderPtr getPrecompiledHeader(const EntryPtr&  entry);
+
+    static const size_t  maxEntries = 8;
+
+    std::mutex  m_lock;
+    std::list<EntryPtr>  m_entries;  // most recently used first
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoProviderPtr ClangProviderCache::getProvider(const std::string&  sourceCode, const std::string&  compileOptions)
+{
+    size_t  hash = getHash(sourceCode, compileOptions);
+
+    EntryPtr  baseEntry;
+
+    {
+        std::lock_guard<std::mutex>  lock(m_lock);
+
+        for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+        {
+            const EntryPtr&  entry = *it;
+
+            if (entry->hash == hash && entry->sourceCode == sourceCode && entry->compileOptions == compileOptions)
+            {
+                m_entries.splice(m_entries.begin(), m_entries, it);
+                return entry->provider;
+            }
+
+            if (entry->declarationBoundary &&
+                entry->compileOptions == compileOptions && 
+                entry->sourceCode.size() < sourceCode.size() &&
+                (!baseEntry || baseEntry->sourceCode.size() < entry->sourceCode.size()) &&
+                sourceCode.compare(0, entry->sourceCode.size(), entry->sourceCode) == 0)
+            {
+                baseEntry = entry;
+            }
+        }
+    }
+
+    ClangPrecompiledHeaderPtr  precompiledHeader;
+    if (baseEntry)
+        precompiledHeader = getPrecompiledHeader(baseEntry);
+
+    TypeInfoProviderPtr  provider;
+
+    if (precompiledHeader)
+    {
+        try {
+            provider = TypeInfoProviderPtr(new TypeInfoProviderClang(
+                sourceCode.substr(precompiledHeader->sourceCode.size()), compileOptions, precompiledHeader));
+        }
+        catch (TypeException&)
+        {
+            // the tail has errors on top of the header: the whole source is compiled, the result
+            // is not cached since its errors may come from the split
+            return TypeInfoProviderPtr(new TypeInfoProviderClang(sourceCode, compileOptions));
+        }
+    }
+    else
+    {
+        provider = TypeInfoProviderPtr(new TypeInfoProviderClang(sourceCode, compileOptions));
+    }
+
+    auto  entry = std::make_shared<Entry>();
+    entry->hash = hash;
+    entry->sourceCode = sourceCode;
+    entry->compileOptions = compileOptions;
+    entry->provider = provider;
+    entry->declarationBoundary = isDeclarationBoundary(sourceCode);
+    entry->precompiled = false;
+
+    {
+        std::lock_guard<std::mutex>  lock(m_lock);
+
+        m_entries.push_front(entry);
+
+        if (m_entries.size() > maxEntries)
+            m_entries.pop_back();
+    }
+
+    return provider;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ClangPrecompiledHeaderPtr ClangProviderCache::getPrecompiledHeader(const EntryPtr&  entry)
+{
+    {
+        std::lock_guard<std::mutex>  lock(m_lock);
+
+        if (entry->precompiled)
+            return entry->precompiledHeader;
+    }
+
+    ClangPrecompiledHeaderPtr  precompiledHeader = buildPrecompiledHeader(entry->sourceCode, entry->compileOptions);
+
+    std::lock_guard<std::mutex>  lock(m_lock);
+
+    entry->precompiled = true;
+    entry->precompiledHeader = precompiledHeader;
+
+    return precompiledHeader;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoProviderClang::TypeInfoProviderClang( const std::string& sourceCode, const std::string& compileOptions)
+{
+    auto  startTime = std::chrono::steady_clock::now();
+
+    std::unique_ptr<ASTUnit>  ast = buildASTUnit(sourceCode, compileOptions);
+
+    m_statistics.compileTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    m_statistics.precompiledSize = 0;
+
+    buildTypeCache(ast);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoProviderClang::TypeInfoProviderClang( const std::string& sourceCode, const std::string& compileOptions, const ClangPrecompiledHeaderPtr&  precompiledHeader)
+{
+    auto  startTime = std::chrono::steady_clock::now();
+
+    std::unique_ptr<ASTUnit>  ast = buildASTUnit(sourceCode, compileOptions, TU_Complete, precompiledHeader);
+
+    if (ast->getDiagnostics().hasErrorOccurred())
+        throw TypeException(L"failed to compile source with the precompiled header");
+
+    m_statistics.compileTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    m_statistics.precompiledSize = precompiledHeader ? precompiledHeader->sourceCode.size() : 0;
+
+    buildTypeCache(ast);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TypeInfoProviderClang::buildTypeCache(std::unique_ptr<ASTUnit>&  ast)
+{
+    auto  startTime = std::chrono::steady_clock::now();
 
     m_astSession = ClangASTSession::getASTSession(ast);
 
     DeclNextVisitor   visitor(m_astSession, &m_typeCache);
 
     visitor.TraverseDecl( m_astSession->getASTContext().getTranslationUnitDecl() );
+
+    m_statistics.typeCollectTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -912,64 +1256,32 @@ TypeInfoPtr TypeInfoProviderClangEnum::Next()
 
 TypeInfoProviderPtr  getTypeInfoProviderFromSource( const std::wstring&  source, const std::wstring&  opts )
 {
-    return TypeInfoProviderPtr( new TypeInfoProviderClang(wstrToStr(source), wstrToStr(opts) ) );
+    return ClangProviderCache::get().getProvider(wstrToStr(source), wstrToStr(opts));
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 TypeInfoProviderPtr  getTypeInfoProviderFromSource(const std::string&  source, const std::string&  opts)
 {
-    return TypeInfoProviderPtr(new TypeInfoProviderClang(source, opts));
+    return ClangProviderCache::get().getProvider(source, opts);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-SymbolProviderClang::SymbolProviderClang(const std::string&  sourceCode, const std::string&  compileOptions)
+TypeInfoProviderStatistics  getTypeInfoProviderStatistics( const TypeInfoProviderPtr&  typeInfoProvider )
 {
-    std::vector<std::unique_ptr<ASTUnit>> ASTs;
-    ASTBuilderAction Action(ASTs);
-    llvm::IntrusiveRefCntPtr<vfs::OverlayFileSystem> OverlayFileSystem(
-        new vfs::OverlayFileSystem(vfs::getRealFileSystem()));
-    llvm::IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
-        new vfs::InMemoryFileSystem);
-    OverlayFileSystem->pushOverlay(InMemoryFileSystem);
-    llvm::IntrusiveRefCntPtr<FileManager> Files(
-        new FileManager(FileSystemOptions(), OverlayFileSystem));
-
-    std::vector< std::string > args;
-
-    args.push_back("clang-tool");
-    args.push_back("-fsyntax-only");
-
-    typedef boost::tokenizer< boost::escaped_list_separator<char> > Tokenizer;
-    boost::escaped_list_separator<char> Separator('\\', ' ', '\"');
-
-    Tokenizer tok(compileOptions, Separator);
-
-    std::copy(tok.begin(), tok.end(), std::inserter(args, args.end()));
-
-    args.push_back("input.cc");
-
-    ToolInvocation toolInvocation(
-        args,
-        &Action,
-        Files.get(),
-        std::move(std::make_shared< PCHContainerOperations >())
-    );
-
-    InMemoryFileSystem->addFile("input.cc", 0, llvm::MemoryBuffer::getMemBuffer(sourceCode.c_str()));
+    auto  clangProvider = boost::dynamic_pointer_cast<TypeInfoProviderClang>(typeInfoProvider);
+    if (!clangProvider)
+        throw TypeException(L"type provider is not compiled from source");
 
-#ifndef _DEBUG
-
-    IgnoringDiagConsumer   diagnosticConsumer;
-
-    toolInvocation.setDiagnosticConsumer(&diagnosticConsumer);
-
-#endif
+    return clangProvider->getStatistics();
+}
 
-    toolInvocation.run();
+///////////////////////////////////////////////////////////////////////////////
 
-    std::unique_ptr<ASTUnit>  ast = std::move(ASTs[0]);
+SymbolProviderClang::SymbolProviderClang(const std::string&  sourceCode, const std::string&  compileOptions)
+{
+    std::unique_ptr<ASTUnit>  ast = buildASTUnit(sourceCode, compileOptions);
 
     m_astSession = ClangASTSession::getASTSession(ast);
 
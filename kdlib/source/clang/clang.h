@@ -17,6 +17,9 @@ typedef boost::shared_ptr<ClangASTSession>  ClangASTSessionPtr;
 
 class TypeInfoProviderClang;
 
+struct ClangPrecompiledHeader;
+typedef std::shared_ptr<const ClangPrecompiledHeader>  ClangPrecompiledHeaderPtr;
+
 
 class ClangASTSession : public boost::enable_shared_from_this<ClangASTSession>
 {
@@ -386,8 +389,16 @@ public:
 
     TypeInfoProviderClang( const std::string&  sourceCode, const std::string&  compileOptions);
 
+    TypeInfoProviderClang( const std::string&  sourceCode, const std::string&  compileOptions, const ClangPrecompiledHeaderPtr&  precompiledHeader);
+
+    TypeInfoProviderStatistics getStatistics() const {
+        return m_statistics;
+    }
+
 private:
 
+    void buildTypeCache(std::unique_ptr<clang::ASTUnit>&  ast);
+
     TypeInfoPtr getTypeByName(const std::wstring& name) override;
 
     TypeInfoEnumeratorPtr getTypeEnumerator(const std::wstring& mask) override;
@@ -399,6 +410,8 @@ private:
     ClangASTSessionPtr  m_astSession;
 
     std::map< std::string, TypeInfoPtr>  m_typeCache;
+
+    TypeInfoProviderStatistics  m_statistics;
 };
 
 
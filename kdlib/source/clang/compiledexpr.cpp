@@ -0,0 +1,573 @@
+#include <stdafx.h>
+
+#include <memory>
+
+#include "kdlib/typedvar.h"
+#include "kdlib/exceptions.h"
+
+#include "compiledexpr.h"
+#include "strconvert.h"
+
+namespace kdlib {
+
+TypedValue getNumericConst(const clang::Token& token);
+
+TypedValue getCharConst(const clang::Token& token);
+
+bool isBinOperation(const clang::Token& token);
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Scope of the compiling: nothing is found, the lookups show that a type depends on the scope
+
+class LookupRecorderScope : public Scope
+{
+public:
+
+    LookupRecorderScope() :
+        m_lookedUp(false)
+    {}
+
+    virtual TypedValue get(const std::wstring& varName) const override
+    {
+        m_lookedUp = true;
+        throw ExprException(L"error syntax");
+    }
+
+    virtual bool find(const std::wstring& varName, TypedValue& value) const override
+    {
+        m_lookedUp = true;
+        return false;
+    }
+
+    bool isLookedUp() const {
+        return m_lookedUp;
+    }
+
+private:
+
+    mutable bool  m_lookedUp;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// the text lexed back to the same tokens
+std::string getTokensText(TokenIterator begin, TokenIterator end)
+{
+    std::string  text;
+
+    for (auto it = begin; it != end; ++it)
+    {
+        if (!text.empty())
+            text += ' ';
+
+        if (it->getIdentifierInfo())
+        {
+            text += it->getIdentifierInfo()->getName().str();
+        }
+        else if (it->isLiteral())
+        {
+            text.append(it->getLiteralData(), it->getLength());
+        }
+        else
+        {
+            const char*  punctuator = clang::tok::getPunctuatorSpelling(it->getKind());
+            if (!punctuator)
+                throw ExprException(L"error syntax");
+            text += punctuator;
+        }
+    }
+
+    return text;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // end nameless namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+CompiledExprPtr compileExpr(const std::wstring& expr, const TypeInfoProviderPtr& typeInfoProvider)
+{
+    return compileExpr(wstrToStr(expr), typeInfoProvider);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CompiledExprPtr compileExpr(const std::string& expr, const TypeInfoProviderPtr& typeInfoProvider)
+{
+    auto  tokens = lexExpression(expr);
+    TokenStream  tokenStream(tokens);
+    parser::MatchMemoScope  matchMemo;
+
+    auto  root = ExprCompiler(typeInfoProvider, &tokenStream).getResult();
+
+    return CompiledExprPtr(new CompiledExprImpl(expr, std::move(root)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypedValue IdentifierExprNode::eval(const ScopePtr& scope)
+{
+    TypedValue   result;
+    if (scope->find(m_wname, result))
+        return result;
+
+    TypeInfoPtr  typeInfo = boost::atomic_load(&m_typeInfo);
+
+    if (!typeInfo)
+    {
+        try {
+            typeInfo = evalType(m_name, m_typeInfoProvider);
+        }
+        catch (DbgException&)
+        {
+            throw  ExprException(L"error syntax");
+        }
+
+        boost::atomic_store(&m_typeInfo, typeInfo);
+    }
+
+    return typeInfo->getValue();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypedValue SizeofExprNode::eval(const ScopePtr& scope)
+{
+    if (m_operand)
+    {
+        try {
+            return m_operand->eval(scope).getType()->getSize();
+        }
+        catch (DbgException&)
+        {
+            if (!m_typeInfo)
+                throw;
+        }
+    }
+
+    return m_typeInfo->getSize();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ExprNodePtr  ExprCompiler::getResult()
+{
+    std::list<ExprNodePtr>  operands;
+    std::list<std::unique_ptr<BinOperation>> operations;
+
+    bool  ternary = false;
+
+    while (true)
+    {
+        std::list<PreOperation>  preOperations;
+        PreOperation  preOp;
+        while (getPreUnaryOperation(preOp))
+        {
+            preOperations.push_front(std::move(preOp));
+            preOp = PreOperation();
+        }
+
+        auto  val = getOperand();
+
+        while (true)
+        {
+            assert(!m_tokens->empty());
+
+            auto  token = m_tokens->front();
+
+            if (token.isOneOf(m_endToken, clang::tok::question))
+                break;
+
+            if (isBinOperation(token))
+                break;
+
+            if (token.is(clang::tok::l_square))
+            {
+                m_tokens->pop_front();
+                auto  index = ExprCompiler(m_typeInfoProvider, m_tokens, clang::tok::r_square).getResult();
+                val.reset(new ArrayExprNode(std::move(val), std::move(index)));
+                continue;
+            }
+
+            if (token.isOneOf(clang::tok::period, clang::tok::arrow))
+            {
+                m_tokens->pop_front();
+
+                if (m_tokens->front().is(m_endToken))
+                    throw ExprException(L"error syntax");
+
+                token = m_tokens->front();
+
+                if (!token.is(clang::tok::identifier))
+                    throw ExprException(L"error syntax");
+
+                std::string  name(token.getIdentifierInfo()->getNameStart(), token.getLength());
+
+                m_tokens->pop_front();
+
+                val.reset(new UnaryExprNode(new AttributeOperation(name), std::move(val)));
+                continue;
+            }
+
+            throw ExprException(L"error syntax");
+        }
+
+        for (auto& op : preOperations)
+        {
+            if (op.operation)
+                val.reset(new UnaryExprNode(op.operation.release(), std::move(val)));
+            else
+                val.reset(new ScopedTypeCastExprNode(op.scopedCastType, m_typeInfoProvider, std::move(val)));
+        }
+
+        operands.push_back(std::move(val));
+
+        auto  token = m_tokens->front();
+
+        if (token.is(clang::tok::question))
+        {
+            ternary = true;
+            break;
+        }
+
+        if (token.is(m_endToken))
+        {
+            m_tokens->pop_front();
+            break;
+        }
+
+        operations.push_back(getOperation());
+    }
+
+    while (!operations.empty())
+    {
+        auto  op = std::max_element(operations.begin(), operations.end(),
+            [](const auto& op1, const auto& op2)
+            {
+                return op1->getPriority() > op2->getPriority();
+            });
+
+        auto op1 = operands.begin();
+        std::advance(op1, std::distance(operations.begin(), op));
+
+        auto op2 = std::next(op1);
+
+        op1->reset(new BinaryExprNode(std::move(*op), std::move(*op1), std::move(*op2)));
+
+        operations.erase(op);
+        operands.erase(op2);
+    }
+
+    if (ternary)
+        return getTernary(std::move(operands.front()));
+
+    return std::move(operands.front());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ExprNodePtr ExprCompiler::getOperand()
+{
+    if (m_tokens->empty())
+        throw ExprException(L"error syntax");
+
+    auto token = m_tokens->front();
+
+    if (token.is(clang::tok::identifier))
+        return getIdentifier();
+
+    m_tokens->pop_front();
+
+    if (token.is(clang::tok::numeric_constant))
+        return ExprNodePtr(new ConstExprNode(getNumericConst(token)));
+
+    if (token.isOneOf(clang::tok::char_constant, clang::tok::wide_char_constant))
+        return ExprNodePtr(new ConstExprNode(getCharConst(token)));
+
+    if (token.is(clang::tok::l_paren))
+        return ExprCompiler(m_typeInfoProvider, m_tokens, clang::tok::r_paren).getResult();
+
+    if (token.is(clang::tok::kw_sizeof))
+        return getSizeof();
+
+    throw ExprException(L"error syntax");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ExprNodePtr ExprCompiler::getIdentifier()
+{
+    std::string  fullName;
+
+    while (!m_tokens->front().is(m_endToken))
+    {
+        auto token = m_tokens->front();
+
+        if (token.is(clang::tok::identifier))
+        {
+            m_tokens->pop_front();
+            fullName += std::string(token.getIdentifierInfo()->getNameStart(), token.getLength());
+        }
+        else if (token.is(clang::tok::colon))
+        {
+            m_tokens->pop_front();
+            fullName += ":";
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (fullName == "true")
+        return ExprNodePtr(new ConstExprNode(TypedValue(true)));
+
+    if (fullName == "false")
+        return ExprNodePtr(new ConstExprNode(TypedValue(false)));
+
+    if (fullName == "nullptr")
+        return ExprNodePtr(new ConstExprNode(TypedValue(nullptr)));
+
+    return ExprNodePtr(new IdentifierExprNode(fullName, m_typeInfoProvider));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ExprNodePtr ExprCompiler::getSizeof()
+{
+    if (!m_tokens->front().is(clang::tok::l_paren))
+        throw  ExprException(L"error syntax");
+
+    m_tokens->pop_front();
+
+    if (m_tokens->front().is(m_endToken))
+        throw ExprException(L"error syntax");
+
+    ExprNodePtr  operand;
+    TokenStream  exprCopy(*m_tokens);
+
+    try {
+        operand = ExprCompiler(m_typeInfoProvider, &exprCopy, clang::tok::r_paren).getResult();
+    }
+    catch (DbgException&)
+    {}
+
+    TypeInfoPtr  typeInfo;
+    TokenStream  typeCopy(*m_tokens);
+
+    try {
+        typeInfo = TypeEval(ScopePtr(new ScopeList()), m_typeInfoProvider, &typeCopy, clang::tok::r_paren).getResult();
+    }
+    catch (DbgException&)
+    {}
+
+    if (operand)
+    {
+        if (typeInfo && typeCopy.size() != exprCopy.size())
+            typeInfo = TypeInfoPtr();
+
+        *m_tokens = exprCopy;
+    }
+    else if (typeInfo)
+    {
+        *m_tokens = typeCopy;
+    }
+    else
+    {
+        throw ExprException(L"error syntax");
+    }
+
+    return ExprNodePtr(new SizeofExprNode(std::move(operand), typeInfo));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+ExprNodePtr ExprCompiler::getTernary(ExprNodePtr&& condition)
+{
+    if (!m_tokens->front().is(clang::tok::question))
+        throw ExprException(L"error syntax");
+
+    m_tokens->pop_front();
+
+    auto  value1 = ExprCompiler(m_typeInfoProvider, m_tokens, clang::tok::colon).getResult();
+
+    auto  value2 = ExprCompiler(m_typeInfoProvider, m_tokens, m_endToken).getResult();
+
+    return ExprNodePtr(new TernaryExprNode(std::move(condition), std::move(value1), std::move(value2)));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::unique_ptr<BinOperation> ExprCompiler::getOperation()
+{
+    if (m_tokens->empty())
+        throw ExprException(L"error syntax");
+
+    auto  token = m_tokens->front();
+
+    if (!isBinOperation(token))
+        throw ExprException(L"error syntax");
+
+    m_tokens->pop_front();
+
+    switch (token.getKind())
+    {
+    case clang::tok::plus:
+        return std::unique_ptr<BinOperation>(new AddExprOperation());
+    case clang::tok::star:
+        return std::unique_ptr<BinOperation>(new MultExprOperation());
+    case clang::tok::minus:
+        return std::unique_ptr<BinOperation>(new SubExprOperation());
+    case clang::tok::slash:
+        return std::unique_ptr<BinOperation>(new DivExprOperation());
+    case clang::tok::percent:
+        return std::unique_ptr<BinOperation>(new ModExprOperation());
+    case clang::tok::equalequal:
+        return std::unique_ptr<BinOperation>(new EqualOperation());
+    case clang::tok::exclaimequal:
+        return std::unique_ptr<BinOperation>(new NotEqualOperation());
+    case clang::tok::less:
+        return std::unique_ptr<BinOperation>(new LessOperation());
+    case clang::tok::lessequal:
+        return std::unique_ptr<BinOperation>(new LessEqualOperation());
+    case clang::tok::greater:
+        return std::unique_ptr<BinOperation>(new GreaterOperation());
+    case clang::tok::greaterequal:
+        return std::unique_ptr<BinOperation>(new GreaterEqualOperation());
+    case clang::tok::lessless:
+        return std::unique_ptr<BinOperation>(new LeftShiftOperation());
+    case clang::tok::greatergreater:
+        return std::unique_ptr<BinOperation>(new RightShiftOperation());
+    case clang::tok::amp:
+        return std::unique_ptr<BinOperation>(new BitwiseAndOperation());
+    case clang::tok::pipe:
+        return std::unique_ptr<BinOperation>(new BitwiseOrOperation());
+    case clang::tok::caret:
+        return std::unique_ptr<BinOperation>(new BitwiseXorOperation());
+    case clang::tok::pipepipe:
+        return std::unique_ptr<BinOperation>(new BoolOrOperation());
+    case clang::tok::ampamp:
+        return std::unique_ptr<BinOperation>(new BoolAndOperation());
+    }
+
+    throw ExprException(L"error syntax");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ExprCompiler::getPreUnaryOperation(PreOperation& preOperation)
+{
+    std::unique_ptr<UnaryOperation>&  operation = preOperation.operation;
+
+    if (m_tokens->empty())
+        throw ExprException(L"error syntax");
+
+    auto  token = m_tokens->front();
+
+    if (token.isOneOf(clang::tok::numeric_constant,
+        clang::tok::identifier,
+        clang::tok::char_constant,
+        clang::tok::wide_char_constant))
+            return false;
+
+    if (token.is(clang::tok::l_paren))
+        return getTypeCast(preOperation);
+
+    if (token.is(clang::tok::kw_sizeof))
+    {
+        if (std::next(m_tokens->begin())->is(m_endToken))
+            throw ExprException(L"error syntax");
+
+        if (std::next(m_tokens->begin())->is(clang::tok::l_paren))
+            return false;
+
+        m_tokens->pop_front();
+        operation.reset(new SizeofOperation());
+        return true;
+    }
+
+    if (isBaseTypeKeyWord(token))
+        return false;
+
+    m_tokens->pop_front();
+
+    switch (token.getKind())
+    {
+    case clang::tok::minus:
+        operation.reset(new UnMinusOperation());
+        return true;
+    case clang::tok::plus:
+        operation.reset(new UnPlusOperation());
+        return true;
+    case clang::tok::star:
+        operation.reset(new DerefOperation());
+        return true;
+    case clang::tok::tilde:
+        operation.reset(new BitwiseNotOperation());
+        return true;
+    case clang::tok::exclaim:
+        operation.reset(new BooleanNotOperation());
+        return true;
+    case clang::tok::amp:
+        operation.reset(new RefOperation());
+        return true;
+    }
+
+    throw ExprException(L"error syntax");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ExprCompiler::getTypeCast(PreOperation& operation)
+{
+    boost::shared_ptr<LookupRecorderScope>  recorder(new LookupRecorderScope());
+
+    TokenStream  exprCopy(*m_tokens);
+    exprCopy.pop_front();
+
+    try {
+
+        TypeInfoPtr  typeCast = TypeEval(recorder, m_typeInfoProvider, &exprCopy, clang::tok::r_paren).getResult();
+
+        if (!recorder->isLookedUp())
+        {
+            *m_tokens = exprCopy;
+            operation.operation.reset(new TypeCastOperation(typeCast));
+            return true;
+        }
+    }
+    catch (DbgException&)
+    {
+        if (!recorder->isLookedUp())
+            return false;
+    }
+
+    // the type has the identifiers of the scope: it is a cast if the text is a type,
+    // the type itself is resolved by the eval with its scope
+
+    using namespace parser;
+
+    TokenStream  typeCopy(*m_tokens);
+    typeCopy.pop_front();
+
+    QualifiedTypeMatcher  typeMatcher;
+    auto  matcher = all_of(typeMatcher, token_is(clang::tok::r_paren));
+    auto  matchResult = matcher.match(std::make_pair(typeCopy.begin(), typeCopy.end()));
+
+    if (!matchResult.isMatched())
+        return false;
+
+    operation.scopedCastType = getTokensText(matchResult.begin(), std::prev(matchResult.end()));
+
+    m_tokens->seek(matchResult.end());
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+}
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <memory>
+#include <list>
+#include <vector>
+
+#include "clang/Lex/Token.h"
+
+#include "kdlib/typedvar.h"
+
+#include "evalexpr.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+class ExprNode;
+typedef std::unique_ptr<ExprNode>  ExprNodePtr;
+
+class ExprNode
+{
+public:
+
+    virtual ~ExprNode()
+    {}
+
+    virtual TypedValue eval(const ScopePtr& scope) = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class ConstExprNode : public ExprNode
+{
+public:
+
+    explicit ConstExprNode(const TypedValue& value) :
+        m_value(value)
+    {}
+
+    TypedValue eval(const ScopePtr& scope) override
+    {
+        return m_value;
+    }
+
+private:
+
+    TypedValue  m_value;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class IdentifierExprNode : public ExprNode
+{
+public:
+
+    IdentifierExprNode(const std::string& name, const TypeInfoProviderPtr& typeInfoProvider) :
+        m_name(name),
+        m_wname(strToWStr(name)),
+        m_typeInfoProvider(typeInfoProvider)
+    {}
+
+    TypedValue eval(const ScopePtr& scope) override;
+
+private:
+
+    std::string  m_name;
+    std::wstring  m_wname;
+    TypeInfoProviderPtr  m_typeInfoProvider;
+
+    // a compiled expression is shared by the threads ( a breakpoint condition ): the type is
+    // published atomically. Only a found type is kept, the name may be resolved after a
+    // module load
+    TypeInfoPtr  m_typeInfo;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Cast to a type which looks up the scope ( an expression of a template argument ): the type
+// is resolved by every eval. The cast to a type known by the compiling is a TypeCastOperation
+
+class ScopedTypeCastExprNode : public ExprNode
+{
+public:
+
+    ScopedTypeCastExprNode(const std::string& typeName, const TypeInfoProviderPtr& typeInfoProvider, ExprNodePtr&& operand) :
+        m_typeName(typeName),
+        m_typeInfoProvider(typeInfoProvider),
+        m_operand(std::move(operand))
+    {}
+
+    TypedValue eval(const ScopePtr& scope) override
+    {
+        TypeCastOperation  cast(evalType(m_typeName, m_typeInfoProvider, scope));
+        return cast.getResult(m_operand->eval(scope));
+    }
+
+private:
+
+    std::string  m_typeName;
+    TypeInfoProviderPtr  m_typeInfoProvider;
+    ExprNodePtr  m_operand;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class UnaryExprNode : public ExprNode
+{
+public:
+
+    UnaryExprNode(UnaryOperation* operation, ExprNodePtr&& operand) :
+        m_operation(operation),
+        m_operand(std::move(operand))
+    {}
+
+    TypedValue eval(const ScopePtr& scope) override
+    {
+        return m_operation->getResult(m_operand->eval(scope));
+    }
+
+private:
+
+    std::unique_ptr<UnaryOperation>  m_operation;
+    ExprNodePtr  m_operand;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class BinaryExprNode : public ExprNode
+{
+public:
+
+    BinaryExprNode(std::unique_ptr<BinOperation>&& operation, ExprNodePtr&& operand1, ExprNodePtr&& operand2) :
+        m_operation(std::move(operation)),
+        m_operand1(std::move(operand1)),
+        m_operand2(std::move(operand2))
+    {}
+
+    TypedValue eval(const ScopePtr& scope) override
+    {
+        auto  val1 = m_operand1->eval(scope);
+        auto  val2 = m_operand2->eval(scope);
+        return m_operation->getResult(val1, val2);
+    }
+
+private:
+
+    std::unique_ptr<BinOperation>  m_operation;
+    ExprNodePtr  m_operand1;
+    ExprNodePtr  m_operand2;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class ArrayExprNode : public ExprNode
+{
+public:
+
+    ArrayExprNode(ExprNodePtr&& operand, ExprNodePtr&& index) :
+        m_operand(std::move(operand)),
+        m_index(std::move(index))
+    {}
+
+    TypedValue eval(const ScopePtr& scope) override
+    {
+        TypedValue  val = m_operand->eval(scope);
+        size_t  index = m_index->eval(scope).getValue();
+        return val.getElement(index);
+    }
+
+private:
+
+    ExprNodePtr  m_operand;
+    ExprNodePtr  m_index;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class SizeofExprNode : public ExprNode
+{
+public:
+
+    SizeofExprNode(ExprNodePtr&& operand, const TypeInfoPtr& typeInfo) :
+        m_operand(std::move(operand)),
+        m_typeInfo(typeInfo)
+    {}
+
+    TypedValue eval(const ScopePtr& scope) override;
+
+private:
+
+    ExprNodePtr  m_operand;
+    TypeInfoPtr  m_typeInfo;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class TernaryExprNode : public ExprNode
+{
+public:
+
+    TernaryExprNode(ExprNodePtr&& condition, ExprNodePtr&& value1, ExprNodePtr&& value2) :
+        m_condition(std::move(condition)),
+        m_value1(std::move(value1)),
+        m_value2(std::move(value2))
+    {}
+
+    TypedValue eval(const ScopePtr& scope) override
+    {
+        return m_condition->eval(scope) ? m_value1->eval(scope) : m_value2->eval(scope);
+    }
+
+private:
+
+    ExprNodePtr  m_condition;
+    ExprNodePtr  m_value1;
+    ExprNodePtr  m_value2;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class ExprCompiler {
+
+public:
+
+    ExprCompiler(
+        const TypeInfoProviderPtr& typeInfoProvider,
+        TokenStream* tokens,
+        clang::tok::TokenKind  endToken = clang::tok::eof
+    ) :
+        m_typeInfoProvider(typeInfoProvider),
+        m_tokens(tokens),
+        m_endToken(endToken)
+    {}
+
+    ExprNodePtr  getResult();
+
+private:
+
+    ExprNodePtr getOperand();
+    ExprNodePtr getIdentifier();
+    ExprNodePtr getSizeof();
+    ExprNodePtr getTernary(ExprNodePtr&& condition);
+
+    std::unique_ptr<BinOperation> getOperation();
+
+    // a pre unary operation or a cast to a type depending on the scope
+    struct PreOperation {
+        std::unique_ptr<UnaryOperation>  operation;
+        std::string  scopedCastType;
+    };
+
+    bool getPreUnaryOperation(PreOperation& operation);
+
+    bool getTypeCast(PreOperation& operation);
+
+    TypeInfoProviderPtr  m_typeInfoProvider;
+    TokenStream*  m_tokens;
+    clang::tok::TokenKind  m_endToken;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class CompiledExprImpl : public CompiledExpr
+{
+public:
+
+    CompiledExprImpl(const std::string& expr, ExprNodePtr&& root) :
+        m_expr(expr),
+        m_root(std::move(root))
+    {}
+
+    TypedValue eval(const ScopePtr& scope) override
+    {
+        return m_root->eval(scope);
+    }
+
+    std::wstring getExpr() const override
+    {
+        return strToWStr(m_expr);
+    }
+
+private:
+
+    std::string  m_expr;
+    ExprNodePtr  m_root;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+}
@@ -3,17 +3,10 @@
 #include <memory>
 #include <regex>
 
-#include "clang/Basic/MemoryBufferCache.h"
-#include "clang/Basic/TargetOptions.h"
-#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/IdentifierTable.h"
+#include "clang/Basic/LangOptions.h"
 
-#include "clang/Lex/Preprocessor.h"
-#include "clang/Lex/PreprocessorOptions.h"
-#include "clang/Lex/HeaderSearch.h"
-#include "clang/Lex/HeaderSearchOptions.h"
-
-#include "clang/Frontend/CompilerInstance.h"
-#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Lex/Lexer.h"
 
 #include "kdlib/typedvar.h"
 #include "kdlib/exceptions.h"
@@ -45,78 +38,11 @@ TypedValue evalExpr(const std::wstring& expr, const ScopePtr& scope, const TypeI
 
 TypedValue evalExpr(const std::string& expr, const ScopePtr& scope, const TypeInfoProviderPtr& typeInfoProvider)
 {
-    auto  preprocessorOptions = std::make_shared<clang::PreprocessorOptions>();
-
-    llvm::IntrusiveRefCntPtr<clang::DiagnosticIDs> diagnosticIDs(new clang::DiagnosticIDs());
-
-    auto diagnosticOptions = new clang::DiagnosticOptions();
-
-    //auto textDiagnosticPrinter = new clang::TextDiagnosticPrinter(llvm::outs(), diagnosticOptions);
-
-    auto diagnosticConsumer = new clang::IgnoringDiagConsumer();
-
-    clang::DiagnosticsEngine  diagnosticEngine(diagnosticIDs, diagnosticOptions, diagnosticConsumer);
-
-    clang::LangOptions  langOptions;
-
-    llvm::IntrusiveRefCntPtr<clang::vfs::InMemoryFileSystem>  memoryFileSystem(new clang::vfs::InMemoryFileSystem());
-
-    memoryFileSystem->addFile("<input>", 0, llvm::MemoryBuffer::getMemBuffer(expr));
-
-    clang::FileSystemOptions  fileSystemOptions;
-    clang::FileManager  fileManager(fileSystemOptions, memoryFileSystem);
-    clang::SourceManager  sourceManager(diagnosticEngine, fileManager);
-
-    const clang::FileEntry *pFile = fileManager.getFile("<input>");
-    clang::FileID  fileID = sourceManager.getOrCreateFileID(pFile, clang::SrcMgr::C_User);
-    sourceManager.setMainFileID(fileID);
-
-    clang::MemoryBufferCache  memoryBufferCache;
-
-    auto headerSearchOptions = std::make_shared<clang::HeaderSearchOptions>();
-    auto targetOptions = std::make_shared<clang::TargetOptions>();
-    targetOptions->Triple = llvm::sys::getDefaultTargetTriple();
-    clang::TargetInfo*  targetInfo = clang::TargetInfo::CreateTargetInfo(diagnosticEngine, targetOptions);
-    clang::HeaderSearch  headerSearch(headerSearchOptions, sourceManager, diagnosticEngine, langOptions, targetInfo);
-
-    clang::CompilerInstance  compilerInstance;
-
-    clang::Preprocessor   preprocessor(
-        preprocessorOptions,
-        diagnosticEngine,
-        langOptions,
-        sourceManager,
-        memoryBufferCache,
-        headerSearch,
-        compilerInstance
-    );
-    preprocessor.Initialize(*targetInfo);
-
-    preprocessor.EnterMainSourceFile();
-    diagnosticConsumer->BeginSourceFile(langOptions, &preprocessor);
-
-    clang::Token token;
-
-    std::list<clang::Token>  tokens;
-
-    do {
-
-        preprocessor.Lex(token);
-
-        if (diagnosticEngine.hasErrorOccurred())
-        {
-            NOT_IMPLEMENTED();
-        }
-
-        tokens.push_back(token);
-
-    } while (!token.is(clang::tok::eof));
+    auto  tokens = lexExpression(expr);
+    TokenStream  tokenStream(tokens);
+    parser::MatchMemoScope  matchMemo;
 
-    diagnosticConsumer->EndSourceFile();
-
-    ExprEval  exprEval(scope, typeInfoProvider, &tokens);
-
-    return exprEval.getResult();
+    return ExprEval(scope, typeInfoProvider, &tokenStream).getResult();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -130,84 +56,99 @@ TypeInfoPtr evalType(const std::wstring& expr, const TypeInfoProviderPtr typeInf
 
 TypeInfoPtr evalType(const std::string& expr, const TypeInfoProviderPtr typeInfoProvider)
 {
-    auto  preprocessorOptions = std::make_shared<clang::PreprocessorOptions>();
+    return evalType(expr, typeInfoProvider, ScopePtr(new ScopeList()));
+}
 
-    llvm::IntrusiveRefCntPtr<clang::DiagnosticIDs> diagnosticIDs(new clang::DiagnosticIDs());
+///////////////////////////////////////////////////////////////////////////////
 
-    auto diagnosticOptions = new clang::DiagnosticOptions();
+TypeInfoPtr evalType(const std::string& expr, const TypeInfoProviderPtr& typeInfoProvider, const ScopePtr& scope)
+{
+    auto  tokens = lexExpression(expr);
+    TokenStream  tokenStream(tokens);
+    parser::MatchMemoScope  matchMemo;
 
-    //auto textDiagnosticPrinter = new clang::TextDiagnosticPrinter(llvm::outs(), diagnosticOptions);
+    return TypeEval(scope, typeInfoProvider, &tokenStream).getResult();
+}
 
-    auto diagnosticConsumer = new clang::IgnoringDiagConsumer();
+///////////////////////////////////////////////////////////////////////////////
 
-    clang::DiagnosticsEngine  diagnosticEngine(diagnosticIDs, diagnosticOptions, diagnosticConsumer);
+namespace {
 
-    clang::LangOptions  langOptions;
+class ExprLexerContext
+{
+public:
 
-    llvm::IntrusiveRefCntPtr<clang::vfs::InMemoryFileSystem>  memoryFileSystem(new clang::vfs::InMemoryFileSystem());
-    memoryFileSystem->addFile("<input>", 0, llvm::MemoryBuffer::getMemBuffer(expr.c_str()));
+    static ExprLexerContext& get()
+    {
+        static thread_local ExprLexerContext  lexerContext;
+        return lexerContext;
+    }
 
-    clang::FileSystemOptions  fileSystemOptions;
-    clang::FileManager  fileManager(fileSystemOptions, memoryFileSystem);
-    clang::SourceManager  sourceManager(diagnosticEngine, fileManager);
+    const clang::LangOptions& getLangOptions() const
+    {
+        return m_langOptions;
+    }
 
-    const clang::FileEntry *pFile = fileManager.getFile("<input>");
-    clang::FileID  fileID = sourceManager.getOrCreateFileID(pFile, clang::SrcMgr::C_User);
-    sourceManager.setMainFileID(fileID);
+    clang::IdentifierInfo& getIdentifier(llvm::StringRef name)
+    {
+        return m_identifierTable.get(name);
+    }
 
-    clang::MemoryBufferCache  memoryBufferCache;
+private:
 
-    auto headerSearchOptions = std::make_shared<clang::HeaderSearchOptions>();
-    auto targetOptions = std::make_shared<clang::TargetOptions>();
-    targetOptions->Triple = llvm::sys::getDefaultTargetTriple();
-    clang::TargetInfo*  targetInfo = clang::TargetInfo::CreateTargetInfo(diagnosticEngine, targetOptions);
-    clang::HeaderSearch  headerSearch(headerSearchOptions, sourceManager, diagnosticEngine, langOptions, targetInfo);
+    ExprLexerContext() :
+        m_identifierTable(m_langOptions)
+    {}
 
-    clang::CompilerInstance  compilerInstance;
+    clang::LangOptions  m_langOptions;
 
-    clang::Preprocessor   preprocessor(
-        preprocessorOptions,
-        diagnosticEngine,
-        langOptions,
-        sourceManager,
-        memoryBufferCache,
-        headerSearch,
-        compilerInstance
-    );
-    preprocessor.Initialize(*targetInfo);
+    clang::IdentifierTable  m_identifierTable;
+};
 
-    preprocessor.EnterMainSourceFile();
-    diagnosticConsumer->BeginSourceFile(langOptions, &preprocessor);
+}
 
-    clang::Token token;
+///////////////////////////////////////////////////////////////////////////////
+
+TokenList lexExpression(const std::string& expr)
+{
+    auto&  lexerContext = ExprLexerContext::get();
+
+    const char*  bufferStart = expr.c_str();
+    const char*  bufferEnd = bufferStart + expr.size();
 
-    std::list<clang::Token>  tokens;
+    clang::Lexer  lexer(clang::SourceLocation(), lexerContext.getLangOptions(), bufferStart, bufferStart, bufferEnd);
+
+    TokenList  tokens;
+    tokens.reserve(expr.size() / 2 + 1);
+
+    clang::Token token;
 
     do {
 
-        preprocessor.Lex(token);
+        lexer.LexFromRawLexer(token);
 
-        if (diagnosticEngine.hasErrorOccurred())
+        if (token.is(clang::tok::unknown))
+            throw ExprException(L"error syntax");
+
+        if (token.is(clang::tok::raw_identifier))
         {
-            NOT_IMPLEMENTED();
+            auto&  identifierInfo = lexerContext.getIdentifier(token.getRawIdentifier());
+            token.setIdentifierInfo(&identifierInfo);
+            token.setKind(identifierInfo.getTokenID());
         }
 
         tokens.push_back(token);
 
     } while (!token.is(clang::tok::eof));
 
-    diagnosticConsumer->EndSourceFile();
-
-    TypeEval  exprEval(ScopePtr(new ScopeList()), typeInfoProvider, &tokens);
-
-    return exprEval.getResult();
+    return tokens;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 ExprEval::ExprEval(const ScopePtr& scope,
     const TypeInfoProviderPtr& typeInfoProvider,
-    std::list<clang::Token>* tokens,
+    TokenStream* tokens,
     clang::tok::TokenKind  endToken)
 {
     m_scope = scope;
@@ -586,7 +527,7 @@ UnaryOperation* ExprEval::getTypeCastOperation()
 
     try {
 
-        std::list<clang::Token>   exprCopy(m_tokens->begin(), m_tokens->end());
+        TokenStream  exprCopy(*m_tokens);
 
         exprCopy.pop_front();
 
@@ -637,7 +578,7 @@ size_t ExprEval::getSizeof()
         throw ExprException(L"error syntax");
 
     try {
-        std::list<clang::Token>   exprCopy(m_tokens->begin(), m_tokens->end());
+        TokenStream  exprCopy(*m_tokens);
         TypedValue  exprResult = ExprEval(m_scope, m_typeInfoProvider, &exprCopy, clang::tok::r_paren).getResult();
         *m_tokens = exprCopy;
         return exprResult.getType()->getSize();
@@ -819,7 +760,7 @@ TypeInfoPtr TypeEval::getResult()
     QualifiedTypeMatcher typeMatcher;
 
     auto matcher = all_of(typeMatcher, token_is(m_endToken));
-    auto matchResult = matcher.match(std::make_pair(m_tokens->cbegin(), m_tokens->cend()));
+    auto matchResult = matcher.match(std::make_pair(m_tokens->begin(), m_tokens->end()));
 
     if (!matchResult.isMatched())
         throw  ExprException(L"error syntax");
@@ -851,7 +792,7 @@ TypeInfoPtr TypeEval::getResult()
         typeInfo = applyComplexModifierRecursive(typeMatcher.getComplexMather(), typeInfo);
     }  
 
-    m_tokens->erase(matchResult.begin(), matchResult.end());
+    m_tokens->seek(matchResult.end());
 
     return typeInfo;
 }
@@ -865,7 +806,7 @@ std::list<std::string>  TypeEval::getTemplateArgList()
     TypeMatcher typeMatcher;
 
     auto matcher = all_of(typeMatcher, token_is(m_endToken));
-    auto matchResult = matcher.match(std::make_pair(m_tokens->cbegin(), m_tokens->cend()));
+    auto matchResult = matcher.match(std::make_pair(m_tokens->begin(), m_tokens->end()));
 
     if (!matchResult.isMatched())
         throw  ExprException(L"error syntax");
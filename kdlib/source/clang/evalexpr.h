@@ -11,6 +11,15 @@
 
 namespace kdlib {
 
+///////////////////////////////////////////////////////////////////////////////
+
+// Tokens refer to the expression text, so expr must outlive the returned list
+TokenList lexExpression(const std::string& expr);
+
+// the identifiers of the type ( array dimensions, template arguments ) are looked up in the scope
+TypeInfoPtr evalType(const std::string& expr, const TypeInfoProviderPtr& typeInfoProvider, const ScopePtr& scope);
+
+///////////////////////////////////////////////////////////////////////////////
 
 class BinOperation {
 public:
@@ -436,7 +445,7 @@ public:
     ExprEval(
         const ScopePtr& scope,
         const TypeInfoProviderPtr& typeInfoProvider,
-        std::list<clang::Token>* tokens,
+        TokenStream* tokens,
         clang::tok::TokenKind  endToken = clang::tok::eof
         );
 
@@ -446,7 +455,7 @@ private:
 
     ScopePtr   m_scope;
     TypeInfoProviderPtr  m_typeInfoProvider;
-    std::list<clang::Token>*  m_tokens;
+    TokenStream*  m_tokens;
     clang::tok::TokenKind  m_endToken;
 
     TypedValue getOperand();
@@ -508,7 +517,7 @@ public:
        
     TypeEval(const ScopePtr& scope,
         const TypeInfoProviderPtr& typeInfoProvider,
-        std::list<clang::Token>* tokens,
+        TokenStream* tokens,
         clang::tok::TokenKind  endToken = clang::tok::eof
     ) : m_scope(scope), m_typeInfoProvider(typeInfoProvider), m_tokens(tokens), m_endToken(endToken)
     {}
@@ -542,7 +551,7 @@ private:
     
     TypeInfoProviderPtr  m_typeInfoProvider;
 
-    std::list<clang::Token>*  m_tokens;
+    TokenStream*  m_tokens;
     clang::tok::TokenKind  m_endToken;
 
 };
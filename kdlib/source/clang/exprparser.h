@@ -63,7 +63,7 @@ public:
     }
 
 private:
-    std::unique_ptr<ConstExpressionMatcher>  exprMatcher;
+    std::shared_ptr<ConstExpressionMatcher>  exprMatcher;
 };
 
 class OperandMatcher : public Matcher
@@ -249,10 +249,10 @@ private:
     Is<clang::tok::ampamp>  m_ampampMatcher;
 };
 
-class ConstExpressionMatcher : public Matcher
+class ConstExpressionMatcher : public MemoMatcher<ConstExpressionMatcher>
 {
 public:
-    auto  match(const TokenRange& matchRange)
+    MatchResult  matchTokens(const TokenRange& matchRange)
     {
         auto matcher = all_of(
             cap(operandMatcher, operandMatcher),
@@ -283,7 +283,7 @@ private:
 inline
 MatchResult  NestedExprMatcher::match(const TokenRange& matchRange)
 {
-    exprMatcher = std::make_unique<ConstExpressionMatcher>();
+    exprMatcher = std::make_shared<ConstExpressionMatcher>();
     auto matcher = all_of(
         token_is(clang::tok::l_paren),
         *exprMatcher.get(),
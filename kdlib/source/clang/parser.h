@@ -2,6 +2,10 @@
 
 #include <list>
 #include <vector>
+#include <map>
+#include <memory>
+#include <tuple>
+#include <typeinfo>
 
 #include "clang/Lex/Token.h"
 #include "clang/Lex/Preprocessor.h"
@@ -10,10 +14,68 @@ namespace kdlib {
 
 std::string  tokenToStr(const clang::Token& token);
 
-using TokenIterator = std::list<clang::Token>::const_iterator;
+using TokenList = std::vector<clang::Token>;
+
+using TokenIterator = TokenList::const_iterator;
 
 using TokenRange = std::pair<TokenIterator, TokenIterator>;
 
+///////////////////////////////////////////////////////////////////////////////
+
+class TokenStream
+{
+public:
+
+    explicit TokenStream(const TokenList& tokens) :
+        m_tokens(&tokens),
+        m_pos(0)
+    {}
+
+    bool empty() const
+    {
+        return m_pos >= m_tokens->size();
+    }
+
+    size_t size() const
+    {
+        return m_tokens->size() - m_pos;
+    }
+
+    const clang::Token& front() const
+    {
+        assert(!empty());
+        return (*m_tokens)[m_pos];
+    }
+
+    void pop_front()
+    {
+        assert(!empty());
+        ++m_pos;
+    }
+
+    TokenIterator begin() const
+    {
+        return m_tokens->cbegin() + m_pos;
+    }
+
+    TokenIterator end() const
+    {
+        return m_tokens->cend();
+    }
+
+    void seek(const TokenIterator& pos)
+    {
+        m_pos = std::distance(m_tokens->cbegin(), pos);
+    }
+
+private:
+
+    const TokenList*  m_tokens;
+    size_t  m_pos;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 namespace parser {
 
 
@@ -77,6 +139,111 @@ protected:
     MatchResult  matchResult;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+
+// Packrat memo of matcher results keyed by (matcher type, token range).
+// Matchers capture their sub-matchers, so a successful entry keeps a copy
+// of the whole matched state; a failed one is stored as nullptr.
+class MatchMemo
+{
+public:
+
+    using Key = std::tuple<const std::type_info*, const clang::Token*, size_t>;
+
+    static MatchMemo*& current()
+    {
+        static thread_local MatchMemo*  memo = nullptr;
+        return memo;
+    }
+
+    bool find(const Key& key, std::shared_ptr<const void>& result) const
+    {
+        auto  it = m_results.find(key);
+        if (it == m_results.end())
+            return false;
+        result = it->second;
+        return true;
+    }
+
+    void insert(const Key& key, const std::shared_ptr<const void>& result)
+    {
+        m_results[key] = result;
+    }
+
+private:
+
+    std::map<Key, std::shared_ptr<const void>>  m_results;
+};
+
+// Enables memoization for the matchers run on one token list.
+// Scopes nest: each lexed expression gets its own memo.
+class MatchMemoScope
+{
+public:
+
+    MatchMemoScope() :
+        m_prevMemo(MatchMemo::current())
+    {
+        MatchMemo::current() = &m_memo;
+    }
+
+    ~MatchMemoScope()
+    {
+        MatchMemo::current() = m_prevMemo;
+    }
+
+    MatchMemoScope(const MatchMemoScope&) = delete;
+    MatchMemoScope& operator=(const MatchMemoScope&) = delete;
+
+private:
+
+    MatchMemo  m_memo;
+    MatchMemo*  m_prevMemo;
+};
+
+// Base for the recursive matchers: T implements matchTokens(), match()
+// serves repeated attempts on the same token range from the memo.
+template<typename T>
+class MemoMatcher : public Matcher
+{
+public:
+
+    MatchResult match(const TokenRange& matchRange)
+    {
+        T&  self = static_cast<T&>(*this);
+
+        MatchMemo*  memo = MatchMemo::current();
+
+        if (!memo || matchRange.first == matchRange.second)
+            return self.matchTokens(matchRange);
+
+        MatchMemo::Key  key(&typeid(T), &*matchRange.first, std::distance(matchRange.first, matchRange.second));
+
+        std::shared_ptr<const void>  memoResult;
+        if (memo->find(key, memoResult))
+        {
+            if (!memoResult)
+                return matchResult = MatchResult();
+
+            self = *static_cast<const T*>(memoResult.get());
+            return matchResult;
+        }
+
+        T  matcher;
+        MatchResult  result = matcher.matchTokens(matchRange);
+
+        if (result.isMatched())
+            memo->insert(key, std::make_shared<T>(matcher));
+        else
+            memo->insert(key, nullptr);
+
+        self = std::move(matcher);
+        return result;
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 
 template<TokenKind  tokenKind>
 class Is : public Matcher
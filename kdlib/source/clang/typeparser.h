@@ -148,7 +148,7 @@ public:
 
 private:
 
-    std::unique_ptr<ComplexMatcher>  innerMatcher;
+    std::shared_ptr<ComplexMatcher>  innerMatcher;
 
 };
 
@@ -182,12 +182,12 @@ private:
     Is<clang::tok::ampamp> rvalueRefMacther;
 };
 
-class ComplexMatcher : public Matcher
+class ComplexMatcher : public MemoMatcher<ComplexMatcher>
 {
 
 public:
 
-    MatchResult  match(const TokenRange& matchRange)
+    MatchResult  matchTokens(const TokenRange& matchRange)
     {
         auto matcher =  all_of(
             opt(pointersMatcher), 
@@ -324,11 +324,11 @@ private:
 
 class QualifiedTypeMatcher;
 
-class TemplateArgMatcher : public Matcher
+class TemplateArgMatcher : public MemoMatcher<TemplateArgMatcher>
 {
 public:
 
-    MatchResult  match(const TokenRange& matchRange);
+    MatchResult  matchTokens(const TokenRange& matchRange);
 
     bool isType() const;
 
@@ -346,7 +346,7 @@ public:
 
 private:
 
-    std::unique_ptr<QualifiedTypeMatcher>  typeMatcher;
+    std::shared_ptr<QualifiedTypeMatcher>  typeMatcher;
 
     ConstExpressionMatcher  exprMatcher;
 };
@@ -375,10 +375,10 @@ private:
 };
 
 
-class TemplateMatcher : public Matcher
+class TemplateMatcher : public MemoMatcher<TemplateMatcher>
 {
 public:
-    MatchResult  match(const TokenRange& matchRange)
+    MatchResult  matchTokens(const TokenRange& matchRange)
     {
         auto matcher = all_of(
             token_is(clang::tok::less),
@@ -400,10 +400,10 @@ private:
     TemplateArgsMatcher  templateArgsMatcher;
 };
 
-class DoubleTemplateMatcher : public Matcher
+class DoubleTemplateMatcher : public MemoMatcher<DoubleTemplateMatcher>
 {
 public:
-    MatchResult  match(const TokenRange& matchRange)
+    MatchResult  matchTokens(const TokenRange& matchRange)
     {
         auto matcher =
             all_of(
@@ -468,11 +468,11 @@ private:
 };
 
 
-class CustomTypeMatcher : public Matcher
+class CustomTypeMatcher : public MemoMatcher<CustomTypeMatcher>
 {
 public:
 
-    MatchResult  match(const TokenRange& matchRange)
+    MatchResult  matchTokens(const TokenRange& matchRange)
     {
         auto matcher =
             all_of(
@@ -581,10 +581,10 @@ private:
     StandardIntMatcher  stdIntMatcher;
 };
 
-class QualifiedTypeMatcher : public Matcher
+class QualifiedTypeMatcher : public MemoMatcher<QualifiedTypeMatcher>
 {
 public:
-    MatchResult  match(const TokenRange& matchRange)
+    MatchResult  matchTokens(const TokenRange& matchRange)
     {
         auto matcher = all_of(
             opt(constMatcher1),
@@ -656,7 +656,7 @@ private:
 inline
 MatchResult NestedComplexMatcher::match(const TokenRange& matchRange)
 {
-    innerMatcher = std::make_unique<ComplexMatcher>();
+    innerMatcher = std::make_shared<ComplexMatcher>();
     return matchResult = all_of(Is<clang::tok::l_paren>(), *innerMatcher.get(), Is<clang::tok::r_paren>()).match(matchRange);
 }
 
@@ -667,9 +667,9 @@ const ComplexMatcher& NestedComplexMatcher::getInnerMatcher() const
 } 
 
 inline
-MatchResult TemplateArgMatcher::match(const TokenRange& matchRange)
+MatchResult TemplateArgMatcher::matchTokens(const TokenRange& matchRange)
 {
-    typeMatcher = std::make_unique<QualifiedTypeMatcher>();
+    typeMatcher = std::make_shared<QualifiedTypeMatcher>();
     auto matcher = any_of(
         exprMatcher,
         *typeMatcher.get()
@@ -680,7 +680,7 @@ MatchResult TemplateArgMatcher::match(const TokenRange& matchRange)
 inline
 bool TemplateArgMatcher::isType() const
 {
-    return typeMatcher->getMatchResult().isMatched();
+    return typeMatcher && typeMatcher->getMatchResult().isMatched();
 }
 
 inline
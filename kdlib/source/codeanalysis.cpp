@@ -0,0 +1,977 @@
+#include "stdafx.h"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <sstream>
+#include <iomanip>
+
+#include <boost/thread/recursive_mutex.hpp>
+
+#include "kdlib/codeanalysis.h"
+#include "kdlib/x86decoder.h"
+#include "kdlib/exceptions.h"
+
+namespace kdlib {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+
+const unsigned short  machineI386 = 0x14C;
+const unsigned short  machineAmd64 = 0x8664;
+
+const size_t  codePageSize = 0x1000;
+
+// a function is not traced further than this: a guard against the data decoded as code
+const size_t  maxFunctionInstructions = 0x10000;
+
+const unsigned int  indexMagic = 0x4943444B;     // "KDCI"
+const unsigned int  indexVersion = 1;
+const size_t  indexHeaderSize = 8 * 4;
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool isBlockEnd(const X86Instruction& instruction)
+{
+    if ((instruction.flags & (X86InstrBranch | X86InstrReturn)) != 0)
+        return true;
+
+    switch (instruction.mnemonic)
+    {
+    case X86Hlt:
+    case X86Int3:
+    case X86Ud0:
+    case X86Ud1:
+    case X86Ud2:
+    case X86Iret:
+    case X86Iretd:
+    case X86Iretq:
+    case X86Sysret:
+        return true;
+
+    default:
+        break;
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool isFlowEnd(const X86Instruction& instruction)
+{
+    return isBlockEnd(instruction) && (instruction.flags & X86InstrConditional) == 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+class CodeAnalyzer
+{
+public:
+
+    CodeAnalyzer(const PEImageReader& reader, MEMOFFSET_64 imageBase, const std::vector<CodeRange>& symbolFunctions) :
+        m_reader(reader),
+        m_imageBase(imageBase),
+        m_symbolFunctions(symbolFunctions)
+    {}
+
+    CodeIndexPtr analyze();
+
+private:
+
+    struct CodeRegion {
+        MEMOFFSET_32  rva;
+        std::vector<unsigned char>  code;
+        std::vector<bool>  validPages;
+        std::vector<size_t>  runEnds;   // for a valid page: the first invalid page after it
+    };
+
+    struct Instruction {
+        unsigned char  length;
+        bool  blockEnd;
+    };
+
+    void readCode(const PECodeDirectory& codeDir);
+
+    // the readable code bytes from the rva to the end of its region or an unreadable page
+    bool getCode(MEMOFFSET_32 rva, const unsigned char*& code, size_t& size) const;
+
+    bool isCode(MEMOFFSET_32 rva) const {
+        const unsigned char*  code;
+        size_t  size;
+        return getCode(rva, code, size);
+    }
+
+    bool toRva(MEMOFFSET_64 address, MEMOFFSET_32& rva) const;
+
+    void addEntry(MEMOFFSET_32 rva, unsigned long source);
+
+    bool isOwned(MEMOFFSET_32 rva) const;
+
+    void analyzeFunction(MEMOFFSET_32 entry);
+
+    void addRefs(const X86Instruction& instruction, MEMOFFSET_32 rva, std::set<MEMOFFSET_32>& leaders, std::vector<MEMOFFSET_32>& pending);
+
+    const PEImageReader&  m_reader;
+    MEMOFFSET_64  m_imageBase;
+    const std::vector<CodeRange>&  m_symbolFunctions;
+
+    CPUType  m_cpuMode;
+    MEMOFFSET_64  m_addressMask;
+    MEMOFFSET_32  m_imageSize;
+    std::vector<CodeRegion>  m_regions;
+
+    std::map<MEMOFFSET_32, unsigned long>  m_entries;       // known function entries and their sources
+    std::set<MEMOFFSET_32>  m_pendingEntries;
+    std::map<MEMOFFSET_32, unsigned long>  m_blockMap;      // block rva -> block index
+
+    std::vector<CodeFunction>  m_functions;
+    std::vector<CodeBlock>  m_blocks;
+    std::vector<CodeRef>  m_refs;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+CodeIndexPtr CodeAnalyzer::analyze()
+{
+    PECodeDirectory  codeDir = getPECode(m_reader, PEImageMapped);
+
+    switch (codeDir.machine)
+    {
+    case machineI386:
+        m_cpuMode = CPU_I386;
+        m_addressMask = 0xFFFFFFFF;
+        break;
+
+    case machineAmd64:
+        m_cpuMode = CPU_AMD64;
+        m_addressMask = ~0ULL;
+        break;
+
+    default:
+        throw DbgException("code analysis supports only x86 and x64 images");
+    }
+
+    m_imageSize = codeDir.imageSize;
+
+    readCode(codeDir);
+
+    // all the known entries are collected before the tracing: a branch to a known
+    // entry is a tail call and does not take the code of other function
+
+    for (const auto& range : m_symbolFunctions)
+        addEntry(range.rva, CodeFromSymbol);
+
+    for (const auto& function : codeDir.runtimeFunctions)
+        addEntry(function.begin, CodeFromUnwind);
+
+    PEExportDirectory  exportDir = getPEExports(m_reader, PEImageMapped);
+    for (const auto& exportEntry : exportDir.exports)
+    {
+        if (!exportEntry.forwarded)
+            addEntry(exportEntry.rva, CodeFromExport);
+    }
+
+    if (codeDir.entryPoint != 0)
+        addEntry(codeDir.entryPoint, CodeFromEntry);
+
+    // call targets found by the tracing are added to the pending set
+
+    while (!m_pendingEntries.empty())
+    {
+        MEMOFFSET_32  entry = *m_pendingEntries.begin();
+        m_pendingEntries.erase(m_pendingEntries.begin());
+
+        analyzeFunction(entry);
+    }
+
+    // the functions were traced by the pending order: sort them by rva keeping
+    // the blocks groups
+
+    std::vector<unsigned long>  functionOrder(m_functions.size());
+    for (unsigned long i = 0; i < functionOrder.size(); ++i)
+        functionOrder[i] = i;
+
+    std::sort(functionOrder.begin(), functionOrder.end(), [this](unsigned long left, unsigned long right) {
+        return m_functions[left].rva < m_functions[right].rva;
+    });
+
+    std::vector<CodeFunction>  functions;
+    std::vector<CodeBlock>  blocks;
+    functions.reserve(m_functions.size());
+    blocks.reserve(m_blocks.size());
+
+    for (auto functionIndex : functionOrder)
+    {
+        CodeFunction  function = m_functions[functionIndex];
+        function.sources = m_entries[function.rva];     // a call found after the tracing adds a source
+
+        auto  begin = m_blocks.begin() + function.firstBlock;
+        auto  end = begin + function.blockCount;
+
+        function.firstBlock = static_cast<unsigned long>(blocks.size());
+
+        for (auto block = begin; block != end; ++block)
+        {
+            blocks.push_back(*block);
+            blocks.back().function = static_cast<unsigned long>(functions.size());
+        }
+
+        functions.push_back(function);
+    }
+
+    std::sort(m_refs.begin(), m_refs.end(), [](const CodeRef& left, const CodeRef& right) {
+        if (left.from != right.from)
+            return left.from < right.from;
+        if (left.to != right.to)
+            return left.to < right.to;
+        return left.type < right.type;
+    });
+
+    m_refs.erase(std::unique(m_refs.begin(), m_refs.end(), [](const CodeRef& left, const CodeRef& right) {
+        return left.from == right.from && left.to == right.to && left.type == right.type;
+    }), m_refs.end());
+
+    return CodeIndexPtr(new CodeIndex(codeDir.timeDataStamp, codeDir.checkSum, functions, blocks, m_refs));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CodeAnalyzer::readCode(const PECodeDirectory& codeDir)
+{
+    for (const auto& section : codeDir.sections)
+    {
+        if (!section.isExecutable() || section.size == 0)
+            continue;
+
+        CodeRegion  region;
+        region.rva = section.rva;
+        region.code.resize(section.size);
+        region.validPages.assign((section.size + codePageSize - 1) / codePageSize, true);
+
+        // the whole section by one read, a dump can miss some pages of it: then
+        // it is read by pages
+
+        try {
+            m_reader(section.rva, &region.code[0], region.code.size());
+        }
+        catch (DbgException&)
+        {
+            for (size_t page = 0; page < region.validPages.size(); ++page)
+            {
+                size_t  offset = page * codePageSize;
+                size_t  length = std::min(codePageSize, region.code.size() - offset);
+
+                try {
+                    m_reader(section.rva + static_cast<MEMOFFSET_32>(offset), &region.code[offset], length);
+                }
+                catch (DbgException&)
+                {
+                    region.validPages[page] = false;
+                }
+            }
+        }
+
+        // the readable run of every page is found once, not on every decoded instruction
+        region.runEnds.resize(region.validPages.size());
+        for (size_t page = region.validPages.size(); page-- > 0;)
+        {
+            if (!region.validPages[page])
+                region.runEnds[page] = page;
+            else if (page + 1 < region.validPages.size() && region.validPages[page + 1])
+                region.runEnds[page] = region.runEnds[page + 1];
+            else
+                region.runEnds[page] = page + 1;
+        }
+
+        m_regions.push_back(region);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool CodeAnalyzer::getCode(MEMOFFSET_32 rva, const unsigned char*& code, size_t& size) const
+{
+    for (const auto& region : m_regions)
+    {
+        if (rva < region.rva || rva - region.rva >= region.code.size())
+            continue;
+
+        size_t  offset = rva - region.rva;
+        size_t  page = offset / codePageSize;
+
+        if (!region.validPages[page])
+            return false;
+
+        size_t  end = region.runEnds[page];
+
+        code = &region.code[offset];
+        size = std::min(end * codePageSize, region.code.size()) - offset;
+        return true;
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool CodeAnalyzer::toRva(MEMOFFSET_64 address, MEMOFFSET_32& rva) const
+{
+    MEMOFFSET_64  offset = (address - m_imageBase) & m_addressMask;
+    if (offset >= m_imageSize)
+        return false;
+
+    rva = static_cast<MEMOFFSET_32>(offset);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CodeAnalyzer::addEntry(MEMOFFSET_32 rva, unsigned long source)
+{
+    if (!isCode(rva))
+        return;
+
+    auto  it = m_entries.find(rva);
+    if (it != m_entries.end())
+    {
+        it->second |= source;
+        return;
+    }
+
+    m_entries.insert(std::make_pair(rva, source));
+    m_pendingEntries.insert(rva);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool CodeAnalyzer::isOwned(MEMOFFSET_32 rva) const
+{
+    auto  it = m_blockMap.upper_bound(rva);
+    if (it == m_blockMap.begin())
+        return false;
+
+    const CodeBlock&  block = m_blocks[(--it)->second];
+    return rva - block.rva < block.size;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CodeAnalyzer::addRefs(const X86Instruction& instruction, MEMOFFSET_32 rva, std::set<MEMOFFSET_32>& leaders, std::vector<MEMOFFSET_32>& pending)
+{
+    MEMOFFSET_32  targetRva;
+
+    if (instruction.target != 0 && toRva(instruction.target, targetRva))
+    {
+        if ((instruction.flags & X86InstrCall) != 0)
+        {
+            CodeRef  ref = { rva, targetRva, CodeRefCall };
+            m_refs.push_back(ref);
+
+            addEntry(targetRva, CodeFromCall);
+        }
+        else
+        {
+            CodeRef  ref = { rva, targetRva, CodeRefJump };
+            m_refs.push_back(ref);
+
+            // a branch to other function is a tail call: it is not traced
+            if (m_entries.find(targetRva) == m_entries.end() && isCode(targetRva))
+            {
+                leaders.insert(targetRva);
+                pending.push_back(targetRva);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < instruction.operandCount; ++i)
+    {
+        const X86Operand&  operand = instruction.operands[i];
+
+        MEMOFFSET_64  address;
+
+        if (operand.type == X86OpMemory)
+        {
+            if (!getX86StaticAddress(instruction, operand, address))
+                continue;
+        }
+        else if (operand.type == X86OpImmediate && operand.size >= 4)
+        {
+            // "push offset g_var", "mov rcx, offset g_var"
+            address = static_cast<MEMOFFSET_64>(operand.value);
+        }
+        else
+        {
+            continue;
+        }
+
+        if (toRva(address, targetRva))
+        {
+            CodeRef  ref = { rva, targetRva, CodeRefData };
+            m_refs.push_back(ref);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CodeAnalyzer::analyzeFunction(MEMOFFSET_32 entry)
+{
+    // the entry was taken by other function ( a call into its middle or a jump
+    // to it was traced before the call was found )
+    if (isOwned(entry))
+        return;
+
+    X86Decoder  decoder(m_cpuMode);
+    X86Instruction  instruction;
+
+    std::map<MEMOFFSET_32, Instruction>  instructions;
+    std::set<MEMOFFSET_32>  leaders;
+    std::vector<MEMOFFSET_32>  pending;
+
+    leaders.insert(entry);
+    pending.push_back(entry);
+
+    while (!pending.empty() && instructions.size() < maxFunctionInstructions)
+    {
+        MEMOFFSET_32  rva = pending.back();
+        pending.pop_back();
+
+        while (instructions.size() < maxFunctionInstructions)
+        {
+            if (instructions.find(rva) != instructions.end())
+            {
+                // the flow joins the traced code
+                leaders.insert(rva);
+                break;
+            }
+
+            if (rva != entry && (m_entries.find(rva) != m_entries.end() || isOwned(rva)))
+                break;
+
+            const unsigned char*  code;
+            size_t  size;
+
+            if (!getCode(rva, code, size))
+                break;
+
+            if (decoder.decode(code, size, m_imageBase + rva, instruction) != X86DecodeOk)
+                break;
+
+            if (instruction.mnemonic == X86Invalid)
+                break;
+
+            addRefs(instruction, rva, leaders, pending);
+
+            Instruction  traced = { instruction.length, isBlockEnd(instruction) };
+            instructions.insert(std::make_pair(rva, traced));
+
+            if (isFlowEnd(instruction))
+                break;
+
+            rva += instruction.length;
+
+            if (traced.blockEnd)
+                leaders.insert(rva);
+        }
+    }
+
+    if (instructions.empty())
+        return;
+
+    // basic blocks: a block starts at a leader or after a branch and ends before
+    // a gap in the traced code
+
+    CodeFunction  function = {};
+    function.rva = entry;
+    function.firstBlock = static_cast<unsigned long>(m_blocks.size());
+
+    unsigned long  functionIndex = static_cast<unsigned long>(m_functions.size());
+
+    MEMOFFSET_32  functionEnd = entry;
+    bool  newBlock = true;
+
+    for (auto it = instructions.begin(); it != instructions.end(); ++it)
+    {
+        MEMOFFSET_32  rva = it->first;
+
+        if (!newBlock)
+        {
+            const CodeBlock&  last = m_blocks.back();
+            newBlock = last.rva + last.size != rva || leaders.find(rva) != leaders.end();
+        }
+
+        if (newBlock)
+        {
+            CodeBlock  block = { rva, 0, functionIndex };
+            m_blocks.push_back(block);
+            newBlock = false;
+        }
+
+        m_blocks.back().size += it->second.length;
+
+        if (it->second.blockEnd)
+            newBlock = true;
+
+        functionEnd = std::max(functionEnd, rva + it->second.length);
+    }
+
+    function.blockCount = static_cast<unsigned long>(m_blocks.size()) - function.firstBlock;
+    function.size = functionEnd - entry;
+
+    for (unsigned long i = function.firstBlock; i < m_blocks.size(); ++i)
+        m_blockMap.insert(std::make_pair(m_blocks[i].rva, i));
+
+    m_functions.push_back(function);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void putValue(std::vector<unsigned char>& data, unsigned int value)
+{
+    unsigned char  bytes[4];
+    memcpy(bytes, &value, sizeof(bytes));
+    data.insert(data.end(), bytes, bytes + sizeof(bytes));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+class IndexReader
+{
+public:
+
+    IndexReader(const void* data, size_t size) :
+        m_data(static_cast<const unsigned char*>(data)),
+        m_size(size),
+        m_pos(0)
+    {}
+
+    unsigned int getValue()
+    {
+        if (m_size - m_pos < 4)
+            throw DbgException("code index is corrupted");
+
+        unsigned int  value;
+        memcpy(&value, m_data + m_pos, sizeof(value));
+        m_pos += sizeof(value);
+        return value;
+    }
+
+    unsigned char getByte()
+    {
+        if (m_pos >= m_size)
+            throw DbgException("code index is corrupted");
+
+        return m_data[m_pos++];
+    }
+
+private:
+
+    const unsigned char*  m_data;
+    size_t  m_size;
+    size_t  m_pos;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+struct IndexCacheKey {
+    std::wstring  imageName;
+    unsigned long  timeDataStamp;
+    unsigned long  checkSum;
+    bool  symbolsLoaded;
+};
+
+inline bool operator< (const IndexCacheKey& key1, const IndexCacheKey& key2)
+{
+    if (key1.timeDataStamp != key2.timeDataStamp)
+        return key1.timeDataStamp < key2.timeDataStamp;
+    if (key1.checkSum != key2.checkSum)
+        return key1.checkSum < key2.checkSum;
+    if (key1.symbolsLoaded != key2.symbolsLoaded)
+        return key1.symbolsLoaded < key2.symbolsLoaded;
+    return key1.imageName < key2.imageName;
+}
+
+struct ModuleIndexKey {
+    PROCESS_DEBUG_ID  processId;
+    MEMOFFSET_64  moduleBase;
+    bool  symbolsLoaded;
+};
+
+inline bool operator< (const ModuleIndexKey& key1, const ModuleIndexKey& key2)
+{
+    if (key1.processId != key2.processId)
+        return key1.processId < key2.processId;
+    if (key1.moduleBase != key2.moduleBase)
+        return key1.moduleBase < key2.moduleBase;
+    return key1.symbolsLoaded < key2.symbolsLoaded;
+}
+
+boost::recursive_mutex  g_indexCacheLock;
+std::map<ModuleIndexKey, CodeIndexPtr>  g_indexCache;
+std::wstring  g_indexDirectory;
+
+///////////////////////////////////////////////////////////////////////////////
+
+// "ntdll_5F2A1B3C001F8A2E.kci": the same scheme as the symbol store uses for images,
+// "ntdll_5F2A1B3C001F8A2E_nosym.kci" is built without the symbols
+std::wstring getIndexFileName(const IndexCacheKey& key)
+{
+    std::wstringstream  sstr;
+    sstr << g_indexDirectory << L'\\' << key.imageName << L'_'
+        << std::hex << std::uppercase << std::setfill(L'0')
+        << std::setw(8) << key.timeDataStamp << std::setw(8) << key.checkSum
+        << (key.symbolsLoaded ? L".kci" : L"_nosym.kci");
+    return sstr.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CodeIndexPtr loadIndexFile(const IndexCacheKey& key)
+{
+    FILE*  file = 0;
+    if (_wfopen_s(&file, getIndexFileName(key).c_str(), L"rb") != 0)
+        return CodeIndexPtr();
+
+    std::vector<unsigned char>  data;
+    unsigned char  block[0x10000];
+    size_t  readed;
+
+    while ((readed = fread(block, 1, sizeof(block), file)) > 0)
+        data.insert(data.end(), block, block + readed);
+
+    fclose(file);
+
+    try {
+        CodeIndexPtr  codeIndex = CodeIndex::load(data.data(), data.size());
+        if (codeIndex->getTimeDataStamp() == key.timeDataStamp && codeIndex->getCheckSum() == key.checkSum)
+            return codeIndex;
+    }
+    catch (DbgException&)
+    {}
+
+    // a corrupted or a stale file is rebuilt
+    return CodeIndexPtr();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void saveIndexFile(const IndexCacheKey& key, const CodeIndexPtr& codeIndex)
+{
+    std::vector<unsigned char>  data;
+    codeIndex->save(data);
+
+    FILE*  file = 0;
+    if (_wfopen_s(&file, getIndexFileName(key).c_str(), L"wb") != 0)
+        return;
+
+    fwrite(data.data(), 1, data.size(), file);
+    fclose(file);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // end nameless namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+CodeIndex::CodeIndex(
+    unsigned long timeDataStamp,
+    unsigned long checkSum,
+    std::vector<CodeFunction>& functions,
+    std::vector<CodeBlock>& blocks,
+    std::vector<CodeRef>& refs ) :
+        m_timeDataStamp(timeDataStamp),
+        m_checkSum(checkSum)
+{
+    m_functions.swap(functions);
+    m_blocks.swap(blocks);
+    m_refs.swap(refs);
+
+    buildLookup();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void CodeIndex::buildLookup()
+{
+    m_blockOrder.resize(m_blocks.size());
+    for (unsigned long i = 0; i < m_blockOrder.size(); ++i)
+        m_blockOrder[i] = i;
+
+    std::sort(m_blockOrder.begin(), m_blockOrder.end(), [this](unsigned long left, unsigned long right) {
+        return m_blocks[left].rva < m_blocks[right].rva;
+    });
+
+    m_refTargets.resize(m_refs.size());
+    for (unsigned long i = 0; i < m_refTargets.size(); ++i)
+        m_refTargets[i] = i;
+
+    std::stable_sort(m_refTargets.begin(), m_refTargets.end(), [this](unsigned long left, unsigned long right) {
+        return m_refs[left].to < m_refs[right].to;
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const CodeBlock* CodeIndex::findBlock(MEMOFFSET_32 rva) const
+{
+    auto  it = std::upper_bound(m_blockOrder.begin(), m_blockOrder.end(), rva, [this](MEMOFFSET_32 rva, unsigned long block) {
+        return rva < m_blocks[block].rva;
+    });
+
+    if (it == m_blockOrder.begin())
+        return 0;
+
+    const CodeBlock&  block = m_blocks[*--it];
+    if (rva - block.rva >= block.size)
+        return 0;
+
+    return &block;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const CodeFunction* CodeIndex::findFunction(MEMOFFSET_32 rva) const
+{
+    const CodeBlock*  block = findBlock(rva);
+    return block ? &m_functions[block->function] : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<CodeRef> CodeIndex::getRefsFrom(const CodeFunction& function) const
+{
+    std::vector<CodeRef>  refs;
+
+    for (unsigned long i = function.firstBlock; i < function.firstBlock + function.blockCount; ++i)
+    {
+        const CodeBlock&  block = m_blocks[i];
+
+        auto  it = std::lower_bound(m_refs.begin(), m_refs.end(), block.rva, [](const CodeRef& ref, MEMOFFSET_32 rva) {
+            return ref.from < rva;
+        });
+
+        for (; it != m_refs.end() && it->from - block.rva < block.size; ++it)
+            refs.push_back(*it);
+    }
+
+    return refs;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<CodeRef> CodeIndex::getRefsTo(MEMOFFSET_32 rva) const
+{
+    std::vector<CodeRef>  refs;
+
+    auto  it = std::lower_bound(m_refTargets.begin(), m_refTargets.end(), rva, [this](unsigned long ref, MEMOFFSET_32 rva) {
+        return m_refs[ref].to < rva;
+    });
+
+    for (; it != m_refTargets.end() && m_refs[*it].to == rva; ++it)
+        refs.push_back(m_refs[*it]);
+
+    return refs;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// header, functions ( 5 dwords ), blocks ( rva and size: the owner is known from
+// the function ), references ( from and to ) and the reference types by bytes
+
+void CodeIndex::save(std::vector<unsigned char>& data) const
+{
+    data.clear();
+    data.reserve(indexHeaderSize + m_functions.size() * 20 + m_blocks.size() * 8 + m_refs.size() * 9);
+
+    putValue(data, indexMagic);
+    putValue(data, indexVersion);
+    putValue(data, m_timeDataStamp);
+    putValue(data, m_checkSum);
+    putValue(data, static_cast<unsigned int>(m_functions.size()));
+    putValue(data, static_cast<unsigned int>(m_blocks.size()));
+    putValue(data, static_cast<unsigned int>(m_refs.size()));
+    putValue(data, 0);
+
+    for (const auto& function : m_functions)
+    {
+        putValue(data, function.rva);
+        putValue(data, function.size);
+        putValue(data, function.sources);
+        putValue(data, function.firstBlock);
+        putValue(data, function.blockCount);
+    }
+
+    for (const auto& block : m_blocks)
+    {
+        putValue(data, block.rva);
+        putValue(data, block.size);
+    }
+
+    for (const auto& ref : m_refs)
+    {
+        putValue(data, ref.from);
+        putValue(data, ref.to);
+    }
+
+    for (const auto& ref : m_refs)
+        data.push_back(ref.type);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CodeIndexPtr CodeIndex::load(const void* data, size_t size)
+{
+    IndexReader  reader(data, size);
+
+    if (reader.getValue() != indexMagic || reader.getValue() != indexVersion)
+        throw DbgException("unknown code index format");
+
+    unsigned long  timeDataStamp = reader.getValue();
+    unsigned long  checkSum = reader.getValue();
+    size_t  functionCount = reader.getValue();
+    size_t  blockCount = reader.getValue();
+    size_t  refCount = reader.getValue();
+    reader.getValue();
+
+    if (functionCount > size / 20 || blockCount > size / 8 || refCount > size / 9)
+        throw DbgException("code index is corrupted");
+
+    std::vector<CodeFunction>  functions(functionCount);
+    std::vector<CodeBlock>  blocks(blockCount);
+    std::vector<CodeRef>  refs(refCount);
+
+    for (unsigned long i = 0; i < functionCount; ++i)
+    {
+        CodeFunction&  function = functions[i];
+        function.rva = reader.getValue();
+        function.size = reader.getValue();
+        function.sources = reader.getValue();
+        function.firstBlock = reader.getValue();
+        function.blockCount = reader.getValue();
+
+        if (function.firstBlock > blockCount || function.blockCount > blockCount - function.firstBlock)
+            throw DbgException("code index is corrupted");
+
+        for (unsigned long j = function.firstBlock; j < function.firstBlock + function.blockCount; ++j)
+            blocks[j].function = i;
+    }
+
+    for (auto& block : blocks)
+    {
+        block.rva = reader.getValue();
+        block.size = reader.getValue();
+    }
+
+    for (auto& ref : refs)
+    {
+        ref.from = reader.getValue();
+        ref.to = reader.getValue();
+    }
+
+    for (auto& ref : refs)
+    {
+        unsigned char  type = reader.getByte();
+        if (type > CodeRefData)
+            throw DbgException("code index is corrupted");
+        ref.type = static_cast<CodeRefType>(type);
+    }
+
+    return CodeIndexPtr(new CodeIndex(timeDataStamp, checkSum, functions, blocks, refs));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CodeIndexPtr analyzeCode(const PEImageReader& reader, MEMOFFSET_64 imageBase, const std::vector<CodeRange>& symbolFunctions)
+{
+    return CodeAnalyzer(reader, imageBase, symbolFunctions).analyze();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void setCodeIndexDirectory(const std::wstring& path)
+{
+    boost::recursive_mutex::scoped_lock  lock(g_indexCacheLock);
+
+    g_indexDirectory = path;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CodeIndexPtr findCodeIndex(PROCESS_DEBUG_ID processId, MEMOFFSET_64 moduleBase, const std::wstring& imageName,
+    unsigned long timeDataStamp, unsigned long checkSum, bool symbolsLoaded)
+{
+    boost::recursive_mutex::scoped_lock  lock(g_indexCacheLock);
+
+    ModuleIndexKey  moduleKey = { processId, moduleBase, symbolsLoaded };
+
+    // a stale entry of a missed unload is replaced
+    auto  it = g_indexCache.find(moduleKey);
+    if (it != g_indexCache.end() && it->second->getTimeDataStamp() == timeDataStamp && it->second->getCheckSum() == checkSum)
+        return it->second;
+
+    if (g_indexDirectory.empty())
+        return CodeIndexPtr();
+
+    IndexCacheKey  fileKey = { imageName, timeDataStamp, checkSum, symbolsLoaded };
+
+    CodeIndexPtr  codeIndex = loadIndexFile(fileKey);
+    if (codeIndex)
+        g_indexCache[moduleKey] = codeIndex;
+
+    return codeIndex;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void insertCodeIndex(PROCESS_DEBUG_ID processId, MEMOFFSET_64 moduleBase, const std::wstring& imageName,
+    const CodeIndexPtr& codeIndex, bool symbolsLoaded)
+{
+    boost::recursive_mutex::scoped_lock  lock(g_indexCacheLock);
+
+    ModuleIndexKey  moduleKey = { processId, moduleBase, symbolsLoaded };
+
+    g_indexCache[moduleKey] = codeIndex;
+
+    if (!g_indexDirectory.empty())
+    {
+        IndexCacheKey  fileKey = { imageName, codeIndex->getTimeDataStamp(), codeIndex->getCheckSum(), symbolsLoaded };
+        saveIndexFile(fileKey, codeIndex);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void removeCodeIndex(PROCESS_DEBUG_ID processId, MEMOFFSET_64 moduleBase)
+{
+    boost::recursive_mutex::scoped_lock  lock(g_indexCacheLock);
+
+    ModuleIndexKey  moduleKey = { processId, moduleBase, false };
+    g_indexCache.erase(moduleKey);
+
+    moduleKey.symbolsLoaded = true;
+    g_indexCache.erase(moduleKey);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void removeProcessCodeIndices(PROCESS_DEBUG_ID processId)
+{
+    boost::recursive_mutex::scoped_lock  lock(g_indexCacheLock);
+
+    for (auto it = g_indexCache.begin(); it != g_indexCache.end(); )
+    {
+        if (it->first.processId == processId)
+            it = g_indexCache.erase(it);
+        else
+            ++it;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -0,0 +1,318 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "kdlib/variant.h"
+#include "kdlib/exceptions.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Register descriptors of a raw CPU context structure. Tables are built at compile
+// time ( see CPU_REGISTER macros ), so the context implementations read registers
+// by a table lookup and do not depend on the engine register set
+
+enum CPURegisterClass {
+    CPURegInteger,
+    CPURegFloat,
+    CPURegVector        // 128-bit registers: NumVariant can not hold them
+};
+
+struct CPURegisterDesc {
+    unsigned long  index;           // CodeView register id
+    const wchar_t*  name;
+    size_t  offset;                 // offset of the register field in the raw context
+    unsigned char  width;           // register size in bytes
+    unsigned char  shift;           // bit offset of a sub register in the field ( "ah": 8 )
+    CPURegisterClass  regClass;
+};
+
+#define CPU_REGISTER(context, index, name, field) \
+    { index, name, offsetof(context, field), sizeof(static_cast<context*>(0)->field), 0, CPURegInteger }
+
+#define CPU_SUBREGISTER(context, index, name, field, width, shift) \
+    { index, name, offsetof(context, field), width, shift, CPURegInteger }
+
+#define CPU_FLOAT_REGISTER(context, index, name, field) \
+    { index, name, offsetof(context, field), sizeof(static_cast<context*>(0)->field), 0, CPURegFloat }
+
+#define CPU_VECTOR_REGISTER(context, index, name, field) \
+    { index, name, offsetof(context, field), sizeof(static_cast<context*>(0)->field), 0, CPURegVector }
+
+///////////////////////////////////////////////////////////////////////////////
+
+constexpr wchar_t registerNameLower(wchar_t c)
+{
+    return c >= L'A' && c <= L'Z' ? c - L'A' + L'a' : c;
+}
+
+// FNV-1a, case insensitive
+constexpr unsigned long registerNameHash(const wchar_t* name)
+{
+    unsigned long  hash = 2166136261UL;
+    for (; *name; ++name)
+        hash = (hash ^ static_cast<unsigned long>(registerNameLower(*name))) * 16777619UL;
+    return hash;
+}
+
+template<size_t RegCount>
+constexpr size_t getRegisterCount(const CPURegisterDesc (&)[RegCount])
+{
+    return RegCount;
+}
+
+template<size_t RegCount>
+constexpr unsigned long getRegisterIndexLimit(const CPURegisterDesc (&registers)[RegCount])
+{
+    unsigned long  limit = 0;
+    for (size_t i = 0; i < RegCount; ++i)
+        limit = registers[i].index >= limit ? registers[i].index + 1 : limit;
+    return limit;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Non template view of a register map: context implementations keep it
+
+class CPURegisterTable
+{
+public:
+
+    constexpr CPURegisterTable(
+        const char*  contextName,
+        const CPURegisterDesc*  registers,
+        size_t  registerCount,
+        const unsigned short*  indexTable,
+        unsigned long  indexLimit,
+        const unsigned short*  nameTable,
+        size_t  nameTableSize ) :
+            m_contextName(contextName),
+            m_registers(registers),
+            m_registerCount(registerCount),
+            m_indexTable(indexTable),
+            m_indexLimit(indexLimit),
+            m_nameTable(nameTable),
+            m_nameTableSize(nameTableSize)
+    {}
+
+    size_t getCount() const {
+        return m_registerCount;
+    }
+
+    const CPURegisterDesc& operator[](size_t i) const {
+        return m_registers[i];
+    }
+
+    const CPURegisterDesc* findByIndex(unsigned long index) const
+    {
+        if (index >= m_indexLimit || m_indexTable[index] == noRegister)
+            return 0;
+        return &m_registers[m_indexTable[index]];
+    }
+
+    const CPURegisterDesc* findByName(const std::wstring& name) const
+    {
+        size_t  mask = m_nameTableSize - 1;
+
+        for (size_t slot = registerNameHash(name.c_str()) & mask; m_nameTable[slot] != noRegister; slot = (slot + 1) & mask)
+        {
+            const CPURegisterDesc&  reg = m_registers[m_nameTable[slot]];
+            if (isEqualName(reg.name, name))
+                return &reg;
+        }
+
+        return 0;
+    }
+
+    const CPURegisterDesc& getByIndex(unsigned long index) const
+    {
+        const CPURegisterDesc*  reg = findByIndex(index);
+        if (reg)
+            return *reg;
+
+        std::stringstream sstr;
+        sstr << m_contextName << " context: unsupported register index " << std::dec << index;
+        throw DbgException(sstr.str());
+    }
+
+    const CPURegisterDesc& getByName(const std::wstring& name) const
+    {
+        const CPURegisterDesc*  reg = findByName(name);
+        if (reg)
+            return *reg;
+
+        std::stringstream sstr;
+        sstr << m_contextName << " context: unsupported register " << std::string(name.begin(), name.end());
+        throw DbgException(sstr.str());
+    }
+
+    static NumVariant readRegister(const CPURegisterDesc& reg, const void* rawContext);
+
+    // values of all the scalar registers in the table order, vector registers are skipped
+    void exportRegisters(const void* rawContext, std::vector<unsigned long>& indices, std::vector<NumVariant>& values) const;
+
+    static const unsigned short  noRegister = 0xFFFF;
+
+private:
+
+    static bool isEqualName(const wchar_t* regName, const std::wstring& name)
+    {
+        size_t  i = 0;
+        for (; regName[i] && i < name.size(); ++i)
+        {
+            if (regName[i] != registerNameLower(name[i]))
+                return false;
+        }
+        return regName[i] == 0 && i == name.size();
+    }
+
+    const char*  m_contextName;
+    const CPURegisterDesc*  m_registers;
+    size_t  m_registerCount;
+    const unsigned short*  m_indexTable;
+    unsigned long  m_indexLimit;
+    const unsigned short*  m_nameTable;
+    size_t  m_nameTableSize;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline NumVariant CPURegisterTable::readRegister(const CPURegisterDesc& reg, const void* rawContext)
+{
+    // all the supported targets are little endian: a sub register is a part of the field
+    const unsigned char*  field = static_cast<const unsigned char*>(rawContext) + reg.offset + reg.shift / 8;
+
+    if (reg.regClass == CPURegInteger)
+    {
+        switch (reg.width)
+        {
+        case 1:
+            return NumVariant(*field);
+
+        case 2:
+            {
+                unsigned short  value;
+                memcpy(&value, field, sizeof(value));
+                return NumVariant(value);
+            }
+
+        case 4:
+            {
+                unsigned int  value;
+                memcpy(&value, field, sizeof(value));
+                return NumVariant(static_cast<unsigned long>(value));
+            }
+
+        case 8:
+            {
+                unsigned long long  value;
+                memcpy(&value, field, sizeof(value));
+                return NumVariant(value);
+            }
+        }
+    }
+    else if (reg.regClass == CPURegFloat)
+    {
+        switch (reg.width)
+        {
+        case 4:
+            {
+                float  value;
+                memcpy(&value, field, sizeof(value));
+                return NumVariant(value);
+            }
+
+        case 8:
+            {
+                double  value;
+                memcpy(&value, field, sizeof(value));
+                return NumVariant(value);
+            }
+        }
+    }
+
+    throw DbgException("unsupported registry type");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline void CPURegisterTable::exportRegisters(const void* rawContext, std::vector<unsigned long>& indices, std::vector<NumVariant>& values) const
+{
+    indices.clear();
+    values.clear();
+
+    indices.reserve(m_registerCount);
+    values.reserve(m_registerCount);
+
+    for (size_t i = 0; i < m_registerCount; ++i)
+    {
+        if (m_registers[i].regClass == CPURegVector)
+            continue;
+
+        indices.push_back(m_registers[i].index);
+        values.push_back(readRegister(m_registers[i], rawContext));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Compile time lookup tables: a direct table by CodeView id and an open addressing
+// hash table by name
+
+template<size_t RegCount, unsigned long IndexLimit>
+class CPURegisterMap
+{
+public:
+
+    static const size_t  nameTableSize = RegCount * 2 <= 64 ? 128 : RegCount * 2 <= 256 ? 512 : 1024;
+
+    static_assert(RegCount * 2 <= nameTableSize, "register map is too large");
+
+    constexpr CPURegisterMap(const char* contextName, const CPURegisterDesc (&registers)[RegCount]) :
+        m_contextName(contextName),
+        m_registers(registers),
+        m_indexTable(),
+        m_nameTable()
+    {
+        for (unsigned long i = 0; i < IndexLimit; ++i)
+            m_indexTable[i] = CPURegisterTable::noRegister;
+
+        for (size_t i = 0; i < nameTableSize; ++i)
+            m_nameTable[i] = CPURegisterTable::noRegister;
+
+        for (size_t i = 0; i < RegCount; ++i)
+        {
+            m_indexTable[registers[i].index] = static_cast<unsigned short>(i);
+
+            size_t  slot = registerNameHash(registers[i].name) & (nameTableSize - 1);
+            while (m_nameTable[slot] != CPURegisterTable::noRegister)
+                slot = (slot + 1) & (nameTableSize - 1);
+
+            m_nameTable[slot] = static_cast<unsigned short>(i);
+        }
+    }
+
+    constexpr CPURegisterTable getTable() const
+    {
+        return CPURegisterTable(m_contextName, m_registers, RegCount, m_indexTable, IndexLimit, m_nameTable, nameTableSize);
+    }
+
+private:
+
+    const char*  m_contextName;
+    const CPURegisterDesc*  m_registers;
+    unsigned short  m_indexTable[IndexLimit];
+    unsigned short  m_nameTable[nameTableSize];
+};
+
+#define CPU_REGISTER_MAP(contextName, registers) \
+    CPURegisterMap<getRegisterCount(registers), getRegisterIndexLimit(registers)>(contextName, registers)
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
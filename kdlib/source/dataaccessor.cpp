@@ -27,6 +27,13 @@ DataAccessorPtr  getRegisterAccessor(const std::wstring& registerName)
 
 ///////////////////////////////////////////////////////////////////////////////
 
+DataAccessorPtr  getRegisterAccessor(const CPUContextPtr& cpuContext, unsigned long registerIndex)
+{
+    return DataAccessorPtr(new ContextRegisterAccessor(cpuContext, registerIndex));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 DataAccessorPtr getCacheAccessor(size_t bufferSize, const std::wstring&  location)
 {
     return DataAccessorPtr(new CacheAccessor(bufferSize, location) );
@@ -1586,4 +1586,208 @@ private:
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Register of a captured CPU context ( a stack frame context ). The value is read
+// from the context snapshot by the CodeView register id, so it does not depend on
+// the current engine register set. The snapshot is read only, the top frame uses
+// RegisterAccessor to write the thread registers
+
+class ContextRegisterAccessor : public EmptyAccessor
+{
+public:
+
+    ContextRegisterAccessor(const CPUContextPtr& cpuContext, unsigned long regIndex) :
+        m_cpuContext(cpuContext),
+        m_regIndex(regIndex),
+        m_regName(cpuContext->getRegisterName(regIndex))
+    {
+        // the context gives a register as NumVariant: a vector register does not fit in it
+        try {
+            m_cpuContext->getRegisterByIndex(m_regIndex);
+        }
+        catch (DbgException&)
+        {
+            throw DbgException("frame register wider than a QWORD is not supported");
+        }
+    }
+
+    virtual VarStorage getStorageType() const
+    {
+        return RegisterVar;
+    }
+
+    virtual std::wstring getRegisterName() const
+    {
+        return m_regName;
+    }
+
+    virtual size_t getLength() const
+    {
+        return m_cpuContext->getRegisterByIndex(m_regIndex).getSize();
+    }
+
+    virtual unsigned char readByte(size_t pos = 0) const
+    {
+        return getValue<unsigned char>(pos);
+    }
+
+    virtual char readSignByte(size_t pos = 0) const
+    {
+        return getValue<char>(pos);
+    }
+
+    virtual unsigned short readWord(size_t pos = 0) const
+    {
+        return getValue<unsigned short>(pos);
+    }
+
+    virtual short readSignWord(size_t pos = 0) const
+    {
+        return getValue<short>(pos);
+    }
+
+    virtual unsigned long readDWord(size_t pos = 0) const
+    {
+        return getValue<unsigned long>(pos);
+    }
+
+    virtual long readSignDWord(size_t pos = 0) const
+    {
+        return getValue<long>(pos);
+    }
+
+    virtual unsigned long long readQWord(size_t pos = 0) const
+    {
+        return getValue<unsigned long long>(pos);
+    }
+
+    virtual long long readSignQWord(size_t pos = 0) const
+    {
+        return getValue<long long>(pos);
+    }
+
+    virtual float readFloat(size_t pos = 0) const
+    {
+        return getValue<float>(pos);
+    }
+
+    virtual double readDouble(size_t pos = 0) const
+    {
+        return getValue<double>(pos);
+    }
+
+    virtual void readBytes(std::vector<unsigned char>& dataRange, size_t count, size_t pos = 0) const
+    {
+        readValues<unsigned char>(dataRange, count, pos);
+    }
+
+    virtual void readWords(std::vector<unsigned short>& dataRange, size_t count, size_t pos = 0) const
+    {
+        readValues<unsigned short>(dataRange, count, pos);
+    }
+
+    virtual void readDWords(std::vector<unsigned long>& dataRange, size_t count, size_t pos = 0) const
+    {
+        readValues<unsigned long>(dataRange, count, pos);
+    }
+
+    virtual void readQWords(std::vector<unsigned long long>& dataRange, size_t count, size_t pos = 0) const
+    {
+        readValues<unsigned long long>(dataRange, count, pos);
+    }
+
+    virtual void readSignBytes(std::vector<char>& dataRange, size_t count, size_t pos = 0) const
+    {
+        readValues<char>(dataRange, count, pos);
+    }
+
+    virtual void readSignWords(std::vector<short>& dataRange, size_t count, size_t pos = 0) const
+    {
+        readValues<short>(dataRange, count, pos);
+    }
+
+    virtual void readSignDWords(std::vector<long>& dataRange, size_t count, size_t pos = 0) const
+    {
+        readValues<long>(dataRange, count, pos);
+    }
+
+    virtual void readSignQWords(std::vector<long long>& dataRange, size_t count, size_t pos = 0) const
+    {
+        readValues<long long>(dataRange, count, pos);
+    }
+
+    virtual void readFloats(std::vector<float>& dataRange, size_t count, size_t pos = 0) const
+    {
+        readValues<float>(dataRange, count, pos);
+    }
+
+    virtual void readDoubles(std::vector<double>& dataRange, size_t count, size_t pos = 0) const
+    {
+        readValues<double>(dataRange, count, pos);
+    }
+
+    virtual std::wstring getLocationAsStr() const
+    {
+        return std::wstring(L"@") + m_regName;
+    }
+
+private:
+
+    size_t readRegister(unsigned char (&buffer)[sizeof(unsigned long long)]) const
+    {
+        NumVariant  regValue = m_cpuContext->getRegisterByIndex(m_regIndex);
+
+        if (regValue.isFloat())
+        {
+            float  value = regValue.asFloat();
+            memcpy(buffer, &value, sizeof(value));
+        }
+        else if (regValue.isDouble())
+        {
+            double  value = regValue.asDouble();
+            memcpy(buffer, &value, sizeof(value));
+        }
+        else
+        {
+            unsigned long long  value = regValue.asULongLong();
+            memcpy(buffer, &value, sizeof(value));
+        }
+
+        return regValue.getSize();
+    }
+
+    template <typename T>
+    T getValue(size_t pos) const
+    {
+        unsigned char  regValue[sizeof(unsigned long long)];
+        size_t  regSize = readRegister(regValue);
+
+        if ( pos >= regSize/sizeof(T) )
+            throw DbgException("register accessor range error");
+
+        T  value;
+        memcpy(&value, &regValue[pos*sizeof(T)], sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    void readValues(std::vector<T>& dataRange, size_t count, size_t pos) const
+    {
+        unsigned char  regValue[sizeof(unsigned long long)];
+        size_t  regSize = readRegister(regValue);
+
+        if ( pos > regSize/sizeof(T) || count > regSize/sizeof(T) - pos )
+            throw DbgException("register accessor range error");
+
+        dataRange.resize(count);
+        if (count > 0)
+            memcpy(&dataRange[0], &regValue[pos*sizeof(T)], count*sizeof(T));
+    }
+
+    CPUContextPtr  m_cpuContext;
+    unsigned long  m_regIndex;
+    std::wstring  m_regName;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 }
@@ -67,7 +67,7 @@ DbgIn  *dbgin = &dbgstdin;
 
 void dprintln( const std::wstring &str, bool dml  )
 {
-    dprint( str + L"\r\n", dml );
+    dml ? dbgout->writedml( str + L"\r\n" ) : dbgout->writeln( str );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,244 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include <boost/thread/thread.hpp>
+
+#include "kdlib/dbgout.h"
+#include "kdlib/exceptions.h"
+
+#include "strconvert.h"
+
+namespace kdlib {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+
+const wchar_t  lineEnd[] = L"\r\n";
+const size_t  lineEndLength = 2;
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // end nameless namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+BufferedDbgOut::BufferedDbgOut(DbgOut* target, unsigned long flushPolicy, size_t bufferSize, unsigned long flushInterval) :
+    m_target(target),
+    m_flushPolicy(flushPolicy),
+    m_bufferSize(bufferSize != 0 ? bufferSize : 1),
+    m_flushInterval(flushInterval),
+    m_lastFlush(getTickCount())
+{
+    if (!target)
+        throw DbgException("target is null");
+
+    for (auto& buffer : m_buffers)
+    {
+        buffer.data.reset(new wchar_t[m_bufferSize]);
+        buffer.reserved = 0;
+        buffer.end = 0;
+        buffer.writers = 0;
+    }
+
+    m_current = &m_buffers[0];
+
+    m_text.reserve(m_bufferSize);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+BufferedDbgOut::~BufferedDbgOut()
+{
+    try {
+        flush();
+    }
+    catch (...)
+    {}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BufferedDbgOut::write(const std::wstring& str)
+{
+    append(str, false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BufferedDbgOut::writeln(const std::wstring& str)
+{
+    append(str, true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BufferedDbgOut::writedml(const std::wstring& str)
+{
+    boost::mutex::scoped_lock  lock(m_flushLock);
+
+    drain(m_current);
+    m_target->writedml(str);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BufferedDbgOut::flush()
+{
+    boost::mutex::scoped_lock  lock(m_flushLock);
+
+    drain(m_current);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BufferedDbgOut::append(const std::wstring& str, bool newLine)
+{
+    size_t  length = str.size() + (newLine ? lineEndLength : 0);
+
+    if (length > m_bufferSize)
+    {
+        boost::mutex::scoped_lock  lock(m_flushLock);
+
+        drain(m_current);
+        newLine ? m_target->writeln(str) : m_target->write(str);
+        return;
+    }
+
+    for (;;)
+    {
+        Buffer*  buffer = m_current;
+
+        // the buffer may be swapped between the load and the registration of the writer:
+        // the flush waits for the registered writers only
+        buffer->writers++;
+        if (buffer != m_current)
+        {
+            buffer->writers--;
+            continue;
+        }
+
+        size_t  pos = buffer->reserved.fetch_add(length);
+
+        if (pos + length <= m_bufferSize)
+        {
+            std::copy(str.begin(), str.end(), &buffer->data[pos]);
+            if (newLine)
+                std::copy(lineEnd, lineEnd + lineEndLength, &buffer->data[pos + str.size()]);
+
+            buffer->writers--;
+            break;
+        }
+
+        // the buffer is full: the first write over its end marks where the text ends
+        if (pos <= m_bufferSize)
+            buffer->end = pos;
+
+        buffer->writers--;
+
+        flushBuffer(buffer);
+    }
+
+    if ((m_flushPolicy & DbgOutFlushByNewline) != 0 && (newLine || str.find(L'\n') != std::wstring::npos))
+    {
+        flush();
+        return;
+    }
+
+    if ((m_flushPolicy & DbgOutFlushByTime) != 0 && getTickCount() - m_lastFlush >= m_flushInterval)
+        flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BufferedDbgOut::flushBuffer(Buffer* buffer)
+{
+    boost::mutex::scoped_lock  lock(m_flushLock);
+
+    // another writer may have flushed it already
+    if (m_current == buffer)
+        drain(buffer);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void BufferedDbgOut::drain(Buffer* buffer)
+{
+    m_lastFlush = getTickCount();
+
+    if (buffer->reserved == 0)
+        return;
+
+    // the spare buffer is empty: it was drained by the previous flush
+    m_current = buffer == &m_buffers[0] ? &m_buffers[1] : &m_buffers[0];
+
+    while (buffer->writers != 0)
+        boost::this_thread::yield();
+
+    size_t  reserved = buffer->reserved;
+    size_t  end = reserved <= m_bufferSize ? reserved : static_cast<size_t>(buffer->end);
+
+    buffer->reserved = 0;
+    buffer->end = 0;
+
+    if (end == 0)
+        return;
+
+    m_text.assign(buffer->data.get(), end);
+    m_target->write(m_text);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned long long BufferedDbgOut::getTickCount()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Utf8DbgOut::write(const std::wstring& str)
+{
+    put(str, false);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Utf8DbgOut::writeln(const std::wstring& str)
+{
+    put(str, true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void Utf8DbgOut::put(const std::wstring& str, bool newLine)
+{
+    boost::mutex::scoped_lock  lock(m_lock);
+
+    m_text.resize(str.size());
+
+    size_t  ascii = 0;
+    while (ascii < str.size() && static_cast<unsigned long>(str[ascii]) < 0x80)
+    {
+        m_text[ascii] = static_cast<char>(str[ascii]);
+        ++ascii;
+    }
+
+    if (ascii < str.size())
+    {
+        m_text.resize(ascii);
+        appendUtf8(m_text, str.c_str() + ascii, str.size() - ascii);
+    }
+
+    if (newLine)
+        m_text.append("\r\n");
+
+    fwrite(m_text.data(), 1, m_text.size(), m_file);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
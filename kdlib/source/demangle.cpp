@@ -0,0 +1,1229 @@
+#include "stdafx.h"
+
+#include <cstring>
+
+#include <Windows.h>
+#include <DbgHelp.h>
+
+#include <boost/thread/mutex.hpp>
+
+#include "kdlib/demangle.h"
+
+namespace kdlib {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char* const operatorNames[] = {
+    0,                      // ?0 constructor
+    0,                      // ?1 destructor
+    "operator new",         // ?2
+    "operator delete",      // ?3
+    "operator=",            // ?4
+    "operator>>",           // ?5
+    "operator<<",           // ?6
+    "operator!",            // ?7
+    "operator==",           // ?8
+    "operator!="            // ?9
+};
+
+const char* const operatorAlphaNames[] = {
+    "operator[]",           // ?A
+    0,                      // ?B conversion operator
+    "operator->",           // ?C
+    "operator*",            // ?D
+    "operator++",           // ?E
+    "operator--",           // ?F
+    "operator-",            // ?G
+    "operator+",            // ?H
+    "operator&",            // ?I
+    "operator->*",          // ?J
+    "operator/",            // ?K
+    "operator%",            // ?L
+    "operator<",            // ?M
+    "operator<=",           // ?N
+    "operator>",            // ?O
+    "operator>=",           // ?P
+    "operator,",            // ?Q
+    "operator()",           // ?R
+    "operator~",            // ?S
+    "operator^",            // ?T
+    "operator|",            // ?U
+    "operator&&",           // ?V
+    "operator||",           // ?W
+    "operator*=",           // ?X
+    "operator+=",           // ?Y
+    "operator-="            // ?Z
+};
+
+const char* const operatorUnderscoreDigitNames[] = {
+    "operator/=",           // ?_0
+    "operator%=",           // ?_1
+    "operator>>=",          // ?_2
+    "operator<<=",          // ?_3
+    "operator&=",           // ?_4
+    "operator|=",           // ?_5
+    "operator^=",           // ?_6
+    "`vftable'",            // ?_7
+    "`vbtable'",            // ?_8
+    "`vcall'"               // ?_9
+};
+
+const char* const operatorUnderscoreAlphaNames[] = {
+    "`typeof'",                                 // ?_A
+    "`local static guard'",                     // ?_B
+    0,                                          // ?_C string literal
+    "`vbase destructor'",                       // ?_D
+    "`vector deleting destructor'",             // ?_E
+    "`default constructor closure'",            // ?_F
+    "`scalar deleting destructor'",             // ?_G
+    "`vector constructor iterator'",            // ?_H
+    "`vector destructor iterator'",             // ?_I
+    "`vector vbase constructor iterator'",      // ?_J
+    "`virtual displacement map'",               // ?_K
+    "`eh vector constructor iterator'",         // ?_L
+    "`eh vector destructor iterator'",          // ?_M
+    "`eh vector vbase constructor iterator'",   // ?_N
+    "`copy constructor closure'",               // ?_O
+    0,                                          // ?_P
+    0,                                          // ?_Q
+    0,                                          // ?_R RTTI
+    "`local vftable'",                          // ?_S
+    "`local vftable constructor closure'",      // ?_T
+    "operator new[]",                           // ?_U
+    "operator delete[]",                        // ?_V
+    0,                                          // ?_W
+    "`placement delete closure'",               // ?_X
+    "`placement delete[] closure'"              // ?_Y
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char* const basicTypeNames[] = {
+    0,                      // A reference
+    0,                      // B volatile reference
+    "signed char",          // C
+    "char",                 // D
+    "unsigned char",        // E
+    "short",                // F
+    "unsigned short",       // G
+    "int",                  // H
+    "unsigned int",         // I
+    "long",                 // J
+    "unsigned long",        // K
+    0,                      // L
+    "float",                // M
+    "double",               // N
+    "long double",          // O
+    0,                      // P pointer
+    0,                      // Q const pointer
+    0,                      // R volatile pointer
+    0,                      // S const volatile pointer
+    0,                      // T union
+    0,                      // U struct
+    0,                      // V class
+    0,                      // W enum
+    "void",                 // X
+    0,                      // Y array
+    "..."                   // Z
+};
+
+const char* const extendedTypeNames[] = {
+    0,                      // _A
+    0,                      // _B
+    0,                      // _C
+    "__int8",               // _D
+    "unsigned __int8",      // _E
+    "__int16",              // _F
+    "unsigned __int16",     // _G
+    "__int32",              // _H
+    "unsigned __int32",     // _I
+    "__int64",              // _J
+    "unsigned __int64",     // _K
+    "__int128",             // _L
+    "unsigned __int128",    // _M
+    "bool",                 // _N
+    0,                      // _O
+    0,                      // _P
+    "char8_t",              // _Q
+    0,                      // _R
+    "char16_t",             // _S
+    0,                      // _T
+    "char32_t",             // _U
+    0,                      // _V
+    "wchar_t"               // _W
+};
+
+const char* const accessNames[] = {
+    "private: ",            // A-B
+    "private: static ",     // C-D
+    "private: virtual ",    // E-F
+    0,                      // G-H
+    "protected: ",          // I-J
+    "protected: static ",   // K-L
+    "protected: virtual ",  // M-N
+    0,                      // O-P
+    "public: ",             // Q-R
+    "public: static ",      // S-T
+    "public: virtual ",     // U-V
+    0,                      // W-X
+    ""                      // Y-Z
+};
+
+const char* const variableAccessNames[] = {
+    "private: static ",     // 0
+    "protected: static ",   // 1
+    "public: static ",      // 2
+    "",                     // 3 global
+    ""                      // 4 function local static
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+inline bool isUpper(char c)
+{
+    return c >= 'A' && c <= 'Z';
+}
+
+template<size_t N>
+const char* lookupName(const char* const (&table)[N], size_t index)
+{
+    return index < N ? table[index] : 0;
+}
+
+void appendTemplateArgs(std::string& name, const std::string& args)
+{
+    name += '<';
+    name += args;
+
+    // "vector<int,allocator<int> >": the closing brackets are split as the undname does
+    if (!name.empty() && name[name.size() - 1] == '>')
+        name += ' ';
+
+    name += '>';
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // end nameless namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+MsvcDemangler::MsvcDemangler() :
+    m_pos(0),
+    m_end(0),
+    m_backrefs(4),
+    m_backrefDepth(0),
+    m_depth(0)
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::demangle(const char* decoratedName, size_t length, std::string& result, DemangleMode mode)
+{
+    result.clear();
+
+    if (length > maxNameLength)
+        return false;
+
+    m_pos = decoratedName;
+    m_end = decoratedName + length;
+    m_backrefDepth = 0;
+    m_depth = 0;
+    m_backrefs[0].nameCount = 0;
+    m_backrefs[0].typeCount = 0;
+
+    if (!consume('?'))
+        return false;
+
+    if (!parseSymbol(result, mode))
+    {
+        result.clear();
+        return false;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::consume(const char* str)
+{
+    size_t  length = strlen(str);
+    if (static_cast<size_t>(m_end - m_pos) < length || memcmp(m_pos, str, length) != 0)
+        return false;
+
+    m_pos += length;
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MsvcDemangler::memorizeName(const std::string& name)
+{
+    BackrefTable&  table = backrefs();
+
+    if (table.nameCount >= backrefCount)
+        return;
+
+    for (size_t i = 0; i < table.nameCount; ++i)
+    {
+        if (table.names[i] == name)
+            return;
+    }
+
+    table.names[table.nameCount++] = name;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseSymbol(std::string& result, DemangleMode mode)
+{
+    SpecialName  special = SpecialNone;
+
+    m_name.clear();
+    if (!parseQualifiedName(m_name, &special))
+        return false;
+
+    // the name is enough for the fast mode, only the conversion operator needs
+    // the signature to get its target type
+    if (mode == DemangleNameOnly && special != SpecialConversion)
+    {
+        result = m_name;
+        return true;
+    }
+
+    if (m_pos == m_end)
+        return false;
+
+    char  c = *m_pos;
+
+    if (c >= '0' && c <= '4')
+        return parseVariable(m_name, result);
+
+    if (c == '6' || c == '7')
+        return parseVTable(m_name, result);
+
+    return parseFunction(m_name, special, result, mode);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseFunction(const std::string& name, SpecialName special, std::string& result, DemangleMode mode)
+{
+    char  accessCode = *m_pos++;
+    if (!isUpper(accessCode))
+        return false;
+
+    size_t  accessIndex = (accessCode - 'A') / 2;
+
+    const char*  access = lookupName(accessNames, accessIndex);
+    if (!access)
+        return false;
+
+    // the groups are private, protected, public: ( member, static, virtual ) each
+    bool  isMember = accessCode < 'Y' && accessIndex % 4 != 1;
+
+    std::string  thisQualifiers;
+    if (isMember)
+    {
+        parsePointerModifiers(thisQualifiers);
+        std::string  cv;
+        if (!parseCvQualifiers(cv))
+            return false;
+        thisQualifiers.insert(0, cv);
+    }
+
+    const char*  callConv;
+    if (!parseCallingConvention(callConv))
+        return false;
+
+    TypeText  returnType;
+    bool  hasReturnType = !consume('@');
+    if (hasReturnType && !parseType(returnType))
+        return false;
+
+    std::string  conversionName;
+    if (special == SpecialConversion)
+    {
+        conversionName = name;
+        conversionName += ' ';
+        conversionName += returnType.left;
+        conversionName += returnType.right;
+
+        if (mode == DemangleNameOnly)
+        {
+            result = conversionName;
+            return true;
+        }
+
+        hasReturnType = false;
+    }
+
+    std::string  params;
+    if (!parseParameters(params))
+        return false;
+
+    // throw specification
+    if (!consume('Z') && !consume("_E"))
+        return false;
+
+    result = access;
+
+    if (hasReturnType)
+    {
+        result += returnType.left;
+        result += ' ';
+    }
+
+    result += callConv;
+    result += ' ';
+    result += special == SpecialConversion ? conversionName : name;
+    result += '(';
+    result += params;
+    result += ')';
+    result += thisQualifiers;
+
+    if (hasReturnType)
+        result += returnType.right;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseVariable(const std::string& name, std::string& result)
+{
+    const char*  access = variableAccessNames[*m_pos++ - '0'];
+
+    TypeText  type;
+    if (!parseType(type))
+        return false;
+
+    // storage qualifiers of the variable itself
+    std::string  qualifiers;
+    parsePointerModifiers(qualifiers);
+
+    std::string  cv;
+    if (!parseCvQualifiers(cv))
+        return false;
+
+    result = access;
+    result += type.left;
+    result += cv;
+    result += qualifiers;
+    result += ' ';
+    result += name;
+    result += type.right;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseVTable(const std::string& name, std::string& result)
+{
+    ++m_pos;
+
+    std::string  cv;
+    if (!parseCvQualifiers(cv))
+        return false;
+
+    if (!cv.empty())
+        result = cv.substr(1) + ' ';
+
+    result += name;
+
+    // "{for `Base'}" is the list of the base classes owning the table
+    while (!consume('@'))
+    {
+        std::string  base;
+        if (!parseQualifiedName(base, 0))
+            return false;
+
+        result += "{for `";
+        result += base;
+        result += "'}";
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseQualifiedName(std::string& name, SpecialName* special)
+{
+    std::string  first;
+
+    if (special && peek('?') && m_pos + 1 < m_end && m_pos[1] != '$')
+    {
+        ++m_pos;
+        if (!parseSpecialName(first, *special))
+            return false;
+    }
+    else if (!parseNameFragment(first))
+    {
+        return false;
+    }
+
+    // scopes follow the name in the reverse order: "bar@Foo@ns@@" is "ns::Foo::bar"
+    std::vector<std::string>  scopes;
+
+    while (!consume('@'))
+    {
+        scopes.push_back(std::string());
+        if (!parseNameFragment(scopes.back()))
+            return false;
+    }
+
+    if (special && (*special == SpecialCtor || *special == SpecialDtor))
+    {
+        if (scopes.empty())
+            return false;
+
+        if (*special == SpecialDtor)
+            first += '~';
+
+        first += scopes.front();
+    }
+
+    name.clear();
+
+    for (auto it = scopes.rbegin(); it != scopes.rend(); ++it)
+    {
+        name += *it;
+        name += "::";
+    }
+
+    name += first;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseNameFragment(std::string& fragment)
+{
+    if (m_pos == m_end)
+        return false;
+
+    if (isDigit(*m_pos))
+    {
+        BackrefTable&  table = backrefs();
+        size_t  index = *m_pos++ - '0';
+        if (index >= table.nameCount)
+            return false;
+
+        fragment = table.names[index];
+        return true;
+    }
+
+    if (consume("?$"))
+        return parseTemplateName(fragment);
+
+    if (consume("?A"))
+    {
+        // anonymous namespace: "?A0x12345678@"
+        const char*  begin = m_pos;
+        while (m_pos < m_end && *m_pos != '@')
+            ++m_pos;
+
+        if (!consume('@'))
+            return false;
+
+        fragment = "`anonymous namespace'";
+        memorizeName(std::string("?A") + std::string(begin, m_pos - 1));
+        return true;
+    }
+
+    if (peek('?'))
+        return false;
+
+    return parseSimpleName(fragment, true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseSimpleName(std::string& name, bool memorize)
+{
+    const char*  begin = m_pos;
+
+    while (m_pos < m_end && *m_pos != '@')
+        ++m_pos;
+
+    if (m_pos == begin || m_pos == m_end)
+        return false;
+
+    name.assign(begin, m_pos++);
+
+    if (memorize)
+        memorizeName(name);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseTemplateName(std::string& name)
+{
+    // a template has its own backreference tables for the name and the arguments
+
+    if (++m_backrefDepth == m_backrefs.size())
+        m_backrefs.resize(m_backrefs.size() * 2);
+
+    m_backrefs[m_backrefDepth].nameCount = 0;
+    m_backrefs[m_backrefDepth].typeCount = 0;
+
+    bool  success = false;
+    std::string  args;
+
+    do {
+
+        SpecialName  special = SpecialNone;
+
+        if (consume('?'))
+        {
+            // template operator: "??$?8H@@YA_NHH@Z"
+            if (!parseSpecialName(name, special) || special != SpecialNone)
+                break;
+        }
+        else if (!parseSimpleName(name, true))
+        {
+            break;
+        }
+
+        success = true;
+
+        while (!consume('@'))
+        {
+            std::string  arg;
+            bool  empty = false;
+
+            if (!parseTemplateArg(arg, empty))
+            {
+                success = false;
+                break;
+            }
+
+            if (empty)
+                continue;
+
+            if (!args.empty())
+                args += ',';
+
+            args += arg;
+        }
+
+    } while (false);
+
+    --m_backrefDepth;
+
+    if (!success)
+        return false;
+
+    appendTemplateArgs(name, args);
+
+    memorizeName(name);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseTemplateArg(std::string& arg, bool& empty)
+{
+    if (consume("$0"))
+    {
+        long long  value;
+        if (!parseNumber(value))
+            return false;
+
+        arg = std::to_string(value);
+        return true;
+    }
+
+    if (consume("$$V") || consume("$$Z") || consume("$S"))
+    {
+        // empty parameter pack
+        empty = true;
+        return true;
+    }
+
+    if (peek('$') && !(m_pos + 1 < m_end && m_pos[1] == '$'))
+        return false;
+
+    TypeText  type;
+    if (!parseType(type))
+        return false;
+
+    arg = type.left;
+    arg += type.right;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseSpecialName(std::string& name, SpecialName& special)
+{
+    if (m_pos == m_end)
+        return false;
+
+    const char*  operatorName = 0;
+    char  c = *m_pos++;
+
+    if (c == '0' || c == '1')
+    {
+        special = c == '0' ? SpecialCtor : SpecialDtor;
+        name.clear();
+        return true;
+    }
+
+    if (c == 'B')
+    {
+        special = SpecialConversion;
+        name = "operator";
+        return true;
+    }
+
+    if (isDigit(c))
+    {
+        operatorName = operatorNames[c - '0'];
+    }
+    else if (isUpper(c))
+    {
+        operatorName = operatorAlphaNames[c - 'A'];
+    }
+    else if (c == '_' && m_pos < m_end)
+    {
+        c = *m_pos++;
+
+        if (isDigit(c))
+            operatorName = operatorUnderscoreDigitNames[c - '0'];
+        else if (isUpper(c))
+            operatorName = lookupName(operatorUnderscoreAlphaNames, c - 'A');
+    }
+
+    if (!operatorName)
+        return false;
+
+    special = SpecialNone;
+    name = operatorName;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseNumber(long long& number)
+{
+    bool  negative = consume('?');
+
+    if (m_pos == m_end)
+        return false;
+
+    if (isDigit(*m_pos))
+    {
+        number = *m_pos++ - '0' + 1;
+    }
+    else
+    {
+        // hex digits are encoded as 'A'..'P'
+        unsigned long long  value = 0;
+
+        while (m_pos < m_end && *m_pos >= 'A' && *m_pos <= 'P')
+            value = value * 16 + (*m_pos++ - 'A');
+
+        if (!consume('@'))
+            return false;
+
+        number = static_cast<long long>(value);
+    }
+
+    if (negative)
+        number = -number;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseType(TypeText& type)
+{
+    // pointers, arrays, functions and template arguments nest the types: a crafted name
+    // must fail instead of exhausting the stack
+    if (m_depth >= maxDepth)
+        return false;
+
+    ++m_depth;
+    bool  success = parseTypeCode(type);
+    --m_depth;
+
+    return success;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseTypeCode(TypeText& type)
+{
+    if (m_pos == m_end)
+        return false;
+
+    char  c = *m_pos++;
+
+    if (isUpper(c))
+    {
+        const char*  basicName = basicTypeNames[c - 'A'];
+        if (basicName)
+        {
+            type.left = basicName;
+            return true;
+        }
+    }
+
+    switch (c)
+    {
+    case 'A':
+    case 'B':
+    case 'P':
+    case 'Q':
+    case 'R':
+    case 'S':
+        return parsePointer(c, type);
+
+    case 'T':
+        return parseClass("union ", type);
+
+    case 'U':
+        return parseClass("struct ", type);
+
+    case 'V':
+        return parseClass("class ", type);
+
+    case 'W':
+        if (m_pos == m_end || !isDigit(*m_pos++))
+            return false;
+        return parseClass("enum ", type);
+
+    case 'Y':
+        return parseArray(type);
+
+    case '_':
+        {
+            if (m_pos == m_end || !isUpper(*m_pos))
+                return false;
+
+            const char*  extendedName = lookupName(extendedTypeNames, *m_pos++ - 'A');
+            if (!extendedName)
+                return false;
+
+            type.left = extendedName;
+            return true;
+        }
+
+    case '?':
+        {
+            // cv qualified type of a return value or a template argument
+            std::string  cv;
+            if (!parseCvQualifiers(cv) || !parseType(type))
+                return false;
+
+            type.left += cv;
+            return true;
+        }
+
+    case '$':
+        if (consume("$Q"))
+            return parsePointer('q', type);     // rvalue reference
+
+        if (consume("$R"))
+            return parsePointer('r', type);     // volatile rvalue reference
+
+        if (consume("$T"))
+        {
+            type.left = "std::nullptr_t";
+            return true;
+        }
+
+        if (consume("$C"))
+        {
+            std::string  cv;
+            if (!parseCvQualifiers(cv) || !parseType(type))
+                return false;
+
+            type.left += cv;
+            return true;
+        }
+
+        if (consume("$A6"))
+            return parseFunctionType(type, 0);
+
+        if (consume("$B"))
+            return consume('Y') && parseArray(type);
+
+        return false;
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parsePointer(char pointerCode, TypeText& type)
+{
+    std::string  pointer;
+
+    switch (pointerCode)
+    {
+    case 'A':
+        pointer = "&";
+        break;
+
+    case 'B':
+        pointer = "& volatile";
+        break;
+
+    case 'P':
+        pointer = "*";
+        break;
+
+    case 'Q':
+        pointer = "* const";
+        break;
+
+    case 'R':
+        pointer = "* volatile";
+        break;
+
+    case 'S':
+        pointer = "* const volatile";
+        break;
+
+    case 'q':
+        pointer = "&&";
+        break;
+
+    case 'r':
+        pointer = "&& volatile";
+        break;
+    }
+
+    parsePointerModifiers(pointer);
+
+    if (consume('6'))
+        return parseFunctionType(type, &pointer);
+
+    std::string  cv;
+    if (!parseCvQualifiers(cv) || !parseType(type))
+        return false;
+
+    type.left += cv;
+
+    if (type.right.empty())
+    {
+        type.left += ' ';
+        type.left += pointer;
+    }
+    else
+    {
+        // pointer to an array: "int (*)[10]"
+        type.left += " (";
+        type.left += pointer;
+        type.right.insert(0, ")");
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseClass(const char* keyword, TypeText& type)
+{
+    std::string  name;
+    if (!parseQualifiedName(name, 0))
+        return false;
+
+    type.left = keyword;
+    type.left += name;
+    type.right.clear();
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseArray(TypeText& type)
+{
+    long long  dimensionCount;
+    if (!parseNumber(dimensionCount) || dimensionCount <= 0 || dimensionCount > 32)
+        return false;
+
+    std::string  dimensions;
+
+    for (long long i = 0; i < dimensionCount; ++i)
+    {
+        long long  dimension;
+        if (!parseNumber(dimension))
+            return false;
+
+        dimensions += '[';
+        dimensions += std::to_string(dimension);
+        dimensions += ']';
+    }
+
+    if (!parseType(type))
+        return false;
+
+    type.right = dimensions + type.right;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseFunctionType(TypeText& type, const std::string* pointer)
+{
+    const char*  callConv;
+    if (!parseCallingConvention(callConv))
+        return false;
+
+    TypeText  returnType;
+    if (!parseType(returnType))
+        return false;
+
+    std::string  params;
+    if (!parseParameters(params))
+        return false;
+
+    consume('Z');
+
+    type.left = returnType.left;
+    type.left += ' ';
+
+    // function pointer: "int (__cdecl*)(int)"
+    if (pointer)
+        type.left += '(';
+
+    type.left += callConv;
+
+    if (pointer)
+    {
+        type.left += *pointer;
+        type.left += ')';
+    }
+
+    type.right = "(";
+    type.right += params;
+    type.right += ')';
+    type.right += returnType.right;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseParameters(std::string& params)
+{
+    if (consume('X'))
+    {
+        params = "void";
+        return true;
+    }
+
+    params.clear();
+
+    while (!consume('@'))
+    {
+        if (m_pos == m_end)
+            return false;
+
+        if (!params.empty())
+            params += ',';
+
+        if (consume('Z'))
+        {
+            params += "...";
+            return true;
+        }
+
+        if (isDigit(*m_pos))
+        {
+            const BackrefTable&  table = backrefs();
+            size_t  index = *m_pos++ - '0';
+            if (index >= table.typeCount)
+                return false;
+
+            params += table.types[index];
+            continue;
+        }
+
+        const char*  begin = m_pos;
+
+        TypeText  type;
+        if (!parseType(type))
+            return false;
+
+        // the tables may be reallocated by the nested templates
+        BackrefTable&  table = backrefs();
+
+        // only types with a multi character code are referenced back
+        if (m_pos - begin > 1 && table.typeCount < backrefCount)
+        {
+            std::string&  backref = table.types[table.typeCount++];
+            backref = type.left;
+            backref += type.right;
+        }
+
+        params += type.left;
+        params += type.right;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseCallingConvention(const char*& callConv)
+{
+    if (m_pos == m_end)
+        return false;
+
+    switch (*m_pos++)
+    {
+    case 'A':
+    case 'B':
+        callConv = "__cdecl";
+        return true;
+
+    case 'C':
+    case 'D':
+        callConv = "__pascal";
+        return true;
+
+    case 'E':
+    case 'F':
+        callConv = "__thiscall";
+        return true;
+
+    case 'G':
+    case 'H':
+        callConv = "__stdcall";
+        return true;
+
+    case 'I':
+    case 'J':
+        callConv = "__fastcall";
+        return true;
+
+    case 'Q':
+        callConv = "__vectorcall";
+        return true;
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool MsvcDemangler::parseCvQualifiers(std::string& qualifiers)
+{
+    if (m_pos == m_end)
+        return false;
+
+    switch (*m_pos++)
+    {
+    case 'A':
+        return true;
+
+    case 'B':
+        qualifiers += " const";
+        return true;
+
+    case 'C':
+        qualifiers += " volatile";
+        return true;
+
+    case 'D':
+        qualifiers += " const volatile";
+        return true;
+    }
+
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void MsvcDemangler::parsePointerModifiers(std::string& modifiers)
+{
+    while (m_pos < m_end)
+    {
+        switch (*m_pos)
+        {
+        case 'E':
+            modifiers += " __ptr64";
+            break;
+
+        case 'I':
+            modifiers += " __restrict";
+            break;
+
+        case 'F':
+            modifiers += " __unaligned";
+            break;
+
+        default:
+            return;
+        }
+
+        ++m_pos;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool undecorateMsvcName(const std::string& decoratedName, std::string& result, DemangleMode mode)
+{
+    result.clear();
+
+    if (decoratedName.empty() || decoratedName[0] != '?')
+        return false;
+
+    // DbgHelp functions are single threaded
+    static boost::mutex  undecorateLock;
+    boost::mutex::scoped_lock  lock(undecorateLock);
+
+    char  buffer[0x1000];
+
+    DWORD  length = UnDecorateSymbolName(decoratedName.c_str(), buffer, sizeof(buffer),
+        mode == DemangleNameOnly ? UNDNAME_NAME_ONLY : UNDNAME_COMPLETE);
+
+    // an unknown encoding is copied as is
+    if (length == 0 || decoratedName.compare(0, std::string::npos, buffer, length) == 0)
+        return false;
+
+    result.assign(buffer, length);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string demangleMsvcName(const std::string& decoratedName, DemangleMode mode)
+{
+    static thread_local MsvcDemangler  demangler;
+
+    std::string  result;
+    if (!demangler.demangle(decoratedName, result, mode) && !undecorateMsvcName(decoratedName, result, mode))
+        return decoratedName;
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -2,7 +2,6 @@
 
 #include <Windows.h>
 #include <comutil.h>
-#include <DbgHelp.h>
 
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/hashed_index.hpp>
@@ -16,6 +15,8 @@
 #include "kdlib/symengine.h"
 #include "kdlib/exceptions.h"
 #include "kdlib/memaccess.h"
+#include "kdlib/peimage.h"
+#include "kdlib/demangle.h"
 
 namespace bmi = boost::multi_index;
 
@@ -529,64 +530,32 @@ private:
 
     ExportSymbolDir( ULONGLONG moduleBase )
     {
-        ULONG64  ntHeaderOffset = moduleBase + ptrDWord( moduleBase + 0x3c );
-
-        IMAGE_NT_HEADERS  ntHeaders;
-        readMemory( ntHeaderOffset, &ntHeaders, sizeof(ntHeaders) );
-
-        m_machineType = ntHeaders.FileHeader.Machine;
-
         m_moduleBase = moduleBase;
 
-        if ( m_machineType == IMAGE_FILE_MACHINE_I386 ||
-             m_machineType == IMAGE_FILE_MACHINE_ARMNT )
-        {
-            GetExport<IMAGE_NT_HEADERS32>( moduleBase );
-            return;
-        }
-        
-        if ( m_machineType == IMAGE_FILE_MACHINE_AMD64 ||
-             m_machineType == IMAGE_FILE_MACHINE_ARM64 )
-        {
-            GetExport<IMAGE_NT_HEADERS64>( moduleBase );
-            return;
-        }
-
-        throw SymbolException( L"Unkonw machine type");
-    }
+        auto  imageReader = [moduleBase]( MEMOFFSET_32 rva, void* buffer, size_t length ) {
+            readMemory( moduleBase + rva, buffer, length );
+        };
 
-    template<typename NTHEADERT>
-    void  GetExport( ULONG64 moduleBase )
-    {
-        ULONG64  ntHeaderOffset = moduleBase + ptrDWord( moduleBase + 0x3c );
+        PEExportDirectory  exportDir = getPEExports( imageReader, PEImageMapped );
 
-        NTHEADERT  ntHeader;
-        readMemory( ntHeaderOffset, &ntHeader, sizeof(ntHeader) );
-    
-        if ( ntHeader.OptionalHeader.DataDirectory[0].Size == 0 )
-            return;
+        m_machineType = exportDir.machine;
 
-        ULONG64  exportDirOffset = moduleBase + ntHeader.OptionalHeader.DataDirectory[0].VirtualAddress;
+        getMachineType();  // throws for an unsupported machine
 
-        ULONG  namesCount = (ULONG) ptrDWord( exportDirOffset + 0x18 );
-        ULONG64  funcRvaOffset = moduleBase + ptrDWord( exportDirOffset + 0x1C );
-        ULONG64  namesOffset = moduleBase + ptrDWord( exportDirOffset + 0x20 ); 
-        ULONG64  ordinalsOffset = moduleBase + ptrDWord( exportDirOffset + 0x24 );
+        MsvcDemangler  demangler;
+        std::string  undecoratedName;
 
-        for ( ULONG i = 0; i < namesCount; ++i ) 
+        for ( const auto& exportEntry : exportDir.exports )
         {
-            std::string  exportName = loadCStr( moduleBase + ptrDWord( namesOffset + 4 * i ) );
-            USHORT  exportOrdinal = (USHORT)ptrWord( ordinalsOffset + 2 * i );
-            ULONG rva = (ULONG)ptrDWord( funcRvaOffset + 4 * exportOrdinal );
+            // the fast path does not know RTTI descriptors, string literals and thunks
+            bool  undecorated = demangler.demangle( exportEntry.name, undecoratedName, DemangleNameOnly ) ||
+                undecorateMsvcName( exportEntry.name, undecoratedName, DemangleNameOnly );
 
-            std::vector<char> undecorBuffer(1000);
-            DWORD  undecorLength = UnDecorateSymbolName(exportName.c_str(), &undecorBuffer[0], (DWORD)undecorBuffer.size(), UNDNAME_NAME_ONLY);
-            if (undecorLength > 0)
-                exportName = std::string(&undecorBuffer[0], undecorLength);
+            const std::string&  exportName = undecorated ? undecoratedName : exportEntry.name;
 
             std::wstring wideExportNamr = _bstr_t( exportName.c_str() );
 
-            m_exportMap.add( wideExportNamr, rva );
+            m_exportMap.add( wideExportNamr, exportEntry.rva );
         }
     }
 
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 
-#include <boost/regex.hpp>
+#include <algorithm>
+#include <cwctype>
 
 #include "kdlib/disasm.h"
 #include "kdlib/disasmengine.h"
@@ -10,14 +11,6 @@
 
 /////////////////////////////////////////////////////////////////////////////////
 
-namespace {
-
-static const boost::wregex opcodeRegex(L"^[0-9a-fA-F`]+\\s+[0-9a-fA-F]+\\s+(.*)$");
-
-}
-
-/////////////////////////////////////////////////////////////////////////////////
-
 namespace kdlib {
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -70,12 +63,28 @@ MEMOFFSET_64 Disasm::getNearInstruction( MEMDISPLACEMENT delta ) {
 
 std::wstring Disasm::opmnemo() const
 {
-    boost::wsmatch    matchResult;
+    // "<address> <opcode bytes> <instruction>": skip two fields
+    std::wstring::const_iterator  it = m_disasm.begin();
+
+    for (int field = 0; field < 2; ++field)
+    {
+        std::wstring::const_iterator  fieldBegin = it;
+
+        while (it != m_disasm.end() && (std::iswxdigit(*it) || *it == L'`'))
+            ++it;
 
-    if (!boost::regex_match(m_disasm, matchResult, opcodeRegex))
-        throw DbgException("failed to parse instruction");
+        if (it == fieldBegin || it == m_disasm.end() || !std::iswspace(*it))
+            throw DbgException("failed to parse instruction");
 
-    return std::wstring(matchResult[1].first, matchResult[1].second);
+        while (it != m_disasm.end() && std::iswspace(*it))
+            ++it;
+    }
+
+    std::wstring::const_iterator  end = m_disasm.end();
+    while (end != it && *(end - 1) == L'\n')
+        --end;
+
+    return std::wstring(it, end);
 }
 
 /////////////////////////////////////////////////////////////////////////////////
@@ -87,4 +96,64 @@ std::vector<unsigned char> Disasm::opcode() const
 
 /////////////////////////////////////////////////////////////////////////////////
 
+void decodeRange( MEMOFFSET_64 begin, MEMOFFSET_64 end, std::vector<X86Instruction>& instructions )
+{
+    const size_t  blockSize = 0x10000;
+
+    X86Decoder  decoder(getCPUMode());
+
+    begin = addr64(begin);
+    end = addr64(end);
+
+    std::vector<unsigned char>  buffer;
+    size_t  tail = 0;
+
+    // offset is the address of the buffer start. An instruction truncated by the block
+    // end is moved to the buffer start and decoded with the next block
+    for (MEMOFFSET_64 offset = begin; offset < end; )
+    {
+        if (offset + tail < end)
+        {
+            size_t  readSize = static_cast<size_t>(std::min<MEMOFFSET_64>(end - offset - tail, blockSize));
+
+            buffer.resize(tail + readSize);
+
+            unsigned long  readed = 0;
+            if (!readMemoryUnsafe(offset + tail, &buffer[tail], readSize, false, &readed) || readed == 0)
+                throw MemoryException(offset + tail);
+
+            buffer.resize(tail + readed);
+        }
+
+        size_t  decoded = decoder.decode(&buffer[0], buffer.size(), offset, instructions);
+
+        if (decoded == 0)
+        {
+            // the last instruction crosses the range end
+            unsigned char  code[maxX86InstructionLength];
+            unsigned long  readed = 0;
+            readMemoryUnsafe(offset, code, sizeof(code), false, &readed);
+
+            X86Instruction  instruction;
+            X86DecodeResult  result = decoder.decode(code, readed, offset, instruction);
+
+            if (result == X86DecodeTruncated)
+                throw MemoryException(offset + readed);
+
+            if (result == X86DecodeOk)
+                instructions.push_back(instruction);
+
+            break;
+        }
+
+        tail = buffer.size() - decoded;
+        std::copy(buffer.begin() + decoded, buffer.end(), buffer.begin());
+        buffer.resize(tail);
+
+        offset += decoded;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////////
+
 }; // end kdlib namespace
\ No newline at end of file
@@ -0,0 +1,432 @@
+#include "stdafx.h"
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include "kdlib/eventqueue.h"
+#include "kdlib/exceptions.h"
+
+namespace kdlib {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// events delivered by one wakeup of the consumer thread
+const size_t  eventBatchSize = 0x100;
+
+// the consumer, a waiting producer and flush sleep at most so long if a wakeup is missed
+const boost::posix_time::milliseconds  consumerWaitTimeout(10);
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t roundCapacity(size_t capacity)
+{
+    size_t  roundedCapacity = 2;
+    while (roundedCapacity < capacity)
+        roundedCapacity <<= 1;
+    return roundedCapacity;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // end nameless namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+AsyncEventsCallback::AsyncEventsCallback(DebugEventsCallback* callback, size_t capacity, EventQueueOverflow overflow) :
+    m_callback(callback),
+    m_overflow(overflow),
+    m_capacity(roundCapacity(capacity)),
+    m_slots(new Slot[m_capacity]),
+    m_pushPos(0),
+    m_popPos(0),
+    m_maxDepth(0),
+    m_queued(0),
+    m_delivered(0),
+    m_dropped(0),
+    m_batches(0),
+    m_consumerWaiting(false),
+    m_stop(false),
+    m_deliveryWaiters(0)
+{
+    if (!callback)
+        throw DbgException("callback is null");
+
+    for (size_t i = 0; i < m_capacity; ++i)
+        m_slots[i].sequence = i;
+
+    m_consumer = boost::thread(&AsyncEventsCallback::consumerThread, this);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+AsyncEventsCallback::~AsyncEventsCallback()
+{
+    // no new events after the removing: it waits for the calls in progress
+    removeEventsCallback(this);
+
+    {
+        boost::mutex::scoped_lock  lock(m_waitLock);
+        m_stop = true;
+        m_waitEvent.notify_one();
+    }
+
+    m_consumer.join();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool AsyncEventsCallback::tryPush(QueuedEvent& event)
+{
+    size_t  pos = m_pushPos.load(boost::memory_order_relaxed);
+
+    for (;;)
+    {
+        Slot&  slot = m_slots[pos & (m_capacity - 1)];
+
+        size_t  sequence = slot.sequence.load(boost::memory_order_acquire);
+
+        if (sequence == pos)
+        {
+            if (m_pushPos.compare_exchange_weak(pos, pos + 1, boost::memory_order_relaxed))
+            {
+                slot.event.eventId = event.eventId;
+                slot.event.offset = event.offset;
+                slot.event.text.swap(event.text);
+                slot.event.flag = event.flag;
+
+                slot.sequence.store(pos + 1, boost::memory_order_release);
+
+                size_t  depth = static_cast<size_t>(pos + 1 - m_delivered.load(boost::memory_order_relaxed));
+                size_t  maxDepth = m_maxDepth.load(boost::memory_order_relaxed);
+                while (depth > maxDepth && !m_maxDepth.compare_exchange_weak(maxDepth, depth, boost::memory_order_relaxed));
+
+                return true;
+            }
+        }
+        else if (sequence < pos)
+        {
+            // the slot of the previous round is not taken by the consumer yet: full
+            return false;
+        }
+        else
+        {
+            pos = m_pushPos.load(boost::memory_order_relaxed);
+        }
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool AsyncEventsCallback::tryPop(QueuedEvent& event)
+{
+    Slot&  slot = m_slots[m_popPos & (m_capacity - 1)];
+
+    if (slot.sequence.load(boost::memory_order_acquire) != m_popPos + 1)
+        return false;
+
+    event.eventId = slot.event.eventId;
+    event.offset = slot.event.offset;
+    event.text.swap(slot.event.text);
+    event.flag = slot.event.flag;
+
+    slot.sequence.store(m_popPos + m_capacity, boost::memory_order_release);
+    m_popPos++;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AsyncEventsCallback::push(QueuedEvent& event)
+{
+    if (!tryPush(event))
+    {
+        if (m_overflow == EventQueueDrop)
+        {
+            m_dropped++;
+            return;
+        }
+
+        boost::mutex::scoped_lock  lock(m_waitLock);
+
+        m_deliveryWaiters++;
+
+        // the consumer wakes the waiters after it frees the slots of a batch
+        while (!tryPush(event))
+        {
+            m_waitEvent.notify_one();
+            m_deliveryEvent.timed_wait(lock, consumerWaitTimeout);
+        }
+
+        m_deliveryWaiters--;
+    }
+
+    m_queued++;
+
+    if (m_consumerWaiting)
+    {
+        boost::mutex::scoped_lock  lock(m_waitLock);
+        m_waitEvent.notify_one();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AsyncEventsCallback::consumerThread()
+{
+    std::vector<QueuedEvent>  batch(eventBatchSize);
+
+    for (;;)
+    {
+        size_t  count = 0;
+        while (count < batch.size() && tryPop(batch[count]))
+            count++;
+
+        if (count == 0)
+        {
+            boost::mutex::scoped_lock  lock(m_waitLock);
+
+            if (m_stop)
+            {
+                // the last events can be pushed before the stop
+                if (m_slots[m_popPos & (m_capacity - 1)].sequence.load(boost::memory_order_acquire) == m_popPos + 1)
+                    continue;
+                break;
+            }
+
+            m_consumerWaiting = true;
+            m_waitEvent.timed_wait(lock, consumerWaitTimeout);
+            m_consumerWaiting = false;
+
+            continue;
+        }
+
+        // the slots of the batch are free already
+        notifyDelivery();
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            // an exception of the callback must not stop the consumer thread
+            try {
+                deliver(batch[i]);
+            }
+            catch (std::exception&)
+            {
+            }
+            catch (...)
+            {
+            }
+
+            batch[i].text.clear();
+        }
+
+        m_batches++;
+        m_delivered += count;
+
+        notifyDelivery();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AsyncEventsCallback::notifyDelivery()
+{
+    if (m_deliveryWaiters == 0)
+        return;
+
+    boost::mutex::scoped_lock  lock(m_waitLock);
+    m_deliveryEvent.notify_all();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AsyncEventsCallback::deliver(const QueuedEvent& event)
+{
+    switch (event.eventId)
+    {
+    case DebugEventOutput:
+        m_callback->onDebugOutput(event.text, event.flag);
+        break;
+
+    case DebugEventModuleLoad:
+        m_callback->onModuleLoad(event.offset, event.text);
+        break;
+
+    case DebugEventModuleUnload:
+        m_callback->onModuleUnload(event.offset, event.text);
+        break;
+
+    case DebugEventThreadStart:
+        m_callback->onThreadStart();
+        break;
+
+    case DebugEventThreadStop:
+        m_callback->onThreadStop();
+        break;
+
+    case DebugEventLocalScope:
+        m_callback->onChangeLocalScope();
+        break;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AsyncEventsCallback::flush()
+{
+    boost::mutex::scoped_lock  lock(m_waitLock);
+
+    m_deliveryWaiters++;
+
+    while (m_delivered < m_queued)
+    {
+        m_waitEvent.notify_one();
+        m_deliveryEvent.timed_wait(lock, consumerWaitTimeout);
+    }
+
+    m_deliveryWaiters--;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+EventQueueStatistics AsyncEventsCallback::getStatistics() const
+{
+    EventQueueStatistics  statistics;
+
+    statistics.capacity = m_capacity;
+    statistics.maxDepth = m_maxDepth;
+    statistics.delivered = m_delivered;
+    statistics.dropped = m_dropped;
+    statistics.queued = m_queued;
+    statistics.batches = m_batches;
+    statistics.depth = statistics.queued > statistics.delivered ? static_cast<size_t>(statistics.queued - statistics.delivered) : 0;
+
+    return statistics;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DebugCallbackResult AsyncEventsCallback::onModuleLoad( MEMOFFSET_64 offset, const std::wstring &name )
+{
+    QueuedEvent  event = { DebugEventModuleLoad, offset, name, OutputFlag::Normal };
+    push(event);
+    return DebugCallbackNoChange;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DebugCallbackResult AsyncEventsCallback::onModuleUnload( MEMOFFSET_64 offset, const std::wstring &name )
+{
+    QueuedEvent  event = { DebugEventModuleUnload, offset, name, OutputFlag::Normal };
+    push(event);
+    return DebugCallbackNoChange;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DebugCallbackResult AsyncEventsCallback::onThreadStart()
+{
+    QueuedEvent  event = { DebugEventThreadStart, 0, std::wstring(), OutputFlag::Normal };
+    push(event);
+    return DebugCallbackNoChange;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DebugCallbackResult AsyncEventsCallback::onThreadStop()
+{
+    QueuedEvent  event = { DebugEventThreadStop, 0, std::wstring(), OutputFlag::Normal };
+    push(event);
+    return DebugCallbackNoChange;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AsyncEventsCallback::onChangeLocalScope()
+{
+    QueuedEvent  event = { DebugEventLocalScope, 0, std::wstring(), OutputFlag::Normal };
+    push(event);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AsyncEventsCallback::onDebugOutput(const std::wstring& text, OutputFlag flag)
+{
+    QueuedEvent  event = { DebugEventOutput, 0, text, flag };
+    push(event);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DebugCallbackResult AsyncEventsCallback::onBreakpoint( BREAKPOINT_ID bpId )
+{
+    return m_callback->onBreakpoint(bpId);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DebugCallbackResult AsyncEventsCallback::onException( const ExceptionInfo &exceptionInfo )
+{
+    return m_callback->onException(exceptionInfo);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AsyncEventsCallback::onExecutionStatusChange( ExecutionStatus executionStatus )
+{
+    m_callback->onExecutionStatusChange(executionStatus);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DebugCallbackResult AsyncEventsCallback::onProcessStart(PROCESS_DEBUG_ID processid)
+{
+    return m_callback->onProcessStart(processid);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DebugCallbackResult AsyncEventsCallback::onProcessExit( PROCESS_DEBUG_ID processid, ProcessExitReason  reason, unsigned long exitCode )
+{
+    return m_callback->onProcessExit(processid, reason, exitCode);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AsyncEventsCallback::onCurrentThreadChange(THREAD_DEBUG_ID threadid)
+{
+    m_callback->onCurrentThreadChange(threadid);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AsyncEventsCallback::onChangeSymbolPaths()
+{
+    m_callback->onChangeSymbolPaths();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AsyncEventsCallback::onChangeBreakpoints()
+{
+    m_callback->onChangeBreakpoints();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AsyncEventsCallback::onStartInput()
+{
+    m_callback->onStartInput();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void AsyncEventsCallback::onStopInput()
+{
+    m_callback->onStopInput();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
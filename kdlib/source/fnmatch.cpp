@@ -2,6 +2,8 @@
 
 #include <boost/regex.hpp>
 
+#include "fnmatch.h"
+
 
 /////////////////////////////////////////////////////////////////////////////////
 
@@ -29,15 +31,23 @@ const boost::wregex  wr2(L"\\*");
 const boost::wregex  wr3(L"\\.");
 
 bool fnmatch( const std::wstring& pattern, const std::wstring& str)
+{
+    return FnMatcher(pattern).match(str);
+}
+
+FnMatcher::FnMatcher( const std::wstring& pattern )
 {
     std::wstring mask = pattern;
     mask = boost::regex_replace(mask, wr1, L".");
     mask = boost::regex_replace(mask, wr2, L".*");
     mask = boost::regex_replace(mask, wr3, L"\\.");
 
-    boost::wsmatch  matchResult;
-    boost::wregex  regEx(mask);
-    return boost::regex_match(str, matchResult, regEx);
+    m_regex.assign(mask);
+}
+
+bool FnMatcher::match( const std::wstring& str ) const
+{
+    return boost::regex_match(str, m_regex);
 }
 
 }
@@ -2,6 +2,8 @@
 
 #include <string>
 
+#include <boost/regex.hpp>
+
 namespace kdlib {
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -10,6 +12,21 @@ bool fnmatch( const std::string& pattern, const std::string& str);
 
 bool fnmatch( const std::wstring& pattern, const std::wstring& str);
 
+// A pattern compiled once for a lot of matches: fnmatch builds the regex on each call
+
+class FnMatcher
+{
+public:
+
+    explicit FnMatcher( const std::wstring& pattern );
+
+    bool match( const std::wstring& str ) const;
+
+private:
+
+    boost::wregex  m_regex;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 
 }
@@ -0,0 +1,278 @@
+#include "stdafx.h"
+
+#include <algorithm>
+
+#include "kdlib/heap.h"
+#include "kdlib/exceptions.h"
+
+#include "fnmatch.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+const HeapTypeCache::TypeEntry& HeapTypeCache::getEntry(const HeapTypeId& typeId)
+{
+    boost::recursive_mutex::scoped_lock  lock(m_lock);
+
+    auto  it = m_types.find(typeId);
+    if (it != m_types.end())
+        return it->second;
+
+    TypeEntry  entry;
+    entry.typeInfo = m_resolver(typeId);
+    entry.typeName = entry.typeInfo->getName();
+
+    return m_types.insert(std::make_pair(typeId, entry)).first->second;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr HeapTypeCache::getType(const HeapTypeId& typeId)
+{
+    boost::recursive_mutex::scoped_lock  lock(m_lock);
+
+    return getEntry(typeId).typeInfo;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::wstring HeapTypeCache::getTypeName(const HeapTypeId& typeId)
+{
+    boost::recursive_mutex::scoped_lock  lock(m_lock);
+
+    return getEntry(typeId).typeName;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t HeapTypeCache::getSize() const
+{
+    boost::recursive_mutex::scoped_lock  lock(m_lock);
+
+    return m_types.size();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void HeapTypeCache::clear()
+{
+    boost::recursive_mutex::scoped_lock  lock(m_lock);
+
+    m_types.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+HeapObjectEnum::HeapObjectEnum(
+    const HeapObjectSourceFactory& sourceFactory,
+    const HeapTypeCachePtr& typeCache,
+    const std::wstring& typeMask,
+    size_t minSize,
+    size_t maxSize,
+    size_t batchSize ) :
+        m_sourceFactory(sourceFactory),
+        m_typeCache(typeCache),
+        m_minSize(minSize),
+        m_maxSize(maxSize),
+        m_batchSize(batchSize != 0 ? batchSize : 1),
+        m_batchPos(0)
+{
+    if (!typeMask.empty())
+        m_typeMask = boost::make_shared<FnMatcher>(typeMask);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool HeapObjectEnum::matchType(const HeapTypeId& typeId, std::map<HeapTypeId, bool>& matchedTypes) const
+{
+    if (!m_typeMask)
+        return true;
+
+    auto  it = matchedTypes.find(typeId);
+    if (it != matchedTypes.end())
+        return it->second;
+
+    bool  matched = m_typeMask->match(m_typeCache->getTypeName(typeId));
+    matchedTypes.insert(std::make_pair(typeId, matched));
+
+    return matched;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t HeapObjectEnum::filterBatch(HeapObject* objects, size_t count, std::map<HeapTypeId, bool>& matchedTypes) const
+{
+    size_t  matchedCount = 0;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (!matchSize(objects[i]) || !matchType(objects[i].typeId, matchedTypes))
+            continue;
+
+        if (matchedCount != i)
+            objects[matchedCount] = objects[i];
+
+        matchedCount++;
+    }
+
+    return matchedCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool HeapObjectEnum::readBatch()
+{
+    if (!m_source)
+        m_source = m_sourceFactory();
+
+    m_batch.resize(m_batchSize);
+    m_batchPos = 0;
+
+    size_t  readCount;
+
+    while ((readCount = m_source->read(&m_batch[0], m_batch.size())) > 0)
+    {
+        size_t  matchedCount = filterBatch(&m_batch[0], readCount, m_matchedTypes);
+        if (matchedCount > 0)
+        {
+            m_batch.resize(matchedCount);
+            return true;
+        }
+    }
+
+    m_batch.clear();
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool HeapObjectEnum::next(MEMOFFSET_64& addr, std::wstring& typeName, size_t& size)
+{
+    if (m_batchPos == m_batch.size() && !readBatch())
+        return false;
+
+    const HeapObject&  heapObject = m_batch[m_batchPos++];
+
+    addr = heapObject.address;
+    typeName = m_typeCache->getTypeName(heapObject.typeId);
+    size = heapObject.size;
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool HeapObjectEnum::nextBatch(std::vector<HeapObject>& objects)
+{
+    if (m_batchPos == m_batch.size() && !readBatch())
+    {
+        objects.clear();
+        return false;
+    }
+
+    if (m_batchPos == 0)
+    {
+        objects.swap(m_batch);
+        m_batch.clear();
+    }
+    else
+    {
+        // the rest of the block after next()
+        objects.assign(m_batch.begin() + m_batchPos, m_batch.end());
+    }
+
+    m_batchPos = m_batch.size();
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t HeapObjectEnum::getCount() const
+{
+    HeapObjectSourcePtr  source = m_sourceFactory();
+
+    std::map<HeapTypeId, bool>  matchedTypes(m_matchedTypes);
+
+    size_t  elemCount = 0;
+
+    std::vector<HeapObject>  heapObjects(m_batchSize);
+    size_t  readCount;
+
+    while ((readCount = source->read(&heapObjects[0], heapObjects.size())) > 0)
+        elemCount += filterBatch(&heapObjects[0], readCount, matchedTypes);
+
+    return elemCount;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+HeapStatistics getHeapStatistics(
+    const HeapObjectSourcePtr& source,
+    const HeapTypeCachePtr& typeCache,
+    const std::wstring& typeMask,
+    size_t minSize,
+    size_t maxSize )
+{
+    struct TypeTotal {
+        size_t  count;
+        unsigned long long  totalSize;
+    };
+
+    std::map<HeapTypeId, TypeTotal>  typeTotals;
+
+    std::vector<HeapObject>  heapObjects(HeapObjectBatchSize);
+    size_t  readCount;
+
+    while ((readCount = source->read(&heapObjects[0], heapObjects.size())) > 0)
+    {
+        for (size_t i = 0; i < readCount; ++i)
+        {
+            const HeapObject&  heapObject = heapObjects[i];
+
+            if (minSize != 0 && heapObject.size < minSize)
+                continue;
+
+            if (maxSize != -1 && heapObject.size > maxSize)
+                continue;
+
+            TypeTotal&  total = typeTotals[heapObject.typeId];
+            total.count++;
+            total.totalSize += heapObject.size;
+        }
+    }
+
+    boost::shared_ptr<FnMatcher>  matcher;
+    if (!typeMask.empty())
+        matcher = boost::make_shared<FnMatcher>(typeMask);
+
+    HeapStatistics  statistics;
+    statistics.reserve(typeTotals.size());
+
+    for (const auto& typeTotal : typeTotals)
+    {
+        HeapTypeStatistics  typeStat;
+        typeStat.typeName = typeCache->getTypeName(typeTotal.first);
+
+        if (matcher && !matcher->match(typeStat.typeName))
+            continue;
+
+        typeStat.count = typeTotal.second.count;
+        typeStat.totalSize = typeTotal.second.totalSize;
+
+        statistics.push_back(typeStat);
+    }
+
+    std::sort(statistics.begin(), statistics.end(), [](const HeapTypeStatistics& left, const HeapTypeStatistics& right) {
+        if (left.totalSize != right.totalSize)
+            return left.totalSize < right.totalSize;
+        return left.typeName < right.typeName;
+    });
+
+    return statistics;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
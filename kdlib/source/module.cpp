@@ -71,6 +71,7 @@ ModulePtr loadModule( MEMOFFSET_64 offset )
 
 ModuleImp::ModuleImp(MEMOFFSET_64 offset )
 {
+    m_processId = getCurrentProcessId();
     m_base = findModuleBase( addr64(offset) );
     m_name = getModuleName( m_base );
     m_noSymbols = true;
@@ -218,6 +219,8 @@ std::wstring ModuleImp::getSymFile()
 void ModuleImp::reloadSymbols()
 {
     m_symSession.reset();
+    m_codeIndex.reset();
+    ProcessMonitor::resetTypeCache(m_processId);
     getSymSession();
 }
 
@@ -657,6 +660,64 @@ ScopePtr ModuleImp::getScope()
 
     return ScopePtr(new ModuleScope(shared_from_this()));
 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+CodeIndexPtr ModuleImp::getCodeIndex()
+{
+    if ( m_codeIndex )
+        return m_codeIndex;
+
+    // the symbols are loaded before the lookup: the index built from the exports only
+    // is cached apart and is not taken when the symbols are there
+
+    SymbolPtr  symbolScope;
+
+    try {
+        symbolScope = getSymbolScope();
+    }
+    catch( SymbolException& )
+    {}
+
+    bool  symbolsLoaded = symbolScope && isSymbolLoaded();
+
+    // the same image in the other processes and the previous sessions has the same code:
+    // the index directory keeps it by the image
+
+    m_codeIndex = findCodeIndex( m_processId, m_base, m_name, m_timeDataStamp, m_checkSum, symbolsLoaded );
+    if ( m_codeIndex )
+        return m_codeIndex;
+
+    std::vector<CodeRange>  symbolFunctions;
+
+    if ( symbolsLoaded )
+    {
+        try {
+
+            SymbolPtrList  functions = symbolScope->findChildren( SymTagFunction );
+
+            for ( SymbolPtrList::iterator it = functions.begin(); it != functions.end(); ++it )
+            {
+                CodeRange  range = { (*it)->getRva(), static_cast<MEMOFFSET_32>( (*it)->getSize() ) };
+                symbolFunctions.push_back( range );
+            }
+        }
+        catch( SymbolException& )
+        {}
+    }
+
+    MEMOFFSET_64  moduleBase = m_base;
+
+    auto  imageReader = [moduleBase]( MEMOFFSET_32 rva, void* buffer, size_t length ) {
+        readMemory( moduleBase + rva, buffer, length );
+    };
+
+    m_codeIndex = analyzeCode( imageReader, m_base, symbolFunctions );
+
+    insertCodeIndex( m_processId, m_base, m_name, m_codeIndex, symbolsLoaded );
+
+    return m_codeIndex;
+}
 ///////////////////////////////////////////////////////////////////////////////
 
 //static const std::wregex constMatch(L"[<,](const\\s)([^,>]*)[,>]");
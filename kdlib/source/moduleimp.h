@@ -241,6 +241,11 @@ protected:
     {
         NOT_IMPLEMENTED();
     }
+
+    virtual CodeIndexPtr getCodeIndex()
+    {
+        NOT_IMPLEMENTED();
+    }
 };
 
 
@@ -361,6 +366,8 @@ protected:
 
     virtual ScopePtr getScope();
 
+    CodeIndexPtr getCodeIndex();
+
 protected:
 
     void fillFields(); // ctor-helper
@@ -379,11 +386,13 @@ protected:
 
     std::wstring  m_name;
     std::wstring  m_imageName;
+    PROCESS_DEBUG_ID  m_processId;
     MEMOFFSET_64  m_base;
     size_t  m_size;
     unsigned long  m_timeDataStamp;
     unsigned long  m_checkSum;
     SymbolSessionPtr  m_symSession;
+    CodeIndexPtr  m_codeIndex;
     bool m_isUnloaded;
     bool m_isUserMode;
     bool m_exportSymbols;
@@ -11,6 +11,7 @@
 #include "win/dbgmgr.h"
 
 #include "net.h"
+#include "nettype.h"
 
 #pragma comment(lib, "mscoree.lib") 
 #pragma comment(lib, "corguids.lib")
@@ -32,6 +33,8 @@ public:
    
     ICorDebugProcess* targetProcess();
 
+    HeapTypeCachePtr typeCache();
+
     //void initCLRDebugging();
 
     //ICorDebugModule*  getModule(MEMOFFSET_64  offset);
@@ -127,9 +130,11 @@ private:
     CComPtr<ICLRDebugging>  m_debugging;
 
     typedef  std::map<PROCESS_ID, CComPtr<ICorDebugProcess> >   ProcessMap;
+    typedef  std::map<PROCESS_ID, HeapTypeCachePtr>   TypeCacheMap;
 
     boost::recursive_mutex  m_processLock;
     ProcessMap  m_processMap;
+    TypeCacheMap  m_typeCacheMap;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -183,6 +188,27 @@ ICorDebugProcess* ClrDebugManagerImpl::targetProcess()
 
 ///////////////////////////////////////////////////////////////////////////////
 
+HeapTypeCachePtr ClrDebugManagerImpl::typeCache()
+{
+    boost::recursive_mutex::scoped_lock  lock(m_processLock);
+
+    PROCESS_ID  pid = TargetProcess::getCurrent()->getSystemId();
+
+    HeapTypeCachePtr&  cache = m_typeCacheMap[pid];
+
+    if (!cache)
+    {
+        cache = boost::make_shared<HeapTypeCache>( [](const HeapTypeId& typeId) {
+            COR_TYPEID  corTypeId = { typeId.token1, typeId.token2 };
+            return createNetTypeById(corTypeId);
+        });
+    }
+
+    return cache;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 DebugCallbackResult ClrDebugManagerImpl::onProcessStart(PROCESS_DEBUG_ID processid)
 {
     boost::recursive_mutex::scoped_lock  lock(m_processLock);
@@ -193,6 +219,7 @@ DebugCallbackResult ClrDebugManagerImpl::onProcessStart(PROCESS_DEBUG_ID process
     {
         PROCESS_ID  pid = TargetProcess::getById(processid)->getSystemId();
         m_processMap[pid] = 0;
+        m_typeCacheMap.erase(pid);
     }
 
     return DebugCallbackNoChange;
@@ -208,6 +235,7 @@ DebugCallbackResult ClrDebugManagerImpl::onProcessExit( PROCESS_DEBUG_ID process
     {
         PROCESS_ID  pid = TargetProcess::getById(processid)->getSystemId();
         m_processMap.erase(pid);
+        m_typeCacheMap.erase(pid);
     }
 
     return DebugCallbackNoChange;
@@ -8,6 +8,7 @@
 
 //#include "kdlib/dbgtypedef.h"
 #include "kdlib/typedvar.h"
+#include "kdlib/heap.h"
 
 namespace kdlib {
 
@@ -25,6 +26,9 @@ public:
         return CComQIPtr<ICorDebugProcess5>( targetProcess() );
     }
 
+    // types by COR_TYPEID of the current process
+    virtual HeapTypeCachePtr typeCache() = 0;
+
     static void init();
 
     static void deinit();
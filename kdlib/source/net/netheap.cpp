@@ -7,10 +7,6 @@
 
 #include "net/net.h"
 #include "net/netheap.h"
-#include "net/nettype.h"
-#include "net/metadata.h"
-
-#include "fnmatch.h"
 
 namespace kdlib {
 
@@ -23,112 +19,68 @@ TargetHeapPtr getManagedHeap()
 
 ///////////////////////////////////////////////////////////////////////////////
 
-size_t  NetHeap::getCount(const std::wstring&  typeName, size_t minSize, size_t maxSize) const
+static HeapObjectSourcePtr getNetHeapSource()
 {
-    return NetHeapEnum(typeName, minSize, maxSize).getCount();
+    return HeapObjectSourcePtr( new NetHeapSource() );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TargetHeapEnumPtr  NetHeap::getEnum(const std::wstring&  typeName, size_t minSize, size_t maxSize) 
+size_t  NetHeap::getCount(const std::wstring&  typeName, size_t minSize, size_t maxSize) const
 {
-    return TargetHeapEnumPtr( new NetHeapEnum(typeName, minSize, maxSize) );
+    return HeapObjectEnum(getNetHeapSource, g_netMgr->typeCache(), typeName, minSize, maxSize).getCount();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-NetHeapEnum::NetHeapEnum(const std::wstring&  typeName, size_t minSize, size_t maxSize) :
-    m_typeMask(typeName),
-    m_minSize(minSize),
-    m_maxSize(maxSize)
+TargetHeapEnumPtr  NetHeap::getEnum(const std::wstring&  typeName, size_t minSize, size_t maxSize) 
 {
-    HRESULT  hres = g_netMgr->targetProcess5()->EnumerateHeap(&m_heapEnum);
-    if (FAILED(hres))
-        throw DbgException("Failed ICorDebugProcess5::EnumerateHeap");
+    return TargetHeapEnumPtr( new HeapObjectEnum(getNetHeapSource, g_netMgr->typeCache(), typeName, minSize, maxSize) );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-bool NetHeapEnum::next(MEMOFFSET_64& addr, std::wstring& typeName, size_t& size)
+HeapStatistics  NetHeap::getStatistics(const std::wstring&  typeName, size_t minSize, size_t maxSize) const
 {
-    HRESULT  hres;
-
-    while(true)
-    {
-        COR_HEAPOBJECT   heapObj;
-        hres = m_heapEnum->Next(1, &heapObj, NULL);
-
-        if (FAILED(hres))
-            throw DbgException("Failed ICorDebugHeapEnum::Next");
-
-        if ( S_OK != hres )
-            return false;
-
-        TypeInfoPtr  typeObj = getNetTypeById(heapObj.type);
-
-        std::wstring  tn = typeObj->getName();
-
-        if ( !m_typeMask.empty() && !fnmatch(m_typeMask, typeObj->getName() ))
-            continue;
-
-        if ( m_minSize != 0 && heapObj.size < m_minSize )
-            continue;
-
-        if ( m_maxSize != -1 && heapObj.size > m_maxSize )
-            continue;
-
-        addr = heapObj.address;
-        typeName = tn;
-        size = heapObj.size;
-
-        return true;
-    }
-
-    throw DbgException("NetHeapEnum::Next undefined behaviour");
+    return getHeapStatistics(getNetHeapSource(), g_netMgr->typeCache(), typeName, minSize, maxSize);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-size_t NetHeapEnum::getCount() const
+NetHeapSource::NetHeapSource()
 {
-    CComPtr<ICorDebugHeapEnum>   heapEnum;
-    HRESULT  hres = g_netMgr->targetProcess5()->EnumerateHeap(&heapEnum);
+    HRESULT  hres = g_netMgr->targetProcess5()->EnumerateHeap(&m_heapEnum);
     if (FAILED(hres))
         throw DbgException("Failed ICorDebugProcess5::EnumerateHeap");
+}
 
-    size_t  elemCount = 0;
-
-    while(true)
-    {
-        COR_HEAPOBJECT   heapObj;
-        hres = heapEnum->Next(1, &heapObj, NULL);
-
-        if (FAILED(hres))
-            throw DbgException("Failed ICorDebugHeapEnum::Next");
-
-        if ( S_OK != hres )
-            break;
+///////////////////////////////////////////////////////////////////////////////
 
-        if ( !m_typeMask.empty() || m_minSize != 0 || m_maxSize != -1 )
-        {
-            TypeInfoPtr  typeObj = getNetTypeById(heapObj.type);
+size_t NetHeapSource::read(HeapObject* objects, size_t maxCount)
+{
+    if (maxCount == 0)
+        return 0;
 
-            std::wstring  tn = typeObj->getName();
+    if (m_buffer.size() < maxCount)
+        m_buffer.resize(maxCount);
 
-            if ( !m_typeMask.empty() && !fnmatch(m_typeMask, typeObj->getName() ))
-                continue;
+    ULONG  fetched = 0;
+    HRESULT  hres = m_heapEnum->Next(static_cast<ULONG>(maxCount), &m_buffer[0], &fetched);
 
-            if ( m_minSize != 0 && heapObj.size < m_minSize )
-                continue;
+    if (FAILED(hres))
+        throw DbgException("Failed ICorDebugHeapEnum::Next");
 
-            if ( m_maxSize != -1 && heapObj.size > m_maxSize )
-                continue;
-        }
+    // S_FALSE: the end of the heap, the last objects are fetched
 
-        elemCount++;
+    for (ULONG i = 0; i < fetched; ++i)
+    {
+        objects[i].address = m_buffer[i].address;
+        objects[i].size = static_cast<size_t>(m_buffer[i].size);
+        objects[i].typeId.token1 = m_buffer[i].type.token1;
+        objects[i].typeId.token2 = m_buffer[i].type.token2;
     }
 
-    return elemCount;
+    return fetched;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -17,27 +17,24 @@ protected:
 
     virtual TargetHeapEnumPtr  getEnum(const std::wstring&  typeName=L"", size_t minSize = 0, size_t maxSize = -1);
 
-};
-
-class NetHeapEnum : public TargetHeapEnum
-{
+    virtual HeapStatistics  getStatistics(const std::wstring&  typeName=L"", size_t minSize = 0, size_t maxSize = -1) const;
 
-public:
+};
 
-    NetHeapEnum(const std::wstring&  typeName=L"", size_t minSize = 0, size_t maxSize = -1);
+///////////////////////////////////////////////////////////////////////////////
 
+class NetHeapSource : public HeapObjectSource
+{
 public:
 
-    virtual bool next(MEMOFFSET_64& addr, std::wstring& typeName, size_t&  typeSize);
+    NetHeapSource();
 
-    virtual size_t getCount() const;
+    virtual size_t read(HeapObject* objects, size_t maxCount);
 
 private:
 
-    std::wstring  m_typeMask;
-    size_t  m_minSize;
-    size_t  m_maxSize;
     CComPtr<ICorDebugHeapEnum>   m_heapEnum;
+    std::vector<COR_HEAPOBJECT>  m_buffer;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -36,6 +36,14 @@ TypeInfoPtr getNetTypeArray(COR_TYPEID typeId)
 ///////////////////////////////////////////////////////////////////////////////
 
 TypeInfoPtr  getNetTypeById(COR_TYPEID typeId)
+{
+    HeapTypeId  heapTypeId = { typeId.token1, typeId.token2 };
+    return g_netMgr->typeCache()->getType(heapTypeId);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeInfoPtr  createNetTypeById(COR_TYPEID typeId)
 {
     CComPtr<ICorDebugType>  objType;
     HRESULT  hres = g_netMgr->targetProcess5()->GetTypeForTypeID(typeId, &objType);
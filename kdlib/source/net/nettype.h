@@ -15,8 +15,12 @@ namespace kdlib {
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// cached by the process type cache
 TypeInfoPtr  getNetTypeById(COR_TYPEID typeId);
 
+// builds a new type by ICorDebug calls
+TypeInfoPtr  createNetTypeById(COR_TYPEID typeId);
+
 ///////////////////////////////////////////////////////////////////////////////
 
 class NetTypeInfoBase : public TypeInfo, public boost::enable_shared_from_this<NetTypeInfoBase>
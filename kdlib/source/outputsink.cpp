@@ -0,0 +1,121 @@
+#include "stdafx.h"
+
+#include <algorithm>
+
+#include "kdlib/outputsink.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+void OutputLineSink::write( const wchar_t* text, size_t length )
+{
+    const wchar_t*  end = text + length;
+
+    while ( text != end )
+    {
+        const wchar_t*  lineEnd = std::find( text, end, L'\n' );
+
+        if ( lineEnd == end )
+        {
+            m_tail.append( text, end );
+            return;
+        }
+
+        if ( m_tail.empty() )
+        {
+            putLine( text, lineEnd - text );
+        }
+        else
+        {
+            m_tail.append( text, lineEnd );
+            putLine( m_tail.c_str(), m_tail.size() );
+            m_tail.clear();
+        }
+
+        text = lineEnd + 1;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void OutputLineSink::flush()
+{
+    if ( m_tail.empty() )
+        return;
+
+    std::wstring  line;
+    line.swap( m_tail );
+
+    putLine( line.c_str(), line.size() );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void OutputLineSink::putLine( const wchar_t* line, size_t length )
+{
+    if ( length > 0 && line[length - 1] == L'\r' )
+        --length;
+
+    onLine( line, length );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+OutputChunks::OutputChunks( size_t chunkSize ) :
+    m_chunkSize( chunkSize != 0 ? chunkSize : 1 ),
+    m_size( 0 )
+{}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void OutputChunks::write( const wchar_t* text, size_t length )
+{
+    m_size += length;
+
+    while ( length > 0 )
+    {
+        if ( m_chunks.empty() || m_chunks.back().size() == m_chunkSize )
+        {
+            // the first chunk grows as usual, a short output takes a short buffer
+            bool  first = m_chunks.empty();
+            m_chunks.push_back( std::wstring() );
+            if ( !first )
+                m_chunks.back().reserve( m_chunkSize );
+        }
+
+        std::wstring&  chunk = m_chunks.back();
+
+        size_t  part = std::min( length, m_chunkSize - chunk.size() );
+
+        chunk.append( text, part );
+
+        text += part;
+        length -= part;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::wstring OutputChunks::str() const
+{
+    std::wstring  result;
+    result.reserve( m_size );
+
+    for ( const auto& chunk : m_chunks )
+        result += chunk;
+
+    return result;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void OutputChunks::clear()
+{
+    m_chunks.clear();
+    m_size = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -0,0 +1,461 @@
+#include "stdafx.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include "kdlib/peimage.h"
+#include "kdlib/exceptions.h"
+
+namespace kdlib {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+
+// Offsets of the PE structures fields ( winnt.h ). The parser does not use the
+// windows headers: it works on raw bytes and so it does not depend on the host
+
+const size_t  dosHeaderSize = 0x40;
+const size_t  dosLfanewOffset = 0x3C;
+
+const size_t  ntSignatureSize = 4;
+const size_t  fileHeaderSize = 20;
+const size_t  fileMachineOffset = 0;
+const size_t  fileSectionCountOffset = 2;
+const size_t  fileTimeStampOffset = 4;
+const size_t  fileOptHeaderSizeOffset = 16;
+
+const unsigned short  optMagic32 = 0x10B;
+const unsigned short  optMagic64 = 0x20B;
+const size_t  optEntryPointOffset = 16;
+const size_t  optImageSizeOffset = 56;
+const size_t  optCheckSumOffset = 64;
+const size_t  optDirCountOffset32 = 92;
+const size_t  optDirCountOffset64 = 108;
+
+const size_t  dirExport = 0;
+const size_t  dirException = 3;
+
+const size_t  sectionHeaderSize = 40;
+const size_t  sectionNameSize = 8;
+const size_t  sectionVirtualSizeOffset = 8;
+const size_t  sectionVirtualAddressOffset = 12;
+const size_t  sectionRawSizeOffset = 16;
+const size_t  sectionRawPointerOffset = 20;
+const size_t  sectionCharacteristicsOffset = 36;
+
+const size_t  exportDirSize = 40;
+const size_t  exportFuncCountOffset = 0x14;
+const size_t  exportNameCountOffset = 0x18;
+const size_t  exportFuncTableOffset = 0x1C;
+const size_t  exportNameTableOffset = 0x20;
+const size_t  exportOrdinalTableOffset = 0x24;
+
+const size_t  maxExportNameLength = 0x1000;
+
+const unsigned short  machineAmd64 = 0x8664;
+const size_t  runtimeFunctionSize = 12;
+
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename T>
+T getField(const std::vector<unsigned char>& buffer, size_t offset)
+{
+    if (offset + sizeof(T) > buffer.size())
+        throw SymbolException(L"PE image is corrupted");
+
+    T  value;
+    memcpy(&value, &buffer[offset], sizeof(T));
+    return value;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+class PEImageParser
+{
+public:
+
+    PEImageParser(const PEImageReader& reader, PEImageLayout layout) :
+        m_reader(reader),
+        m_layout(layout)
+    {}
+
+    PEExportDirectory getExports();
+
+    PECodeDirectory getCode();
+
+private:
+
+    struct Section {
+        std::string  name;
+        MEMOFFSET_32  virtualAddress;
+        MEMOFFSET_32  virtualSize;
+        MEMOFFSET_32  rawPointer;
+        MEMOFFSET_32  rawSize;
+        unsigned long  characteristics;
+    };
+
+    void readHeaders();
+
+    std::vector<unsigned char> readRva(MEMOFFSET_32 rva, size_t length);
+
+    // available is the count of the bytes from the rva to the end of its section
+    MEMOFFSET_32 rvaToOffset(MEMOFFSET_32 rva, size_t* available = 0) const;
+
+    std::string readName(MEMOFFSET_32 rva);
+
+    // a table is taken from the export directory block if it lies there ( the usual
+    // layout ), otherwise it is read separately
+    std::vector<unsigned char> getTable(MEMOFFSET_32 rva, size_t length);
+
+    const PEImageReader&  m_reader;
+    PEImageLayout  m_layout;
+
+    unsigned short  m_machine;
+    unsigned long  m_timeDataStamp;
+    unsigned long  m_checkSum;
+    MEMOFFSET_32  m_imageSize;
+    MEMOFFSET_32  m_entryPoint;
+    MEMOFFSET_32  m_exportRva;
+    MEMOFFSET_32  m_exportSize;
+    MEMOFFSET_32  m_exceptionRva;
+    MEMOFFSET_32  m_exceptionSize;
+    std::vector<Section>  m_sections;
+
+    std::vector<unsigned char>  m_exportBlock;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+void PEImageParser::readHeaders()
+{
+    std::vector<unsigned char>  dosHeader(dosHeaderSize);
+    m_reader(0, &dosHeader[0], dosHeader.size());
+
+    if (dosHeader[0] != 'M' || dosHeader[1] != 'Z')
+        throw SymbolException(L"PE image has no DOS header");
+
+    MEMOFFSET_32  ntHeaderOffset = getField<unsigned int>(dosHeader, dosLfanewOffset);
+
+    std::vector<unsigned char>  ntHeader(ntSignatureSize + fileHeaderSize);
+    m_reader(ntHeaderOffset, &ntHeader[0], ntHeader.size());
+
+    if (ntHeader[0] != 'P' || ntHeader[1] != 'E' || ntHeader[2] != 0 || ntHeader[3] != 0)
+        throw SymbolException(L"PE image has no NT header");
+
+    m_machine = getField<unsigned short>(ntHeader, ntSignatureSize + fileMachineOffset);
+    m_timeDataStamp = getField<unsigned int>(ntHeader, ntSignatureSize + fileTimeStampOffset);
+    size_t  sectionCount = getField<unsigned short>(ntHeader, ntSignatureSize + fileSectionCountOffset);
+    size_t  optHeaderSize = getField<unsigned short>(ntHeader, ntSignatureSize + fileOptHeaderSizeOffset);
+
+    // the optional header and the section table in one read
+    std::vector<unsigned char>  optHeader(optHeaderSize + sectionCount * sectionHeaderSize);
+    if (optHeader.empty())
+        throw SymbolException(L"PE image has no optional header");
+
+    m_reader(ntHeaderOffset + static_cast<MEMOFFSET_32>(ntHeader.size()), &optHeader[0], optHeader.size());
+
+    size_t  dirCountOffset;
+    switch (getField<unsigned short>(optHeader, 0))
+    {
+    case optMagic32:
+        dirCountOffset = optDirCountOffset32;
+        break;
+
+    case optMagic64:
+        dirCountOffset = optDirCountOffset64;
+        break;
+
+    default:
+        throw SymbolException(L"PE image has unknown optional header");
+    }
+
+    m_entryPoint = getField<unsigned int>(optHeader, optEntryPointOffset);
+    m_imageSize = getField<unsigned int>(optHeader, optImageSizeOffset);
+    m_checkSum = getField<unsigned int>(optHeader, optCheckSumOffset);
+
+    m_exportRva = 0;
+    m_exportSize = 0;
+    m_exceptionRva = 0;
+    m_exceptionSize = 0;
+
+    size_t  dirCount = dirCountOffset + 4 <= optHeaderSize ? getField<unsigned int>(optHeader, dirCountOffset) : 0;
+
+    if (dirCount > dirExport)
+    {
+        m_exportRva = getField<unsigned int>(optHeader, dirCountOffset + 4 + dirExport * 8);
+        m_exportSize = getField<unsigned int>(optHeader, dirCountOffset + 8 + dirExport * 8);
+    }
+
+    if (dirCount > dirException)
+    {
+        m_exceptionRva = getField<unsigned int>(optHeader, dirCountOffset + 4 + dirException * 8);
+        m_exceptionSize = getField<unsigned int>(optHeader, dirCountOffset + 8 + dirException * 8);
+    }
+
+    m_sections.resize(sectionCount);
+
+    for (size_t i = 0; i < sectionCount; ++i)
+    {
+        size_t  sectionOffset = optHeaderSize + i * sectionHeaderSize;
+
+        MEMOFFSET_32  virtualSize = getField<unsigned int>(optHeader, sectionOffset + sectionVirtualSizeOffset);
+        MEMOFFSET_32  rawSize = getField<unsigned int>(optHeader, sectionOffset + sectionRawSizeOffset);
+
+        m_sections[i].virtualAddress = getField<unsigned int>(optHeader, sectionOffset + sectionVirtualAddressOffset);
+        m_sections[i].virtualSize = std::max(virtualSize, rawSize);
+        m_sections[i].rawPointer = getField<unsigned int>(optHeader, sectionOffset + sectionRawPointerOffset);
+        m_sections[i].rawSize = rawSize;
+        m_sections[i].characteristics = getField<unsigned int>(optHeader, sectionOffset + sectionCharacteristicsOffset);
+
+        const char*  name = reinterpret_cast<const char*>(&optHeader[sectionOffset]);
+        m_sections[i].name.assign(name, std::find(name, name + sectionNameSize, '\0'));
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MEMOFFSET_32 PEImageParser::rvaToOffset(MEMOFFSET_32 rva, size_t* available) const
+{
+    for (const auto& section : m_sections)
+    {
+        if (section.virtualAddress <= rva && rva - section.virtualAddress < section.virtualSize)
+        {
+            MEMOFFSET_32  sectionOffset = rva - section.virtualAddress;
+
+            if (m_layout == PEImageMapped)
+            {
+                if (available)
+                    *available = section.virtualSize - sectionOffset;
+                return rva;
+            }
+
+            // the rest of the virtual size is not in the file
+            if (available)
+                *available = sectionOffset < section.rawSize ? section.rawSize - sectionOffset : 0;
+
+            return section.rawPointer + sectionOffset;
+        }
+    }
+
+    if (m_layout == PEImageMapped)
+    {
+        // the headers or a gap between the sections: the bound is the image end if it is known
+        if (available)
+            *available = rva < m_imageSize ? m_imageSize - rva : maxExportNameLength;
+        return rva;
+    }
+
+    throw SymbolException(L"PE image RVA is out of sections");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<unsigned char> PEImageParser::readRva(MEMOFFSET_32 rva, size_t length)
+{
+    std::vector<unsigned char>  buffer(length);
+    if (length > 0)
+        m_reader(rvaToOffset(rva), &buffer[0], length);
+    return buffer;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<unsigned char> PEImageParser::getTable(MEMOFFSET_32 rva, size_t length)
+{
+    if (rva >= m_exportRva && rva - m_exportRva + length <= m_exportBlock.size())
+    {
+        auto  begin = m_exportBlock.begin() + (rva - m_exportRva);
+        return std::vector<unsigned char>(begin, begin + length);
+    }
+
+    return readRva(rva, length);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string PEImageParser::readName(MEMOFFSET_32 rva)
+{
+    if (rva >= m_exportRva && rva - m_exportRva < m_exportBlock.size())
+    {
+        const char*  begin = reinterpret_cast<const char*>(&m_exportBlock[rva - m_exportRva]);
+        const char*  end = reinterpret_cast<const char*>(&m_exportBlock[0] + m_exportBlock.size());
+        if (static_cast<size_t>(end - begin) > maxExportNameLength)
+            end = begin + maxExportNameLength;
+        return std::string(begin, std::find(begin, end, '\0'));
+    }
+
+    // the name is out of the export directory: read it by small blocks, a name may end
+    // just before the end of its section and the file
+
+    std::string  name;
+    char  block[0x40];
+
+    while (name.size() < maxExportNameLength)
+    {
+        size_t  available;
+        MEMOFFSET_32  offset = rvaToOffset(rva + static_cast<MEMOFFSET_32>(name.size()), &available);
+
+        size_t  length = std::min(std::min(sizeof(block), available), maxExportNameLength - name.size());
+        if (length == 0)
+            break;
+
+        m_reader(offset, block, length);
+
+        char*  end = std::find(block, block + length, '\0');
+        name.append(block, end);
+
+        if (end != block + length)
+            break;
+    }
+
+    return name;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PEExportDirectory PEImageParser::getExports()
+{
+    readHeaders();
+
+    PEExportDirectory  exportDir;
+    exportDir.machine = m_machine;
+
+    if (m_exportSize == 0)
+        return exportDir;
+
+    // the directory, the tables and the names pool are usually placed in the
+    // directory block, so one read is enough for the whole export table
+
+    m_exportBlock = readRva(m_exportRva, std::max<size_t>(m_exportSize, exportDirSize));
+
+    size_t  funcCount = getField<unsigned int>(m_exportBlock, exportFuncCountOffset);
+    size_t  nameCount = getField<unsigned int>(m_exportBlock, exportNameCountOffset);
+    MEMOFFSET_32  funcTableRva = getField<unsigned int>(m_exportBlock, exportFuncTableOffset);
+    MEMOFFSET_32  nameTableRva = getField<unsigned int>(m_exportBlock, exportNameTableOffset);
+    MEMOFFSET_32  ordinalTableRva = getField<unsigned int>(m_exportBlock, exportOrdinalTableOffset);
+
+    if (funcCount > 0xFFFF || nameCount > funcCount)
+        throw SymbolException(L"PE image export directory is corrupted");
+
+    std::vector<unsigned char>  funcTable = getTable(funcTableRva, funcCount * 4);
+    std::vector<unsigned char>  nameTable = getTable(nameTableRva, nameCount * 4);
+    std::vector<unsigned char>  ordinalTable = getTable(ordinalTableRva, nameCount * 2);
+
+    exportDir.exports.reserve(nameCount);
+
+    for (size_t i = 0; i < nameCount; ++i)
+    {
+        PEExport  exportEntry;
+
+        exportEntry.ordinal = getField<unsigned short>(ordinalTable, i * 2);
+        exportEntry.rva = getField<unsigned int>(funcTable, exportEntry.ordinal * 4);
+        exportEntry.forwarded = exportEntry.rva >= m_exportRva && exportEntry.rva - m_exportRva < m_exportSize;
+        exportEntry.name = readName(getField<unsigned int>(nameTable, i * 4));
+
+        exportDir.exports.push_back(exportEntry);
+    }
+
+    return exportDir;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PECodeDirectory PEImageParser::getCode()
+{
+    readHeaders();
+
+    PECodeDirectory  codeDir;
+    codeDir.machine = m_machine;
+    codeDir.timeDataStamp = m_timeDataStamp;
+    codeDir.checkSum = m_checkSum;
+    codeDir.imageSize = m_imageSize;
+    codeDir.entryPoint = m_entryPoint;
+
+    codeDir.sections.reserve(m_sections.size());
+
+    for (const auto& section : m_sections)
+    {
+        PESection  sectionEntry;
+        sectionEntry.name = section.name;
+        sectionEntry.rva = section.virtualAddress;
+        sectionEntry.size = section.virtualSize;
+        sectionEntry.characteristics = section.characteristics;
+
+        codeDir.sections.push_back(sectionEntry);
+    }
+
+    // the x64 exception directory is an array of RUNTIME_FUNCTION: begin, end
+    // and unwind info rva. The whole table is taken by one read
+
+    if (m_machine != machineAmd64 || m_exceptionSize < runtimeFunctionSize)
+        return codeDir;
+
+    std::vector<unsigned char>  exceptionTable = readRva(m_exceptionRva, m_exceptionSize);
+
+    size_t  functionCount = exceptionTable.size() / runtimeFunctionSize;
+    codeDir.runtimeFunctions.reserve(functionCount);
+
+    for (size_t i = 0; i < functionCount; ++i)
+    {
+        PERuntimeFunction  function;
+        function.begin = getField<unsigned int>(exceptionTable, i * runtimeFunctionSize);
+        function.end = getField<unsigned int>(exceptionTable, i * runtimeFunctionSize + 4);
+
+        if (function.begin != 0 && function.begin < function.end)
+            codeDir.runtimeFunctions.push_back(function);
+    }
+
+    return codeDir;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PEImageReader getBufferReader(const void* image, size_t imageSize)
+{
+    const unsigned char*  imageBytes = static_cast<const unsigned char*>(image);
+
+    return [=](MEMOFFSET_32 offset, void* buffer, size_t length)
+    {
+        if (offset > imageSize || length > imageSize - offset)
+            throw SymbolException(L"PE image is truncated");
+
+        memcpy(buffer, imageBytes + offset, length);
+    };
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // end nameless namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+PEExportDirectory getPEExports(const PEImageReader& reader, PEImageLayout layout)
+{
+    return PEImageParser(reader, layout).getExports();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PEExportDirectory getPEExports(const void* image, size_t imageSize, PEImageLayout layout)
+{
+    return getPEExports(getBufferReader(image, imageSize), layout);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PECodeDirectory getPECode(const PEImageReader& reader, PEImageLayout layout)
+{
+    return PEImageParser(reader, layout).getCode();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PECodeDirectory getPECode(const void* image, size_t imageSize, PEImageLayout layout)
+{
+    return getPECode(getBufferReader(image, imageSize), layout);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -1,10 +1,22 @@
 #include "stdafx.h"
 
+#include <algorithm>
 #include <map>
+#include <sstream>
+#include <vector>
+#include <unordered_map>
 
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 #include <boost/thread/recursive_mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <boost/atomic.hpp>
 
+#include "kdlib/dbgengine.h"
+#include "kdlib/cpucontext.h"
+#include "kdlib/dbgio.h"
+#include "kdlib/codeanalysis.h"
+
 #include "processmon.h"
 
 namespace kdlib
@@ -28,10 +40,19 @@ public:
     TypeInfoPtr getTypeInfo(const std::wstring& name);
     void insertTypeInfo(const TypeInfoPtr& typeInfo);
 
-    void insertBreakpoint(const BreakpointPtr& breakpoint);
+    TypeInfoPtr getTypeExprInfo(const std::wstring& typeExpr);
+    void insertTypeExprInfo(const std::wstring& typeExpr, const TypeInfoPtr& typeInfo, MEMOFFSET_64 moduleBase);
+    void resetTypeCache();
+
+    void insertBreakpoint(const BreakpointPtr& breakpoint, const CompiledExprPtr& condition);
     void removeBreakpoint(const BreakpointPtr& breakpoint);
+    void setBreakpointTracepoint(BREAKPOINT_ID id);
+    bool isTracepoint(BREAKPOINT_ID id);
+
+    // false if the breakpoint has a condition and it is false: the hit is skipped
+    bool checkBreakpointCondition(BREAKPOINT_ID id);
 
-    DebugCallbackResult breakpointHit(BreakpointPtr& breakpoint);
+    DebugCallbackResult breakpointHit(BREAKPOINT_ID id);
 
     void onChangeSymbolPaths();
 
@@ -44,19 +65,100 @@ private:
     typedef std::map<std::wstring, TypeInfoPtr>  TypeInfoMap;
     TypeInfoMap  m_typeInfoMap;
     boost::recursive_mutex  m_typeInfoLock;
+
+    // resolved type expressions ( "nt!_LIST_ENTRY*[4]" ), bounded by maxTypeExprCacheSize.
+    // The module base of a qualified expression drops the entry on the module unload
+    static const size_t  maxTypeExprCacheSize = 1024;
+    struct TypeExprEntry {
+        TypeInfoPtr  typeInfo;
+        MEMOFFSET_64  moduleBase;
+    };
+    typedef std::unordered_map<std::wstring, TypeExprEntry>  TypeExprMap;
+    TypeExprMap  m_typeExprMap;
     
-    typedef std::map<BREAKPOINT_ID, BreakpointPtr>  BreakpointIdMap;
-    BreakpointIdMap  m_breakpointMap;
+    struct BreakpointEntry {
+        BreakpointPtr  breakpoint;
+        CompiledExprPtr  condition;
+        ScopePtr  conditionScope;
+        bool  tracepoint;
+    };
+
+    // under m_breakpointLock, 0 if the id is not registered
+    const BreakpointEntry* findBreakpoint(BREAKPOINT_ID id) const;
+
+    // indexed by the breakpoint id: the engine gives the lowest free ids. The ids over
+    // maxBreakpointId ( a script setting the ids itself ) are kept in the map
+    static const BREAKPOINT_ID  maxBreakpointId = 0x10000;
+    typedef std::vector<BreakpointEntry>  BreakpointTable;
+    typedef std::map<BREAKPOINT_ID, BreakpointEntry>  BreakpointMap;
+    BreakpointTable  m_breakpointTable;
+    BreakpointMap  m_breakpointMap;
     boost::recursive_mutex  m_breakpointLock;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 
+// Scope of the breakpoint conditions: registers by name, then the default scope.
+// A name is checked for a register once, the register index is kept
+
+class BreakpointConditionScope : public Scope
+{
+public:
+
+    BreakpointConditionScope() :
+        m_defaultScope(getDefaultScope())
+    {}
+
+    virtual TypedValue get(const std::wstring& varName) const override
+    {
+        TypedValue  value;
+        if (!find(varName, value))
+            throw DbgException("unknown identifier of the breakpoint condition");
+        return value;
+    }
+
+    virtual bool find(const std::wstring& varName, TypedValue& value) const override
+    {
+        auto  it = m_registers.find(varName);
+        if (it == m_registers.end())
+        {
+            unsigned long  regIndex = notRegister;
+            try {
+                regIndex = getRegisterIndex(varName);
+            }
+            catch (DbgException&)
+            {}
+
+            it = m_registers.insert(std::make_pair(varName, regIndex)).first;
+        }
+
+        if (it->second != notRegister)
+        {
+            value = getRegisterByIndex(it->second);
+            return true;
+        }
+
+        return m_defaultScope->find(varName, value);
+    }
+
+private:
+
+    static const unsigned long  notRegister = ~0UL;
+
+    ScopePtr  m_defaultScope;
+    mutable std::map<std::wstring, unsigned long>  m_registers;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
 class ProcessMonitorImpl {
 
 public:
 
-    ProcessMonitorImpl() : m_bpUnique(0x80000000)
+    ProcessMonitorImpl() : 
+        m_bpUnique(0x80000000),
+        m_callbacks(boost::make_shared<EventsCallbackArray>()),
+        m_eventsMask(0)
     {}
 
     ~ProcessMonitorImpl()
@@ -75,7 +177,7 @@ public:
 
     DebugCallbackResult moduleLoad(PROCESS_DEBUG_ID id, MEMOFFSET_64 offset, const std::wstring& moduleName);
     DebugCallbackResult moduleUnload(PROCESS_DEBUG_ID id, MEMOFFSET_64  offset, const std::wstring& moduleName);
-    DebugCallbackResult breakpointHit(PROCESS_DEBUG_ID id, BreakpointPtr& breakpoint);
+    DebugCallbackResult breakpointHit(PROCESS_DEBUG_ID id, BREAKPOINT_ID bpId);
     void currentThreadChange(THREAD_DEBUG_ID threadid);
     void executionStatusChange(ExecutionStatus status);
     void localScopeChange();
@@ -92,11 +194,16 @@ public:
     TypeInfoPtr getTypeInfo(const std::wstring& name, PROCESS_DEBUG_ID id = -1);
     void insertTypeInfo(const TypeInfoPtr& typeInfo, PROCESS_DEBUG_ID id = -1);
 
-    void registerEventsCallback(DebugEventsCallback *callback);
+    TypeInfoPtr getTypeExprInfo(const std::wstring& typeExpr, PROCESS_DEBUG_ID id);
+    void insertTypeExprInfo(const std::wstring& typeExpr, const TypeInfoPtr& typeInfo, MEMOFFSET_64 moduleBase, PROCESS_DEBUG_ID id);
+    void resetTypeCache(PROCESS_DEBUG_ID id);
+
+    void registerEventsCallback(DebugEventsCallback *callback, unsigned long eventsMask);
     void removeEventsCallback(DebugEventsCallback *callback);
 
-    void registerBreakpoint( const BreakpointPtr& breakpoint, PROCESS_DEBUG_ID id = -1 );
+    void registerBreakpoint( const BreakpointPtr& breakpoint, PROCESS_DEBUG_ID id, const CompiledExprPtr& condition );
     void removeBreakpoint( const BreakpointPtr& breakpoint, PROCESS_DEBUG_ID id = -1 );
+    void setBreakpointTracepoint( BREAKPOINT_ID bpId, PROCESS_DEBUG_ID id );
 
 private:
 
@@ -111,10 +218,40 @@ private:
 
 private:
 
-    typedef std::list<DebugEventsCallback*>  EventsCallbackList;
+    // shared by the entry of every array built after the registration
+    struct EventsCallbackState {
+        boost::atomic<bool>  removed;
+        boost::atomic<unsigned long>  calls;    // dispatches calling the callback now
+    };
+
+    typedef boost::shared_ptr<EventsCallbackState>  EventsCallbackStatePtr;
+
+    struct EventsCallbackEntry {
+        DebugEventsCallback*  callback;
+        unsigned long  eventsMask;
+        EventsCallbackStatePtr  state;
+    };
+
+    typedef std::vector<EventsCallbackEntry>  EventsCallbackArray;
+    typedef boost::shared_ptr<const EventsCallbackArray>  EventsCallbackArrayPtr;
+
+    // Copy on write: the dispatch takes a snapshot of the array without a lock and calls only
+    // the interested callbacks, register and remove build a new array under m_callbacksLock.
+    // A snapshot may be older than the last remove: the dispatch skips the removed entries
+    // and remove waits for the calls of the callback started before it was marked
+    template<typename Notify>
+    DebugCallbackResult notifyCallbacks(unsigned long eventId, Notify notify);
+
+    void waitCallbackCalls(const EventsCallbackState* state);
+
+    void endCallbackCall(EventsCallbackState& state);
 
     boost::recursive_mutex      m_callbacksLock;
-    EventsCallbackList          m_callbacks;
+    EventsCallbackArrayPtr      m_callbacks;
+    boost::atomic<unsigned long>  m_eventsMask;     // union of the callback masks
+
+    boost::mutex                m_callsLock;
+    boost::condition_variable   m_callsDone;
 };
 
 ProcessMonitorImpl*  g_procmon;
@@ -159,9 +296,9 @@ void ProcessMonitor::deinit()
 
 /////////////////////////////////////////////////////////////////////////////
 
-void ProcessMonitor::registerEventsCallback(DebugEventsCallback *callback)
+void ProcessMonitor::registerEventsCallback(DebugEventsCallback *callback, unsigned long eventsMask)
 {
-    g_procmon->registerEventsCallback(callback);
+    g_procmon->registerEventsCallback(callback, eventsMask);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -173,12 +310,12 @@ void ProcessMonitor::removeEventsCallback(DebugEventsCallback *callback)
 
 /////////////////////////////////////////////////////////////////////////////
 
-void ProcessMonitor::registerBreakpoint( const BreakpointPtr& breakpoint, PROCESS_DEBUG_ID id )
+void ProcessMonitor::registerBreakpoint( const BreakpointPtr& breakpoint, PROCESS_DEBUG_ID id, const CompiledExprPtr& condition )
 {
     if ( id == -1 )
         id = getCurrentProcessId();
 
-    g_procmon->registerBreakpoint(breakpoint, id);
+    g_procmon->registerBreakpoint(breakpoint, id, condition);
 }
 
 
@@ -194,6 +331,16 @@ void ProcessMonitor::removeBreakpoint( const BreakpointPtr& breakpoint, PROCESS_
 
 /////////////////////////////////////////////////////////////////////////////
 
+void ProcessMonitor::setBreakpointTracepoint( BREAKPOINT_ID bpId, PROCESS_DEBUG_ID id )
+{
+    if ( id == -1 )
+        id = getCurrentProcessId();
+
+    g_procmon->setBreakpointTracepoint(bpId, id);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
 DebugCallbackResult ProcessMonitor::processStart(PROCESS_DEBUG_ID id)
 {
     return g_procmon->processStart(id);
@@ -257,9 +404,9 @@ DebugCallbackResult ProcessMonitor::moduleUnload(PROCESS_DEBUG_ID id, MEMOFFSET_
 
 ///////////////////////////////////////////////////////////////////////////////
 
-DebugCallbackResult ProcessMonitor::breakpointHit(PROCESS_DEBUG_ID id, BreakpointPtr& breakpoint)
+DebugCallbackResult ProcessMonitor::breakpointHit(PROCESS_DEBUG_ID id, BREAKPOINT_ID bpId)
 {
-    return g_procmon->breakpointHit(id, breakpoint);
+    return g_procmon->breakpointHit(id, bpId);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -367,48 +514,100 @@ void ProcessMonitor::insertTypeInfo(const TypeInfoPtr& typeInfo, PROCESS_DEBUG_I
 
 ///////////////////////////////////////////////////////////////////////////////
 
-DebugCallbackResult ProcessMonitorImpl::processStart(PROCESS_DEBUG_ID id)
+TypeInfoPtr ProcessMonitor::getTypeExprInfo(const std::wstring& typeExpr, PROCESS_DEBUG_ID id)
 {
-    {
-        ProcessInfoPtr  proc = ProcessInfoPtr(new ProcessInfo());
-        boost::recursive_mutex::scoped_lock l(m_lock);
-        m_processMap[id] = proc;
-    }
-
-    DebugCallbackResult  result = DebugCallbackNoChange;
+    if (id == -1)
+        id = getCurrentProcessId();
 
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
+    return g_procmon->getTypeExprInfo(typeExpr, id);
+}
 
-    EventsCallbackList::iterator  it = m_callbacks.begin();
+///////////////////////////////////////////////////////////////////////////////
 
-    for (; it != m_callbacks.end(); ++it)
-    {
-        DebugCallbackResult  ret = (*it)->onProcessStart(id);
-        result = ret != DebugCallbackNoChange ? ret : result;
-    }
+void ProcessMonitor::insertTypeExprInfo(const std::wstring& typeExpr, const TypeInfoPtr& typeInfo, MEMOFFSET_64 moduleBase, PROCESS_DEBUG_ID id)
+{
+    if (id == -1)
+        id = getCurrentProcessId();
 
-    return result;
+    g_procmon->insertTypeExprInfo(typeExpr, typeInfo, moduleBase, id);
 }
 
-
 ///////////////////////////////////////////////////////////////////////////////
 
-DebugCallbackResult ProcessMonitorImpl::processStop(PROCESS_DEBUG_ID id, ProcessExitReason reason, unsigned int exitCode)
+void ProcessMonitor::resetTypeCache(PROCESS_DEBUG_ID id)
 {
-    {
-        boost::recursive_mutex::scoped_lock l(m_lock);
-        m_processMap.erase(id);
+    if (id == -1)
+        id = getCurrentProcessId();
+
+    g_procmon->resetTypeCache(id);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+// nesting of the event dispatch on the current thread
+// the callbacks called by the dispatch of the current thread, a callback may remove
+// itself or another running callback
+thread_local std::vector<const void*>  dispatchCalls;
+
+class DispatchGuard {
+
+public:
+
+    DispatchGuard(const void* state) {
+        dispatchCalls.push_back(state);
     }
 
+    ~DispatchGuard() {
+        dispatchCalls.pop_back();
+    }
+};
+
+} // end nameless namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+template<typename Notify>
+DebugCallbackResult ProcessMonitorImpl::notifyCallbacks(unsigned long eventId, Notify notify)
+{
     DebugCallbackResult  result = DebugCallbackNoChange;
 
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
+    if ((m_eventsMask & eventId) == 0)
+        return result;
 
-    EventsCallbackList::iterator  it = m_callbacks.begin();
+    EventsCallbackArrayPtr  callbacks = boost::atomic_load(&m_callbacks);
 
-    for (; it != m_callbacks.end(); ++it)
+    for (const auto& entry : *callbacks)
     {
-        DebugCallbackResult  ret = (*it)->onProcessExit(id, reason, exitCode);
+        if ((entry.eventsMask & eventId) == 0)
+            continue;
+
+        EventsCallbackState&  state = *entry.state;
+
+        // the call is counted before the check: remove either sees the call or it is skipped
+        state.calls++;
+
+        if (state.removed)
+        {
+            endCallbackCall(state);
+            continue;
+        }
+
+        DebugCallbackResult  ret;
+
+        try {
+            DispatchGuard  guard(&state);
+            ret = notify(entry.callback);
+        }
+        catch (...)
+        {
+            endCallbackCall(state);
+            throw;
+        }
+
+        endCallbackCall(state);
+
         result = ret != DebugCallbackNoChange ? ret : result;
     }
 
@@ -417,40 +616,82 @@ DebugCallbackResult ProcessMonitorImpl::processStop(PROCESS_DEBUG_ID id, Process
 
 ///////////////////////////////////////////////////////////////////////////////
 
-DebugCallbackResult ProcessMonitorImpl::createThread()
+void ProcessMonitorImpl::endCallbackCall(EventsCallbackState& state)
 {
-    DebugCallbackResult  result = DebugCallbackNoChange;
-
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
-
-    EventsCallbackList::iterator  it = m_callbacks.begin();
+    state.calls--;
 
-    for (; it != m_callbacks.end(); ++it)
+    // every call of a removed callback wakes the waiting removes, not only the last one:
+    // a callback removing itself waits for the count of its own calls, not for zero.
+    // The notify is under the lock, so a remove checking the count can not miss it
+    if (state.removed)
     {
-        DebugCallbackResult  ret = (*it)->onThreadStart();
-        result = ret != DebugCallbackNoChange ? ret : result;
+        boost::mutex::scoped_lock  lock(m_callsLock);
+        m_callsDone.notify_all();
     }
+}
 
-    return result;
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitorImpl::waitCallbackCalls(const EventsCallbackState* state)
+{
+    boost::mutex::scoped_lock  lock(m_callsLock);
+
+    // the calls of the current thread are below on its stack, they end after the remove
+    unsigned long  ownCalls = static_cast<unsigned long>(
+        std::count(dispatchCalls.begin(), dispatchCalls.end(), state));
+
+    while (state->calls > ownCalls)
+        m_callsDone.wait(lock);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-DebugCallbackResult ProcessMonitorImpl::stopThread()
+DebugCallbackResult ProcessMonitorImpl::processStart(PROCESS_DEBUG_ID id)
 {
-    DebugCallbackResult  result = DebugCallbackNoChange;
+    {
+        ProcessInfoPtr  proc = ProcessInfoPtr(new ProcessInfo());
+        boost::recursive_mutex::scoped_lock l(m_lock);
+        m_processMap[id] = proc;
+    }
+
+    return notifyCallbacks(DebugEventProcessStart, [&](DebugEventsCallback* callback) {
+        return callback->onProcessStart(id);
+    });
+}
 
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
 
-    EventsCallbackList::iterator  it = m_callbacks.begin();
+///////////////////////////////////////////////////////////////////////////////
 
-    for (; it != m_callbacks.end(); ++it)
+DebugCallbackResult ProcessMonitorImpl::processStop(PROCESS_DEBUG_ID id, ProcessExitReason reason, unsigned int exitCode)
+{
     {
-        DebugCallbackResult  ret = (*it)->onThreadStop();
-        result = ret != DebugCallbackNoChange ? ret : result;
+        boost::recursive_mutex::scoped_lock l(m_lock);
+        m_processMap.erase(id);
     }
 
-    return result;
+    removeProcessCodeIndices(id);
+
+    return notifyCallbacks(DebugEventProcessExit, [&](DebugEventsCallback* callback) {
+        return callback->onProcessExit(id, reason, exitCode);
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DebugCallbackResult ProcessMonitorImpl::createThread()
+{
+    return notifyCallbacks(DebugEventThreadStart, [&](DebugEventsCallback* callback) {
+        return callback->onThreadStart();
+    });
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DebugCallbackResult ProcessMonitorImpl::stopThread()
+{
+    return notifyCallbacks(DebugEventThreadStop, [&](DebugEventsCallback* callback) {
+        return callback->onThreadStop();
+    });
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -511,16 +752,11 @@ DebugCallbackResult ProcessMonitorImpl::moduleLoad(PROCESS_DEBUG_ID id, MEMOFFSE
         loadModule(offset);
     }
 
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
-
-    EventsCallbackList::iterator  it;
-    for (it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
-    {
-        DebugCallbackResult  ret = (*it)->onModuleLoad(offset, moduleName);
-        result = ret != DebugCallbackNoChange ? ret : result;
-    }
+    DebugCallbackResult  ret = notifyCallbacks(DebugEventModuleLoad, [&](DebugEventsCallback* callback) {
+        return callback->onModuleLoad(offset, moduleName);
+    });
 
-    return result;
+    return ret != DebugCallbackNoChange ? ret : result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -534,80 +770,70 @@ DebugCallbackResult ProcessMonitorImpl::moduleUnload(PROCESS_DEBUG_ID id, MEMOFF
     if ( processInfo )
         processInfo->removeModule( offset );
 
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
+    removeCodeIndex( id, offset );
 
-    EventsCallbackList::iterator  it;
-    for ( it = m_callbacks.begin(); it != m_callbacks.end(); ++it )
-    {
-        DebugCallbackResult  ret = (*it)->onModuleUnload(offset, moduleName );
-        result = ret != DebugCallbackNoChange ? ret : result;
-    }
+    DebugCallbackResult  ret = notifyCallbacks(DebugEventModuleUnload, [&](DebugEventsCallback* callback) {
+        return callback->onModuleUnload(offset, moduleName);
+    });
 
-    return result;
+    return ret != DebugCallbackNoChange ? ret : result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-DebugCallbackResult ProcessMonitorImpl::breakpointHit(PROCESS_DEBUG_ID id, BreakpointPtr& breakpoint)
+DebugCallbackResult ProcessMonitorImpl::breakpointHit(PROCESS_DEBUG_ID id, BREAKPOINT_ID bpId)
 {
     DebugCallbackResult  result = DebugCallbackNoChange;
 
     ProcessInfoPtr  processInfo = getProcess(id);
     if ( processInfo )
-        result = processInfo->breakpointHit(breakpoint);
+    {
+        // the condition is false: go on without the breakpoint callback and the events
+        if ( !processInfo->checkBreakpointCondition(bpId) )
+            return DebugCallbackProceed;
 
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
+        result = processInfo->breakpointHit(bpId);
 
-    EventsCallbackList::iterator  it;
-    for (it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
-    {
-        DebugCallbackResult  ret = (*it)->onBreakpoint(breakpoint->getId());
-        result = ret != DebugCallbackNoChange ? ret : result;
+        // the tracepoint hit is captured natively: the subscribers ( scripts ) are not called
+        if ( processInfo->isTracepoint(bpId) )
+            return DebugCallbackProceed;
     }
 
-    return result;
+    DebugCallbackResult  ret = notifyCallbacks(DebugEventBreakpoint, [&](DebugEventsCallback* callback) {
+        return callback->onBreakpoint(bpId);
+    });
+
+    return ret != DebugCallbackNoChange ? ret : result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void ProcessMonitorImpl::currentThreadChange(THREAD_DEBUG_ID threadid)
 {
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
-
-    EventsCallbackList::iterator  it = m_callbacks.begin();
-
-    for (; it != m_callbacks.end(); ++it)
-    {
-        (*it)->onCurrentThreadChange(threadid);
-    }
+    notifyCallbacks(DebugEventCurrentThread, [&](DebugEventsCallback* callback) {
+        callback->onCurrentThreadChange(threadid);
+        return DebugCallbackNoChange;
+    });
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void ProcessMonitorImpl::executionStatusChange(ExecutionStatus status)
 {
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
-
-    EventsCallbackList::iterator  it = m_callbacks.begin();
-
-    for (; it != m_callbacks.end(); ++it)
-    {
-        (*it)->onExecutionStatusChange(status);
-    }
+    notifyCallbacks(DebugEventExecutionStatus, [&](DebugEventsCallback* callback) {
+        callback->onExecutionStatusChange(status);
+        return DebugCallbackNoChange;
+    });
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void ProcessMonitorImpl::localScopeChange()
 {
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
-
-    EventsCallbackList::iterator  it = m_callbacks.begin();
-
-    for (; it != m_callbacks.end(); ++it)
-    {
-        (*it)->onChangeLocalScope();
-    }
+    notifyCallbacks(DebugEventLocalScope, [&](DebugEventsCallback* callback) {
+        callback->onChangeLocalScope();
+        return DebugCallbackNoChange;
+    });
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -622,87 +848,59 @@ void ProcessMonitorImpl::changeSymbolPaths()
            it->second->onChangeSymbolPaths();
     }
 
-    {
-        boost::recursive_mutex::scoped_lock l(m_callbacksLock);
-
-        EventsCallbackList::iterator  it = m_callbacks.begin();
-
-        for (; it != m_callbacks.end(); ++it)
-        {
-            (*it)->onChangeSymbolPaths();
-        }
-    }
+    notifyCallbacks(DebugEventSymbolPaths, [&](DebugEventsCallback* callback) {
+        callback->onChangeSymbolPaths();
+        return DebugCallbackNoChange;
+    });
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void ProcessMonitorImpl::breakpointsChange(PROCESS_DEBUG_ID id)
 {
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
-
-    EventsCallbackList::iterator  it = m_callbacks.begin();
-
-    for (; it != m_callbacks.end(); ++it)
-    {
-        (*it)->onChangeBreakpoints();
-    }
+    notifyCallbacks(DebugEventBreakpoints, [&](DebugEventsCallback* callback) {
+        callback->onChangeBreakpoints();
+        return DebugCallbackNoChange;
+    });
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 DebugCallbackResult  ProcessMonitorImpl::exceptionHit(const ExceptionInfo& excinfo)
 {
-    DebugCallbackResult  result = DebugCallbackNoChange;
-
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
-
-    EventsCallbackList::iterator  it;
-    for (it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
-    {
-        DebugCallbackResult  ret = (*it)->onException(excinfo);
-        result = ret != DebugCallbackNoChange ? ret : result;
-    }
-
-    return result;
+    return notifyCallbacks(DebugEventException, [&](DebugEventsCallback* callback) {
+        return callback->onException(excinfo);
+    });
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void ProcessMonitorImpl::debugOutput(const std::wstring& text, OutputFlag flag)
 {
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
-
-    EventsCallbackList::iterator  it;
-    for (it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
-    {
-        (*it)->onDebugOutput(text, flag);
-    }
+    notifyCallbacks(DebugEventOutput, [&](DebugEventsCallback* callback) {
+        callback->onDebugOutput(text, flag);
+        return DebugCallbackNoChange;
+    });
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void ProcessMonitorImpl::startInput()
 {
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
-
-    EventsCallbackList::iterator  it;
-    for (it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
-    {
-        (*it)->onStartInput();
-    }
+    notifyCallbacks(DebugEventInput, [&](DebugEventsCallback* callback) {
+        callback->onStartInput();
+        return DebugCallbackNoChange;
+    });
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void ProcessMonitorImpl::stopInput()
 {
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
-
-    EventsCallbackList::iterator  it;
-    for (it = m_callbacks.begin(); it != m_callbacks.end(); ++it)
-    {
-        (*it)->onStopInput();
-    }
+    notifyCallbacks(DebugEventInput, [&](DebugEventsCallback* callback) {
+        callback->onStopInput();
+        return DebugCallbackNoChange;
+    });
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -736,6 +934,35 @@ void ProcessMonitorImpl::insertTypeInfo(const TypeInfoPtr& typeInfo, PROCESS_DEB
 
 ///////////////////////////////////////////////////////////////////////////////
 
+TypeInfoPtr ProcessMonitorImpl::getTypeExprInfo(const std::wstring& typeExpr, PROCESS_DEBUG_ID id)
+{
+    ProcessInfoPtr  processInfo = getProcess(id);
+    if (processInfo)
+        return processInfo->getTypeExprInfo(typeExpr);
+
+    return TypeInfoPtr();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitorImpl::insertTypeExprInfo(const std::wstring& typeExpr, const TypeInfoPtr& typeInfo, MEMOFFSET_64 moduleBase, PROCESS_DEBUG_ID id)
+{
+    ProcessInfoPtr  processInfo = getProcess(id);
+    if (processInfo)
+        processInfo->insertTypeExprInfo(typeExpr, typeInfo, moduleBase);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessMonitorImpl::resetTypeCache(PROCESS_DEBUG_ID id)
+{
+    ProcessInfoPtr  processInfo = getProcess(id);
+    if (processInfo)
+        processInfo->resetTypeCache();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 ProcessInfoPtr ProcessMonitorImpl::getProcess( PROCESS_DEBUG_ID id )
 {
     boost::recursive_mutex::scoped_lock l(m_lock);
@@ -754,29 +981,68 @@ ProcessInfoPtr ProcessMonitorImpl::getProcess( PROCESS_DEBUG_ID id )
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void ProcessMonitorImpl::registerEventsCallback(DebugEventsCallback *callback)
+void ProcessMonitorImpl::registerEventsCallback(DebugEventsCallback *callback, unsigned long eventsMask)
 {
     boost::recursive_mutex::scoped_lock l(m_callbacksLock);
-    m_callbacks.push_back(callback);
+
+    boost::shared_ptr<EventsCallbackArray>  callbacks = boost::make_shared<EventsCallbackArray>(*m_callbacks);
+
+    EventsCallbackEntry  entry = { callback, eventsMask, boost::make_shared<EventsCallbackState>() };
+    entry.state->removed = false;
+    entry.state->calls = 0;
+    callbacks->push_back(entry);
+
+    boost::atomic_store(&m_callbacks, EventsCallbackArrayPtr(callbacks));
+
+    m_eventsMask |= eventsMask;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 void ProcessMonitorImpl::removeEventsCallback(DebugEventsCallback *callback)
 {
-    boost::recursive_mutex::scoped_lock l(m_callbacksLock);
-    m_callbacks.remove(callback);
+    std::vector<EventsCallbackStatePtr>  removed;
+
+    {
+        boost::recursive_mutex::scoped_lock l(m_callbacksLock);
+
+        boost::shared_ptr<EventsCallbackArray>  callbacks = boost::make_shared<EventsCallbackArray>();
+        unsigned long  eventsMask = 0;
+
+        for (const auto& entry : *m_callbacks)
+        {
+            if (entry.callback == callback)
+            {
+                // any snapshot holding the entry skips it from now
+                entry.state->removed = true;
+                removed.push_back(entry.state);
+                continue;
+            }
+
+            callbacks->push_back(entry);
+            eventsMask |= entry.eventsMask;
+        }
+
+        boost::atomic_store(&m_callbacks, EventsCallbackArrayPtr(callbacks));
+
+        m_eventsMask = eventsMask;
+    }
+
+    // the callback is usually destroyed after the removing: wait for the calls of the
+    // other threads, whatever snapshot they took
+    for (const auto& state : removed)
+        waitCallbackCalls(state.get());
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void ProcessMonitorImpl::registerBreakpoint( const BreakpointPtr& breakpoint, PROCESS_DEBUG_ID id )
+void ProcessMonitorImpl::registerBreakpoint( const BreakpointPtr& breakpoint, PROCESS_DEBUG_ID id, const CompiledExprPtr& condition )
 {
     ProcessInfoPtr  processInfo = getProcess(id);
 
     if ( processInfo )
     {
-        processInfo->insertBreakpoint(breakpoint);
+        processInfo->insertBreakpoint(breakpoint, condition);
     }
 }
 
@@ -794,6 +1060,18 @@ void ProcessMonitorImpl::removeBreakpoint( const BreakpointPtr& breakpoint, PROC
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void ProcessMonitorImpl::setBreakpointTracepoint( BREAKPOINT_ID bpId, PROCESS_DEBUG_ID id )
+{
+    ProcessInfoPtr  processInfo = getProcess(id);
+
+    if ( processInfo )
+    {
+        processInfo->setBreakpointTracepoint(bpId);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 ModulePtr ProcessInfo::getModule(MEMOFFSET_64  offset)
 {
     boost::recursive_mutex::scoped_lock l(m_moduleLock);
@@ -826,8 +1104,21 @@ void ProcessInfo::insertModule( ModulePtr& module)
 
 void ProcessInfo::removeModule(MEMOFFSET_64  offset )
 {
-    boost::recursive_mutex::scoped_lock l(m_moduleLock);
-    m_moduleMap.erase(offset);
+    {
+        boost::recursive_mutex::scoped_lock l(m_moduleLock);
+        m_moduleMap.erase(offset);
+    }
+
+    // the type names are kept: only the expressions naming the module are stale
+    boost::recursive_mutex::scoped_lock l(m_typeInfoLock);
+
+    for ( TypeExprMap::iterator it = m_typeExprMap.begin(); it != m_typeExprMap.end(); )
+    {
+        if ( it->second.moduleBase == offset )
+            it = m_typeExprMap.erase(it);
+        else
+            ++it;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -855,11 +1146,80 @@ void ProcessInfo::insertTypeInfo(const TypeInfoPtr& typeInfo)
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void ProcessInfo::insertBreakpoint(const BreakpointPtr& breakpoint)
+TypeInfoPtr ProcessInfo::getTypeExprInfo(const std::wstring& typeExpr)
 {
+    boost::recursive_mutex::scoped_lock l(m_typeInfoLock);
+
+    TypeExprMap::iterator  it = m_typeExprMap.find(typeExpr);
+
+    if (it != m_typeExprMap.end())
+        return it->second.typeInfo;
+
+    return TypeInfoPtr();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessInfo::insertTypeExprInfo(const std::wstring& typeExpr, const TypeInfoPtr& typeInfo, MEMOFFSET_64 moduleBase)
+{
+    boost::recursive_mutex::scoped_lock l(m_typeInfoLock);
+
+    if (m_typeExprMap.size() >= maxTypeExprCacheSize)
+        m_typeExprMap.clear();
+
+    TypeExprEntry  entry;
+    entry.typeInfo = typeInfo;
+    entry.moduleBase = moduleBase;
+
+    m_typeExprMap.insert(std::make_pair(typeExpr, entry));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessInfo::resetTypeCache()
+{
+    boost::recursive_mutex::scoped_lock l(m_typeInfoLock);
+
+    m_typeInfoMap.clear();
+    m_typeExprMap.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessInfo::insertBreakpoint(const BreakpointPtr& breakpoint, const CompiledExprPtr& condition)
+{
+    BREAKPOINT_ID  id = breakpoint->getId();
+
+    BreakpointEntry  entry;
+    entry.breakpoint = breakpoint;
+    entry.condition = condition;
+    entry.tracepoint = false;
+    if ( condition )
+        entry.conditionScope = ScopePtr( new BreakpointConditionScope() );
+
     boost::recursive_mutex::scoped_lock l(m_breakpointLock);
-    
-    m_breakpointMap[breakpoint->getId()] = breakpoint;
+
+    if ( id >= maxBreakpointId )
+    {
+        m_breakpointMap[id] = entry;
+        return;
+    }
+
+    if ( m_breakpointTable.size() <= id )
+        m_breakpointTable.resize(id + 1);
+
+    m_breakpointTable[id] = entry;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const ProcessInfo::BreakpointEntry* ProcessInfo::findBreakpoint(BREAKPOINT_ID id) const
+{
+    if ( id < m_breakpointTable.size() )
+        return m_breakpointTable[id].breakpoint ? &m_breakpointTable[id] : 0;
+
+    BreakpointMap::const_iterator  it = m_breakpointMap.find(id);
+    return it != m_breakpointMap.end() ? &it->second : 0;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -871,13 +1231,18 @@ void ProcessInfo::removeBreakpoint(const BreakpointPtr& breakpoint)
     {
         boost::recursive_mutex::scoped_lock l(m_breakpointLock);
 
-        BreakpointIdMap::iterator   it = m_breakpointMap.find(breakpoint->getId());
-        if (it == m_breakpointMap.end() )
+        BREAKPOINT_ID  id = breakpoint->getId();
+
+        const BreakpointEntry*  entry = findBreakpoint(id);
+        if ( !entry )
             return;
 
-        origbp = it->second;
+        origbp = entry->breakpoint;
 
-        m_breakpointMap.erase(it);
+        if ( id < m_breakpointTable.size() )
+            m_breakpointTable[id] = BreakpointEntry();
+        else
+            m_breakpointMap.erase(id);
     }
 
     BreakpointCallback*  callback = origbp->getCallback();
@@ -886,19 +1251,75 @@ void ProcessInfo::removeBreakpoint(const BreakpointPtr& breakpoint)
 
 }
 
+///////////////////////////////////////////////////////////////////////////////
+
+void ProcessInfo::setBreakpointTracepoint(BREAKPOINT_ID id)
+{
+    boost::recursive_mutex::scoped_lock l(m_breakpointLock);
+
+    BreakpointEntry*  entry = const_cast<BreakpointEntry*>(findBreakpoint(id));
+    if ( entry )
+        entry->tracepoint = true;
+}
 
 ///////////////////////////////////////////////////////////////////////////////
 
-DebugCallbackResult ProcessInfo::breakpointHit(BreakpointPtr& breakpoint)
+bool ProcessInfo::isTracepoint(BREAKPOINT_ID id)
 {
     boost::recursive_mutex::scoped_lock l(m_breakpointLock);
-    
-    BreakpointIdMap::iterator  it =  m_breakpointMap.find( breakpoint->getId() );
 
-    if ( it == m_breakpointMap.end() )
+    const BreakpointEntry*  entry = findBreakpoint(id);
+    return entry && entry->tracepoint;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool ProcessInfo::checkBreakpointCondition(BREAKPOINT_ID id)
+{
+    CompiledExprPtr  condition;
+    ScopePtr  conditionScope;
+
+    {
+        boost::recursive_mutex::scoped_lock l(m_breakpointLock);
+
+        const BreakpointEntry*  entry = findBreakpoint(id);
+        if ( !entry || !entry->condition )
+            return true;
+
+        condition = entry->condition;
+        conditionScope = entry->conditionScope;
+    }
+
+    // a condition that can not be evaluated breaks, and the error is printed
+    try {
+        return condition->eval(conditionScope) ? true : false;
+    }
+    catch (DbgException& e)
+    {
+        std::string  desc = e.what();
+
+        std::wstringstream  sstr;
+        sstr << L"breakpoint " << id << L" condition \"" << condition->getExpr() << L"\" failed: "
+             << std::wstring(desc.begin(), desc.end());
+
+        eprintln(sstr.str());
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+DebugCallbackResult ProcessInfo::breakpointHit(BREAKPOINT_ID id)
+{
+    boost::recursive_mutex::scoped_lock l(m_breakpointLock);
+
+    const BreakpointEntry*  entry = findBreakpoint(id);
+    if ( !entry )
         return DebugCallbackNoChange;
 
-    BreakpointPtr  origBp = it->second;
+    BreakpointPtr  origBp = entry->breakpoint;
 
     BreakpointCallback*  callback = origBp->getCallback();
     if ( callback == 0 )
@@ -911,13 +1332,17 @@ DebugCallbackResult ProcessInfo::breakpointHit(BreakpointPtr& breakpoint)
 
 void ProcessInfo::onChangeSymbolPaths()
 {
-    boost::recursive_mutex::scoped_lock l(m_moduleLock);
-
-    for ( ModuleMap::iterator it = m_moduleMap.begin(); it != m_moduleMap.end(); ++it)
     {
-        if ( !it->second->isSymbolLoaded() )
-            it->second->resetSymbols();
+        boost::recursive_mutex::scoped_lock l(m_moduleLock);
+
+        for ( ModuleMap::iterator it = m_moduleMap.begin(); it != m_moduleMap.end(); ++it)
+        {
+            if ( !it->second->isSymbolLoaded() )
+                it->second->resetSymbols();
+        }
     }
+
+    resetTypeCache();
 }
 
 /////////////////////////////////////////////////////////////////////////////
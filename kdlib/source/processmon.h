@@ -4,6 +4,7 @@
 #include "kdlib/breakpoint.h"
 #include "kdlib/dbgcallbacks.h"
 #include "kdlib/typeinfo.h"
+#include "kdlib/typedvar.h"
 #include "kdlib/module.h"
 
 namespace kdlib {
@@ -25,7 +26,7 @@ public: // notification
     static DebugCallbackResult stopThread();
     static DebugCallbackResult moduleLoad(PROCESS_DEBUG_ID id, MEMOFFSET_64 offset, const std::wstring &moduleName);
     static DebugCallbackResult moduleUnload(PROCESS_DEBUG_ID id, MEMOFFSET_64  offset, const std::wstring &moduleName);
-    static DebugCallbackResult breakpointHit(PROCESS_DEBUG_ID id, BreakpointPtr& breakpoint);
+    static DebugCallbackResult breakpointHit(PROCESS_DEBUG_ID id, BREAKPOINT_ID bpId);
     static void currentThreadChange(THREAD_DEBUG_ID id);
     static void executionStatusChange(ExecutionStatus status);
     static void breakpointsChange(PROCESS_DEBUG_ID id);
@@ -50,17 +51,23 @@ public: // module manipulation
 
 public: //breakpoint callbacks
 
-    static void registerBreakpoint( const BreakpointPtr& breakpoint, PROCESS_DEBUG_ID id = -1 );
+    static void registerBreakpoint( const BreakpointPtr& breakpoint, PROCESS_DEBUG_ID id = -1, const CompiledExprPtr& condition = CompiledExprPtr() );
     static void removeBreakpoint( const BreakpointPtr& breakpoint, PROCESS_DEBUG_ID id = -1 );
+    static void setBreakpointTracepoint( BREAKPOINT_ID bpId, PROCESS_DEBUG_ID id = -1 );
 
 public: //callbacks
-    static void registerEventsCallback(DebugEventsCallback *callback);
+    static void registerEventsCallback(DebugEventsCallback *callback, unsigned long eventsMask = DebugEventAll);
     static void removeEventsCallback(DebugEventsCallback *callback);
 
 public: // 
 
     static TypeInfoPtr getTypeInfo(const std::wstring& name, PROCESS_DEBUG_ID id = -1);
     static void insertTypeInfo( const TypeInfoPtr& typeInfo, PROCESS_DEBUG_ID id = -1);
+
+    static TypeInfoPtr getTypeExprInfo(const std::wstring& typeExpr, PROCESS_DEBUG_ID id = -1);
+    // moduleBase is the module the expression names, 0 for an unqualified name
+    static void insertTypeExprInfo(const std::wstring& typeExpr, const TypeInfoPtr& typeInfo, MEMOFFSET_64 moduleBase, PROCESS_DEBUG_ID id = -1);
+    static void resetTypeCache(PROCESS_DEBUG_ID id = -1);
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,960 @@
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <set>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "kdlib/serializer.h"
+#include "kdlib/memaccess.h"
+#include "kdlib/exceptions.h"
+
+#include "strconvert.h"
+
+namespace kdlib {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+
+const size_t  outputBufferSize = 0x10000;
+
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned long long readUnsigned(const unsigned char* data, size_t size)
+{
+    unsigned long long  value = 0;
+
+    for (size_t i = 0; i < size && i < sizeof(value); ++i)
+        value |= static_cast<unsigned long long>(data[i]) << (8 * i);
+
+    return value;
+}
+
+long long readSigned(const unsigned char* data, size_t size)
+{
+    unsigned long long  value = readUnsigned(data, size);
+
+    if (size > 0 && size < sizeof(value) && ((value >> (8 * size - 1)) & 1) != 0)
+        value |= ~0ULL << (8 * size);
+
+    return static_cast<long long>(value);
+}
+
+double readFloat(const unsigned char* data, size_t size)
+{
+    if (size == sizeof(float))
+    {
+        float  value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    if (size == sizeof(double))
+    {
+        double  value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    return 0.0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// An encoder of the value tree with the buffered output to the sink
+
+class ValueWriter : private boost::noncopyable
+{
+public:
+
+    explicit ValueWriter(SerializerSink& sink) :
+        m_sink(sink)
+    {
+        m_buffer.reserve(outputBufferSize);
+    }
+
+    virtual ~ValueWriter()
+    {}
+
+    virtual void beginMap(size_t count) = 0;
+    virtual void endMap() = 0;
+    virtual void beginArray(size_t count) = 0;
+    virtual void endArray() = 0;
+    virtual void key(const std::string& name) = 0;
+
+    virtual void signedValue(long long value) = 0;
+    virtual void unsignedValue(unsigned long long value) = 0;
+    virtual void floatValue(double value) = 0;
+    virtual void boolValue(bool value) = 0;
+    virtual void nullValue() = 0;
+    virtual void stringValue(const std::string& value) = 0;
+
+    void flush()
+    {
+        if (!m_buffer.empty())
+        {
+            m_sink.write(&m_buffer[0], m_buffer.size());
+            m_buffer.clear();
+        }
+    }
+
+protected:
+
+    void put(char c)
+    {
+        if (m_buffer.size() == outputBufferSize)
+            flush();
+        m_buffer.push_back(c);
+    }
+
+    void put(const char* data, size_t length)
+    {
+        if (m_buffer.size() + length > outputBufferSize)
+        {
+            flush();
+
+            if (length > outputBufferSize)
+            {
+                m_sink.write(data, length);
+                return;
+            }
+        }
+
+        m_buffer.insert(m_buffer.end(), data, data + length);
+    }
+
+private:
+
+    SerializerSink&  m_sink;
+    std::vector<char>  m_buffer;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class JsonWriter : public ValueWriter
+{
+public:
+
+    explicit JsonWriter(SerializerSink& sink) :
+        ValueWriter(sink),
+        m_separator(false)
+    {}
+
+    virtual void beginMap(size_t count)
+    {
+        separator();
+        put('{');
+        m_separator = false;
+    }
+
+    virtual void endMap()
+    {
+        put('}');
+        m_separator = true;
+    }
+
+    virtual void beginArray(size_t count)
+    {
+        separator();
+        put('[');
+        m_separator = false;
+    }
+
+    virtual void endArray()
+    {
+        put(']');
+        m_separator = true;
+    }
+
+    virtual void key(const std::string& name)
+    {
+        separator();
+        putString(name);
+        put(':');
+        m_separator = false;
+    }
+
+    virtual void signedValue(long long value)
+    {
+        separator();
+        if (value < 0)
+        {
+            put('-');
+            putUnsigned(0ULL - static_cast<unsigned long long>(value));
+        }
+        else
+        {
+            putUnsigned(static_cast<unsigned long long>(value));
+        }
+        m_separator = true;
+    }
+
+    virtual void unsignedValue(unsigned long long value)
+    {
+        separator();
+        putUnsigned(value);
+        m_separator = true;
+    }
+
+    virtual void floatValue(double value)
+    {
+        if (!std::isfinite(value))
+        {
+            nullValue();
+            return;
+        }
+
+        separator();
+        char  buffer[32];
+        int  length = std::snprintf(buffer, sizeof(buffer), "%.17g", value);
+        put(buffer, static_cast<size_t>(length));
+        m_separator = true;
+    }
+
+    virtual void boolValue(bool value)
+    {
+        separator();
+        if (value)
+            put("true", 4);
+        else
+            put("false", 5);
+        m_separator = true;
+    }
+
+    virtual void nullValue()
+    {
+        separator();
+        put("null", 4);
+        m_separator = true;
+    }
+
+    virtual void stringValue(const std::string& value)
+    {
+        separator();
+        putString(value);
+        m_separator = true;
+    }
+
+private:
+
+    void separator()
+    {
+        if (m_separator)
+            put(',');
+    }
+
+    void putUnsigned(unsigned long long value)
+    {
+        char  buffer[24];
+        char*  p = buffer + sizeof(buffer);
+
+        do {
+            *--p = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+
+        put(p, buffer + sizeof(buffer) - p);
+    }
+
+    void putString(const std::string& value)
+    {
+        static const char  hexDigits[] = "0123456789abcdef";
+
+        put('"');
+
+        for (size_t i = 0; i < value.size(); ++i)
+        {
+            unsigned char  c = static_cast<unsigned char>(value[i]);
+
+            if (c == '"' || c == '\\')
+            {
+                put('\\');
+                put(static_cast<char>(c));
+            }
+            else if (c < 0x20)
+            {
+                char  escape[] = { '\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xF] };
+                put(escape, sizeof(escape));
+            }
+            else
+            {
+                put(static_cast<char>(c));
+            }
+        }
+
+        put('"');
+    }
+
+    bool  m_separator;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class CborWriter : public ValueWriter
+{
+public:
+
+    explicit CborWriter(SerializerSink& sink) :
+        ValueWriter(sink)
+    {}
+
+    virtual void beginMap(size_t count)
+    {
+        putHead(5, count);
+    }
+
+    virtual void endMap()
+    {}
+
+    virtual void beginArray(size_t count)
+    {
+        putHead(4, count);
+    }
+
+    virtual void endArray()
+    {}
+
+    virtual void key(const std::string& name)
+    {
+        stringValue(name);
+    }
+
+    virtual void signedValue(long long value)
+    {
+        if (value < 0)
+            putHead(1, ~static_cast<unsigned long long>(value));
+        else
+            putHead(0, static_cast<unsigned long long>(value));
+    }
+
+    virtual void unsignedValue(unsigned long long value)
+    {
+        putHead(0, value);
+    }
+
+    virtual void floatValue(double value)
+    {
+        unsigned long long  bits;
+        memcpy(&bits, &value, sizeof(bits));
+
+        put(static_cast<char>(0xFB));
+        putBigEndian(bits, 8);
+    }
+
+    virtual void boolValue(bool value)
+    {
+        put(static_cast<char>(value ? 0xF5 : 0xF4));
+    }
+
+    virtual void nullValue()
+    {
+        put(static_cast<char>(0xF6));
+    }
+
+    virtual void stringValue(const std::string& value)
+    {
+        putHead(3, value.size());
+        put(value.data(), value.size());
+    }
+
+private:
+
+    void putHead(unsigned char majorType, unsigned long long value)
+    {
+        unsigned char  head = static_cast<unsigned char>(majorType << 5);
+
+        if (value < 24)
+        {
+            put(static_cast<char>(head | value));
+        }
+        else if (value <= 0xFF)
+        {
+            put(static_cast<char>(head | 24));
+            putBigEndian(value, 1);
+        }
+        else if (value <= 0xFFFF)
+        {
+            put(static_cast<char>(head | 25));
+            putBigEndian(value, 2);
+        }
+        else if (value <= 0xFFFFFFFF)
+        {
+            put(static_cast<char>(head | 26));
+            putBigEndian(value, 4);
+        }
+        else
+        {
+            put(static_cast<char>(head | 27));
+            putBigEndian(value, 8);
+        }
+    }
+
+    void putBigEndian(unsigned long long value, size_t size)
+    {
+        char  buffer[8];
+
+        for (size_t i = 0; i < size; ++i)
+            buffer[i] = static_cast<char>(value >> (8 * (size - i - 1)));
+
+        put(buffer, size);
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum ValueKind {
+    ValueNull,
+    ValueSigned,
+    ValueUnsigned,
+    ValueFloat,
+    ValueBool,
+    ValueBitField,
+    ValuePointer,
+    ValueUdt,
+    ValueArray,
+    ValueCharArray,
+    ValueWCharArray
+};
+
+ValueKind getBaseKind(const std::wstring& typeName)
+{
+    if (typeName == L"Float" || typeName == L"Double")
+        return ValueFloat;
+
+    if (typeName == L"Bool")
+        return ValueBool;
+
+    if (typeName == L"Char" || typeName == L"Long" || typeName.compare(0, 3, L"Int") == 0)
+        return ValueSigned;
+
+    if (typeName == L"WChar" || typeName == L"ULong" || typeName == L"Hresult" || typeName.compare(0, 4, L"UInt") == 0)
+        return ValueUnsigned;
+
+    return ValueNull;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+// How to decode a value of the type from the object buffer, built once for a type
+
+struct TypeLayout;
+
+struct FieldLayout {
+    std::string  name;
+    size_t  index;
+    MEMOFFSET_32  offset;
+    bool  virtualMember;
+    TypeLayout*  layout;
+};
+
+struct TypeLayout {
+
+    TypeLayout() :
+        kind(ValueNull),
+        size(0),
+        bitOffset(0),
+        bitWidth(0),
+        bitSigned(false),
+        elementCount(0),
+        elementLayout(0),
+        targetResolved(false),
+        targetLayout(0)
+    {}
+
+    TypeInfoPtr  type;
+    ValueKind  kind;
+    size_t  size;
+
+    BITOFFSET  bitOffset;
+    BITOFFSET  bitWidth;
+    bool  bitSigned;
+
+    size_t  elementCount;
+    TypeLayout*  elementLayout;
+
+    bool  targetResolved;
+    TypeLayout*  targetLayout;
+
+    std::vector<FieldLayout>  fields;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+class TypedVarSerializer : private boost::noncopyable
+{
+public:
+
+    TypedVarSerializer(ValueWriter& writer, const SerializerOptions& options) :
+        m_writer(writer),
+        m_options(options)
+    {}
+
+    void serialize(const TypedVarPtr& var)
+    {
+        writeVar(var, 0);
+        m_writer.flush();
+    }
+
+private:
+
+    TypeLayout& getLayout(const TypeInfoPtr& type);
+    void buildLayout(TypeLayout& layout);
+
+    std::vector<unsigned char>& getBuffer(size_t depth);
+
+    void writeVar(const TypedVarPtr& var, size_t depth);
+    void writeValue(TypeLayout& layout, const unsigned char* data, MEMOFFSET_64 address, size_t depth);
+    void writeUdt(TypeLayout& layout, const unsigned char* data, MEMOFFSET_64 address, size_t depth);
+    void writeArray(TypeLayout& layout, const unsigned char* data, MEMOFFSET_64 address, size_t depth);
+    void writePointer(TypeLayout& layout, MEMOFFSET_64 value, size_t depth);
+    void writeVirtualMember(TypeLayout& layout, const FieldLayout& field, MEMOFFSET_64 address, size_t depth);
+
+    ValueWriter&  m_writer;
+    SerializerOptions  m_options;
+
+    std::map<const TypeInfo*, TypeLayout>  m_layouts;
+    std::set<MEMOFFSET_64>  m_written;
+    std::vector<std::vector<unsigned char> >  m_buffers;
+    std::string  m_text;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypeLayout& TypedVarSerializer::getLayout(const TypeInfoPtr& type)
+{
+    std::map<const TypeInfo*, TypeLayout>::iterator  it = m_layouts.find(type.get());
+    if (it != m_layouts.end())
+        return it->second;
+
+    // the map keeps the node address, the nested layouts are pointed to
+    TypeLayout&  layout = m_layouts[type.get()];
+    layout.type = type;
+
+    try {
+        buildLayout(layout);
+    }
+    catch (DbgException&)
+    {
+        layout.kind = ValueNull;
+        layout.fields.clear();
+    }
+
+    return layout;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TypedVarSerializer::buildLayout(TypeLayout& layout)
+{
+    const TypeInfoPtr&  type = layout.type;
+
+    if (type->isBitField())
+    {
+        TypeInfoPtr  bitType = type->getBitType();
+
+        layout.kind = ValueBitField;
+        layout.size = bitType->getSize();
+        layout.bitOffset = type->getBitOffset();
+        layout.bitWidth = type->getBitWidth();
+        layout.bitSigned = getBaseKind(bitType->getName()) == ValueSigned;
+        return;
+    }
+
+    if (type->isEnum())
+    {
+        layout.kind = ValueSigned;
+        layout.size = type->getSize();
+        return;
+    }
+
+    if (type->isBase())
+    {
+        layout.kind = getBaseKind(type->getName());
+        layout.size = type->getSize();
+        return;
+    }
+
+    if (type->isPointer())
+    {
+        layout.kind = ValuePointer;
+        layout.size = type->getSize();
+        return;
+    }
+
+    if (type->isArray())
+    {
+        TypeInfoPtr  elementType = type->getElement(0);
+
+        layout.size = type->getSize();
+        layout.elementCount = type->getElementCount();
+        layout.elementLayout = &getLayout(elementType);
+
+        if (layout.elementLayout->kind == ValueSigned && elementType->getName() == L"Char")
+            layout.kind = ValueCharArray;
+        else if (layout.elementLayout->kind == ValueUnsigned && elementType->getName() == L"WChar")
+            layout.kind = ValueWCharArray;
+        else
+            layout.kind = ValueArray;
+        return;
+    }
+
+    if (type->isUserDefined())
+    {
+        layout.kind = ValueUdt;
+        layout.size = type->getSize();
+
+        size_t  fieldCount = type->getElementCount();
+        layout.fields.reserve(fieldCount);
+
+        for (size_t i = 0; i < fieldCount; ++i)
+        {
+            if (type->isStaticMember(i) || type->isConstMember(i))
+                continue;
+
+            FieldLayout  field;
+
+            std::wstring  fieldName = type->getElementName(i);
+            appendUtf8(field.name, fieldName.c_str(), fieldName.size());
+
+            field.index = i;
+            field.virtualMember = type->isVirtualMember(i);
+            field.offset = field.virtualMember ? 0 : type->getElementOffset(i);
+            field.layout = &getLayout(type->getElement(i));
+
+            layout.fields.push_back(field);
+        }
+        return;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<unsigned char>& TypedVarSerializer::getBuffer(size_t depth)
+{
+    if (m_buffers.size() <= depth)
+        m_buffers.resize(depth + 1);
+    return m_buffers[depth];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TypedVarSerializer::writeVar(const TypedVarPtr& var, size_t depth)
+{
+    TypeLayout&  layout = getLayout(var->getType());
+
+    size_t  size = var->getSize();
+
+    std::vector<unsigned char>&  buffer = getBuffer(depth);
+    buffer.clear();
+
+    if (size > 0)
+    {
+        DataAccessorPtr  dataRange = getCacheAccessor(size);
+        var->writeBytes(dataRange);
+        dataRange->readBytes(buffer, size);
+    }
+
+    // a shorter variable is padded not to check the size of each field
+    if (buffer.size() < layout.size)
+        buffer.resize(layout.size, 0);
+
+    MEMOFFSET_64  address = 0;
+
+    try {
+        address = var->getAddress();
+    }
+    catch (DbgException&)
+    {}
+
+    if (address != 0)
+        m_written.insert(address);
+
+    if (buffer.empty())
+        m_writer.nullValue();
+    else
+        writeValue(layout, &buffer[0], address, depth);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TypedVarSerializer::writeValue(TypeLayout& layout, const unsigned char* data, MEMOFFSET_64 address, size_t depth)
+{
+    switch (layout.kind)
+    {
+    case ValueSigned:
+        m_writer.signedValue(readSigned(data, layout.size));
+        break;
+
+    case ValueUnsigned:
+        m_writer.unsignedValue(readUnsigned(data, layout.size));
+        break;
+
+    case ValueFloat:
+        m_writer.floatValue(readFloat(data, layout.size));
+        break;
+
+    case ValueBool:
+        m_writer.boolValue(readUnsigned(data, layout.size) != 0);
+        break;
+
+    case ValueBitField:
+        {
+            unsigned long long  value = readUnsigned(data, layout.size) >> layout.bitOffset;
+
+            if (layout.bitWidth < 64)
+            {
+                value &= (1ULL << layout.bitWidth) - 1;
+
+                if (layout.bitSigned && layout.bitWidth > 0 && ((value >> (layout.bitWidth - 1)) & 1) != 0)
+                    value |= ~0ULL << layout.bitWidth;
+            }
+
+            if (layout.bitSigned)
+                m_writer.signedValue(static_cast<long long>(value));
+            else
+                m_writer.unsignedValue(value);
+        }
+        break;
+
+    case ValuePointer:
+        writePointer(layout, readUnsigned(data, layout.size), depth);
+        break;
+
+    case ValueUdt:
+        writeUdt(layout, data, address, depth);
+        break;
+
+    case ValueArray:
+        writeArray(layout, data, address, depth);
+        break;
+
+    case ValueCharArray:
+        {
+            const char*  str = reinterpret_cast<const char*>(data);
+            size_t  length = 0;
+            while (length < layout.size && str[length] != 0)
+                ++length;
+
+            m_text.clear();
+            appendUtf8(m_text, reinterpret_cast<const unsigned char*>(str), length);
+            m_writer.stringValue(m_text);
+        }
+        break;
+
+    case ValueWCharArray:
+        {
+            // the target WChar is UTF-16 whatever the host wchar_t is
+            std::vector<unsigned short>  units;
+            units.reserve(layout.size / 2);
+
+            for (size_t i = 0; i + 1 < layout.size; i += 2)
+            {
+                unsigned short  unit = static_cast<unsigned short>(data[i] | (data[i + 1] << 8));
+                if (unit == 0)
+                    break;
+                units.push_back(unit);
+            }
+
+            m_text.clear();
+            if (!units.empty())
+                appendUtf8(m_text, &units[0], units.size());
+            m_writer.stringValue(m_text);
+        }
+        break;
+
+    default:
+        m_writer.nullValue();
+        break;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TypedVarSerializer::writeUdt(TypeLayout& layout, const unsigned char* data, MEMOFFSET_64 address, size_t depth)
+{
+    if (depth > m_options.maxDepth)
+    {
+        m_writer.nullValue();
+        return;
+    }
+
+    m_writer.beginMap(layout.fields.size());
+
+    for (size_t i = 0; i < layout.fields.size(); ++i)
+    {
+        const FieldLayout&  field = layout.fields[i];
+
+        m_writer.key(field.name);
+
+        if (field.virtualMember)
+        {
+            writeVirtualMember(layout, field, address, depth);
+            continue;
+        }
+
+        if (field.offset + field.layout->size > layout.size)
+        {
+            m_writer.nullValue();
+            continue;
+        }
+
+        writeValue(*field.layout, data + field.offset, address != 0 ? address + field.offset : 0, depth + 1);
+    }
+
+    m_writer.endMap();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TypedVarSerializer::writeArray(TypeLayout& layout, const unsigned char* data, MEMOFFSET_64 address, size_t depth)
+{
+    if (depth > m_options.maxDepth)
+    {
+        m_writer.nullValue();
+        return;
+    }
+
+    size_t  elementSize = layout.elementLayout->size;
+
+    size_t  count = elementSize != 0 ? std::min(layout.elementCount, layout.size / elementSize) : 0;
+    count = std::min(count, m_options.maxArrayElements);
+
+    m_writer.beginArray(count);
+
+    for (size_t i = 0; i < count; ++i)
+        writeValue(*layout.elementLayout, data + i * elementSize, address != 0 ? address + i * elementSize : 0, depth + 1);
+
+    m_writer.endArray();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TypedVarSerializer::writePointer(TypeLayout& layout, MEMOFFSET_64 value, size_t depth)
+{
+    if (!layout.targetResolved && m_options.pointers != SerializerPointerValue)
+    {
+        layout.targetResolved = true;
+
+        try {
+            TypeLayout&  targetLayout = getLayout(layout.type->deref());
+
+            if (targetLayout.size > 0 && targetLayout.kind != ValueNull &&
+                (m_options.pointers == SerializerPointerFollowAll || targetLayout.kind == ValueUdt))
+            {
+                layout.targetLayout = &targetLayout;
+            }
+        }
+        catch (DbgException&)
+        {}
+    }
+
+    if (layout.targetLayout == 0 || value == 0 || depth >= m_options.maxDepth || m_written.find(value) != m_written.end())
+    {
+        m_writer.unsignedValue(value);
+        return;
+    }
+
+    std::vector<unsigned char>&  buffer = getBuffer(depth + 1);
+    buffer.resize(layout.targetLayout->size);
+
+    try {
+        readMemory(value, &buffer[0], buffer.size());
+    }
+    catch (MemoryException&)
+    {
+        m_writer.unsignedValue(value);
+        return;
+    }
+
+    m_written.insert(value);
+
+    m_writer.beginMap(2);
+    m_writer.key("address");
+    m_writer.unsignedValue(value);
+    m_writer.key("value");
+    writeValue(*layout.targetLayout, &buffer[0], value, depth + 1);
+    m_writer.endMap();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TypedVarSerializer::writeVirtualMember(TypeLayout& layout, const FieldLayout& field, MEMOFFSET_64 address, size_t depth)
+{
+    TypedVarPtr  fieldVar;
+
+    if (address != 0)
+    {
+        try {
+            fieldVar = loadTypedVar(layout.type, address)->getElement(field.index);
+        }
+        catch (DbgException&)
+        {}
+    }
+
+    if (fieldVar)
+        writeVar(fieldVar, depth + 1);
+    else
+        m_writer.nullValue();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+class StringSink : public SerializerSink
+{
+public:
+
+    explicit StringSink(std::string& output) :
+        m_output(output)
+    {}
+
+    virtual void write(const char* data, size_t length)
+    {
+        m_output.append(data, length);
+    }
+
+private:
+
+    std::string&  m_output;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // end nameless namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+void serializeTypedVar(const TypedVarPtr& var, SerializerSink& sink, const SerializerOptions& options)
+{
+    if (!var)
+        throw DbgException("typed variable is null");
+
+    boost::scoped_ptr<ValueWriter>  writer;
+
+    if (options.format == SerializerCbor)
+        writer.reset(new CborWriter(sink));
+    else
+        writer.reset(new JsonWriter(sink));
+
+    TypedVarSerializer(*writer, options).serialize(var);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::string serializeTypedVar(const TypedVarPtr& var, const SerializerOptions& options)
+{
+    std::string  output;
+    StringSink  sink(output);
+
+    serializeTypedVar(var, sink, options);
+
+    return output;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -106,8 +106,7 @@ TypedVarPtr StackFrameImpl::getTypedParam(unsigned long index)
     {
         unsigned long  regId = sym->getRegisterId();
 
-        return loadTypedVar(loadType(sym), getRegisterAccessor(m_cpuContext->getRegisterName(regId)));
-       // return loadTypedVar(loadType(sym), getVariantAccessor(m_cpuContext->getRegisterByIndex(regId)));
+        return loadTypedVar(loadType(sym), getRegisterVarAccessor(regId));
     }
     else if (location == LocIsRegRel)
     {
@@ -161,7 +160,7 @@ TypedVarPtr StackFrameImpl::getTypedParam(const std::wstring& paramName)
             {
                 unsigned long  regId = sym->getRegisterId();
 
-                return loadTypedVar(loadType(sym), getCacheAccessor(m_cpuContext->getRegisterByIndex(regId), L"@" + m_cpuContext->getRegisterName(regId)));
+                return loadTypedVar(loadType(sym), getRegisterVarAccessor(regId));
             }
             else if (location == LocIsRegRel)
             {
@@ -239,7 +238,7 @@ TypedVarPtr StackFrameImpl::getLocalVar(unsigned long index)
     {
         unsigned long  regId = sym->getRegisterId();
 
-        return loadTypedVar(loadType(sym), getRegisterAccessor(m_cpuContext->getRegisterName(regId)));
+        return loadTypedVar(loadType(sym), getRegisterVarAccessor(regId));
 
     }
     else if (location == LocIsRegRel)
@@ -294,7 +293,7 @@ TypedVarPtr StackFrameImpl::getLocalVar(const std::wstring& paramName)
             {
                 unsigned long  regId = sym->getRegisterId();
 
-                return loadTypedVar(loadType(sym), getCacheAccessor(m_cpuContext->getRegisterByIndex(regId), L"@" + m_cpuContext->getRegisterName(regId)));
+                return loadTypedVar(loadType(sym), getRegisterVarAccessor(regId));
             }
             else if (location == LocIsRegRel)
             {
@@ -708,6 +707,18 @@ SymbolPtrList  StackFrameImpl::getBlockStaticVars(SymbolPtr& sym)
 
 /////////////////////////////////////////////////////////////////////////////
 
+DataAccessorPtr StackFrameImpl::getRegisterVarAccessor(unsigned long regId)
+{
+    // the top frame registers are the thread registers: a variable is written to the thread
+    // and may be wider than a QWORD. The other frames read the unwound context
+    if ( m_number == 0 )
+        return getRegisterAccessor(m_cpuContext->getRegisterName(regId));
+
+    return getRegisterAccessor(m_cpuContext, regId);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+
 MEMOFFSET_64 StackFrameImpl::getOffset(unsigned long regRel, MEMOFFSET_REL relOffset)
 {
     switch( regRel )
@@ -121,6 +121,8 @@ private:
 
     MEMOFFSET_64 getOffset(unsigned long regRel, MEMOFFSET_REL relOffset);
 
+    DataAccessorPtr getRegisterVarAccessor(unsigned long regId);
+
     MEMOFFSET_64  m_ip;
     MEMOFFSET_64  m_ret;
     MEMOFFSET_64  m_fp;
@@ -8,4 +8,47 @@ namespace kdlib {
 std::string  wstrToStr(const std::wstring& str);
 std::wstring  strToWStr(const std::string& str);
 
+// appends the UTF-16 ( wchar_t on Windows ) or UTF-32 units as UTF-8
+template<typename T>
+void appendUtf8(std::string& out, const T* units, size_t length)
+{
+    for (size_t i = 0; i < length; ++i)
+    {
+        unsigned long  codePoint = static_cast<unsigned long>(units[i]);
+
+        if (sizeof(T) == 2 && codePoint >= 0xD800 && codePoint < 0xDC00 && i + 1 < length)
+        {
+            unsigned long  lowSurrogate = static_cast<unsigned long>(units[i + 1]);
+            if (lowSurrogate >= 0xDC00 && lowSurrogate < 0xE000)
+            {
+                codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (lowSurrogate - 0xDC00);
+                ++i;
+            }
+        }
+
+        if (codePoint < 0x80)
+        {
+            out += static_cast<char>(codePoint);
+        }
+        else if (codePoint < 0x800)
+        {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else if (codePoint < 0x10000)
+        {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        else
+        {
+            out += static_cast<char>(0xF0 | ((codePoint >> 18) & 0x07));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+}
+
 }
@@ -0,0 +1,176 @@
+#include "stdafx.h"
+
+#include <chrono>
+
+#include "kdlib/tracepoint.h"
+#include "kdlib/dbgengine.h"
+#include "kdlib/cpucontext.h"
+#include "kdlib/exceptions.h"
+
+#include "processmon.h"
+
+namespace kdlib {
+
+///////////////////////////////////////////////////////////////////////////////
+
+class TracepointSet::Tracepoint : public BreakpointCallback
+{
+public:
+
+    Tracepoint(TracepointSet* tracepointSet, size_t index, MEMOFFSET_64 offset) :
+        m_set(tracepointSet),
+        m_index(index),
+        m_hitCount(0)
+    {
+        m_breakpoint = softwareBreakPointSet(offset, this);
+
+        // the target is stopped while the set is filled: the mark is in place before the first hit
+        ProcessMonitor::setBreakpointTracepoint(m_breakpoint->getId());
+    }
+
+    ~Tracepoint()
+    {
+        try {
+            m_breakpoint->remove();
+        }
+        catch (DbgException&)
+        {}
+    }
+
+    virtual DebugCallbackResult onHit()
+    {
+        unsigned long long  hitCount = m_hitCount++;
+
+        if (hitCount % m_set->m_sampleRate == 0)
+            m_set->record(m_index);
+
+        return DebugCallbackProceed;
+    }
+
+    virtual void onRemove()
+    {}
+
+    MEMOFFSET_64 getOffset() const {
+        return m_breakpoint->getOffset();
+    }
+
+    unsigned long long getHitCount() const {
+        return m_hitCount;
+    }
+
+private:
+
+    TracepointSet*  m_set;
+    size_t  m_index;
+    BreakpointPtr  m_breakpoint;
+    boost::atomic<unsigned long long>  m_hitCount;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+TracepointSet::TracepointSet(const std::vector<std::wstring>& registerNames, unsigned long sampleRate, size_t capacity) :
+    m_sampleRate(sampleRate != 0 ? sampleRate : 1),
+    m_capacity(2),
+    m_writePos(0),
+    m_readPos(0),
+    m_dropped(0),
+    m_failed(0)
+{
+    if (registerNames.size() > maxTracepointRegisters)
+        throw DbgException("too many tracepoint registers");
+
+    for (const auto& registerName : registerNames)
+        m_registers.push_back(getRegisterIndex(registerName));
+
+    while (m_capacity < capacity)
+        m_capacity <<= 1;
+
+    m_samples.reset(new TracepointSample[m_capacity]);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TracepointSet::~TracepointSet()
+{
+    m_tracepoints.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t TracepointSet::add(MEMOFFSET_64 offset)
+{
+    size_t  index = m_tracepoints.size();
+    m_tracepoints.push_back(boost::make_shared<Tracepoint>(this, index, offset));
+    return index;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::vector<TracepointHits> TracepointSet::getHits() const
+{
+    std::vector<TracepointHits>  hits(m_tracepoints.size());
+
+    for (size_t i = 0; i < m_tracepoints.size(); ++i)
+    {
+        hits[i].offset = m_tracepoints[i]->getOffset();
+        hits[i].hitCount = m_tracepoints[i]->getHitCount();
+    }
+
+    return hits;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TracepointSet::record(size_t tracepoint)
+{
+    size_t  writePos = m_writePos.load(boost::memory_order_relaxed);
+
+    if (writePos - m_readPos.load(boost::memory_order_acquire) >= m_capacity)
+    {
+        m_dropped++;
+        return;
+    }
+
+    TracepointSample&  sample = m_samples[writePos & (m_capacity - 1)];
+
+    sample.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    sample.tracepoint = tracepoint;
+
+    // the hit is reported from the event dispatch: an error must not leave it,
+    // the slot is not published and is reused by the next sample
+    try {
+
+        sample.threadId = getCurrentThreadId();
+        sample.ip = getInstructionOffset();
+
+        for (size_t i = 0; i < maxTracepointRegisters; ++i)
+            sample.registers[i] = i < m_registers.size() ? getRegisterByIndex(m_registers[i]).asULongLong() : 0;
+    }
+    catch (DbgException&)
+    {
+        m_failed++;
+        return;
+    }
+
+    m_writePos.store(writePos + 1, boost::memory_order_release);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void TracepointSet::readSamples(std::vector<TracepointSample>& samples)
+{
+    size_t  readPos = m_readPos.load(boost::memory_order_relaxed);
+    size_t  writePos = m_writePos.load(boost::memory_order_acquire);
+
+    samples.reserve(samples.size() + writePos - readPos);
+
+    for (; readPos != writePos; ++readPos)
+        samples.push_back(m_samples[readPos & (m_capacity - 1)]);
+
+    m_readPos.store(readPos, boost::memory_order_release);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
@@ -22,31 +22,10 @@ namespace {
 
 using namespace kdlib;
 
-std::wstring printFieldValue( const TypeInfoPtr& fieldType, const TypedVarPtr& fieldVar )
+void printFieldValue( StrBuffer& buffer, const TypeInfoPtr& fieldType, const TypedVarPtr& fieldVar )
 {
-    std::wstringstream  sstr;
-
-    if ( fieldType->isBase() )
-    {
-        return dynamic_cast<const kdlib::TypedVarBase*>( fieldVar.get() )->printValue();
-    }
-
-    if ( fieldType->isPointer() )
-    {
-        return dynamic_cast<const kdlib::TypedVarPointer*>( fieldVar.get() )->printValue();
-    }
-
-    if (fieldType->isBitField())
-    {
-        return dynamic_cast<const kdlib::TypedVarBitField*>(fieldVar.get())->printValue();
-    }
-
-    if (fieldType->isEnum())
-    {
-        return dynamic_cast<const kdlib::TypedVarEnum*>(fieldVar.get())->printValue();
-    }
-
-    return L"";
+    if ( fieldType->isBase() || fieldType->isPointer() || fieldType->isBitField() || fieldType->isEnum() )
+        fieldVar->printValue(buffer);
 }
 
 
@@ -787,35 +766,55 @@ void TypedVarBase::setValue(const NumVariant& value)
 
 std::wstring TypedVarBase::str()
 {
-    std::wstringstream  sstr;
+    StrBuffer  buffer;
+    str(buffer);
+    return buffer.str();
+}
 
-    sstr << m_typeInfo->getName() << L" at " << m_varData->getLocationAsStr();
-    sstr << " Value: ";
+///////////////////////////////////////////////////////////////////////////////
+
+void TypedVarBase::str(StrBuffer& buffer)
+{
+    buffer.append(m_typeInfo->getName()).append(L" at ").append(m_varData->getLocationAsStr());
+    buffer.append(L" Value: ");
     try
     {
-        sstr << getValue().asHex() <<  L" (" << getValue().asStr() <<  L")";
+        NumVariant  value = getValue();
+        value.printHex(buffer);
+        buffer.append(L" (");
+        value.printStr(buffer);
+        buffer.append(L')');
     }
     catch (const MemoryException &)
     {
-        sstr << L"????";
+        buffer.append(L"????");
     }
-
-    return sstr.str();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 std::wstring TypedVarBase::printValue() const
 {
-    std::wstringstream  sstr;
+    StrBuffer  buffer(0x40);
+    printValue(buffer);
+    return buffer.str();
+}
 
+///////////////////////////////////////////////////////////////////////////////
+
+void TypedVarBase::printValue(StrBuffer& buffer) const
+{
     try {
-        sstr << getValue().asHex() <<  L" (" << getValue().asStr() <<  L")";
-        return sstr.str();
+        NumVariant  value = getValue();
+        value.printHex(buffer);
+        buffer.append(L" (");
+        value.printStr(buffer);
+        buffer.append(L')');
+        return;
     } catch(MemoryException& )
     {}
 
-    return L"Invalid memory";
+    buffer.append(L"Invalid memory");
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1072,9 +1071,16 @@ MEMDISPLACEMENT TypedVarUdt::getVirtualBaseDisplacement( size_t index )
 
 std::wstring TypedVarUdt::str()
 {
-    std::wstringstream  sstr;
+    StrBuffer  buffer(0x1000);
+    str(buffer);
+    return buffer.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
 
-    sstr << L"struct/class: " << m_typeInfo->getName() << L" at " <<  m_varData->getLocationAsStr() << std::endl;
+void TypedVarUdt::str(StrBuffer& buffer)
+{
+    buffer.append(L"struct/class: ").append(m_typeInfo->getName()).append(L" at ").append(m_varData->getLocationAsStr()).append(L'\n');
     
     for ( size_t i = 0; i < m_typeInfo->getElementCount(); ++i )
     {
@@ -1092,8 +1098,8 @@ std::wstring TypedVarUdt::str()
             if ( staticOffset != 0 )
                 fieldVar = loadTypedVar( fieldType, staticOffset );
 
-            sstr << L"   =" << std::right << std::setw(10) << std::setfill(L'0') << std::hex << staticOffset;
-            sstr << L" " << std::left << std::setw(18) << std::setfill(L' ') << m_typeInfo->getElementName(i) << ':';
+            buffer.append(L"   =").appendHex(staticOffset, 10);
+            buffer.append(L' ').appendPadded(m_typeInfo->getElementName(i), 18).append(L':');
         }
         else
         {
@@ -1105,21 +1111,21 @@ std::wstring TypedVarUdt::str()
             }
 
             fieldVar = loadTypedVar( fieldType, m_varData->copy(fieldOffset, fieldType->getSize()) );
-            sstr << L"   +" << std::right << std::setw(4) << std::setfill(L'0') << std::hex << fieldOffset;
-            sstr << L" " << std::left << std::setw(24) << std::setfill(L' ') << m_typeInfo->getElementName(i) << ':';
+            buffer.append(L"   +").appendHex(fieldOffset, 4);
+            buffer.append(L' ').appendPadded(m_typeInfo->getElementName(i), 24).append(L':');
         }
 
-        sstr << " " << std::left << fieldType->getName();
+        buffer.append(L' ').append(fieldType->getName());
+
+        buffer.append(L"   ");
 
         if ( fieldVar )
-            sstr << L"   " << ::printFieldValue( fieldType, fieldVar );
+            ::printFieldValue( buffer, fieldType, fieldVar );
         else
-            sstr << L"   " << L"failed to get value";
+            buffer.append(L"failed to get value");
 
-        sstr << std::endl;
+        buffer.append(L'\n');
     }
-
-    return sstr.str();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1133,30 +1139,47 @@ TypedVarPtr TypedVarPointer::deref()
 
 std::wstring TypedVarPointer::str()
 {
-    std::wstringstream   sstr;
+    StrBuffer  buffer;
+    str(buffer);
+    return buffer.str();
+}
 
-    sstr << L"Ptr " << m_typeInfo->getName() << L" at " <<  m_varData->getLocationAsStr();
-    sstr << L" Value: " <<  printValue();
+///////////////////////////////////////////////////////////////////////////////
 
-    return sstr.str();
+void TypedVarPointer::str(StrBuffer& buffer)
+{
+    buffer.append(L"Ptr ").append(m_typeInfo->getName()).append(L" at ").append(m_varData->getLocationAsStr());
+    buffer.append(L" Value: ");
+    printValue(buffer);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 std::wstring TypedVarPointer::printValue() const
 {
-    std::wstringstream   sstr;
+    StrBuffer  buffer(0x40);
+    printValue(buffer);
+    return buffer.str();
+}
 
+///////////////////////////////////////////////////////////////////////////////
+
+void TypedVarPointer::printValue(StrBuffer& buffer) const
+{
     try {
 
-         sstr << getValue().asHex() <<  L" (" << getValue().asStr() <<  L")";
-         return sstr.str();
+        NumVariant  value = getValue();
+        value.printHex(buffer);
+        buffer.append(L" (");
+        value.printStr(buffer);
+        buffer.append(L')');
+        return;
 
     }
     catch(MemoryException&)
     {}
 
-    return L"Invalid memory";
+    buffer.append(L"Invalid memory");
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1246,74 +1269,104 @@ void TypedVarBitField::setValue(const NumVariant& value)
 
 std::wstring TypedVarBitField::str()
 {
-    std::wstringstream   sstr;
+    StrBuffer  buffer;
+    str(buffer);
+    return buffer.str();
+}
 
-    sstr << L"BitField " << m_typeInfo->getName() << L" at " <<  m_varData->getLocationAsStr();
-    sstr << L" Value: " <<  printValue();
+///////////////////////////////////////////////////////////////////////////////
 
-    return sstr.str();
+void TypedVarBitField::str(StrBuffer& buffer)
+{
+    buffer.append(L"BitField ").append(m_typeInfo->getName()).append(L" at ").append(m_varData->getLocationAsStr());
+    buffer.append(L" Value: ");
+    printValue(buffer);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 std::wstring TypedVarBitField::printValue() const
 {
-    std::wstringstream  sstr;
+    StrBuffer  buffer(0x40);
+    printValue(buffer);
+    return buffer.str();
+}
 
+///////////////////////////////////////////////////////////////////////////////
+
+void TypedVarBitField::printValue(StrBuffer& buffer) const
+{
     try {
-        sstr << getValue().asHex() << L" (" << getValue().asStr() << L")";
-        return sstr.str();
+        NumVariant  value = getValue();
+        value.printHex(buffer);
+        buffer.append(L" (");
+        value.printStr(buffer);
+        buffer.append(L')');
+        return;
     }
     catch (MemoryException&)
     {
     }
 
-    return L"Invalid memory";
+    buffer.append(L"Invalid memory");
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 std::wstring TypedVarEnum::str()
 {
-    std::wstringstream       sstr;
+    StrBuffer  buffer;
+    str(buffer);
+    return buffer.str();
+}
 
-    sstr << L"enum: " << m_typeInfo->getName() << L" at " <<  m_varData->getLocationAsStr();
-    sstr << L" Value: " << printValue();
+///////////////////////////////////////////////////////////////////////////////
 
-    return sstr.str();
+void TypedVarEnum::str(StrBuffer& buffer)
+{
+    buffer.append(L"enum: ").append(m_typeInfo->getName()).append(L" at ").append(m_varData->getLocationAsStr());
+    buffer.append(L" Value: ");
+    printValue(buffer);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 std::wstring TypedVarEnum::printValue() const
 {
-    std::wstringstream   sstr;
+    StrBuffer  buffer(0x40);
+    printValue(buffer);
+    return buffer.str();
+}
+
+///////////////////////////////////////////////////////////////////////////////
 
+void TypedVarEnum::printValue(StrBuffer& buffer) const
+{
     try {
 
-        unsigned long   ulongVal1 = getValue().asULong();
+        NumVariant  value = getValue();
+        unsigned long   ulongVal1 = value.asULong();
 
         for ( size_t i = 0; i < m_typeInfo->getElementCount(); ++i )
         {
             unsigned long   ulongVal2 = m_typeInfo->getElement(i)->getValue().asULong();
             if ( ulongVal1 == ulongVal2 )
             {
-                sstr << m_typeInfo->getElementName(i);
-                sstr << L" (" << getValue().asHex() << L")";
-
-                return sstr.str();
+                buffer.append(m_typeInfo->getElementName(i));
+                buffer.append(L" (");
+                value.printHex(buffer);
+                buffer.append(L')');
+                return;
             }
         }
 
-        sstr << getValue().asHex();
-        sstr << L" ( No matching name )";
+        value.printHex(buffer);
+        buffer.append(L" ( No matching name )");
     }
     catch( MemoryException& )
     {
-        sstr << L"????";
+        buffer.append(L"????");
     }
-
-    return sstr.str();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1334,6 +1387,20 @@ TypedValue  TypedVarFunction::call(const TypedValueList& arglst)
     if ( getAddress() == 0 )
         throw TypeException(L"function has no body");
 
+    FunctionCallContext  context;
+
+    return call(context, arglst);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypedValue  TypedVarFunction::call(FunctionCallContext& context, const TypedValueList& arglst)
+{
+    if ( getAddress() == 0 )
+        throw TypeException(L"function has no body");
+
+    context.beginCall();
+
     switch (getCPUMode() )
     {
         case CPU_I386:
@@ -1341,16 +1408,16 @@ TypedValue  TypedVarFunction::call(const TypedValueList& arglst)
             switch( m_typeInfo->getCallingConvention() ) 
             {
                 case CallConv_NearC:
-                    return callCdecl(arglst);
+                    return callCdecl(context, arglst);
 
                 case CallConv_NearStd:
-                    return callStd(arglst);
+                    return callStd(context, arglst);
 
                 case CallConv_NearFast:
-                    return callFast(arglst);
+                    return callFast(context, arglst);
 
                 case CallConv_ThisCall:
-                    return callThis(arglst);
+                    return callThis(context, arglst);
 
                 default:
                     throw TypeException(L"unsupported calling convention");
@@ -1359,7 +1426,7 @@ TypedValue  TypedVarFunction::call(const TypedValueList& arglst)
             break;
         }
         case CPU_AMD64:
-            return callX64(arglst);
+            return callX64(context, arglst);
     }
 
     throw DbgException( "Unknown processor type" );
@@ -1413,35 +1480,25 @@ TypedValueList TypedVarFunction::castArgs(const TypedValueList& arglst)
 
 /////////////////////////////////////////////////////////////////////////////
 
-TypedValue TypedVarFunction::callCdecl(const TypedValueList& arglst)
+TypedValue TypedVarFunction::callCdecl(FunctionCallContext& context, const TypedValueList& arglst)
 {
-    CPUContextAutoRestore  cpuContext;
-
     TypedValueList  args = castArgs(arglst);
 
     TypeInfoPtr  retType =  m_typeInfo->getReturnType();
 
-    MEMOFFSET_64   retOffset = ( !retType->isVoid() && retType->getSize() > 8 ) ? stackAlloc(retType->getSize()) : 0UL;
+    MEMOFFSET_64   retOffset = ( !retType->isVoid() && retType->getSize() > 8 ) ? context.stackAlloc(retType->getSize()) : 0UL;
 
     for ( TypedValueList::const_reverse_iterator  it = args.rbegin(); it != args.rend(); ++it)
     {
-        size_t  argSize = it->getSize();
-        it->writeBytes( getMemoryAccessor( stackAlloc( argSize ), argSize ) );
+        context.pushInStack( *it );
     }
 
     if ( retOffset > 0 )
     {
-        if ( retType->getPtrSize() == 4 )
-        {
-            pushInStack( static_cast<unsigned long>(retOffset) );
-        }
-        else
-        {
-            pushInStack( retOffset );
-        }
+        context.pushInStack( retOffset, retType->getPtrSize() );
     }
 
-    makeCallx86();
+    context.call( getAddress() );
 
     if ( retOffset > 0 )
     {
@@ -1488,22 +1545,20 @@ TypedValue TypedVarFunction::callCdecl(const TypedValueList& arglst)
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TypedValue TypedVarFunction::callStd(const TypedValueList& args)
+TypedValue TypedVarFunction::callStd(FunctionCallContext& context, const TypedValueList& args)
 {
-    return callCdecl(args);
+    return callCdecl(context, args);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TypedValue TypedVarFunction::callFast(const TypedValueList& arglst)
+TypedValue TypedVarFunction::callFast(FunctionCallContext& context, const TypedValueList& arglst)
 {
-    CPUContextAutoRestore  cpuContext;
-
     TypedValueList  args = castArgs(arglst);
 
     TypeInfoPtr  retType =  m_typeInfo->getReturnType();
 
-    MEMOFFSET_64   retOffset = ( !retType->isVoid() && retType->getSize() > 8 ) ? stackAlloc(retType->getSize()) : 0UL;
+    MEMOFFSET_64   retOffset = ( !retType->isVoid() && retType->getSize() > 8 ) ? context.stackAlloc(retType->getSize()) : 0UL;
 
     if ( retOffset > 0 )
     {
@@ -1513,25 +1568,23 @@ TypedValue TypedVarFunction::callFast(const TypedValueList& arglst)
     int i = args.size() - 1;
     for ( TypedValueList::reverse_iterator  it = args.rbegin(); it != args.rend(); ++it, --i)
     {
-        size_t  argSize = it->getSize();
-
         switch(i)
         {
         case 0:
             if ( it->getSize() <= 4 )
-                it->writeBytes(getRegisterAccessor(L"edx"));
+                context.setRegister(L"edx", *it);
             break;
 
         case 1:
             if ( it->getSize() <= 4 )
-                it->writeBytes(getRegisterAccessor(L"ecx"));
+                context.setRegister(L"ecx", *it);
             break;
         }
 
-        it->writeBytes( getMemoryAccessor( stackAlloc( argSize ), argSize ) );
+        context.pushInStack( *it );
     }
 
-    makeCallx86();
+    context.call( getAddress() );
 
     if ( retOffset > 0 )
     {
@@ -1578,39 +1631,28 @@ TypedValue TypedVarFunction::callFast(const TypedValueList& arglst)
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TypedValue TypedVarFunction::callThis(const TypedValueList& arglst)
+TypedValue TypedVarFunction::callThis(FunctionCallContext& context, const TypedValueList& arglst)
 {
-    CPUContextAutoRestore  cpuContext;
-
     TypedValueList  args = castArgs(arglst);
 
     TypeInfoPtr  retType =  m_typeInfo->getReturnType();
 
-    MEMOFFSET_64   retOffset = ( !retType->isVoid() &&  retType->getSize() > 8 ) ? stackAlloc(retType->getSize()) : 0UL;
+    MEMOFFSET_64   retOffset = ( !retType->isVoid() &&  retType->getSize() > 8 ) ? context.stackAlloc(retType->getSize()) : 0UL;
 
     for ( TypedValueList::const_reverse_iterator  it = args.rbegin(); it != args.rend(); ++it)
     {
-        size_t  argSize = it->getSize();
-
         if ( it + 1 == args.rend() )
-            it->writeBytes(getRegisterAccessor(L"ecx"));
+            context.setRegister(L"ecx", *it);
         else
-            it->writeBytes( getMemoryAccessor( stackAlloc( argSize ), argSize ) );
+            context.pushInStack( *it );
     }
 
     if ( retOffset > 0 )
     {
-        if ( retType->getPtrSize() == 4 )
-        {
-            pushInStack( static_cast<unsigned long>(retOffset) );
-        }
-        else
-        {
-            pushInStack( retOffset );
-        }
+        context.pushInStack( retOffset, retType->getPtrSize() );
     }
    
-    makeCallx86();
+    context.call( getAddress() );
 
     if ( retOffset > 0 )
     {
@@ -1658,10 +1700,8 @@ TypedValue TypedVarFunction::callThis(const TypedValueList& arglst)
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TypedValue TypedVarFunction::callX64(const TypedValueList& arglst)
+TypedValue TypedVarFunction::callX64(FunctionCallContext& context, const TypedValueList& arglst)
 {
-    CPUContextAutoRestore  cpuContext;
-
     TypedValueList  args = castArgs(arglst);
 
     TypeInfoPtr  retType =  m_typeInfo->getReturnType();
@@ -1671,14 +1711,12 @@ TypedValue TypedVarFunction::callX64(const TypedValueList& arglst)
     {
         if ( i < 4 && it->getSize() > 8 )
         {
-            size_t  argSize = it->getSize();
-            MEMOFFSET_64  stackOffset = stackAlloc( argSize );
-            it->writeBytes( getMemoryAccessor( stackOffset, argSize ) );
+            MEMOFFSET_64  stackOffset = context.pushInStack( *it );
             *it = TypedValue(stackOffset);
         }
     }
 
-    MEMOFFSET_64   retOffset = ( !retType->isVoid() && retType->getSize() > 8 ) ? stackAlloc(retType->getSize()) : 0UL;
+    MEMOFFSET_64   retOffset = ( !retType->isVoid() && retType->getSize() > 8 ) ? context.stackAlloc(retType->getSize()) : 0UL;
 
     if ( retOffset > 0 )
     {
@@ -1686,46 +1724,44 @@ TypedValue TypedVarFunction::callX64(const TypedValueList& arglst)
     }
 
     // align arguments to 16 byte 
-    MEMOFFSET_64  stkOffset = getStackOffset();
+    MEMOFFSET_64  stkOffset = context.getStackOffset();
     stkOffset = stkOffset / 16 * 16;
     if ( ( args.size() <= 4 ? 4 : args.size() ) % 2 != 0 )
     {
         //arg count: 5,7,9,...
         stkOffset -= 8;
     }
-    setStackOffset(stkOffset);
+    context.setStackOffset(stkOffset);
 
     i = args.size() - 1;
     for ( TypedValueList::reverse_iterator  it = args.rbegin(); it != args.rend(); ++it, --i)
     {
-        size_t  argSize = it->getSize();
-
         switch(i)
         {
         case 0:
-            it->writeBytes(getRegisterAccessor(L"rcx"));
+            context.setRegister(L"rcx", *it);
             break;
 
         case 1:
-            it->writeBytes(getRegisterAccessor(L"rdx"));
+            context.setRegister(L"rdx", *it);
             break;
 
         case 2:
-            it->writeBytes(getRegisterAccessor(L"r8"));
+            context.setRegister(L"r8", *it);
             break;
 
         case 3:
-            it->writeBytes(getRegisterAccessor(L"r9"));
+            context.setRegister(L"r9", *it);
             break;
 
         default:
-            it->writeBytes( getMemoryAccessor( stackAlloc( argSize ), argSize ) );
+            context.pushInStack( *it );
         }
     }
 
-    stackAlloc(4*8);
+    context.stackAlloc(4*8);
 
-    makeCallx64();
+    context.call( getAddress() );
 
     if ( retOffset > 0 )
     {
@@ -1772,54 +1808,141 @@ TypedValue TypedVarFunction::callX64(const TypedValueList& arglst)
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void TypedVarFunction::makeCallx86()
+FunctionCallContext::FunctionCallContext() :
+    m_cpuContext( loadCPUContext() )
 {
-    MEMOFFSET_64   ip = getInstructionOffset();
+    m_machineWord = m_cpuContext->getCPUMode() == CPU_AMD64 ? 8 : 4;
+    m_returnOffset = m_cpuContext->getIP();
+    m_savedStackOffset = m_cpuContext->getSP();
+    m_stackOffset = m_savedStackOffset;
 
-    ScopedBreakpoint  bp = softwareBreakPointSet(ip);
+    m_ipIndex = kdlib::getRegisterIndex( m_machineWord == 8 ? L"rip" : L"eip" );
+    m_spIndex = kdlib::getRegisterIndex( m_machineWord == 8 ? L"rsp" : L"esp" );
 
-    pushInStack( static_cast<unsigned long>(ip));
+    m_breakpoint = softwareBreakPointSet(m_returnOffset);
+}
 
-    setInstructionOffset( getAddress() );
+///////////////////////////////////////////////////////////////////////////////
 
-    while( getInstructionOffset() != ip )
-    {
-        targetGo();
+FunctionCallContext::~FunctionCallContext()
+{
+    m_breakpoint->remove();
+    m_cpuContext->restore();
+}
 
-        if ( getLastEventType() == EventTypeException )
-        {
-            ExceptionInfo  excInfo = getLastException();
+///////////////////////////////////////////////////////////////////////////////
 
-            if ( !excInfo.firstChance )
-            {
+void FunctionCallContext::beginCall()
+{
+    m_stackOffset = m_savedStackOffset;
+    m_frame.clear();
+    m_regIndices.clear();
+    m_regValues.clear();
+}
 
-                std::wstringstream sstr;
-                sstr << L"Exception occured during call function" << std::endl;
-                sstr << L"   Exception address: 0x" << std::hex << excInfo.exceptionAddress << std::endl;
-                sstr << L"   Exception code: 0x" << std::hex << excInfo.exceptionCode << std::endl;
-                sstr << L"   Exception record: 0x" << std::hex << excInfo.exceptionRecord << std::endl;
+///////////////////////////////////////////////////////////////////////////////
 
-                throw CallException( sstr.str() );
-            }
-        }
-    }
+void FunctionCallContext::setStackOffset(MEMOFFSET_64 offset)
+{
+    if ( offset > m_stackOffset )
+        throw DbgException("stack offset is above the call frame");
+
+    m_frame.insert( m_frame.begin(), static_cast<size_t>(m_stackOffset - offset), 0 );
+    m_stackOffset = offset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MEMOFFSET_64 FunctionCallContext::stackAlloc(size_t byteCount)
+{
+    byteCount = ( ( byteCount + m_machineWord - 1 ) / m_machineWord ) * m_machineWord;
+
+    setStackOffset( m_stackOffset - byteCount );
+
+    return m_stackOffset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MEMOFFSET_64 FunctionCallContext::pushInStack(const TypedValue& value)
+{
+    size_t  byteCount = value.getSize();
+
+    MEMOFFSET_64  offset = stackAlloc(byteCount);
+
+    DataAccessorPtr  dataRange = getCacheAccessor(byteCount);
+    value.writeBytes(dataRange);
+
+    std::vector<unsigned char>  buffer(byteCount);
+    dataRange->readBytes(buffer, byteCount);
+
+    std::copy( buffer.begin(), buffer.end(), m_frame.begin() );
+
+    return offset;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FunctionCallContext::pushInStack(MEMOFFSET_64 value, size_t byteCount)
+{
+    stackAlloc(byteCount);
+
+    for ( size_t i = 0; i < byteCount && i < sizeof(value); ++i )
+        m_frame[i] = static_cast<unsigned char>( value >> ( 8 * i ) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void FunctionCallContext::setRegister(const std::wstring& name, const TypedValue& value)
+{
+    size_t  byteCount = value.getSize();
+
+    if ( byteCount > sizeof(unsigned long long) )
+        throw TypeException(L"argument does not fit a register");
+
+    DataAccessorPtr  dataRange = getCacheAccessor(byteCount);
+    value.writeBytes(dataRange);
+
+    std::vector<unsigned char>  buffer(byteCount);
+    dataRange->readBytes(buffer, byteCount);
+
+    unsigned long long  regValue = 0;
+    for ( size_t i = 0; i < byteCount; ++i )
+        regValue |= static_cast<unsigned long long>(buffer[i]) << ( 8 * i );
+
+    m_regIndices.push_back( getRegisterIndex(name) );
+    m_regValues.push_back( regValue );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+unsigned long FunctionCallContext::getRegisterIndex(const std::wstring& name)
+{
+    std::map<std::wstring, unsigned long>::const_iterator  it = m_registerIndices.find(name);
+    if ( it != m_registerIndices.end() )
+        return it->second;
+
+    unsigned long  index = kdlib::getRegisterIndex(name);
+    m_registerIndices.insert( std::make_pair(name, index) );
+    return index;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void TypedVarFunction::makeCallx64()
+void FunctionCallContext::call(MEMOFFSET_64 offset)
 {
-    StackPtr  stk = getStack();
-    StackFramePtr  lastFrame = stk->getFrame(0);
-    MEMOFFSET_64   ip = lastFrame->getIP();
+    pushInStack( m_returnOffset, m_machineWord );
 
-    ScopedBreakpoint  bp = softwareBreakPointSet(ip);
+    writeMemory( m_stackOffset, &m_frame.front(), m_frame.size() );
 
-    pushInStack(ip);
+    m_regIndices.push_back( m_spIndex );
+    m_regValues.push_back( m_stackOffset );
+    m_regIndices.push_back( m_ipIndex );
+    m_regValues.push_back( offset );
 
-    setInstructionOffset( getAddress() );
+    setRegisterValues( m_regIndices, m_regValues );
 
-    while( getInstructionOffset() != ip )
+    while( getInstructionOffset() != m_returnOffset )
     {
         targetGo();
 
@@ -1844,113 +1967,182 @@ void TypedVarFunction::makeCallx64()
 
 ///////////////////////////////////////////////////////////////////////////////
 
+FunctionCallSite::FunctionCallSite(const TypedVarPtr& function) :
+    m_function(function)
+{
+    if ( !dynamic_cast<TypedVarFunction*>( m_function.get() ) )
+        throw TypeException(L"is not a function");
+
+    if ( m_function->getAddress() == 0 )
+        throw TypeException(L"function has no body");
+
+    m_context.reset( new FunctionCallContext() );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+FunctionCallSite::~FunctionCallSite()
+{
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+TypedValue FunctionCallSite::call(const TypedValueList& arglst)
+{
+    return static_cast<TypedVarFunction*>( m_function.get() )->call(*m_context, arglst);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 SymbolFunction::SymbolFunction( const SymbolPtr& symbol ) :
     TypedVarFunction( loadType( symbol ), getMemoryAccessor( symbol->getVa(), 0 ), ::getSymbolName(symbol) ),
-    m_symbol( symbol )
+    m_symbol( symbol ),
+    m_childrenLoaded( false )
 {
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-SymbolPtr SymbolFunction::getChildSymbol(size_t index)
+SymbolFunction::ChildData SymbolFunction::getChildData(const SymbolPtr& symbol)
 {
-    SymbolPtrList  paramLst = m_symbol->findChildren(SymTagData);
-    if (paramLst.size() < index)
-        throw IndexException(index);
+    ChildData  childData;
+
+    childData.symbol = symbol;
+    childData.name = symbol->getName();
+    childData.dataKind = symbol->getDataKind();
+    childData.locType = symbol->getLocType();
+    childData.offset = 0;
+    childData.regRelativeId = 0;
+    childData.registerId = 0;
 
-    SymbolPtrList::iterator itVar = paramLst.begin();
-    for (size_t i = 0; itVar != paramLst.end(); ++itVar)
+    if ( childData.locType == LocIsRegRel )
     {
-        unsigned long  dataKind = (*itVar)->getDataKind();
+        childData.offset = symbol->getOffset();
+        childData.regRelativeId = symbol->getRegRelativeId();
+    }
+    else if ( childData.locType == LocIsEnregistered )
+    {
+        childData.registerId = symbol->getRegisterId();
+    }
 
-        if (dataKind == DataIsParam || dataKind == DataIsObjectPtr)
-        {
-            if (i == index)
-            {
-                return *itVar;
-            }
+    return childData;
+}
 
-            i++;
-        }
+///////////////////////////////////////////////////////////////////////////////
+
+void SymbolFunction::checkChildren()
+{
+    if ( m_childrenLoaded )
+        return;
+
+    SymbolPtrList  childLst = m_symbol->findChildren(SymTagData);
+
+    std::vector<ChildData>  children;
+    std::vector<size_t>  params;
+    std::map<std::wstring, size_t>  childNames;
+
+    children.reserve( childLst.size() );
+
+    for ( SymbolPtrList::iterator  it = childLst.begin(); it != childLst.end(); ++it )
+    {
+        children.push_back( getChildData(*it) );
+
+        const ChildData&  childData = children.back();
+
+        if ( childData.dataKind == DataIsParam || childData.dataKind == DataIsObjectPtr )
+            params.push_back( children.size() - 1 );
+
+        childNames.insert( std::make_pair( childData.name, children.size() - 1 ) );
     }
 
-    throw IndexException(index);
+    m_children.swap(children);
+    m_params.swap(params);
+    m_childNames.swap(childNames);
+
+    m_childrenLoaded = true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-MEMOFFSET_REL SymbolFunction::getElementOffset( size_t index )
+const SymbolFunction::ChildData& SymbolFunction::getParam(size_t index)
 {
-    SymbolPtr  paramSym = getChildSymbol(index);
+    checkChildren();
 
-    return paramSym->getOffset();
+    if ( index >= m_params.size() )
+        throw IndexException(index);
+
+    return m_children[ m_params[index] ];
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-RELREG_ID SymbolFunction::getElementOffsetRelativeReg(size_t index )
+const SymbolFunction::ChildData& SymbolFunction::getChild(const std::wstring& name)
+{
+    checkChildren();
+
+    std::map<std::wstring, size_t>::const_iterator  it = m_childNames.find(name);
+    if ( it != m_childNames.end() )
+        return m_children[ it->second ];
+
+    // not a data child: it is searched by the symbol once and is kept with the others
+    m_children.push_back( getChildData( m_symbol->getChildByName(name) ) );
+    m_childNames.insert( std::make_pair( name, m_children.size() - 1 ) );
+
+    return m_children.back();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+MEMOFFSET_REL SymbolFunction::getElementOffset( size_t index )
 {
-    SymbolPtr  paramSym = getChildSymbol(index);
+    return getParam(index).getOffset();
+}
 
-    return paramSym->getRegRelativeId();
+///////////////////////////////////////////////////////////////////////////////
+
+RELREG_ID SymbolFunction::getElementOffsetRelativeReg(size_t index )
+{
+    return getParam(index).getRegRelativeId();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 VarStorage SymbolFunction::getElementStorage(const std::wstring& fieldName)
 {
-    SymbolPtr  paramSym = m_symbol->getChildByName(fieldName);
-    if (paramSym->getLocType() == LocIsEnregistered)
-        return RegisterVar;
-    return MemoryVar;
+    return getChild(fieldName).getStorage();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 VarStorage SymbolFunction::getElementStorage(size_t index)
 {
-    SymbolPtr  paramSym = getChildSymbol(index);
-    if (paramSym->getLocType() == LocIsEnregistered)
-        return RegisterVar;
-    return MemoryVar;
+    return getParam(index).getStorage();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 MEMOFFSET_REL SymbolFunction::getElementOffset( const std::wstring& paramName )
 {
-    SymbolPtr  paramSym = m_symbol->getChildByName(paramName);
-
-    return paramSym->getOffset();
+    return getChild(paramName).getOffset();
 }
  
 ///////////////////////////////////////////////////////////////////////////////
 
 RELREG_ID SymbolFunction::getElementOffsetRelativeReg(const std::wstring& paramName )
 {
-    SymbolPtr  paramSym = m_symbol->getChildByName(paramName);
-
-    return paramSym->getRegRelativeId();
+    return getChild(paramName).getRegRelativeId();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 size_t SymbolFunction::getElementIndex(const std::wstring& paramName )
 {
-    SymbolPtrList  paramLst = m_symbol->findChildren( SymTagData );
+    checkChildren();
 
-    SymbolPtrList::iterator itVar = paramLst.begin();
-
-    for ( size_t i = 0; itVar != paramLst.end(); ++itVar )
+    for ( size_t i = 0; i < m_params.size(); ++i )
     {
-        unsigned long  dataKind = (*itVar)->getDataKind();
-
-        if (dataKind == DataIsParam || dataKind == DataIsObjectPtr)
-        {
-            if (  (*itVar)->getName() == paramName )
-                return i;
-            i++;
-        }
+        if ( m_children[ m_params[i] ].name == paramName )
+            return i;
     }
 
     throw DbgException("parameter is not found");
@@ -1960,8 +2152,7 @@ size_t SymbolFunction::getElementIndex(const std::wstring& paramName )
 
 std::wstring SymbolFunction::getElementName( size_t index )
 {
-    SymbolPtr  paramSym = getChildSymbol(index);
-    return  paramSym->getName();
+    return getParam(index).name;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1983,17 +2174,14 @@ MEMOFFSET_64 SymbolFunction::getDebugXImpl(SymTags symTag) const
 
 unsigned long SymbolFunction::getElementReg(const std::wstring& fieldName)
 {
-    SymbolPtr  paramSym = m_symbol->getChildByName(fieldName);
-
-    return paramSym->getRegRelativeId();
+    return getChild(fieldName).getRegRelativeId();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 unsigned long SymbolFunction::getElementReg(size_t index)
 {
-    SymbolPtr  paramSym = getChildSymbol(index);
-    return paramSym->getRegisterId();
+    return getParam(index).getRegisterId();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2082,11 +2270,11 @@ TypedVarMethodBound::TypedVarMethodBound(
 
 ///////////////////////////////////////////////////////////////////////////////
 
-TypedValue TypedVarMethodBound::call(const TypedValueList& arglst)
+TypedValue TypedVarMethodBound::call(FunctionCallContext& context, const TypedValueList& arglst)
 {
     TypedValueList  argListWithThis = arglst;
     argListWithThis.insert( argListWithThis.begin(), m_this );
-    return TypedVarFunction::call(argListWithThis);
+    return TypedVarFunction::call(context, argListWithThis);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
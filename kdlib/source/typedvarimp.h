@@ -3,6 +3,8 @@
 #include <kdlib/typedvar.h>
 #include <kdlib/exceptions.h>
 #include <kdlib/memaccess.h>
+#include <kdlib/cpucontext.h>
+#include <kdlib/breakpoint.h>
 
 namespace kdlib {
 
@@ -230,6 +232,8 @@ public:
 
     std::wstring printValue() const;
 
+    void printValue(StrBuffer& buffer) const;
+
 protected:
 
     virtual NumVariant getValue() const;
@@ -238,6 +242,8 @@ protected:
 
 
     virtual std::wstring str();
+
+    virtual void str(StrBuffer& buffer);
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -289,6 +295,8 @@ protected:
 
     virtual std::wstring str();
 
+    virtual void str(StrBuffer& buffer);
+
     virtual TypedVarPtr getMethod( const std::wstring &name, const std::wstring&  prototype = L"");
     
     virtual TypedVarPtr getMethod( const std::wstring &name, TypeInfoPtr prototype)
@@ -349,9 +357,12 @@ public:
 
     virtual std::wstring str();
 
+    virtual void str(StrBuffer& buffer);
 
     std::wstring printValue() const;
 
+    void printValue(StrBuffer& buffer) const;
+
 private:
 
     MEMOFFSET_64  getPtrValue() const {
@@ -401,7 +412,11 @@ public:
 
     virtual std::wstring str();
 
+    virtual void str(StrBuffer& buffer);
+
     std::wstring printValue() const;
+
+    void printValue(StrBuffer& buffer) const;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -419,7 +434,65 @@ public:
 
     virtual std::wstring str();
 
+    virtual void str(StrBuffer& buffer);
+
     std::wstring printValue() const;
+
+    void printValue(StrBuffer& buffer) const;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// The state of the target function calls from the current instruction: the CPU context is
+// saved and the return breakpoint is set once and are kept for all the calls. The frame of
+// each call is built here and goes to the target with one memory and one register write
+class FunctionCallContext : private boost::noncopyable
+{
+public:
+
+    FunctionCallContext();
+
+    // removes the return breakpoint and restores the CPU context
+    ~FunctionCallContext();
+
+    // starts the frame from the stack pointer of the saved context
+    void beginCall();
+
+    MEMOFFSET_64 getStackOffset() const {
+        return m_stackOffset;
+    }
+
+    // moves the stack pointer down only, the gap is a part of the frame
+    void setStackOffset(MEMOFFSET_64 offset);
+
+    MEMOFFSET_64 stackAlloc(size_t byteCount);
+    MEMOFFSET_64 pushInStack(const TypedValue& value);
+    void pushInStack(MEMOFFSET_64 value, size_t byteCount);
+
+    void setRegister(const std::wstring& name, const TypedValue& value);
+
+    // writes the frame, jumps to the function and runs the target until the function returns
+    void call(MEMOFFSET_64 offset);
+
+private:
+
+    unsigned long getRegisterIndex(const std::wstring& name);
+
+    CPUContextPtr  m_cpuContext;
+    BreakpointPtr  m_breakpoint;
+
+    size_t  m_machineWord;
+    MEMOFFSET_64  m_returnOffset;
+    MEMOFFSET_64  m_savedStackOffset;
+    unsigned long  m_ipIndex;
+    unsigned long  m_spIndex;
+    std::map<std::wstring, unsigned long>  m_registerIndices;
+
+    // the frame bytes from m_stackOffset up
+    MEMOFFSET_64  m_stackOffset;
+    std::vector<unsigned char>  m_frame;
+    std::vector<unsigned long>  m_regIndices;
+    std::vector<unsigned long long>  m_regValues;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -456,18 +529,17 @@ public:
 
     virtual TypedValue call(const TypedValueList& arglst);
 
+    virtual TypedValue call(FunctionCallContext& context, const TypedValueList& arglst);
+
 protected:
 
     TypedValueList castArgs(const TypedValueList& arglst);
 
-    TypedValue callCdecl(const TypedValueList& arglst);
-    TypedValue callStd(const TypedValueList& arglst);
-    TypedValue callFast(const TypedValueList& arglst);
-    TypedValue callThis(const TypedValueList& arglst);
-    TypedValue callX64(const TypedValueList& arglst);
-
-    void makeCallx86();
-    void makeCallx64();
+    TypedValue callCdecl(FunctionCallContext& context, const TypedValueList& arglst);
+    TypedValue callStd(FunctionCallContext& context, const TypedValueList& arglst);
+    TypedValue callFast(FunctionCallContext& context, const TypedValueList& arglst);
+    TypedValue callThis(FunctionCallContext& context, const TypedValueList& arglst);
+    TypedValue callX64(FunctionCallContext& context, const TypedValueList& arglst);
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -738,11 +810,51 @@ public:
 
 protected:
 
-    SymbolPtr getChildSymbol(size_t index);
+    // the data children of the function ( the parameters and the locals ) are taken from the
+    // symbol once with the attributes available for their location
+    struct ChildData {
+
+        SymbolPtr  symbol;
+        std::wstring  name;
+        unsigned long  dataKind;
+        unsigned long  locType;
+        MEMOFFSET_REL  offset;
+        unsigned long  regRelativeId;
+        unsigned long  registerId;
+
+        MEMOFFSET_REL getOffset() const {
+            return locType == LocIsRegRel ? offset : symbol->getOffset();
+        }
+
+        unsigned long getRegRelativeId() const {
+            return locType == LocIsRegRel ? regRelativeId : symbol->getRegRelativeId();
+        }
+
+        unsigned long getRegisterId() const {
+            return locType == LocIsEnregistered ? registerId : symbol->getRegisterId();
+        }
+
+        VarStorage getStorage() const {
+            return locType == LocIsEnregistered ? RegisterVar : MemoryVar;
+        }
+    };
+
+    const ChildData& getParam(size_t index);
+
+    const ChildData& getChild(const std::wstring& name);
+
+    void checkChildren();
+
+    static ChildData getChildData(const SymbolPtr& symbol);
 
     MEMOFFSET_64 getDebugXImpl(SymTags symTag) const;
 
     SymbolPtr  m_symbol;
+
+    bool  m_childrenLoaded;
+    std::vector<ChildData>  m_children;
+    std::vector<size_t>  m_params;
+    std::map<std::wstring, size_t>  m_childNames;
 };
 
 
@@ -760,7 +872,9 @@ public:
         const std::wstring& name, 
         MEMOFFSET_64 thisValue);
 
-     virtual TypedValue call(const TypedValueList& arglst);
+     using TypedVarFunction::call;
+
+     virtual TypedValue call(FunctionCallContext& context, const TypedValueList& arglst);
 
 private:
 
@@ -2,6 +2,8 @@
 #include <sstream>
 #include <iomanip>
 #include <regex>
+#include <algorithm>
+#include <cwctype>
 
 #include "kdlib/exceptions.h"
 #include "kdlib/dbgengine.h"
@@ -18,97 +20,159 @@ namespace {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static const std::wregex complexSymMatch(L"^([\\*]*)([^\\(\\)\\*\\[\\]]*)([\\(\\)\\*\\[\\]\\d]*)$");
+// A complex type name is "[*]name[suffix]" where the suffix consists only of
+// pointer, array and bracket characters: "*", "[", "]", "(", ")" and digits
+
+inline bool isComplexSuffixChar( wchar_t c )
+{
+    return c == L'*' || c == L'[' || c == L']' || c == L'(' || c == L')' || ( c >= L'0' && c <= L'9' );
+}
+
+bool splitComplexTypeName( const std::wstring &fullTypeName, std::wstring &typeName, std::wstring &suffix )
+{
+    size_t  nameBegin = fullTypeName.find_first_not_of( L'*' );
+    if ( nameBegin == std::wstring::npos )
+        nameBegin = fullTypeName.size();
+
+    size_t  suffixBegin = fullTypeName.find_first_of( L"*[]()", nameBegin );
+    if ( suffixBegin == std::wstring::npos )
+        suffixBegin = fullTypeName.size();
+
+    for ( size_t i = suffixBegin; i < fullTypeName.size(); ++i )
+    {
+        if ( !isComplexSuffixChar( fullTypeName[i] ) )
+            return false;
+    }
+
+    typeName.assign( fullTypeName, nameBegin, suffixBegin - nameBegin );
+    suffix.assign( fullTypeName, suffixBegin, std::wstring::npos );
+
+    return true;
+}
 
 std::wstring getTypeNameFromComplex( const std::wstring &fullTypeName )
 {
-    std::wsmatch    matchResult;
+    std::wstring  typeName, suffix;
 
-    if ( !std::regex_match( fullTypeName, matchResult, complexSymMatch ) )
+    if ( !splitComplexTypeName( fullTypeName, typeName, suffix ) )
         return L"";
 
-    return std::wstring( matchResult[2].first, matchResult[2].second );
+    return typeName;
 }
 
 std::wstring getTypeSuffixFromComplex( const std::wstring &fullTypeName )
 {
-    std::wsmatch    matchResult;
+    std::wstring  typeName, suffix;
 
-    if ( !std::regex_match( fullTypeName, matchResult, complexSymMatch ) )
+    if ( !splitComplexTypeName( fullTypeName, typeName, suffix ) )
         return L"";
 
-    return std::wstring( matchResult[3].first, matchResult[3].second );
+    return suffix;
 }
 
-
 ///////////////////////////////////////////////////////////////////////////////
 
-static const std::wregex bracketMatch(L"^([^\\(]*)\\((.*)\\)([^\\)]*)$"); 
-
 void getBracketExpression( std::wstring &suffix, std::wstring &bracketExpression )
 {
-    std::wsmatch    matchResult;
+    // "head(inner)tail": the first opening and the last closing bracket
 
-    if ( std::regex_match( suffix, matchResult, bracketMatch  ) )
-    {
-        bracketExpression = std::wstring( matchResult[2].first, matchResult[2].second );
-        
-        std::wstring  newSuffix;
+    size_t  openPos = suffix.find( L'(' );
+    if ( openPos == std::wstring::npos )
+        return;
 
-        if ( matchResult[1].matched )
-            newSuffix += std::wstring( matchResult[1].first, matchResult[1].second );
+    size_t  closePos = suffix.rfind( L')' );
+    if ( closePos == std::wstring::npos || closePos < openPos )
+        return;
 
-        if ( matchResult[3].matched )
-            newSuffix += std::wstring( matchResult[3].first, matchResult[3].second );
+    bracketExpression = suffix.substr( openPos + 1, closePos - openPos - 1 );
 
-        suffix = newSuffix;
-    }
+    suffix = suffix.substr( 0, openPos ) + suffix.substr( closePos + 1 );
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static const std::wregex ptrMatch(L"^\\*(.*)$");
-
 bool getPtrExpression( std::wstring &suffix )
 {
-    std::wsmatch    matchResult;
+    if ( suffix.empty() || suffix[0] != L'*' )
+        return false;
 
-    if ( std::regex_match( suffix, matchResult, ptrMatch  ) )
-    {
-        suffix = std::wstring(matchResult[1].first, matchResult[1].second );
+    suffix.erase( 0, 1 );
 
-        return true;
-    }
+    return true;
+}
 
-    return false;
+///////////////////////////////////////////////////////////////////////////////
+
+bool getArrayExpression( std::wstring &suffix, size_t &arraySize )
+{
+    // "head[digits]"
+
+    if ( suffix.size() < 3 || suffix.back() != L']' )
+        return false;
+
+    size_t  digitsEnd = suffix.size() - 1;
+    size_t  digitsBegin = digitsEnd;
+
+    while ( digitsBegin > 0 && suffix[digitsBegin - 1] >= L'0' && suffix[digitsBegin - 1] <= L'9' )
+        --digitsBegin;
+
+    if ( digitsBegin == digitsEnd || digitsBegin == 0 || suffix[digitsBegin - 1] != L'[' )
+        return false;
+
+    arraySize = 0;
+    for ( size_t i = digitsBegin; i < digitsEnd; ++i )
+        arraySize = arraySize * 10 + ( suffix[i] - L'0' );
+
+    suffix.erase( digitsBegin - 1 );
+
+    return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static const std::wregex arrayMatch(L"^(.*)\\[(\\d+)\\]$");
+// Canonical form of a type expression used as a cache key: no leading or trailing
+// blanks and no blanks around the module separator and the pointer/array suffix.
+// Template arguments are kept as is: "TemplateStruct<int> [4]" is a valid argument
 
-bool getArrayExpression( std::wstring &suffix, size_t &arraySize )
+inline bool isTypeExprDelimiter( wchar_t c )
 {
-    std::wsmatch    matchResult;
+    return c == L'!' || c == L'*' || c == L'[' || c == L']';
+}
+
+std::wstring normalizeTypeExpression( const std::wstring &typeName )
+{
+    std::wstring  result;
+    result.reserve( typeName.size() );
+
+    bool  pendingSpace = false;
+    int  templateLevel = 0;
 
-    if ( std::regex_match( suffix, matchResult, arrayMatch  ) )
+    for ( wchar_t c : typeName )
     {
-        std::wstringstream  sstr;
-        sstr << std::wstring(matchResult[2].first, matchResult[2].second );
-        sstr >> arraySize;
+        if ( templateLevel == 0 && ( c == L' ' || c == L'\t' ) )
+        {
+            pendingSpace = !result.empty() && !isTypeExprDelimiter( result.back() );
+            continue;
+        }
 
-        suffix = std::wstring(matchResult[1].first, matchResult[1].second );
+        if ( pendingSpace && !isTypeExprDelimiter( c ) )
+            result += L' ';
 
-        return true;
+        pendingSpace = false;
+
+        if ( c == L'<' )
+            ++templateLevel;
+        else if ( c == L'>' && templateLevel > 0 )
+            --templateLevel;
+
+        result += c;
     }
 
-    return false;
+    return result;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
-///////////////////////////////////////////////////////////////////////////////
-
 } // end nameless namespace
 
 namespace kdlib {
@@ -281,21 +345,37 @@ TypeInfoPtr loadType( const std::wstring &typeName )
     if ( typeName.empty() )
         throw TypeException(L"type name is empty");
 
-    if ( TypeInfo::isBaseType( typeName ) )
-        return TypeInfo::getBaseTypeInfo( typeName );
+    std::wstring  typeExpr = normalizeTypeExpression( typeName );
+
+    if ( TypeInfo::isBaseType( typeExpr ) )
+        return TypeInfo::getBaseTypeInfo( typeExpr );
 
-    splitSymName( typeName, moduleName, symName );
+    TypeInfoPtr  typeInfo = ProcessMonitor::getTypeExprInfo( typeExpr );
+    if ( typeInfo )
+        return typeInfo;
+
+    splitSymName( typeExpr, moduleName, symName );
+
+    MEMOFFSET_64  moduleBase = 0;
 
     if ( moduleName.empty() )
     {
-        return TypeInfo::getTypeInfoFromCache(symName);
+        typeInfo = TypeInfo::getTypeInfoFromCache(symName);
     }
+    else
+    {
+        ModulePtr  module = loadModule(moduleName);
 
-    ModulePtr  module = loadModule(moduleName);
+        SymbolPtr  symbolScope = module->getSymbolScope();
 
-    SymbolPtr  symbolScope = module->getSymbolScope();
+        typeInfo = loadType(symbolScope, symName );
 
-    return loadType(symbolScope, symName );
+        moduleBase = module->getBase();
+    }
+
+    ProcessMonitor::insertTypeExprInfo( typeExpr, typeInfo, moduleBase );
+
+    return typeInfo;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -699,7 +779,43 @@ std::vector<TypeFieldPtr> enumFields(
 
 ///////////////////////////////////////////////////////////////////////////////
 
-static const std::wregex baseMatch(L"^(Char)|(WChar)|(Int1B)|(UInt1B)|(Int2B)|(UInt2B)|(Int4B)|(UInt4B)|(Int8B)|(UInt8B)|(Long)|(ULong)|(Float)|(Bool)|(Double)|(Void)|(Hresult)|(NoType)$" );
+enum BaseTypeIndex {
+    baseTypeChar,
+    baseTypeWChar,
+    baseTypeInt1B,
+    baseTypeUInt1B,
+    baseTypeInt2B,
+    baseTypeUInt2B,
+    baseTypeInt4B,
+    baseTypeUInt4B,
+    baseTypeInt8B,
+    baseTypeUInt8B,
+    baseTypeLong,
+    baseTypeULong,
+    baseTypeFloat,
+    baseTypeBool,
+    baseTypeDouble,
+    baseTypeVoid,
+    baseTypeHresult,
+    baseTypeNoType,
+    baseTypeCount
+};
+
+static const wchar_t*  baseTypeNames[baseTypeCount] = {
+    L"Char", L"WChar", L"Int1B", L"UInt1B", L"Int2B", L"UInt2B", L"Int4B", L"UInt4B", L"Int8B", L"UInt8B",
+    L"Long", L"ULong", L"Float", L"Bool", L"Double", L"Void", L"Hresult", L"NoType"
+};
+
+static int getBaseTypeIndex( const std::wstring &typeName )
+{
+    for ( int i = 0; i < baseTypeCount; ++i )
+    {
+        if ( typeName == baseTypeNames[i] )
+            return i;
+    }
+
+    return -1;
+}
 
 bool TypeInfo::isBaseType( const std::wstring &typeName )
 {
@@ -712,8 +828,7 @@ bool TypeInfo::isBaseType( const std::wstring &typeName )
             return false;
     }
 
-    std::wsmatch    baseMatchResult;
-    return std::regex_match( name, baseMatchResult, baseMatch );
+    return getBaseTypeIndex( name ) >= 0;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -730,63 +845,61 @@ TypeInfoPtr TypeInfo::getBaseTypeInfo( const std::wstring &typeName, size_t ptrS
     if ( isComplexType( typeName ) )
         return getComplexTypeInfo( typeName, SymbolPtr() );
 
-    std::wsmatch    baseMatchResult;
-
-    if ( std::regex_match( typeName, baseMatchResult, baseMatch ) )
+    switch ( getBaseTypeIndex( typeName ) )
     {
-        if ( baseMatchResult[1].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<char>(L"Char", ptrSize) );
+    case baseTypeChar:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<char>(L"Char", ptrSize) );
 
-        if ( baseMatchResult[2].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<wchar_t>(L"WChar", ptrSize) );
+    case baseTypeWChar:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<wchar_t>(L"WChar", ptrSize) );
 
-        if ( baseMatchResult[3].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<char>(L"Int1B", ptrSize ) );
+    case baseTypeInt1B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<char>(L"Int1B", ptrSize ) );
 
-        if ( baseMatchResult[4].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned char>(L"UInt1B", ptrSize ) );
+    case baseTypeUInt1B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned char>(L"UInt1B", ptrSize ) );
 
-        if ( baseMatchResult[5].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<short>(L"Int2B", ptrSize) );
+    case baseTypeInt2B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<short>(L"Int2B", ptrSize) );
 
-        if ( baseMatchResult[6].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned short>(L"UInt2B", ptrSize) );
+    case baseTypeUInt2B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned short>(L"UInt2B", ptrSize) );
 
-        if ( baseMatchResult[7].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<long>(L"Int4B", ptrSize) );
+    case baseTypeInt4B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<long>(L"Int4B", ptrSize) );
 
-        if ( baseMatchResult[8].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned long>(L"UInt4B", ptrSize) );
+    case baseTypeUInt4B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned long>(L"UInt4B", ptrSize) );
 
-        if ( baseMatchResult[9].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<__int64>(L"Int8B", ptrSize) );
+    case baseTypeInt8B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<__int64>(L"Int8B", ptrSize) );
 
-        if ( baseMatchResult[10].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned __int64>(L"UInt8B", ptrSize) );
+    case baseTypeUInt8B:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned __int64>(L"UInt8B", ptrSize) );
 
-        if ( baseMatchResult[11].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<long>(L"Long", ptrSize) );
+    case baseTypeLong:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<long>(L"Long", ptrSize) );
 
-        if ( baseMatchResult[12].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned long>(L"ULong", ptrSize) );
+    case baseTypeULong:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned long>(L"ULong", ptrSize) );
 
-        if ( baseMatchResult[13].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<float>(L"Float", ptrSize) );
+    case baseTypeFloat:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<float>(L"Float", ptrSize) );
 
-        if ( baseMatchResult[14].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<bool>(L"Bool", ptrSize) );
+    case baseTypeBool:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<bool>(L"Bool", ptrSize) );
 
-        if ( baseMatchResult[15].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<double>(L"Double", ptrSize) );
+    case baseTypeDouble:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<double>(L"Double", ptrSize) );
 
-        if ( baseMatchResult[16].matched )
-            return TypeInfoPtr( new TypeInfoVoid( ptrSize ) );
+    case baseTypeVoid:
+        return TypeInfoPtr( new TypeInfoVoid( ptrSize ) );
 
-        if ( baseMatchResult[17].matched )
-            return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned long>(L"Hresult", ptrSize) );
+    case baseTypeHresult:
+        return TypeInfoPtr( new TypeInfoBaseWrapper<unsigned long>(L"Hresult", ptrSize) );
 
-        if ( baseMatchResult[18].matched )
-            return TypeInfoPtr( new TypeInfoNoType() );
+    case baseTypeNoType:
+        return TypeInfoPtr( new TypeInfoNoType() );
     }
 
     NOT_IMPLEMENTED();
@@ -1020,22 +1133,26 @@ std::pair<std::wstring::const_iterator, std::wstring::const_iterator> removeSpac
     return result;
 }
 
-static const std::wregex templateMatch(L"^([\\w:]*)<(.*)>$");
+inline bool isTemplateNameChar( wchar_t c )
+{
+    return iswalnum(c) || c == L'_' || c == L':';
+}
 
 }
 
 std::list<std::wstring> TypeInfoImp::getTempalteArgs()
 {
-    std::wsmatch    matchResult;
     const auto&  typeName = getName();
-    if ( !std::regex_match(typeName, matchResult, templateMatch))
+
+    auto  argsBegin = std::find_if_not(typeName.begin(), typeName.end(), isTemplateNameChar);
+    if (argsBegin == typeName.end() || *argsBegin != L'<' || typeName.back() != L'>')
         throw TypeException(getName(), L"type is not a template");
     
     std::list<std::wstring>   argList;
 
-    auto  current = matchResult[2].first;
+    auto  current = std::next(argsBegin);
     auto  argStart = current;
-    auto  end = matchResult[2].second;
+    auto  end = std::prev(typeName.end());
 
     int  nestedLevel = 0;
 
@@ -1147,9 +1264,9 @@ std::wstring TypeInfoReference::getName()
 
 std::wstring TypeInfoFields::print()
 {
-    std::wstringstream  sstr;
+    StrBuffer  buffer(0x1000);
 
-    sstr << getName() << " Size: 0x" << std::hex << getSize() << " (" << std::dec << getSize() << ")" << std::endl;
+    buffer.append(getName()).append(L" Size: 0x").appendHex(getSize(), 0).append(L" (").appendDec(getSize()).append(L")\n");
     
     size_t  fieldCount = getElementCount();
 
@@ -1164,29 +1281,29 @@ std::wstring TypeInfoFields::print()
         else
         if ( udtField->isStaticMember() )
         {
-            sstr << L"   =" << std::right << std::setw(10) << std::setfill(L'0') << std::hex << udtField->getStaticOffset();
-            sstr << L" " << std::left << std::setw(18) << std::setfill(L' ') << udtField->getName() << L':';
+            buffer.append(L"   =").appendHex(udtField->getStaticOffset(), 10);
+            buffer.append(L' ').appendPadded(udtField->getName(), 18).append(L':');
         }
         else
         {
             if ( udtField->isVirtualMember() )
             {
-                sstr << L"   virtual base " << udtField->getVirtualBaseClassName();
-                sstr << L" +" << std::right << std::setw(4) << std::setfill(L'0') << std::hex << udtField->getOffset();
-                sstr << L" " << udtField->getName() << L':';
+                buffer.append(L"   virtual base ").append(udtField->getVirtualBaseClassName());
+                buffer.append(L" +").appendHex(udtField->getOffset(), 4);
+                buffer.append(L' ').append(udtField->getName()).append(L':');
             }
             else
             {
-                sstr << L"   +" << std::right << std::setw(4) << std::setfill(L'0') << std::hex << udtField->getOffset();
-                sstr << L" " << std::left << std::setw(24) << std::setfill(L' ') << udtField->getName() << L':';
+                buffer.append(L"   +").appendHex(udtField->getOffset(), 4);
+                buffer.append(L' ').appendPadded(udtField->getName(), 24).append(L':');
             }
         }
 
-        sstr << L" " << std::left << udtField->getTypeInfo()->getName();
-        sstr << std::endl;
+        buffer.append(L' ').append(udtField->getTypeInfo()->getName());
+        buffer.append(L'\n');
     }
 
-    return sstr.str();
+    return buffer.str();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -3,6 +3,7 @@
 #include <boost/enable_shared_from_this.hpp>
 
 #include <kdlib/memaccess.h>
+#include <kdlib/typedvar.h>
 
 #include "win/dbgmgr.h"
 
@@ -35,11 +36,16 @@ public:
 
     virtual void remove();
 
+    void setCondition(const std::wstring& condition) {
+        m_condition = compileExpr(condition);
+    }
+
 protected:
 
     BREAKPOINT_ID  m_id;
     MEMOFFSET_64  m_offset;
     BreakpointCallback*  m_callback;
+    CompiledExprPtr  m_condition;
 };
 
 
@@ -153,6 +159,16 @@ BreakpointPtr softwareBreakPointSet(MEMOFFSET_64 offset, BreakpointCallback *cal
 
 ///////////////////////////////////////////////////////////////////////////////
 
+BreakpointPtr softwareBreakPointSet(MEMOFFSET_64 offset, const std::wstring& condition, BreakpointCallback *callback)
+{
+    boost::shared_ptr<SoftwareBreakpointImpl>  bp = boost::make_shared<SoftwareBreakpointImpl>(offset, callback);
+    bp->setCondition(condition);
+    bp->set();
+    return bp;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 BreakpointPtr hardwareBreakPointSet(MEMOFFSET_64 offset, size_t size, ACCESS_TYPE accessType, BreakpointCallback *callback)
 {
     BreakpointPtr  bp = BreakpointPtr( new HardwareBreakpointImpl(offset, size, accessType, callback) );
@@ -162,6 +178,16 @@ BreakpointPtr hardwareBreakPointSet(MEMOFFSET_64 offset, size_t size, ACCESS_TYP
 
 ///////////////////////////////////////////////////////////////////////////////
 
+BreakpointPtr hardwareBreakPointSet(MEMOFFSET_64 offset, size_t size, ACCESS_TYPE accessType, const std::wstring& condition, BreakpointCallback *callback)
+{
+    boost::shared_ptr<HardwareBreakpointImpl>  bp = boost::make_shared<HardwareBreakpointImpl>(offset, size, accessType, callback);
+    bp->setCondition(condition);
+    bp->set();
+    return bp;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 unsigned long getNumberBreakpoints()
 {
     HRESULT  hres;
@@ -251,8 +277,16 @@ void SoftwareBreakpointImpl::set()
         throw DbgEngException( L"IDebugBreakpoint::GetId", hres);
     }
 
-    BreakpointPtr  ptr = shared_from_this();
-    ProcessMonitor::registerBreakpoint(ptr);
+    // the engine breakpoint is armed already: it must not stay without an owner
+    try {
+        BreakpointPtr  ptr = shared_from_this();
+        ProcessMonitor::registerBreakpoint(ptr, -1, m_condition);
+    }
+    catch (...)
+    {
+        g_dbgMgr->control->RemoveBreakpoint(bp);
+        throw;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -306,19 +340,29 @@ void HardwareBreakpointImpl::set()
         throw DbgEngException( L"IDebugBreakpoint::GetId", hres);
     }
 
-    BreakpointPtr  ptr = shared_from_this();
-    ProcessMonitor::registerBreakpoint(ptr);
+    // the engine breakpoint is armed already: it must not stay without an owner
+    try {
+        BreakpointPtr  ptr = shared_from_this();
+        ProcessMonitor::registerBreakpoint(ptr, -1, m_condition);
+    }
+    catch (...)
+    {
+        g_dbgMgr->control->RemoveBreakpoint(bp);
+        throw;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
 
 DebugCallbackResult BreakpointCallbackHandler(IDebugBreakpoint2 *bp2)
 {
-    CComQIPtr<IDebugBreakpoint>  bp1 = bp2;
-    
-    BreakpointPtr  bpptr = getBreakpoint(bp1);
+    // only the id is needed: the breakpoint object is taken from the process table
+    ULONG  bpid;
+    HRESULT  hres = bp2->GetId(&bpid);
+    if ( FAILED(hres) )
+        throw DbgEngException( L"IDebugBreakpoint::GetId", hres);
 
-    return ProcessMonitor::breakpointHit( getCurrentProcessId(), bpptr);
+    return ProcessMonitor::breakpointHit( getCurrentProcessId(), bpid);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
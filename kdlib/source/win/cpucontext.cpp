@@ -9,6 +9,7 @@
 #include "stackimpl.h"
 #include "cpucontextimpl.h"
 #include "dbgmgr.h"
+#include "autoswitch.h"
 
 
 namespace kdlib {
@@ -91,6 +92,107 @@ NumVariant getRegisterByIndex(unsigned long index)
 
 ///////////////////////////////////////////////////////////////////////////////
 
+size_t RegisterSnapshot::getRegisterPosition(const std::wstring& regName) const
+{
+    for (size_t i = 0; i < m_registers.size(); ++i)
+    {
+        if (_wcsicmp(m_registers[i].c_str(), regName.c_str()) == 0)
+            return i;
+    }
+
+    throw DbgException("register snapshot has no such register");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void RegisterSnapshot::setValue(size_t threadPos, size_t regPos, const NumVariant& value)
+{
+    unsigned long long&  slot = m_values[regPos * m_threads.size() + threadPos];
+
+    if (value.isFloat())
+    {
+        float  val = value.asFloat();
+        unsigned long  bits;
+        memcpy(&bits, &val, sizeof(bits));
+        slot = bits;
+    }
+    else if (value.isDouble())
+    {
+        double  val = value.asDouble();
+        memcpy(&slot, &val, sizeof(slot));
+    }
+    else
+    {
+        slot = value.asULongLong();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+RegisterSnapshot getRegisterSnapshot(const std::vector<std::wstring>& registers, const std::vector<THREAD_DEBUG_ID>& threads)
+{
+    std::vector<THREAD_DEBUG_ID>  threadIds(threads);
+
+    if (threadIds.empty())
+    {
+        unsigned long  threadCount = getNumberThreads();
+
+        threadIds.reserve(threadCount);
+        for (unsigned long i = 0; i < threadCount; ++i)
+            threadIds.push_back(getThreadIdByIndex(i));
+    }
+
+    if (threadIds.empty())
+        return RegisterSnapshot(threadIds, registers);
+
+    ContextAutoRestore  contextRestore;
+
+    RegisterSnapshot  snapshot(threadIds, registers);
+
+    std::vector<unsigned long>  indices;
+    std::vector<NumVariant>  values;
+
+    for (size_t i = 0; i < threadIds.size(); ++i)
+    {
+        if (threadIds[i] != getCurrentThreadId())
+            setCurrentThreadById(threadIds[i]);
+
+        // the whole thread context is read once, registers are taken from the copy
+        CPUContextPtr  cpu = loadCPUContext();
+
+        if (!registers.empty())
+        {
+            for (size_t j = 0; j < registers.size(); ++j)
+                snapshot.setValue(i, j, cpu->getRegisterByName(registers[j]));
+
+            continue;
+        }
+
+        cpu->getRegisters(indices, values);
+
+        if (i == 0)
+        {
+            std::vector<std::wstring>  names;
+            names.reserve(indices.size());
+
+            for (auto index : indices)
+                names.push_back(cpu->getRegisterName(index));
+
+            snapshot = RegisterSnapshot(threadIds, names);
+        }
+
+        if (values.size() != snapshot.getRegisterCount())
+            throw DbgException("threads have different register sets");
+
+        for (size_t j = 0; j < values.size(); ++j)
+            snapshot.setValue(i, j, values[j]);
+    }
+
+    return snapshot;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 void setRegisterByName(const std::wstring& regName, const NumVariant& value)
 {
     unsigned long index = getRegisterIndex(regName);
@@ -279,6 +381,44 @@ void popFromStack(NumVariant& value)
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void CPUContext::getRegisters(std::vector<unsigned long>& indices, std::vector<NumVariant>& values)
+{
+    // the CodeView register indices of all the CPUs are below
+    const unsigned long  maxRegisterIndex = 0x1000;
+
+    indices.clear();
+    values.clear();
+
+    unsigned long  registerNumber = getRegisterNumber();
+    unsigned long  registerFound = 0;
+
+    for (unsigned long index = 0; index < maxRegisterIndex && registerFound < registerNumber; ++index)
+    {
+        // the indices are sparse: the context knows the names of its registers only
+        try {
+            getRegisterName(index);
+        }
+        catch (DbgException&)
+        {
+            continue;
+        }
+
+        registerFound++;
+
+        // a vector register is not a NumVariant
+        try {
+            NumVariant  value = getRegisterByIndex(index);
+
+            indices.push_back(index);
+            values.push_back(value);
+        }
+        catch (DbgException&)
+        {}
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 CPUContextPtr loadCPUContext()
 {
     switch( kdlib::getCPUType() )
@@ -309,6 +449,34 @@ CPUContextPtr loadCPUContext()
 
 ///////////////////////////////////////////////////////////////////////////////
 
+CPUContextPtr loadCPUContext(CPUType cpuType, const void* rawContext, size_t rawContextSize)
+{
+    switch( cpuType )
+    {
+    case CPU_AMD64:
+        if ( rawContextSize < sizeof(CONTEXT_X64) )
+            throw DbgException("raw context is too small");
+        {
+            CONTEXT_X64  context;
+            memcpy( &context, rawContext, sizeof(context) );
+            return CPUContextPtr( new CPUContextAmd64(context) );
+        }
+
+    case CPU_I386:
+        if ( rawContextSize < sizeof(CONTEXT_X86) )
+            throw DbgException("raw context is too small");
+        {
+            CONTEXT_X86  context;
+            memcpy( &context, rawContext, sizeof(context) );
+            return CPUContextPtr( new CPUContextI386(context) );
+        }
+    }
+
+    throw DbgException("Unknown CPU");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 template <class ContextType>
 StackPtr getStackImpl(bool inlineFrames)
 {
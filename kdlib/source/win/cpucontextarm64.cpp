@@ -14,626 +14,182 @@ namespace kdlib {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-NumVariant CPUContextArm64::getRegisterByIndex(unsigned long index)
-{
-    switch (index)
-    {
-    case CV_ARM64_W0:
-        return NumVariant(static_cast<unsigned long>(m_context.X0 & 0xFFFFFFFF));
-    case CV_ARM64_W1:
-        return NumVariant(static_cast<unsigned long>(m_context.X1 & 0xFFFFFFFF));
-    case CV_ARM64_W2:
-        return NumVariant(static_cast<unsigned long>(m_context.X2 & 0xFFFFFFFF));
-    case CV_ARM64_W3:
-        return NumVariant(static_cast<unsigned long>(m_context.X3 & 0xFFFFFFFF));
-    case CV_ARM64_W4:
-        return NumVariant(static_cast<unsigned long>(m_context.X4 & 0xFFFFFFFF));
-    case CV_ARM64_W5:
-        return NumVariant(static_cast<unsigned long>(m_context.X5 & 0xFFFFFFFF));
-    case CV_ARM64_W6:
-        return NumVariant(static_cast<unsigned long>(m_context.X6 & 0xFFFFFFFF));
-    case CV_ARM64_W7:
-        return NumVariant(static_cast<unsigned long>(m_context.X7 & 0xFFFFFFFF));
-    case CV_ARM64_W8:
-        return NumVariant(static_cast<unsigned long>(m_context.X8 & 0xFFFFFFFF));
-    case CV_ARM64_W9:
-        return NumVariant(static_cast<unsigned long>(m_context.X9 & 0xFFFFFFFF));
-    case CV_ARM64_W10:
-        return NumVariant(static_cast<unsigned long>(m_context.X10 & 0xFFFFFFFF));
-    case CV_ARM64_W11:
-        return NumVariant(static_cast<unsigned long>(m_context.X11 & 0xFFFFFFFF));
-    case CV_ARM64_W12:
-        return NumVariant(static_cast<unsigned long>(m_context.X12 & 0xFFFFFFFF));
-    case CV_ARM64_W13:
-        return NumVariant(static_cast<unsigned long>(m_context.X13 & 0xFFFFFFFF));
-    case CV_ARM64_W14:
-        return NumVariant(static_cast<unsigned long>(m_context.X14 & 0xFFFFFFFF));
-    case CV_ARM64_W15:
-        return NumVariant(static_cast<unsigned long>(m_context.X15 & 0xFFFFFFFF));
-    case CV_ARM64_W16:
-        return NumVariant(static_cast<unsigned long>(m_context.X16 & 0xFFFFFFFF));
-    case CV_ARM64_W17:
-        return NumVariant(static_cast<unsigned long>(m_context.X17 & 0xFFFFFFFF));
-    case CV_ARM64_W18:
-        return NumVariant(static_cast<unsigned long>(m_context.X18 & 0xFFFFFFFF));
-    case CV_ARM64_W19:
-        return NumVariant(static_cast<unsigned long>(m_context.X19 & 0xFFFFFFFF));
-    case CV_ARM64_W20:
-        return NumVariant(static_cast<unsigned long>(m_context.X20 & 0xFFFFFFFF));
-    case CV_ARM64_W21:
-        return NumVariant(static_cast<unsigned long>(m_context.X21 & 0xFFFFFFFF));
-    case CV_ARM64_W22:
-        return NumVariant(static_cast<unsigned long>(m_context.X22 & 0xFFFFFFFF));
-    case CV_ARM64_W23:
-        return NumVariant(static_cast<unsigned long>(m_context.X23 & 0xFFFFFFFF));
-    case CV_ARM64_W24:
-        return NumVariant(static_cast<unsigned long>(m_context.X24 & 0xFFFFFFFF));
-    case CV_ARM64_W25:
-        return NumVariant(static_cast<unsigned long>(m_context.X25 & 0xFFFFFFFF));
-    case CV_ARM64_W26:
-        return NumVariant(static_cast<unsigned long>(m_context.X26 & 0xFFFFFFFF));
-    case CV_ARM64_W27:
-        return NumVariant(static_cast<unsigned long>(m_context.X27 & 0xFFFFFFFF));
-    case CV_ARM64_W28:
-        return NumVariant(static_cast<unsigned long>(m_context.X28 & 0xFFFFFFFF));
-    case CV_ARM64_W29:
-        return NumVariant(static_cast<unsigned long>(m_context.Fp & 0xFFFFFFFF));
-    case CV_ARM64_W30:
-        return NumVariant(static_cast<unsigned long>(m_context.Lr & 0xFFFFFFFF));
-
-    case CV_ARM64_X0:
-        return NumVariant(m_context.X0);
-    case CV_ARM64_X1:
-        return NumVariant(m_context.X1);
-    case CV_ARM64_X2:
-        return NumVariant(m_context.X2);
-    case CV_ARM64_X3:
-        return NumVariant(m_context.X3);
-    case CV_ARM64_X4:
-        return NumVariant(m_context.X4);
-    case CV_ARM64_X5:
-        return NumVariant(m_context.X5);
-    case CV_ARM64_X6:
-        return NumVariant(m_context.X6);
-    case CV_ARM64_X7:
-        return NumVariant(m_context.X7);
-    case CV_ARM64_X8:
-        return NumVariant(m_context.X8);
-    case CV_ARM64_X9:
-        return NumVariant(m_context.X9);
-    case CV_ARM64_X10:
-        return NumVariant(m_context.X10);
-    case CV_ARM64_X11:
-        return NumVariant(m_context.X11);
-    case CV_ARM64_X12:
-        return NumVariant(m_context.X12);
-    case CV_ARM64_X13:
-        return NumVariant(m_context.X13);
-    case CV_ARM64_X14:
-        return NumVariant(m_context.X14);
-    case CV_ARM64_X15:
-        return NumVariant(m_context.X15);
-    /* CV_ARM64_IP0 / CV_ARM64_IP1 ??? */
-    case CV_ARM64_X18:
-        return NumVariant(m_context.X18);
-    case CV_ARM64_X19:
-        return NumVariant(m_context.X19);
-    case CV_ARM64_X20:
-        return NumVariant(m_context.X20);
-    case CV_ARM64_X21:
-        return NumVariant(m_context.X21);
-    case CV_ARM64_X22:
-        return NumVariant(m_context.X22);
-    case CV_ARM64_X23:
-        return NumVariant(m_context.X23);
-    case CV_ARM64_X24:
-        return NumVariant(m_context.X24);
-    case CV_ARM64_X25:
-        return NumVariant(m_context.X25);
-    case CV_ARM64_X26:
-        return NumVariant(m_context.X26);
-    case CV_ARM64_X27:
-        return NumVariant(m_context.X27);
-    case CV_ARM64_X28:
-        return NumVariant(m_context.X28);
-    case CV_ARM64_FP:
-        return NumVariant(m_context.Fp);
-    case CV_ARM64_LR:
-        return NumVariant(m_context.Lr);
-    case CV_ARM64_SP:
-        return NumVariant(m_context.Sp);
-    case CV_ARM64_PC:
-        return NumVariant(m_context.Pc);
-
-    case CV_ARM64_NZCV:
-        return NumVariant(m_context.ContextFlags);
-    case CV_ARM64_CPSR:
-        return NumVariant(m_context.Cpsr);
-
-    case CV_ARM64_S0:
-        return NumVariant(m_context.V[0].S);
-    case CV_ARM64_S1:
-        return NumVariant(m_context.V[1].S);
-    case CV_ARM64_S2:
-        return NumVariant(m_context.V[2].S);
-    case CV_ARM64_S3:
-        return NumVariant(m_context.V[3].S);
-    case CV_ARM64_S4:
-        return NumVariant(m_context.V[4].S);
-    case CV_ARM64_S5:
-        return NumVariant(m_context.V[5].S);
-    case CV_ARM64_S6:
-        return NumVariant(m_context.V[6].S);
-    case CV_ARM64_S7:
-        return NumVariant(m_context.V[7].S);
-    case CV_ARM64_S8:
-        return NumVariant(m_context.V[8].S);
-    case CV_ARM64_S9:
-        return NumVariant(m_context.V[9].S);
-    case CV_ARM64_S10:
-        return NumVariant(m_context.V[10].S);
-    case CV_ARM64_S11:
-        return NumVariant(m_context.V[11].S);
-    case CV_ARM64_S12:
-        return NumVariant(m_context.V[12].S);
-    case CV_ARM64_S13:
-        return NumVariant(m_context.V[13].S);
-    case CV_ARM64_S14:
-        return NumVariant(m_context.V[14].S);
-    case CV_ARM64_S15:
-        return NumVariant(m_context.V[15].S);
-    case CV_ARM64_S16:
-        return NumVariant(m_context.V[16].S);
-    case CV_ARM64_S17:
-        return NumVariant(m_context.V[17].S);
-    case CV_ARM64_S18:
-        return NumVariant(m_context.V[18].S);
-    case CV_ARM64_S19:
-        return NumVariant(m_context.V[19].S);
-    case CV_ARM64_S20:
-        return NumVariant(m_context.V[20].S);
-    case CV_ARM64_S21:
-        return NumVariant(m_context.V[21].S);
-    case CV_ARM64_S22:
-        return NumVariant(m_context.V[22].S);
-    case CV_ARM64_S23:
-        return NumVariant(m_context.V[23].S);
-    case CV_ARM64_S24:
-        return NumVariant(m_context.V[24].S);
-    case CV_ARM64_S25:
-        return NumVariant(m_context.V[25].S);
-    case CV_ARM64_S26:
-        return NumVariant(m_context.V[26].S);
-    case CV_ARM64_S27:
-        return NumVariant(m_context.V[27].S);
-    case CV_ARM64_S28:
-        return NumVariant(m_context.V[28].S);
-    case CV_ARM64_S29:
-        return NumVariant(m_context.V[29].S);
-    case CV_ARM64_S30:
-        return NumVariant(m_context.V[30].S);
-    case CV_ARM64_S31:
-        return NumVariant(m_context.V[31].S);
-
-    case CV_ARM64_D0:
-        return NumVariant(m_context.V[0].D);
-    case CV_ARM64_D1:
-        return NumVariant(m_context.V[1].D);
-    case CV_ARM64_D2:
-        return NumVariant(m_context.V[2].D);
-    case CV_ARM64_D3:
-        return NumVariant(m_context.V[3].D);
-    case CV_ARM64_D4:
-        return NumVariant(m_context.V[4].D);
-    case CV_ARM64_D5:
-        return NumVariant(m_context.V[5].D);
-    case CV_ARM64_D6:
-        return NumVariant(m_context.V[6].D);
-    case CV_ARM64_D7:
-        return NumVariant(m_context.V[7].D);
-    case CV_ARM64_D8:
-        return NumVariant(m_context.V[8].D);
-    case CV_ARM64_D9:
-        return NumVariant(m_context.V[9].D);
-    case CV_ARM64_D10:
-        return NumVariant(m_context.V[10].D);
-    case CV_ARM64_D11:
-        return NumVariant(m_context.V[11].D);
-    case CV_ARM64_D12:
-        return NumVariant(m_context.V[12].D);
-    case CV_ARM64_D13:
-        return NumVariant(m_context.V[13].D);
-    case CV_ARM64_D14:
-        return NumVariant(m_context.V[14].D);
-    case CV_ARM64_D15:
-        return NumVariant(m_context.V[15].D);
-    case CV_ARM64_D16:
-        return NumVariant(m_context.V[16].D);
-    case CV_ARM64_D17:
-        return NumVariant(m_context.V[17].D);
-    case CV_ARM64_D18:
-        return NumVariant(m_context.V[18].D);
-    case CV_ARM64_D19:
-        return NumVariant(m_context.V[19].D);
-    case CV_ARM64_D20:
-        return NumVariant(m_context.V[20].D);
-    case CV_ARM64_D21:
-        return NumVariant(m_context.V[21].D);
-    case CV_ARM64_D22:
-        return NumVariant(m_context.V[22].D);
-    case CV_ARM64_D23:
-        return NumVariant(m_context.V[23].D);
-    case CV_ARM64_D24:
-        return NumVariant(m_context.V[24].D);
-    case CV_ARM64_D25:
-        return NumVariant(m_context.V[25].D);
-    case CV_ARM64_D26:
-        return NumVariant(m_context.V[26].D);
-    case CV_ARM64_D27:
-        return NumVariant(m_context.V[27].D);
-    case CV_ARM64_D28:
-        return NumVariant(m_context.V[28].D);
-    case CV_ARM64_D29:
-        return NumVariant(m_context.V[29].D);
-    case CV_ARM64_D30:
-        return NumVariant(m_context.V[30].D);
-    case CV_ARM64_D31:
-        return NumVariant(m_context.V[31].D);
-
-    /* NumVariant can not provide 128-bit registers :( */
-    // CV_ARM64_Q0 ... CV_ARM64_Q31
-
-    case CV_ARM64_FPSR:
-        return NumVariant(m_context.Fpsr);
-    case CV_ARM64_FPCR:
-        return NumVariant(m_context.Fpcr);
-    }
-
-    std::stringstream sstr;
-    sstr << "ARM64 context: unsupported register index " << std::dec << index;
-    throw DbgException(sstr.str());
-}
+namespace {
+
+constexpr CPURegisterDesc  arm64Registers[] = {
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W0, L"w0", X0, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W1, L"w1", X1, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W2, L"w2", X2, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W3, L"w3", X3, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W4, L"w4", X4, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W5, L"w5", X5, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W6, L"w6", X6, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W7, L"w7", X7, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W8, L"w8", X8, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W9, L"w9", X9, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W10, L"w10", X10, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W11, L"w11", X11, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W12, L"w12", X12, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W13, L"w13", X13, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W14, L"w14", X14, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W15, L"w15", X15, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W16, L"w16", X16, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W17, L"w17", X17, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W18, L"w18", X18, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W19, L"w19", X19, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W20, L"w20", X20, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W21, L"w21", X21, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W22, L"w22", X22, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W23, L"w23", X23, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W24, L"w24", X24, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W25, L"w25", X25, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W26, L"w26", X26, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W27, L"w27", X27, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W28, L"w28", X28, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W29, L"w29", Fp, 4, 0),
+    CPU_SUBREGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_W30, L"w30", Lr, 4, 0),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X0, L"x0", X0),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X1, L"x1", X1),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X2, L"x2", X2),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X3, L"x3", X3),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X4, L"x4", X4),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X5, L"x5", X5),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X6, L"x6", X6),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X7, L"x7", X7),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X8, L"x8", X8),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X9, L"x9", X9),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X10, L"x10", X10),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X11, L"x11", X11),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X12, L"x12", X12),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X13, L"x13", X13),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X14, L"x14", X14),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X15, L"x15", X15),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X18, L"x18", X18),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X19, L"x19", X19),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X20, L"x20", X20),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X21, L"x21", X21),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X22, L"x22", X22),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X23, L"x23", X23),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X24, L"x24", X24),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X25, L"x25", X25),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X26, L"x26", X26),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X27, L"x27", X27),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_X28, L"x28", X28),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_FP, L"fp", Fp),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_LR, L"lr", Lr),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_SP, L"sp", Sp),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_PC, L"pc", Pc),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_NZCV, L"nzcv", Cpsr),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_CPSR, L"cpsr", Cpsr),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S0, L"s0", V[0].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S1, L"s1", V[1].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S2, L"s2", V[2].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S3, L"s3", V[3].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S4, L"s4", V[4].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S5, L"s5", V[5].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S6, L"s6", V[6].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S7, L"s7", V[7].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S8, L"s8", V[8].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S9, L"s9", V[9].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S10, L"s10", V[10].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S11, L"s11", V[11].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S12, L"s12", V[12].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S13, L"s13", V[13].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S14, L"s14", V[14].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S15, L"s15", V[15].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S16, L"s16", V[16].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S17, L"s17", V[17].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S18, L"s18", V[18].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S19, L"s19", V[19].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S20, L"s20", V[20].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S21, L"s21", V[21].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S22, L"s22", V[22].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S23, L"s23", V[23].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S24, L"s24", V[24].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S25, L"s25", V[25].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S26, L"s26", V[26].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S27, L"s27", V[27].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S28, L"s28", V[28].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S29, L"s29", V[29].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S30, L"s30", V[30].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_S31, L"s31", V[31].S[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D0, L"d0", V[0].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D1, L"d1", V[1].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D2, L"d2", V[2].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D3, L"d3", V[3].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D4, L"d4", V[4].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D5, L"d5", V[5].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D6, L"d6", V[6].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D7, L"d7", V[7].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D8, L"d8", V[8].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D9, L"d9", V[9].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D10, L"d10", V[10].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D11, L"d11", V[11].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D12, L"d12", V[12].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D13, L"d13", V[13].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D14, L"d14", V[14].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D15, L"d15", V[15].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D16, L"d16", V[16].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D17, L"d17", V[17].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D18, L"d18", V[18].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D19, L"d19", V[19].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D20, L"d20", V[20].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D21, L"d21", V[21].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D22, L"d22", V[22].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D23, L"d23", V[23].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D24, L"d24", V[24].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D25, L"d25", V[25].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D26, L"d26", V[26].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D27, L"d27", V[27].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D28, L"d28", V[28].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D29, L"d29", V[29].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D30, L"d30", V[30].D[0]),
+    CPU_FLOAT_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_D31, L"d31", V[31].D[0]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q0, L"q0", V[0]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q1, L"q1", V[1]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q2, L"q2", V[2]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q3, L"q3", V[3]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q4, L"q4", V[4]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q5, L"q5", V[5]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q6, L"q6", V[6]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q7, L"q7", V[7]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q8, L"q8", V[8]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q9, L"q9", V[9]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q10, L"q10", V[10]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q11, L"q11", V[11]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q12, L"q12", V[12]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q13, L"q13", V[13]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q14, L"q14", V[14]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q15, L"q15", V[15]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q16, L"q16", V[16]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q17, L"q17", V[17]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q18, L"q18", V[18]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q19, L"q19", V[19]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q20, L"q20", V[20]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q21, L"q21", V[21]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q22, L"q22", V[22]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q23, L"q23", V[23]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q24, L"q24", V[24]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q25, L"q25", V[25]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q26, L"q26", V[26]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q27, L"q27", V[27]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q28, L"q28", V[28]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q29, L"q29", V[29]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q30, L"q30", V[30]),
+    CPU_VECTOR_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_Q31, L"q31", V[31]),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_FPSR, L"fpsr", Fpsr),
+    CPU_REGISTER(CONTEXT_ARM64_STRUCT, CV_ARM64_FPCR, L"fpcr", Fpcr)
+};
+
+constexpr auto  arm64RegisterMap = CPU_REGISTER_MAP("ARM64", arm64Registers);
+
+} // end nameless namespace
 
 ///////////////////////////////////////////////////////////////////////////////
 
-std::wstring CPUContextArm64::getRegisterName(unsigned long index)
+CPURegisterTable CPUContextArm64::getRegisterTable()
 {
-    switch (index)
-    {
-    case CV_ARM64_W0:
-        return L"w0";
-    case CV_ARM64_W1:
-        return L"w1";
-    case CV_ARM64_W2:
-        return L"w2";
-    case CV_ARM64_W3:
-        return L"w3";
-    case CV_ARM64_W4:
-        return L"w4";
-    case CV_ARM64_W5:
-        return L"w5";
-    case CV_ARM64_W6:
-        return L"w6";
-    case CV_ARM64_W7:
-        return L"w7";
-    case CV_ARM64_W8:
-        return L"w8";
-    case CV_ARM64_W9:
-        return L"w9";
-    case CV_ARM64_W10:
-        return L"w10";
-    case CV_ARM64_W11:
-        return L"w11";
-    case CV_ARM64_W12:
-        return L"w12";
-    case CV_ARM64_W13:
-        return L"w13";
-    case CV_ARM64_W14:
-        return L"w14";
-    case CV_ARM64_W15:
-        return L"w15";
-    case CV_ARM64_W16:
-        return L"w16";
-    case CV_ARM64_W17:
-        return L"w17";
-    case CV_ARM64_W18:
-        return L"w18";
-    case CV_ARM64_W19:
-        return L"w19";
-    case CV_ARM64_W20:
-        return L"w20";
-    case CV_ARM64_W21:
-        return L"w21";
-    case CV_ARM64_W22:
-        return L"w22";
-    case CV_ARM64_W23:
-        return L"w23";
-    case CV_ARM64_W24:
-        return L"w24";
-    case CV_ARM64_W25:
-        return L"w25";
-    case CV_ARM64_W26:
-        return L"w26";
-    case CV_ARM64_W27:
-        return L"w27";
-    case CV_ARM64_W28:
-        return L"w28";
-    case CV_ARM64_W29:
-        return L"w29";
-    case CV_ARM64_W30:
-        return L"w30";
-
-    case CV_ARM64_X0:
-        return L"x0";
-    case CV_ARM64_X1:
-        return L"x1";
-    case CV_ARM64_X2:
-        return L"x2";
-    case CV_ARM64_X3:
-        return L"x3";
-    case CV_ARM64_X4:
-        return L"x4";
-    case CV_ARM64_X5:
-        return L"x5";
-    case CV_ARM64_X6:
-        return L"x6";
-    case CV_ARM64_X7:
-        return L"x7";
-    case CV_ARM64_X8:
-        return L"x8";
-    case CV_ARM64_X9:
-        return L"x9";
-    case CV_ARM64_X10:
-        return L"x10";
-    case CV_ARM64_X11:
-        return L"x11";
-    case CV_ARM64_X12:
-        return L"x12";
-    case CV_ARM64_X13:
-        return L"x13";
-    case CV_ARM64_X14:
-        return L"x14";
-    case CV_ARM64_X15:
-        return L"x15";
-    case CV_ARM64_X18:
-        return L"x18";
-    case CV_ARM64_X19:
-        return L"x19";
-    case CV_ARM64_X20:
-        return L"x20";
-    case CV_ARM64_X21:
-        return L"x21";
-    case CV_ARM64_X22:
-        return L"x22";
-    case CV_ARM64_X23:
-        return L"x23";
-    case CV_ARM64_X24:
-        return L"x24";
-    case CV_ARM64_X25:
-        return L"x25";
-    case CV_ARM64_X26:
-        return L"x26";
-    case CV_ARM64_X27:
-        return L"x27";
-    case CV_ARM64_X28:
-        return L"x28";
-
-    case CV_ARM64_FP:
-        return L"fp";
-    case CV_ARM64_LR:
-        return L"lr";
-    case CV_ARM64_SP:
-        return L"sp";
-    case CV_ARM64_PC:
-        return L"pc";
-
-    case CV_ARM64_CPSR:
-        return L"cpsr";
-
-    case CV_ARM64_S0:
-        return L"s0";
-    case CV_ARM64_S1:
-        return L"s1";
-    case CV_ARM64_S2:
-        return L"s2";
-    case CV_ARM64_S3:
-        return L"s3";
-    case CV_ARM64_S4:
-        return L"s4";
-    case CV_ARM64_S5:
-        return L"s5";
-    case CV_ARM64_S6:
-        return L"s6";
-    case CV_ARM64_S7:
-        return L"s7";
-    case CV_ARM64_S8:
-        return L"s8";
-    case CV_ARM64_S9:
-        return L"s9";
-    case CV_ARM64_S10:
-        return L"s10";
-    case CV_ARM64_S11:
-        return L"s11";
-    case CV_ARM64_S12:
-        return L"s12";
-    case CV_ARM64_S13:
-        return L"s13";
-    case CV_ARM64_S14:
-        return L"s14";
-    case CV_ARM64_S15:
-        return L"s15";
-    case CV_ARM64_S16:
-        return L"s16";
-    case CV_ARM64_S17:
-        return L"s17";
-    case CV_ARM64_S18:
-        return L"s18";
-    case CV_ARM64_S19:
-        return L"s19";
-    case CV_ARM64_S20:
-        return L"s20";
-    case CV_ARM64_S21:
-        return L"s21";
-    case CV_ARM64_S22:
-        return L"s22";
-    case CV_ARM64_S23:
-        return L"s23";
-    case CV_ARM64_S24:
-        return L"s24";
-    case CV_ARM64_S25:
-        return L"s25";
-    case CV_ARM64_S26:
-        return L"s26";
-    case CV_ARM64_S27:
-        return L"s27";
-    case CV_ARM64_S28:
-        return L"s28";
-    case CV_ARM64_S29:
-        return L"s29";
-    case CV_ARM64_S30:
-        return L"s30";
-    case CV_ARM64_S31:
-        return L"s31";
-
-    case CV_ARM64_D0:
-        return L"d0";
-    case CV_ARM64_D1:
-        return L"d1";
-    case CV_ARM64_D2:
-        return L"d2";
-    case CV_ARM64_D3:
-        return L"d3";
-    case CV_ARM64_D4:
-        return L"d4";
-    case CV_ARM64_D5:
-        return L"d5";
-    case CV_ARM64_D6:
-        return L"d6";
-    case CV_ARM64_D7:
-        return L"d7";
-    case CV_ARM64_D8:
-        return L"d8";
-    case CV_ARM64_D9:
-        return L"d9";
-    case CV_ARM64_D10:
-        return L"d10";
-    case CV_ARM64_D11:
-        return L"d11";
-    case CV_ARM64_D12:
-        return L"d12";
-    case CV_ARM64_D13:
-        return L"d13";
-    case CV_ARM64_D14:
-        return L"d14";
-    case CV_ARM64_D15:
-        return L"d15";
-    case CV_ARM64_D16:
-        return L"d16";
-    case CV_ARM64_D17:
-        return L"d17";
-    case CV_ARM64_D18:
-        return L"d18";
-    case CV_ARM64_D19:
-        return L"d19";
-    case CV_ARM64_D20:
-        return L"d20";
-    case CV_ARM64_D21:
-        return L"d21";
-    case CV_ARM64_D22:
-        return L"d22";
-    case CV_ARM64_D23:
-        return L"d23";
-    case CV_ARM64_D24:
-        return L"d24";
-    case CV_ARM64_D25:
-        return L"d25";
-    case CV_ARM64_D26:
-        return L"d26";
-    case CV_ARM64_D27:
-        return L"d27";
-    case CV_ARM64_D28:
-        return L"d28";
-    case CV_ARM64_D29:
-        return L"d29";
-    case CV_ARM64_D30:
-        return L"d30";
-    case CV_ARM64_D31:
-        return L"d31";
-
-    case CV_ARM64_Q0:
-        return L"q0";
-    case CV_ARM64_Q1:
-        return L"q1";
-    case CV_ARM64_Q2:
-        return L"q2";
-    case CV_ARM64_Q3:
-        return L"q3";
-    case CV_ARM64_Q4:
-        return L"q4";
-    case CV_ARM64_Q5:
-        return L"q5";
-    case CV_ARM64_Q6:
-        return L"q6";
-    case CV_ARM64_Q7:
-        return L"q7";
-    case CV_ARM64_Q8:
-        return L"q8";
-    case CV_ARM64_Q9:
-        return L"q9";
-    case CV_ARM64_Q10:
-        return L"q10";
-    case CV_ARM64_Q11:
-        return L"q11";
-    case CV_ARM64_Q12:
-        return L"q12";
-    case CV_ARM64_Q13:
-        return L"q13";
-    case CV_ARM64_Q14:
-        return L"q14";
-    case CV_ARM64_Q15:
-        return L"q15";
-    case CV_ARM64_Q16:
-        return L"q16";
-    case CV_ARM64_Q17:
-        return L"q17";
-    case CV_ARM64_Q18:
-        return L"q18";
-    case CV_ARM64_Q19:
-        return L"q19";
-    case CV_ARM64_Q20:
-        return L"q20";
-    case CV_ARM64_Q21:
-        return L"q21";
-    case CV_ARM64_Q22:
-        return L"q22";
-    case CV_ARM64_Q23:
-        return L"q23";
-    case CV_ARM64_Q24:
-        return L"q24";
-    case CV_ARM64_Q25:
-        return L"q25";
-    case CV_ARM64_Q26:
-        return L"q26";
-    case CV_ARM64_Q27:
-        return L"q27";
-    case CV_ARM64_Q28:
-        return L"q28";
-    case CV_ARM64_Q29:
-        return L"q29";
-    case CV_ARM64_Q30:
-        return L"q30";
-    case CV_ARM64_Q31:
-        return L"q31";
-
-    case CV_ARM64_FPSR:
-        return L"fpsr";
-    case CV_ARM64_FPCR:
-        return L"fpcr";
-    }
-
-    std::stringstream sstr;
-    sstr << "ARM64 context: unsupported register index " << std::dec << index;
-    throw DbgException(sstr.str());
+    return arm64RegisterMap.getTable();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -14,164 +14,54 @@ namespace kdlib {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-NumVariant CPUContextI386::getRegisterByIndex(unsigned long index)
-{
-    switch (index)
-    {
-    case CV_REG_AL:
-        return NumVariant(static_cast<unsigned char>(m_context.Eax & 0xFF));
-    case CV_REG_CL:
-        return NumVariant(static_cast<unsigned char>(m_context.Ecx & 0xFF));
-    case CV_REG_DL:
-        return NumVariant(static_cast<unsigned char>(m_context.Edx & 0xFF));
-    case CV_REG_BL:
-        return NumVariant(static_cast<unsigned char>(m_context.Ebx & 0xFF));
-    case CV_REG_AH:
-        return NumVariant(static_cast<unsigned char>((m_context.Eax & 0xFF00) >> 8));
-    case CV_REG_CH:
-        return NumVariant(static_cast<unsigned char>((m_context.Ecx & 0xFF00) >> 8));
-    case CV_REG_DH:
-        return NumVariant(static_cast<unsigned char>((m_context.Edx & 0xFF00) >> 8));
-    case CV_REG_BH:
-       return NumVariant(static_cast<unsigned char>((m_context.Ebx & 0xFF00) >> 8));
-    case CV_REG_AX:
-        return NumVariant(static_cast<unsigned short>(m_context.Eax & 0xFFFF));
-    case CV_REG_CX:
-        return NumVariant(static_cast<unsigned short>(m_context.Ecx & 0xFFFF));
-    case CV_REG_DX:
-        return NumVariant(static_cast<unsigned short>(m_context.Edx & 0xFFFF));
-    case CV_REG_BX:
-        return NumVariant(static_cast<unsigned short>(m_context.Ebx & 0xFFFF));
-    case CV_REG_SP:
-        return NumVariant(static_cast<unsigned short>(m_context.Esp & 0xFFFF));
-    case CV_REG_BP:
-        return NumVariant(static_cast<unsigned short>(m_context.Ebp & 0xFFFF));
-    case CV_REG_SI:
-        return NumVariant(static_cast<unsigned short>(m_context.Esi & 0xFFFF));
-    case CV_REG_DI:
-        return NumVariant(static_cast<unsigned short>(m_context.Edi & 0xFFFF));
-    case CV_REG_EAX:
-        return NumVariant(m_context.Eax);
-    case CV_REG_ECX:
-        return NumVariant(m_context.Ecx);
-    case CV_REG_EDX:
-        return NumVariant(m_context.Edx);
-    case CV_REG_EBX:
-        return NumVariant(m_context.Ebx);
-    case CV_REG_ESP:
-        return NumVariant(m_context.Esp);
-    case CV_REG_EBP:
-        return NumVariant(m_context.Ebp);
-    case CV_REG_ESI:
-        return NumVariant(m_context.Esi);
-    case CV_REG_EDI:
-       return NumVariant(m_context.Edi);
-    case CV_REG_ES:
-       return NumVariant(m_context.SegEs);
-    case CV_REG_CS:
-       return NumVariant(m_context.SegCs);
-    case CV_REG_SS:
-       return NumVariant(m_context.SegSs);
-    case CV_REG_DS:
-       return NumVariant(m_context.SegDs);
-    case CV_REG_FS:
-        return NumVariant(m_context.SegFs);
-    case CV_REG_GS:
-        return NumVariant(m_context.SegGs);
-    case CV_REG_IP:
-        return NumVariant(static_cast<unsigned short>(m_context.Eip & 0xFFFF));
-    case CV_REG_FLAGS:
-        return NumVariant(static_cast<unsigned short>(m_context.EFlags & 0xFFFF));
-    case CV_REG_EIP:
-        return NumVariant(m_context.Eip);
-    case CV_REG_EFLAGS:
-        return NumVariant(m_context.EFlags);
-    }
+namespace {
 
-    std::stringstream sstr;
-    sstr << "I386 context: unsupported register index " << std::dec << index;
-    throw DbgException(sstr.str());
-}
+constexpr CPURegisterDesc  i386Registers[] = {
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_AL, L"al", Eax, 1, 0),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_CL, L"cl", Ecx, 1, 0),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_DL, L"dl", Edx, 1, 0),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_BL, L"bl", Ebx, 1, 0),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_AH, L"ah", Eax, 1, 8),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_CH, L"ch", Ecx, 1, 8),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_DH, L"dh", Edx, 1, 8),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_BH, L"bh", Ebx, 1, 8),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_AX, L"ax", Eax, 2, 0),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_CX, L"cx", Ecx, 2, 0),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_DX, L"dx", Edx, 2, 0),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_BX, L"bx", Ebx, 2, 0),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_SP, L"sp", Esp, 2, 0),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_BP, L"bp", Ebp, 2, 0),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_SI, L"si", Esi, 2, 0),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_DI, L"di", Edi, 2, 0),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_EAX, L"eax", Eax),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_ECX, L"ecx", Ecx),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_EDX, L"edx", Edx),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_EBX, L"ebx", Ebx),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_ESP, L"esp", Esp),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_EBP, L"ebp", Ebp),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_ESI, L"esi", Esi),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_EDI, L"edi", Edi),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_ES, L"es", SegEs),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_CS, L"cs", SegCs),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_SS, L"ss", SegSs),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_DS, L"ds", SegDs),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_FS, L"fs", SegFs),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_GS, L"gs", SegGs),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_IP, L"ip", Eip, 2, 0),
+    CPU_SUBREGISTER(CONTEXT_X86, CV_REG_FLAGS, L"flags", EFlags, 2, 0),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_EIP, L"eip", Eip),
+    CPU_REGISTER(CONTEXT_X86, CV_REG_EFLAGS, L"eflags", EFlags)
+};
+
+constexpr auto  i386RegisterMap = CPU_REGISTER_MAP("I386", i386Registers);
+
+} // end nameless namespace
 
 ///////////////////////////////////////////////////////////////////////////////
 
-std::wstring  CPUContextI386::getRegisterName(unsigned long index)
+CPURegisterTable CPUContextI386::getRegisterTable()
 {
-    switch (index)
-    {
-    case CV_REG_AL:
-        return L"al";
-    case CV_REG_CL:
-        return L"cl";
-    case CV_REG_DL:
-        return L"dl";
-    case CV_REG_BL:
-        return L"bl";
-    case CV_REG_AH:
-        return L"ah";
-    case CV_REG_CH:
-        return L"ch";
-    case CV_REG_DH:
-        return L"dh";
-    case CV_REG_BH:
-        return L"bh";
-    case CV_REG_AX:
-        return L"ax";
-    case CV_REG_CX:
-        return L"cx";
-    case CV_REG_DX:
-        return L"dx";
-    case CV_REG_BX:
-        return L"bx";
-    case CV_REG_SP:
-        return L"sp";
-    case CV_REG_BP:
-        return L"bp";
-    case CV_REG_SI:
-        return L"si";
-    case CV_REG_DI:
-        return L"di";
-    case CV_REG_EAX:
-        return L"eax";
-    case CV_REG_ECX:
-        return L"ecx";
-    case CV_REG_EDX:
-        return L"edx";
-    case CV_REG_EBX:
-        return L"ebx";
-    case CV_REG_ESP:
-        return L"esp";
-    case CV_REG_EBP:
-        return L"ebp";
-    case CV_REG_ESI:
-        return L"esi";
-    case CV_REG_EDI:
-        return L"edi";
-    case CV_REG_ES:
-        return L"es";
-    case CV_REG_CS:
-        return L"cs";
-    case CV_REG_SS:
-        return L"ss";
-    case CV_REG_DS:
-        return L"ds";
-    case CV_REG_FS:
-        return L"fs";
-    case CV_REG_GS:
-        return L"gs";
-    case CV_REG_IP:
-        return L"ip";
-    case CV_REG_FLAGS:
-        return L"flags";
-    case CV_REG_EIP:
-        return L"eip";
-    case CV_REG_EFLAGS:
-        return L"eflags";
-    }
-
-    std::stringstream sstr;
-    sstr << "I386 context: unsupported register index " << std::dec << index;
-    throw DbgException(sstr.str());
+    return i386RegisterMap.getTable();
 }
 
 ///////////////////////////////////////////////////////////////////////////////
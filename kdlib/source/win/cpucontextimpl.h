@@ -5,6 +5,7 @@
 #include "kdlib/cpucontext.h"
 
 #include "threadctx.h"
+#include "cpuregmap.h"
 
 namespace kdlib {
 
@@ -32,16 +33,25 @@ public:
     }
 
     virtual NumVariant getRegisterByName(const std::wstring &name) {
-        NOT_IMPLEMENTED();
+        return CPURegisterTable::readRegister(m_registers.getByName(name), &m_context);
     }
     virtual void setRegisterByName(const std::wstring &name, const NumVariant& value) {
         NOT_IMPLEMENTED();
     }
+    virtual NumVariant getRegisterByIndex(unsigned long index) {
+        return CPURegisterTable::readRegister(m_registers.getByIndex(index), &m_context);
+    }
     virtual void setRegisterByIndex(unsigned long index, const NumVariant& value) {
         NOT_IMPLEMENTED();
     }
+    virtual std::wstring getRegisterName(unsigned long index) {
+        return m_registers.getByIndex(index).name;
+    }
     virtual unsigned long getRegisterNumber() {
-        NOT_IMPLEMENTED();
+        return static_cast<unsigned long>(m_registers.getCount());
+    }
+    virtual void getRegisters(std::vector<unsigned long>& indices, std::vector<NumVariant>& values) {
+        m_registers.exportRegisters(&m_context, indices, values);
     }
 
     virtual void setIP(MEMOFFSET_64 ip) {
@@ -55,8 +65,8 @@ public:
     }
 
 protected:
-    CPUContextImpl(CPUType cpuType, CPUType cpuMode, const CONTEXT_TYPE *context = nullptr)
-        : m_cpuType{ cpuType }, m_cpuMode{ cpuMode }
+    CPUContextImpl(CPUType cpuType, CPUType cpuMode, const CPURegisterTable& registers, const CONTEXT_TYPE *context = nullptr)
+        : m_cpuType{ cpuType }, m_cpuMode{ cpuMode }, m_registers{ registers }
     {
         if (context)
         {
@@ -77,6 +87,7 @@ protected:
 private:
     const CPUType m_cpuType;
     const CPUType m_cpuMode;
+    const CPURegisterTable m_registers;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -86,18 +97,16 @@ class CPUContextAmd64 : public CPUContextImpl<CONTEXT_X64>
     typedef CPUContextImpl<CONTEXT_X64> Base;
 public:
     CPUContextAmd64() :
-        Base{ CPU_AMD64, CPU_AMD64 }
+        Base{ CPU_AMD64, CPU_AMD64, getRegisterTable() }
     {
     }
 
     explicit CPUContextAmd64(const CONTEXT_X64 &context) :
-        Base{ CPU_AMD64, CPU_AMD64, &context }
+        Base{ CPU_AMD64, CPU_AMD64, getRegisterTable(), &context }
     {
     }
 
-    virtual NumVariant getRegisterByIndex(unsigned long index); 
-
-    virtual std::wstring getRegisterName(unsigned long index);
+    static CPURegisterTable getRegisterTable();
 
     virtual MEMOFFSET_64 getIP() {
         return m_context.Rip;
@@ -119,18 +128,16 @@ class CPUContextI386 : public CPUContextImpl<CONTEXT_X86>
     typedef CPUContextImpl<CONTEXT_X86> Base;
 public:
     CPUContextI386() :
-        Base{ CPU_I386, CPU_I386 }
+        Base{ CPU_I386, CPU_I386, getRegisterTable() }
     {
     }
 
     CPUContextI386(const CONTEXT_X86 &context) :
-        Base{ CPU_I386, CPU_I386, &context }
+        Base{ CPU_I386, CPU_I386, getRegisterTable(), &context }
     {
     }
 
-    virtual NumVariant getRegisterByIndex(unsigned long index);
-
-    virtual std::wstring getRegisterName(unsigned long index);
+    static CPURegisterTable getRegisterTable();
 
     virtual MEMOFFSET_64 getIP() {
         return m_context.Eip;
@@ -152,18 +159,16 @@ class CPUContextWOW64 : public CPUContextImpl<WOW64_CONTEXT>
     typedef CPUContextImpl<WOW64_CONTEXT> Base;
 public:
     CPUContextWOW64() :
-        Base{ CPU_AMD64, CPU_I386 }
+        Base{ CPU_AMD64, CPU_I386, getRegisterTable() }
     {
     }
 
     explicit CPUContextWOW64(const WOW64_CONTEXT &context) :
-        Base{ CPU_AMD64, CPU_I386, &context }
+        Base{ CPU_AMD64, CPU_I386, getRegisterTable(), &context }
     {
     }
 
-    virtual NumVariant getRegisterByIndex(unsigned long index);
-    
-    virtual std::wstring getRegisterName(unsigned long index);
+    static CPURegisterTable getRegisterTable();
 
     virtual MEMOFFSET_64 getIP() {
         return m_context.Eip;
@@ -185,18 +190,16 @@ class CPUContextArm64 : public CPUContextImpl<CONTEXT_ARM64_STRUCT>
     typedef CPUContextImpl<CONTEXT_ARM64_STRUCT> Base;
 public:
     CPUContextArm64() :
-        Base{ CPU_ARM64, CPU_ARM64 }
+        Base{ CPU_ARM64, CPU_ARM64, getRegisterTable() }
     {
     }
 
     explicit CPUContextArm64(const CONTEXT_ARM64_STRUCT &context) :
-        Base{ CPU_ARM64, CPU_ARM64, &context }
+        Base{ CPU_ARM64, CPU_ARM64, getRegisterTable(), &context }
     {
     }
 
-    virtual NumVariant getRegisterByIndex(unsigned long index);
-
-    virtual std::wstring getRegisterName(unsigned long index);
+    static CPURegisterTable getRegisterTable();
 
     virtual MEMOFFSET_64 getIP() {
         return m_context.Pc;
@@ -218,18 +221,16 @@ class CPUContextArm : public CPUContextImpl<CONTEXT_ARM>
     typedef CPUContextImpl<CONTEXT_ARM> Base;
 public:
     CPUContextArm() :
-        Base{ CPU_ARM, CPU_ARM }
+        Base{ CPU_ARM, CPU_ARM, getRegisterTable() }
     {
     }
 
     explicit CPUContextArm(const CONTEXT_ARM &context) :
-        Base{ CPU_ARM, CPU_ARM, &context }
+        Base{ CPU_ARM, CPU_ARM, getRegisterTable(), &context }
     {
     }
 
-    virtual NumVariant getRegisterByIndex(unsigned long index);
-
-    virtual std::wstring getRegisterName(unsigned long index);
+    static CPURegisterTable getRegisterTable();
 
     virtual MEMOFFSET_64 getIP() {
         return m_context.Pc;
@@ -579,6 +579,8 @@ std::wstring debugCommand( const std::wstring &command, bool suppressOutput, con
 
         waitForEvent();
 
+        outReader.checkSink();
+
         return outReader.Line();
     }
 
@@ -594,6 +596,26 @@ std::wstring debugCommand( const std::wstring &command, bool suppressOutput, con
 
 ///////////////////////////////////////////////////////////////////////////////////
 
+void debugCommand( const std::wstring &command, OutputSink& sink, const OutputFlagsSet& captureFlags )
+{
+    HRESULT         hres;
+
+    OutputReader  outReader( g_dbgMgr->client, static_cast<ULONG>(captureFlags), &sink );
+
+    hres = g_dbgMgr->control->ExecuteWide( DEBUG_OUTCTL_THIS_CLIENT, command.c_str(), 0 );
+
+    if ( FAILED( hres ) )
+        throw  DbgEngException( L"IDebugControl::ExecuteWide", hres );
+
+    waitForEvent();
+
+    outReader.checkSink();
+
+    sink.flush();
+}
+
+///////////////////////////////////////////////////////////////////////////////////
+
 NumVariant evaluate( const std::wstring  &expression, bool cplusplus )
 {
     HRESULT             hres;
@@ -1541,9 +1563,9 @@ MEMOFFSET_64 getThreadOffset( THREAD_DEBUG_ID id)
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void registerEventsCallback( DebugEventsCallback *callback )
+void registerEventsCallback( DebugEventsCallback *callback, unsigned long eventsMask )
 {
-    g_dbgMgr->registerEventsCallback(callback);
+    g_dbgMgr->registerEventsCallback(callback, eventsMask);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -2002,6 +2024,56 @@ void setRegisterValue(unsigned long index, void* buffer, size_t bufferSize )
 
 ///////////////////////////////////////////////////////////////////////////////
 
+void setRegisterValues(const std::vector<unsigned long>& indices, const std::vector<unsigned long long>& values)
+{
+    HRESULT  hres;
+
+    if ( indices.size() != values.size() )
+        throw DbgException( "register indices and values do not match" );
+
+    if ( indices.empty() )
+        return;
+
+    std::vector<ULONG>  regIndices( indices.begin(), indices.end() );
+    std::vector<DEBUG_VALUE>  dbgvalues( indices.size() );
+
+    hres = g_dbgMgr->registers->GetValues( static_cast<ULONG>(regIndices.size()), &regIndices[0], 0, &dbgvalues[0] );
+    if ( FAILED(hres) )
+        throw CPUException(L"failed to get value of the register");
+
+    for ( size_t i = 0; i < dbgvalues.size(); ++i )
+    {
+        switch ( dbgvalues[i].Type )
+        {
+        case DEBUG_VALUE_INT8:
+            dbgvalues[i].I8 = static_cast<UCHAR>(values[i]);
+            break;
+
+        case DEBUG_VALUE_INT16:
+            dbgvalues[i].I16 = static_cast<USHORT>(values[i]);
+            break;
+
+        case DEBUG_VALUE_INT32:
+            dbgvalues[i].I32 = static_cast<ULONG>(values[i]);
+            break;
+
+        case DEBUG_VALUE_INT64:
+            dbgvalues[i].I64 = values[i];
+            dbgvalues[i].Nat = FALSE;
+            break;
+
+        default:
+            throw DbgException( "unsupported registry type");
+        }
+    }
+
+    hres = g_dbgMgr->registers->SetValues( static_cast<ULONG>(regIndices.size()), &regIndices[0], 0, &dbgvalues[0] );
+    if ( FAILED(hres) )
+        throw CPUException(L"failed to set value of the register");
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
 unsigned long long loadMSR(unsigned long msrIndex )
 {
     HRESULT  hres;
@@ -88,9 +88,9 @@ DebugManager::~DebugManager()
 
 ///////////////////////////////////////////////////////////////////////////////
 
-void DebugManager::registerEventsCallback(DebugEventsCallback *callback)
+void DebugManager::registerEventsCallback(DebugEventsCallback *callback, unsigned long eventsMask)
 {
-    ProcessMonitor::registerEventsCallback(callback);
+    ProcessMonitor::registerEventsCallback(callback, eventsMask);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -461,8 +461,16 @@ HRESULT STDMETHODCALLTYPE OutputReader::Output(
         __in ULONG Mask,
         __in PCWSTR Text )
 {
-    if ( ( Mask & m_mask ) != 0 )
-        m_readLine += Text;
+    if ( ( Mask & m_mask ) == 0 || m_sinkError )
+        return S_OK;
+
+    try {
+        m_sink->write( Text, wcslen(Text) );
+    }
+    catch(...)
+    {
+        m_sinkError = std::current_exception();
+    }
 
     return S_OK;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <exception>
 #include <list>
 #include <string>
 
@@ -12,6 +13,7 @@
 #include <boost/noncopyable.hpp>
 
 #include "kdlib/dbgcallbacks.h"
+#include "kdlib/outputsink.h"
 
 #include "exceptions.h"
 
@@ -51,7 +53,7 @@ public:
         return previous;
     }
 
-    void registerEventsCallback(DebugEventsCallback *callback);
+    void registerEventsCallback(DebugEventsCallback *callback, unsigned long eventsMask = DebugEventAll);
 
     void removeEventsCallback(DebugEventsCallback *callback);
 
@@ -239,13 +241,15 @@ class OutputReader : public IDebugOutputCallbacksWide, private boost::noncopyabl
 
 public:
 
-    explicit OutputReader(IDebugClient5* client, ULONG outputMask = DEBUG_OUTPUT_NORMAL)
+    // the output goes to the sink or is kept by the reader when the sink is not set
+    explicit OutputReader(IDebugClient5* client, ULONG outputMask = DEBUG_OUTPUT_NORMAL, OutputSink* sink = NULL)
     {
         HRESULT  hres;
 
         m_callbacks = NULL;
         m_client = client;
         m_mask = outputMask;
+        m_sink = sink ? sink : &m_chunks;
 
         hres = m_client->GetOutputCallbacksWide(&m_callbacks);
         if ( FAILED( hres ) )
@@ -263,9 +267,15 @@ public:
         m_client->SetOutputCallbacksWide(m_callbacks);
     }
 
-    const std::wstring&
+    std::wstring
     Line() const {
-        return  m_readLine;
+        return  m_chunks.str();
+    }
+
+    // an exception of the sink can not pass through the engine: it is kept and rethrown here
+    void checkSink() const {
+        if ( m_sinkError )
+            std::rethrow_exception( m_sinkError );
     }
 
     CComPtr<IDebugClient5>& getClient() {
@@ -296,7 +306,11 @@ private:
 
 private:
 
-    std::wstring                        m_readLine;
+    OutputChunks                        m_chunks;
+
+    OutputSink*                         m_sink;
+
+    std::exception_ptr                  m_sinkError;
 
     CComPtr<IDebugClient5>              m_client;
 
@@ -337,6 +337,18 @@ protected:
         return TargetThread::getCurrent();
     }
 
+    virtual RegisterSnapshot getRegisterSnapshot(const std::vector<std::wstring>& registers, const std::vector<THREAD_DEBUG_ID>& threads)
+    {
+        if (isCurrent())
+            return kdlib::getRegisterSnapshot(registers, threads);
+
+        ContextAutoRestore  contextRestore;
+
+        switchContext();
+
+        return kdlib::getRegisterSnapshot(registers, threads);
+    }
+
     virtual unsigned long getNumberModules()
     {
         if (isCurrent())
@@ -600,16 +612,37 @@ protected:
         return kdlib::getStack(inlineFrame);
     }
 
-    virtual unsigned long getNumberRegisters() {
-        NOT_IMPLEMENTED();
+    virtual unsigned long getNumberRegisters()
+    {
+        if (isCurrent())
+            return loadCPUContext()->getRegisterNumber();
+
+        ContextAutoRestore  contextRestore;
+        switchContext();
+
+        return loadCPUContext()->getRegisterNumber();
     }
 
-    virtual NumVariant getRegisterByName(const std::wstring& regName) {
-        NOT_IMPLEMENTED();
+    virtual NumVariant getRegisterByName(const std::wstring& regName)
+    {
+        if (isCurrent())
+            return loadCPUContext()->getRegisterByName(regName);
+
+        ContextAutoRestore  contextRestore;
+        switchContext();
+
+        return loadCPUContext()->getRegisterByName(regName);
     }
 
-    virtual NumVariant getRegisterByIndex(unsigned long regIndex) {
-        NOT_IMPLEMENTED();
+    virtual NumVariant getRegisterByIndex(unsigned long regIndex)
+    {
+        if (isCurrent())
+            return loadCPUContext()->getRegisterByIndex(regIndex);
+
+        ContextAutoRestore  contextRestore;
+        switchContext();
+
+        return loadCPUContext()->getRegisterByIndex(regIndex);
     }
 
     virtual MEMOFFSET_64 getInstructionOffset()
@@ -0,0 +1,2168 @@
+#include "stdafx.h"
+
+#include <cstring>
+
+#include "kdlib/x86decoder.h"
+#include "kdlib/exceptions.h"
+
+namespace kdlib {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char* const mnemonicNames[] = {
+#define X86_MNEMONIC_NAME(id, name) name,
+    X86_MNEMONICS(X86_MNEMONIC_NAME)
+#undef X86_MNEMONIC_NAME
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// operand encodings, the names follow the Intel opcode map notation
+
+enum OperandSpec : unsigned char {
+    O_NONE,
+    O_Eb, O_Ew, O_Ed, O_Eq, O_Ev, O_Ey,     // modrm rm: register or memory
+    O_Gb, O_Gw, O_Gd, O_Gv, O_Gy,           // modrm reg: general register
+    O_Ry,                                   // modrm rm: register only
+    O_M, O_Mb, O_Mw, O_Md, O_Mq, O_Mt, O_Mv, O_Mp, O_Mx,
+    O_MwRv, O_MwRd, O_MbRd,                 // memory of a fixed size or a register
+    O_Ib, O_Ibs, O_Iw, O_Iz, O_Iv, O_I1,
+    O_Jb, O_Jz,
+    O_Ob, O_Ov,                             // moffs
+    O_Ap,
+    O_Sw, O_Cy, O_Dy,
+    O_Zb, O_Zv,                             // register in the low opcode bits
+    O_AL, O_CL, O_DX, O_AX, O_rAX, O_eAX,
+    O_ES, O_CS, O_SS, O_DS, O_FS, O_GS,
+    O_Xb, O_Xv, O_Xz, O_Yb, O_Yv, O_Yz,     // string operands
+    O_XLAT,
+    O_V, O_W, O_Wd, O_Wq, O_U, O_H,         // xmm/ymm/zmm
+    O_P, O_Q, O_N,                          // mmx
+    O_Px, O_Qx, O_Nx,                       // mmx or xmm by the 66 prefix
+    O_ST0, O_STi
+};
+
+enum EntryFlags : unsigned short {
+    F_MODRM = 0x0001,
+    F_GROUP = 0x0002,       // mnemonic is a group index, the modrm reg field selects the entry
+    F_SSE = 0x0004,         // mnemonic is an index of sseMap, the mandatory prefix selects the entry
+    F_DEF64 = 0x0008,       // 64 bit default operand size in the long mode
+    F_INV64 = 0x0010,       // invalid in the long mode
+    F_SIZED = 0x0020,       // mnemonic + 0, 1, 2 for 16, 32, 64 bit operand size ( cbw, cwde, cdqe )
+    F_MMX = 0x0040,         // mmx form without prefix, sse form with 66
+    F_NDS = 0x0080,         // vex form has the vvvv source after the first operand
+    F_NDD = 0x0100,         // vex form has the vvvv destination as the first operand
+    F_REXW = 0x0200,        // mnemonic + 1 with REX.W ( movd -> movq )
+    F_X87 = 0x0400,
+    F_VEX = 0x0800          // vex encoding is allowed for a not sse instruction
+};
+
+struct OpcodeEntry {
+    unsigned short  mnemonic;
+    unsigned short  flags;
+    unsigned char  operands[3];
+};
+
+const unsigned short  MR = F_MODRM;
+const unsigned short  D64 = F_DEF64;
+const unsigned short  I64 = F_INV64;
+
+#define ALU_ROW(mn) \
+    { X86##mn, MR, { O_Eb, O_Gb } }, { X86##mn, MR, { O_Ev, O_Gv } }, \
+    { X86##mn, MR, { O_Gb, O_Eb } }, { X86##mn, MR, { O_Gv, O_Ev } }, \
+    { X86##mn, 0, { O_AL, O_Ib } }, { X86##mn, 0, { O_rAX, O_Iz } }
+
+#define CC_ENTRY(first, cc, fl, a, b) { static_cast<unsigned short>(first + cc), fl, { a, b } }
+
+#define CC_ROW(first, fl, a, b) \
+    CC_ENTRY(first, 0, fl, a, b), CC_ENTRY(first, 1, fl, a, b), CC_ENTRY(first, 2, fl, a, b), CC_ENTRY(first, 3, fl, a, b), \
+    CC_ENTRY(first, 4, fl, a, b), CC_ENTRY(first, 5, fl, a, b), CC_ENTRY(first, 6, fl, a, b), CC_ENTRY(first, 7, fl, a, b), \
+    CC_ENTRY(first, 8, fl, a, b), CC_ENTRY(first, 9, fl, a, b), CC_ENTRY(first, 10, fl, a, b), CC_ENTRY(first, 11, fl, a, b), \
+    CC_ENTRY(first, 12, fl, a, b), CC_ENTRY(first, 13, fl, a, b), CC_ENTRY(first, 14, fl, a, b), CC_ENTRY(first, 15, fl, a, b)
+
+#define REG_ROW(mn, fl, a, b) \
+    { X86##mn, fl, { a, b } }, { X86##mn, fl, { a, b } }, { X86##mn, fl, { a, b } }, { X86##mn, fl, { a, b } }, \
+    { X86##mn, fl, { a, b } }, { X86##mn, fl, { a, b } }, { X86##mn, fl, { a, b } }, { X86##mn, fl, { a, b } }
+
+#define BAD { X86Invalid, 0 }
+
+///////////////////////////////////////////////////////////////////////////////
+
+enum GroupIndex {
+    G_1, G_1A, G_2, G_3b, G_3v, G_4, G_5, G_11b, G_11v,
+    G_6, G_7, G_8, G_9, G_12, G_13, G_14, G_15, G_16, G_P
+};
+
+enum SseIndex {
+    S_10, S_11, S_12, S_13, S_14, S_15, S_16, S_17,
+    S_28, S_29, S_2A, S_2B, S_2C, S_2D, S_2E, S_2F,
+    S_50, S_51, S_52, S_53, S_54, S_55, S_56, S_57,
+    S_58, S_59, S_5A, S_5B, S_5C, S_5D, S_5E, S_5F,
+    S_6C, S_6D, S_6E, S_6F, S_70, S_7C, S_7D, S_7E, S_7F,
+    S_B8, S_BC, S_BD, S_C2, S_C6, S_D0, S_D6, S_E6, S_E7, S_F0, S_F7
+};
+
+const OpcodeEntry  oneByteMap[256] = {
+    /* 00 */ ALU_ROW(Add), { X86Push, I64, { O_ES } }, { X86Pop, I64, { O_ES } },
+    /* 08 */ ALU_ROW(Or), { X86Push, I64, { O_CS } }, BAD,
+    /* 10 */ ALU_ROW(Adc), { X86Push, I64, { O_SS } }, { X86Pop, I64, { O_SS } },
+    /* 18 */ ALU_ROW(Sbb), { X86Push, I64, { O_DS } }, { X86Pop, I64, { O_DS } },
+    /* 20 */ ALU_ROW(And), BAD, { X86Daa, I64 },
+    /* 28 */ ALU_ROW(Sub), BAD, { X86Das, I64 },
+    /* 30 */ ALU_ROW(Xor), BAD, { X86Aaa, I64 },
+    /* 38 */ ALU_ROW(Cmp), BAD, { X86Aas, I64 },
+    /* 40 */ REG_ROW(Inc, I64, O_Zv, O_NONE),
+    /* 48 */ REG_ROW(Dec, I64, O_Zv, O_NONE),
+    /* 50 */ REG_ROW(Push, D64, O_Zv, O_NONE),
+    /* 58 */ REG_ROW(Pop, D64, O_Zv, O_NONE),
+    /* 60 */ { X86Pusha, I64 | F_SIZED }, { X86Popa, I64 | F_SIZED },
+             { X86Bound, MR | I64, { O_Gv, O_M } }, { X86Arpl, MR, { O_Ew, O_Gw } },
+             BAD, BAD, BAD, BAD,
+    /* 68 */ { X86Push, D64, { O_Iz } }, { X86Imul, MR, { O_Gv, O_Ev, O_Iz } },
+             { X86Push, D64, { O_Ibs } }, { X86Imul, MR, { O_Gv, O_Ev, O_Ibs } },
+             { X86Ins, 0, { O_Yb, O_DX } }, { X86Ins, 0, { O_Yz, O_DX } },
+             { X86Outs, 0, { O_DX, O_Xb } }, { X86Outs, 0, { O_DX, O_Xz } },
+    /* 70 */ CC_ROW(X86Jo, D64, O_Jb, O_NONE),
+    /* 80 */ { G_1, F_GROUP | MR, { O_Eb, O_Ib } }, { G_1, F_GROUP | MR, { O_Ev, O_Iz } },
+             { G_1, F_GROUP | MR | I64, { O_Eb, O_Ib } }, { G_1, F_GROUP | MR, { O_Ev, O_Ibs } },
+             { X86Test, MR, { O_Eb, O_Gb } }, { X86Test, MR, { O_Ev, O_Gv } },
+             { X86Xchg, MR, { O_Eb, O_Gb } }, { X86Xchg, MR, { O_Ev, O_Gv } },
+    /* 88 */ { X86Mov, MR, { O_Eb, O_Gb } }, { X86Mov, MR, { O_Ev, O_Gv } },
+             { X86Mov, MR, { O_Gb, O_Eb } }, { X86Mov, MR, { O_Gv, O_Ev } },
+             { X86Mov, MR, { O_MwRv, O_Sw } }, { X86Lea, MR, { O_Gv, O_M } },
+             { X86Mov, MR, { O_Sw, O_Ew } }, { G_1A, F_GROUP | MR | D64, { O_Ev } },
+    /* 90 */ { X86Nop, 0 }, { X86Xchg, 0, { O_Zv, O_rAX } }, { X86Xchg, 0, { O_Zv, O_rAX } }, { X86Xchg, 0, { O_Zv, O_rAX } },
+             { X86Xchg, 0, { O_Zv, O_rAX } }, { X86Xchg, 0, { O_Zv, O_rAX } }, { X86Xchg, 0, { O_Zv, O_rAX } }, { X86Xchg, 0, { O_Zv, O_rAX } },
+    /* 98 */ { X86Cbw, F_SIZED }, { X86Cwd, F_SIZED }, { X86CallFar, I64, { O_Ap } }, { X86Wait, 0 },
+             { X86Pushf, D64 | F_SIZED }, { X86Popf, D64 | F_SIZED }, { X86Sahf, 0 }, { X86Lahf, 0 },
+    /* A0 */ { X86Mov, 0, { O_AL, O_Ob } }, { X86Mov, 0, { O_rAX, O_Ov } },
+             { X86Mov, 0, { O_Ob, O_AL } }, { X86Mov, 0, { O_Ov, O_rAX } },
+             { X86Movs, 0, { O_Yb, O_Xb } }, { X86Movs, 0, { O_Yv, O_Xv } },
+             { X86Cmps, 0, { O_Xb, O_Yb } }, { X86Cmps, 0, { O_Xv, O_Yv } },
+    /* A8 */ { X86Test, 0, { O_AL, O_Ib } }, { X86Test, 0, { O_rAX, O_Iz } },
+             { X86Stos, 0, { O_Yb, O_AL } }, { X86Stos, 0, { O_Yv, O_rAX } },
+             { X86Lods, 0, { O_AL, O_Xb } }, { X86Lods, 0, { O_rAX, O_Xv } },
+             { X86Scas, 0, { O_AL, O_Yb } }, { X86Scas, 0, { O_rAX, O_Yv } },
+    /* B0 */ REG_ROW(Mov, 0, O_Zb, O_Ib),
+    /* B8 */ REG_ROW(Mov, 0, O_Zv, O_Iv),
+    /* C0 */ { G_2, F_GROUP | MR, { O_Eb, O_Ib } }, { G_2, F_GROUP | MR, { O_Ev, O_Ib } },
+             { X86Ret, D64, { O_Iw } }, { X86Ret, D64 },
+             { X86Les, MR | I64, { O_Gv, O_Mp } }, { X86Lds, MR | I64, { O_Gv, O_Mp } },
+             { G_11b, F_GROUP | MR, { O_Eb, O_Ib } }, { G_11v, F_GROUP | MR, { O_Ev, O_Iz } },
+    /* C8 */ { X86Enter, D64, { O_Iw, O_Ib } }, { X86Leave, D64 }, { X86Retf, 0, { O_Iw } }, { X86Retf, 0 },
+             { X86Int3, 0 }, { X86Int, 0, { O_Ib } }, { X86Into, I64 }, { X86Iret, F_SIZED },
+    /* D0 */ { G_2, F_GROUP | MR, { O_Eb, O_I1 } }, { G_2, F_GROUP | MR, { O_Ev, O_I1 } },
+             { G_2, F_GROUP | MR, { O_Eb, O_CL } }, { G_2, F_GROUP | MR, { O_Ev, O_CL } },
+             { X86Aam, I64, { O_Ib } }, { X86Aad, I64, { O_Ib } }, { X86Salc, I64 }, { X86Xlat, 0, { O_XLAT } },
+    /* D8 */ { 0, F_X87 | MR }, { 1, F_X87 | MR }, { 2, F_X87 | MR }, { 3, F_X87 | MR },
+             { 4, F_X87 | MR }, { 5, F_X87 | MR }, { 6, F_X87 | MR }, { 7, F_X87 | MR },
+    /* E0 */ { X86Loopne, D64, { O_Jb } }, { X86Loope, D64, { O_Jb } }, { X86Loop, D64, { O_Jb } }, { X86Jcxz, D64, { O_Jb } },
+             { X86In, 0, { O_AL, O_Ib } }, { X86In, 0, { O_eAX, O_Ib } },
+             { X86Out, 0, { O_Ib, O_AL } }, { X86Out, 0, { O_Ib, O_eAX } },
+    /* E8 */ { X86Call, D64, { O_Jz } }, { X86Jmp, D64, { O_Jz } }, { X86JmpFar, I64, { O_Ap } }, { X86Jmp, D64, { O_Jb } },
+             { X86In, 0, { O_AL, O_DX } }, { X86In, 0, { O_eAX, O_DX } },
+             { X86Out, 0, { O_DX, O_AL } }, { X86Out, 0, { O_DX, O_eAX } },
+    /* F0 */ BAD, { X86Int1, 0 }, BAD, BAD, { X86Hlt, 0 }, { X86Cmc, 0 },
+             { G_3b, F_GROUP | MR, { O_Eb } }, { G_3v, F_GROUP | MR, { O_Ev } },
+    /* F8 */ { X86Clc, 0 }, { X86Stc, 0 }, { X86Cli, 0 }, { X86Sti, 0 }, { X86Cld, 0 }, { X86Std, 0 },
+             { G_4, F_GROUP | MR, { O_Eb } }, { G_5, F_GROUP | MR, { O_Ev } }
+};
+
+const OpcodeEntry  twoByteMap[256] = {
+    /* 00 */ { G_6, F_GROUP | MR }, { G_7, F_GROUP | MR },
+             { X86Lar, MR, { O_Gv, O_Ew } }, { X86Lsl, MR, { O_Gv, O_Ew } },
+             BAD, { X86Syscall, 0 }, { X86Clts, 0 }, { X86Sysret, 0 },
+    /* 08 */ { X86Invd, 0 }, { X86Wbinvd, 0 }, BAD, { X86Ud2, 0 },
+             BAD, { G_P, F_GROUP | MR, { O_Mb } }, { X86Femms, 0 }, BAD,
+    /* 10 */ { S_10, F_SSE | MR }, { S_11, F_SSE | MR }, { S_12, F_SSE | MR }, { S_13, F_SSE | MR },
+             { S_14, F_SSE | MR }, { S_15, F_SSE | MR }, { S_16, F_SSE | MR }, { S_17, F_SSE | MR },
+    /* 18 */ { G_16, F_GROUP | MR, { O_Mb } }, { X86Nop, MR, { O_Ev } }, { X86Nop, MR, { O_Ev } }, { X86Nop, MR, { O_Ev } },
+             { X86Nop, MR, { O_Ev } }, { X86Nop, MR, { O_Ev } }, { X86Nop, MR, { O_Ev } }, { X86Nop, MR, { O_Ev } },
+    /* 20 */ { X86Mov, MR, { O_Ry, O_Cy } }, { X86Mov, MR, { O_Ry, O_Dy } },
+             { X86Mov, MR, { O_Cy, O_Ry } }, { X86Mov, MR, { O_Dy, O_Ry } },
+             BAD, BAD, BAD, BAD,
+    /* 28 */ { S_28, F_SSE | MR }, { S_29, F_SSE | MR }, { S_2A, F_SSE | MR }, { S_2B, F_SSE | MR },
+             { S_2C, F_SSE | MR }, { S_2D, F_SSE | MR }, { S_2E, F_SSE | MR }, { S_2F, F_SSE | MR },
+    /* 30 */ { X86Wrmsr, 0 }, { X86Rdtsc, 0 }, { X86Rdmsr, 0 }, { X86Rdpmc, 0 },
+             { X86Sysenter, 0 }, { X86Sysexit, 0 }, BAD, { X86Unknown, 0 },
+    /* 38 */ BAD, BAD, BAD, BAD, BAD, BAD, BAD, BAD,
+    /* 40 */ CC_ROW(X86Cmovo, MR, O_Gv, O_Ev),
+    /* 50 */ { S_50, F_SSE | MR }, { S_51, F_SSE | MR }, { S_52, F_SSE | MR }, { S_53, F_SSE | MR },
+             { S_54, F_SSE | MR }, { S_55, F_SSE | MR }, { S_56, F_SSE | MR }, { S_57, F_SSE | MR },
+    /* 58 */ { S_58, F_SSE | MR }, { S_59, F_SSE | MR }, { S_5A, F_SSE | MR }, { S_5B, F_SSE | MR },
+             { S_5C, F_SSE | MR }, { S_5D, F_SSE | MR }, { S_5E, F_SSE | MR }, { S_5F, F_SSE | MR },
+    /* 60 */ { X86Punpcklbw, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Punpcklwd, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Punpckldq, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Packsswb, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Pcmpgtb, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Pcmpgtw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Pcmpgtd, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Packuswb, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+    /* 68 */ { X86Punpckhbw, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Punpckhwd, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Punpckhdq, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Packssdw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { S_6C, F_SSE | MR }, { S_6D, F_SSE | MR }, { S_6E, F_SSE | MR }, { S_6F, F_SSE | MR },
+    /* 70 */ { S_70, F_SSE | MR }, { G_12, F_GROUP | MR | F_MMX | F_NDD, { O_Nx, O_Ib } },
+             { G_13, F_GROUP | MR | F_MMX | F_NDD, { O_Nx, O_Ib } }, { G_14, F_GROUP | MR | F_MMX | F_NDD, { O_Nx, O_Ib } },
+             { X86Pcmpeqb, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Pcmpeqw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Pcmpeqd, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Emms, 0 },
+    /* 78 */ { X86Vmread, MR | D64, { O_Ey, O_Gy } }, { X86Vmwrite, MR | D64, { O_Gy, O_Ey } }, BAD, BAD,
+             { S_7C, F_SSE | MR }, { S_7D, F_SSE | MR }, { S_7E, F_SSE | MR }, { S_7F, F_SSE | MR },
+    /* 80 */ CC_ROW(X86Jo, D64, O_Jz, O_NONE),
+    /* 90 */ CC_ROW(X86Seto, MR, O_Eb, O_NONE),
+    /* A0 */ { X86Push, D64, { O_FS } }, { X86Pop, D64, { O_FS } }, { X86Cpuid, 0 }, { X86Bt, MR, { O_Ev, O_Gv } },
+             { X86Shld, MR, { O_Ev, O_Gv, O_Ib } }, { X86Shld, MR, { O_Ev, O_Gv, O_CL } }, BAD, BAD,
+    /* A8 */ { X86Push, D64, { O_GS } }, { X86Pop, D64, { O_GS } }, { X86Rsm, 0 }, { X86Bts, MR, { O_Ev, O_Gv } },
+             { X86Shrd, MR, { O_Ev, O_Gv, O_Ib } }, { X86Shrd, MR, { O_Ev, O_Gv, O_CL } },
+             { G_15, F_GROUP | MR }, { X86Imul, MR, { O_Gv, O_Ev } },
+    /* B0 */ { X86Cmpxchg, MR, { O_Eb, O_Gb } }, { X86Cmpxchg, MR, { O_Ev, O_Gv } },
+             { X86Lss, MR, { O_Gv, O_Mp } }, { X86Btr, MR, { O_Ev, O_Gv } },
+             { X86Lfs, MR, { O_Gv, O_Mp } }, { X86Lgs, MR, { O_Gv, O_Mp } },
+             { X86Movzx, MR, { O_Gv, O_Eb } }, { X86Movzx, MR, { O_Gv, O_Ew } },
+    /* B8 */ { S_B8, F_SSE | MR }, { X86Ud1, MR, { O_Gv, O_Ev } }, { G_8, F_GROUP | MR, { O_Ev, O_Ib } }, { X86Btc, MR, { O_Ev, O_Gv } },
+             { S_BC, F_SSE | MR }, { S_BD, F_SSE | MR }, { X86Movsx, MR, { O_Gv, O_Eb } }, { X86Movsx, MR, { O_Gv, O_Ew } },
+    /* C0 */ { X86Xadd, MR, { O_Eb, O_Gb } }, { X86Xadd, MR, { O_Ev, O_Gv } },
+             { S_C2, F_SSE | MR }, { X86Movnti, MR, { O_M, O_Gy } },
+             { X86Pinsrw, MR | F_MMX | F_NDS, { O_Px, O_MwRd, O_Ib } }, { X86Pextrw, MR | F_MMX | F_VEX, { O_Gd, O_Nx, O_Ib } },
+             { S_C6, F_SSE | MR }, { G_9, F_GROUP | MR },
+    /* C8 */ REG_ROW(Bswap, 0, O_Zv, O_NONE),
+    /* D0 */ { S_D0, F_SSE | MR }, { X86Psrlw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Psrld, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Psrlq, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Paddq, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Pmullw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { S_D6, F_SSE | MR }, { X86Pmovmskb, MR | F_MMX | F_VEX, { O_Gd, O_Nx } },
+    /* D8 */ { X86Psubusb, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Psubusw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Pminub, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Pand, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Paddusb, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Paddusw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Pmaxub, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Pandn, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+    /* E0 */ { X86Pavgb, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Psraw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Psrad, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Pavgw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Pmulhuw, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Pmulhw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { S_E6, F_SSE | MR }, { S_E7, F_SSE | MR },
+    /* E8 */ { X86Psubsb, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Psubsw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Pminsw, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Por, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Paddsb, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Paddsw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Pmaxsw, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Pxor, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+    /* F0 */ { S_F0, F_SSE | MR }, { X86Psllw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Pslld, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Psllq, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Pmuludq, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Pmaddwd, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Psadbw, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { S_F7, F_SSE | MR },
+    /* F8 */ { X86Psubb, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Psubw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Psubd, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Psubq, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Paddb, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Paddw, MR | F_MMX | F_NDS, { O_Px, O_Qx } },
+             { X86Paddd, MR | F_MMX | F_NDS, { O_Px, O_Qx } }, { X86Ud0, MR, { O_Gv, O_Ev } }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// group entries: if an entry has no operands the operands of the opcode are used
+
+const OpcodeEntry  groupMap[][8] = {
+    /* G_1 */   { { X86Add }, { X86Or }, { X86Adc }, { X86Sbb }, { X86And }, { X86Sub }, { X86Xor }, { X86Cmp } },
+    /* G_1A */  { { X86Pop }, BAD, BAD, BAD, BAD, BAD, BAD, BAD },
+    /* G_2 */   { { X86Rol }, { X86Ror }, { X86Rcl }, { X86Rcr }, { X86Shl }, { X86Shr }, { X86Sal }, { X86Sar } },
+    /* G_3b */  { { X86Test, 0, { O_Eb, O_Ib } }, { X86Test, 0, { O_Eb, O_Ib } }, { X86Not }, { X86Neg },
+                  { X86Mul }, { X86Imul }, { X86Div }, { X86Idiv } },
+    /* G_3v */  { { X86Test, 0, { O_Ev, O_Iz } }, { X86Test, 0, { O_Ev, O_Iz } }, { X86Not }, { X86Neg },
+                  { X86Mul }, { X86Imul }, { X86Div }, { X86Idiv } },
+    /* G_4 */   { { X86Inc }, { X86Dec }, BAD, BAD, BAD, BAD, BAD, BAD },
+    /* G_5 */   { { X86Inc }, { X86Dec }, { X86Call, D64 }, { X86CallFar, 0, { O_Mp } },
+                  { X86Jmp, D64 }, { X86JmpFar, 0, { O_Mp } }, { X86Push, D64 }, BAD },
+    /* G_11b */ { { X86Mov }, BAD, BAD, BAD, BAD, BAD, BAD, BAD },
+    /* G_11v */ { { X86Mov }, BAD, BAD, BAD, BAD, BAD, BAD, BAD },
+    /* G_6 */   { { X86Sldt, 0, { O_MwRv } }, { X86Str, 0, { O_MwRv } }, { X86Lldt, 0, { O_Ew } }, { X86Ltr, 0, { O_Ew } },
+                  { X86Verr, 0, { O_Ew } }, { X86Verw, 0, { O_Ew } }, BAD, BAD },
+    /* G_7 */   { { X86Sgdt, 0, { O_M } }, { X86Sidt, 0, { O_M } }, { X86Lgdt, 0, { O_M } }, { X86Lidt, 0, { O_M } },
+                  { X86Smsw, 0, { O_MwRv } }, BAD, { X86Lmsw, 0, { O_Ew } }, { X86Invlpg, 0, { O_Mb } } },
+    /* G_8 */   { BAD, BAD, BAD, BAD, { X86Bt }, { X86Bts }, { X86Btr }, { X86Btc } },
+    /* G_9 */   { BAD, { X86Cmpxchg8b, F_REXW, { O_Mq } }, BAD, BAD, BAD, BAD,
+                  { X86Vmptrld, 0, { O_Mq } }, { X86Vmptrst, 0, { O_Mq } } },
+    /* G_12 */  { BAD, BAD, { X86Psrlw }, BAD, { X86Psraw }, BAD, { X86Psllw }, BAD },
+    /* G_13 */  { BAD, BAD, { X86Psrld }, BAD, { X86Psrad }, BAD, { X86Pslld }, BAD },
+    /* G_14 */  { BAD, BAD, { X86Psrlq }, { X86Psrldq }, BAD, BAD, { X86Psllq }, { X86Pslldq } },
+    /* G_15 */  { { X86Fxsave, 0, { O_M } }, { X86Fxrstor, 0, { O_M } }, { X86Ldmxcsr, F_VEX, { O_Md } }, { X86Stmxcsr, F_VEX, { O_Md } },
+                  { X86Xsave, 0, { O_M } }, { X86Xrstor, 0, { O_M } }, { X86Xsaveopt, 0, { O_M } }, { X86Clflush, 0, { O_Mb } } },
+    /* G_16 */  { { X86Prefetchnta }, { X86Prefetcht0 }, { X86Prefetcht1 }, { X86Prefetcht2 },
+                  { X86Nop, 0, { O_Ev } }, { X86Nop, 0, { O_Ev } }, { X86Nop, 0, { O_Ev } }, { X86Nop, 0, { O_Ev } } },
+    /* G_P */   { { X86Prefetch }, { X86Prefetchw }, { X86Prefetch }, { X86Prefetch },
+                  { X86Prefetch }, { X86Prefetch }, { X86Prefetch }, { X86Prefetch } }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// prefix dependent entries of the 0F map: no prefix, 66, F3, F2
+
+const OpcodeEntry  sseMap[][4] = {
+    /* S_10 */ { { X86Movups, 0, { O_V, O_W } }, { X86Movupd, 0, { O_V, O_W } },
+                 { X86Movss, 0, { O_V, O_Wd } }, { X86Movsd, 0, { O_V, O_Wq } } },
+    /* S_11 */ { { X86Movups, 0, { O_W, O_V } }, { X86Movupd, 0, { O_W, O_V } },
+                 { X86Movss, 0, { O_Wd, O_V } }, { X86Movsd, 0, { O_Wq, O_V } } },
+    /* S_12 */ { { X86Movlps, F_NDS, { O_V, O_Mq } }, { X86Movlpd, F_NDS, { O_V, O_Mq } },
+                 { X86Movsldup, 0, { O_V, O_W } }, { X86Movddup, 0, { O_V, O_Wq } } },
+    /* S_13 */ { { X86Movlps, 0, { O_Mq, O_V } }, { X86Movlpd, 0, { O_Mq, O_V } }, BAD, BAD },
+    /* S_14 */ { { X86Unpcklps, F_NDS, { O_V, O_W } }, { X86Unpcklpd, F_NDS, { O_V, O_W } }, BAD, BAD },
+    /* S_15 */ { { X86Unpckhps, F_NDS, { O_V, O_W } }, { X86Unpckhpd, F_NDS, { O_V, O_W } }, BAD, BAD },
+    /* S_16 */ { { X86Movhps, F_NDS, { O_V, O_Mq } }, { X86Movhpd, F_NDS, { O_V, O_Mq } },
+                 { X86Movshdup, 0, { O_V, O_W } }, BAD },
+    /* S_17 */ { { X86Movhps, 0, { O_Mq, O_V } }, { X86Movhpd, 0, { O_Mq, O_V } }, BAD, BAD },
+    /* S_28 */ { { X86Movaps, 0, { O_V, O_W } }, { X86Movapd, 0, { O_V, O_W } }, BAD, BAD },
+    /* S_29 */ { { X86Movaps, 0, { O_W, O_V } }, { X86Movapd, 0, { O_W, O_V } }, BAD, BAD },
+    /* S_2A */ { { X86Cvtpi2ps, 0, { O_V, O_Q } }, { X86Cvtpi2pd, 0, { O_V, O_Q } },
+                 { X86Cvtsi2ss, F_NDS, { O_V, O_Ey } }, { X86Cvtsi2sd, F_NDS, { O_V, O_Ey } } },
+    /* S_2B */ { { X86Movntps, 0, { O_Mx, O_V } }, { X86Movntpd, 0, { O_Mx, O_V } }, BAD, BAD },
+    /* S_2C */ { { X86Cvttps2pi, 0, { O_P, O_Wq } }, { X86Cvttpd2pi, 0, { O_P, O_W } },
+                 { X86Cvttss2si, 0, { O_Gy, O_Wd } }, { X86Cvttsd2si, 0, { O_Gy, O_Wq } } },
+    /* S_2D */ { { X86Cvtps2pi, 0, { O_P, O_Wq } }, { X86Cvtpd2pi, 0, { O_P, O_W } },
+                 { X86Cvtss2si, 0, { O_Gy, O_Wd } }, { X86Cvtsd2si, 0, { O_Gy, O_Wq } } },
+    /* S_2E */ { { X86Ucomiss, 0, { O_V, O_Wd } }, { X86Ucomisd, 0, { O_V, O_Wq } }, BAD, BAD },
+    /* S_2F */ { { X86Comiss, 0, { O_V, O_Wd } }, { X86Comisd, 0, { O_V, O_Wq } }, BAD, BAD },
+    /* S_50 */ { { X86Movmskps, 0, { O_Gd, O_U } }, { X86Movmskpd, 0, { O_Gd, O_U } }, BAD, BAD },
+    /* S_51 */ { { X86Sqrtps, 0, { O_V, O_W } }, { X86Sqrtpd, 0, { O_V, O_W } },
+                 { X86Sqrtss, F_NDS, { O_V, O_Wd } }, { X86Sqrtsd, F_NDS, { O_V, O_Wq } } },
+    /* S_52 */ { { X86Rsqrtps, 0, { O_V, O_W } }, BAD, { X86Rsqrtss, F_NDS, { O_V, O_Wd } }, BAD },
+    /* S_53 */ { { X86Rcpps, 0, { O_V, O_W } }, BAD, { X86Rcpss, F_NDS, { O_V, O_Wd } }, BAD },
+    /* S_54 */ { { X86Andps, F_NDS, { O_V, O_W } }, { X86Andpd, F_NDS, { O_V, O_W } }, BAD, BAD },
+    /* S_55 */ { { X86Andnps, F_NDS, { O_V, O_W } }, { X86Andnpd, F_NDS, { O_V, O_W } }, BAD, BAD },
+    /* S_56 */ { { X86Orps, F_NDS, { O_V, O_W } }, { X86Orpd, F_NDS, { O_V, O_W } }, BAD, BAD },
+    /* S_57 */ { { X86Xorps, F_NDS, { O_V, O_W } }, { X86Xorpd, F_NDS, { O_V, O_W } }, BAD, BAD },
+    /* S_58 */ { { X86Addps, F_NDS, { O_V, O_W } }, { X86Addpd, F_NDS, { O_V, O_W } },
+                 { X86Addss, F_NDS, { O_V, O_Wd } }, { X86Addsd, F_NDS, { O_V, O_Wq } } },
+    /* S_59 */ { { X86Mulps, F_NDS, { O_V, O_W } }, { X86Mulpd, F_NDS, { O_V, O_W } },
+                 { X86Mulss, F_NDS, { O_V, O_Wd } }, { X86Mulsd, F_NDS, { O_V, O_Wq } } },
+    /* S_5A */ { { X86Cvtps2pd, 0, { O_V, O_Wq } }, { X86Cvtpd2ps, 0, { O_V, O_W } },
+                 { X86Cvtss2sd, F_NDS, { O_V, O_Wd } }, { X86Cvtsd2ss, F_NDS, { O_V, O_Wq } } },
+    /* S_5B */ { { X86Cvtdq2ps, 0, { O_V, O_W } }, { X86Cvtps2dq, 0, { O_V, O_W } },
+                 { X86Cvttps2dq, 0, { O_V, O_W } }, BAD },
+    /* S_5C */ { { X86Subps, F_NDS, { O_V, O_W } }, { X86Subpd, F_NDS, { O_V, O_W } },
+                 { X86Subss, F_NDS, { O_V, O_Wd } }, { X86Subsd, F_NDS, { O_V, O_Wq } } },
+    /* S_5D */ { { X86Minps, F_NDS, { O_V, O_W } }, { X86Minpd, F_NDS, { O_V, O_W } },
+                 { X86Minss, F_NDS, { O_V, O_Wd } }, { X86Minsd, F_NDS, { O_V, O_Wq } } },
+    /* S_5E */ { { X86Divps, F_NDS, { O_V, O_W } }, { X86Divpd, F_NDS, { O_V, O_W } },
+                 { X86Divss, F_NDS, { O_V, O_Wd } }, { X86Divsd, F_NDS, { O_V, O_Wq } } },
+    /* S_5F */ { { X86Maxps, F_NDS, { O_V, O_W } }, { X86Maxpd, F_NDS, { O_V, O_W } },
+                 { X86Maxss, F_NDS, { O_V, O_Wd } }, { X86Maxsd, F_NDS, { O_V, O_Wq } } },
+    /* S_6C */ { BAD, { X86Punpcklqdq, F_NDS, { O_V, O_W } }, BAD, BAD },
+    /* S_6D */ { BAD, { X86Punpckhqdq, F_NDS, { O_V, O_W } }, BAD, BAD },
+    /* S_6E */ { { X86Movd, F_REXW, { O_P, O_Ey } }, { X86Movd, F_REXW, { O_V, O_Ey } }, BAD, BAD },
+    /* S_6F */ { { X86Movq, 0, { O_P, O_Q } }, { X86Movdqa, 0, { O_V, O_W } }, { X86Movdqu, 0, { O_V, O_W } }, BAD },
+    /* S_70 */ { { X86Pshufw, 0, { O_P, O_Q, O_Ib } }, { X86Pshufd, 0, { O_V, O_W, O_Ib } },
+                 { X86Pshufhw, 0, { O_V, O_W, O_Ib } }, { X86Pshuflw, 0, { O_V, O_W, O_Ib } } },
+    /* S_7C */ { BAD, { X86Haddpd, F_NDS, { O_V, O_W } }, BAD, { X86Haddps, F_NDS, { O_V, O_W } } },
+    /* S_7D */ { BAD, { X86Hsubpd, F_NDS, { O_V, O_W } }, BAD, { X86Hsubps, F_NDS, { O_V, O_W } } },
+    /* S_7E */ { { X86Movd, F_REXW, { O_Ey, O_P } }, { X86Movd, F_REXW, { O_Ey, O_V } }, { X86Movq, 0, { O_V, O_Wq } }, BAD },
+    /* S_7F */ { { X86Movq, 0, { O_Q, O_P } }, { X86Movdqa, 0, { O_W, O_V } }, { X86Movdqu, 0, { O_W, O_V } }, BAD },
+    /* S_B8 */ { BAD, BAD, { X86Popcnt, 0, { O_Gv, O_Ev } }, BAD },
+    /* S_BC */ { { X86Bsf, 0, { O_Gv, O_Ev } }, { X86Bsf, 0, { O_Gv, O_Ev } },
+                 { X86Tzcnt, 0, { O_Gv, O_Ev } }, { X86Bsf, 0, { O_Gv, O_Ev } } },
+    /* S_BD */ { { X86Bsr, 0, { O_Gv, O_Ev } }, { X86Bsr, 0, { O_Gv, O_Ev } },
+                 { X86Lzcnt, 0, { O_Gv, O_Ev } }, { X86Bsr, 0, { O_Gv, O_Ev } } },
+    /* S_C2 */ { { X86Cmpps, F_NDS, { O_V, O_W, O_Ib } }, { X86Cmppd, F_NDS, { O_V, O_W, O_Ib } },
+                 { X86Cmpss, F_NDS, { O_V, O_Wd, O_Ib } }, { X86Cmpsd, F_NDS, { O_V, O_Wq, O_Ib } } },
+    /* S_C6 */ { { X86Shufps, F_NDS, { O_V, O_W, O_Ib } }, { X86Shufpd, F_NDS, { O_V, O_W, O_Ib } }, BAD, BAD },
+    /* S_D0 */ { BAD, { X86Addsubpd, F_NDS, { O_V, O_W } }, BAD, { X86Addsubps, F_NDS, { O_V, O_W } } },
+    /* S_D6 */ { BAD, { X86Movq, 0, { O_Wq, O_V } }, { X86Movq2dq, 0, { O_V, O_N } }, { X86Movdq2q, 0, { O_P, O_U } } },
+    /* S_E6 */ { BAD, { X86Cvttpd2dq, 0, { O_V, O_W } }, { X86Cvtdq2pd, 0, { O_V, O_Wq } }, { X86Cvtpd2dq, 0, { O_V, O_W } } },
+    /* S_E7 */ { { X86Movntq, 0, { O_Mq, O_P } }, { X86Movntdq, 0, { O_Mx, O_V } }, BAD, BAD },
+    /* S_F0 */ { BAD, BAD, BAD, { X86Lddqu, 0, { O_V, O_Mx } } },
+    /* S_F7 */ { { X86Maskmovq, 0, { O_P, O_N } }, { X86Maskmovdqu, 0, { O_V, O_U } }, BAD, BAD }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// 0F 38 and 0F 3A maps are sparse: they are listed by opcodes and expanded once
+
+enum PrefixKind {
+    PrefixNone,
+    Prefix66,
+    PrefixF3,
+    PrefixF2,
+    PrefixCount
+};
+
+struct SparseEntry {
+    unsigned char  opcode;
+    unsigned char  prefix;          // PrefixKind or PrefixCount for mmx/sse forms
+    OpcodeEntry  entry;
+};
+
+const unsigned char  PrefixMmx = PrefixCount;
+
+const SparseEntry  threeByteMap38[] = {
+    { 0x00, PrefixMmx, { X86Pshufb, F_NDS, { O_Px, O_Qx } } },
+    { 0x01, PrefixMmx, { X86Phaddw, F_NDS, { O_Px, O_Qx } } },
+    { 0x02, PrefixMmx, { X86Phaddd, F_NDS, { O_Px, O_Qx } } },
+    { 0x03, PrefixMmx, { X86Phaddsw, F_NDS, { O_Px, O_Qx } } },
+    { 0x04, PrefixMmx, { X86Pmaddubsw, F_NDS, { O_Px, O_Qx } } },
+    { 0x05, PrefixMmx, { X86Phsubw, F_NDS, { O_Px, O_Qx } } },
+    { 0x06, PrefixMmx, { X86Phsubd, F_NDS, { O_Px, O_Qx } } },
+    { 0x07, PrefixMmx, { X86Phsubsw, F_NDS, { O_Px, O_Qx } } },
+    { 0x08, PrefixMmx, { X86Psignb, F_NDS, { O_Px, O_Qx } } },
+    { 0x09, PrefixMmx, { X86Psignw, F_NDS, { O_Px, O_Qx } } },
+    { 0x0A, PrefixMmx, { X86Psignd, F_NDS, { O_Px, O_Qx } } },
+    { 0x0B, PrefixMmx, { X86Pmulhrsw, F_NDS, { O_Px, O_Qx } } },
+    { 0x10, Prefix66, { X86Pblendvb, 0, { O_V, O_W } } },
+    { 0x14, Prefix66, { X86Blendvps, 0, { O_V, O_W } } },
+    { 0x15, Prefix66, { X86Blendvpd, 0, { O_V, O_W } } },
+    { 0x17, Prefix66, { X86Ptest, 0, { O_V, O_W } } },
+    { 0x1C, PrefixMmx, { X86Pabsb, 0, { O_Px, O_Qx } } },
+    { 0x1D, PrefixMmx, { X86Pabsw, 0, { O_Px, O_Qx } } },
+    { 0x1E, PrefixMmx, { X86Pabsd, 0, { O_Px, O_Qx } } },
+    { 0x20, Prefix66, { X86Pmovsxbw, 0, { O_V, O_Wq } } },
+    { 0x21, Prefix66, { X86Pmovsxbd, 0, { O_V, O_Wd } } },
+    { 0x22, Prefix66, { X86Pmovsxbq, 0, { O_V, O_MwRd } } },
+    { 0x23, Prefix66, { X86Pmovsxwd, 0, { O_V, O_Wq } } },
+    { 0x24, Prefix66, { X86Pmovsxwq, 0, { O_V, O_Wd } } },
+    { 0x25, Prefix66, { X86Pmovsxdq, 0, { O_V, O_Wq } } },
+    { 0x28, Prefix66, { X86Pmuldq, F_NDS, { O_V, O_W } } },
+    { 0x29, Prefix66, { X86Pcmpeqq, F_NDS, { O_V, O_W } } },
+    { 0x2A, Prefix66, { X86Movntdqa, 0, { O_V, O_Mx } } },
+    { 0x2B, Prefix66, { X86Packusdw, F_NDS, { O_V, O_W } } },
+    { 0x30, Prefix66, { X86Pmovzxbw, 0, { O_V, O_Wq } } },
+    { 0x31, Prefix66, { X86Pmovzxbd, 0, { O_V, O_Wd } } },
+    { 0x32, Prefix66, { X86Pmovzxbq, 0, { O_V, O_MwRd } } },
+    { 0x33, Prefix66, { X86Pmovzxwd, 0, { O_V, O_Wq } } },
+    { 0x34, Prefix66, { X86Pmovzxwq, 0, { O_V, O_Wd } } },
+    { 0x35, Prefix66, { X86Pmovzxdq, 0, { O_V, O_Wq } } },
+    { 0x37, Prefix66, { X86Pcmpgtq, F_NDS, { O_V, O_W } } },
+    { 0x38, Prefix66, { X86Pminsb, F_NDS, { O_V, O_W } } },
+    { 0x39, Prefix66, { X86Pminsd, F_NDS, { O_V, O_W } } },
+    { 0x3A, Prefix66, { X86Pminuw, F_NDS, { O_V, O_W } } },
+    { 0x3B, Prefix66, { X86Pminud, F_NDS, { O_V, O_W } } },
+    { 0x3C, Prefix66, { X86Pmaxsb, F_NDS, { O_V, O_W } } },
+    { 0x3D, Prefix66, { X86Pmaxsd, F_NDS, { O_V, O_W } } },
+    { 0x3E, Prefix66, { X86Pmaxuw, F_NDS, { O_V, O_W } } },
+    { 0x3F, Prefix66, { X86Pmaxud, F_NDS, { O_V, O_W } } },
+    { 0x40, Prefix66, { X86Pmulld, F_NDS, { O_V, O_W } } },
+    { 0x41, Prefix66, { X86Phminposuw, 0, { O_V, O_W } } },
+    { 0xDB, Prefix66, { X86Aesimc, 0, { O_V, O_W } } },
+    { 0xDC, Prefix66, { X86Aesenc, F_NDS, { O_V, O_W } } },
+    { 0xDD, Prefix66, { X86Aesenclast, F_NDS, { O_V, O_W } } },
+    { 0xDE, Prefix66, { X86Aesdec, F_NDS, { O_V, O_W } } },
+    { 0xDF, Prefix66, { X86Aesdeclast, F_NDS, { O_V, O_W } } },
+    { 0xF0, PrefixNone, { X86Movbe, 0, { O_Gv, O_Mv } } },
+    { 0xF0, Prefix66, { X86Movbe, 0, { O_Gv, O_Mv } } },
+    { 0xF0, PrefixF2, { X86Crc32, 0, { O_Gy, O_Eb } } },
+    { 0xF1, PrefixNone, { X86Movbe, 0, { O_Mv, O_Gv } } },
+    { 0xF1, Prefix66, { X86Movbe, 0, { O_Mv, O_Gv } } },
+    { 0xF1, PrefixF2, { X86Crc32, 0, { O_Gy, O_Ev } } },
+    { 0xF6, Prefix66, { X86Adcx, 0, { O_Gy, O_Ey } } },
+    { 0xF6, PrefixF3, { X86Adox, 0, { O_Gy, O_Ey } } }
+};
+
+const SparseEntry  threeByteMap3A[] = {
+    { 0x08, Prefix66, { X86Roundps, 0, { O_V, O_W, O_Ib } } },
+    { 0x09, Prefix66, { X86Roundpd, 0, { O_V, O_W, O_Ib } } },
+    { 0x0A, Prefix66, { X86Roundss, F_NDS, { O_V, O_Wd, O_Ib } } },
+    { 0x0B, Prefix66, { X86Roundsd, F_NDS, { O_V, O_Wq, O_Ib } } },
+    { 0x0C, Prefix66, { X86Blendps, F_NDS, { O_V, O_W, O_Ib } } },
+    { 0x0D, Prefix66, { X86Blendpd, F_NDS, { O_V, O_W, O_Ib } } },
+    { 0x0E, Prefix66, { X86Pblendw, F_NDS, { O_V, O_W, O_Ib } } },
+    { 0x0F, PrefixMmx, { X86Palignr, F_NDS, { O_Px, O_Qx, O_Ib } } },
+    { 0x14, Prefix66, { X86Pextrb, 0, { O_MbRd, O_V, O_Ib } } },
+    { 0x15, Prefix66, { X86Pextrw, 0, { O_MwRd, O_V, O_Ib } } },
+    { 0x16, Prefix66, { X86Pextrd, F_REXW, { O_Ey, O_V, O_Ib } } },
+    { 0x17, Prefix66, { X86Extractps, 0, { O_Ed, O_V, O_Ib } } },
+    { 0x20, Prefix66, { X86Pinsrb, F_NDS, { O_V, O_MbRd, O_Ib } } },
+    { 0x21, Prefix66, { X86Insertps, F_NDS, { O_V, O_Wd, O_Ib } } },
+    { 0x22, Prefix66, { X86Pinsrd, F_NDS | F_REXW, { O_V, O_Ey, O_Ib } } },
+    { 0x40, Prefix66, { X86Dpps, F_NDS, { O_V, O_W, O_Ib } } },
+    { 0x41, Prefix66, { X86Dppd, F_NDS, { O_V, O_W, O_Ib } } },
+    { 0x42, Prefix66, { X86Mpsadbw, F_NDS, { O_V, O_W, O_Ib } } },
+    { 0x44, Prefix66, { X86Pclmulqdq, F_NDS, { O_V, O_W, O_Ib } } },
+    { 0x60, Prefix66, { X86Pcmpestrm, 0, { O_V, O_W, O_Ib } } },
+    { 0x61, Prefix66, { X86Pcmpestri, 0, { O_V, O_W, O_Ib } } },
+    { 0x62, Prefix66, { X86Pcmpistrm, 0, { O_V, O_W, O_Ib } } },
+    { 0x63, Prefix66, { X86Pcmpistri, 0, { O_V, O_W, O_Ib } } },
+    { 0xDF, Prefix66, { X86Aeskeygenassist, 0, { O_V, O_W, O_Ib } } }
+};
+
+class ThreeByteMap
+{
+public:
+
+    template<size_t Count>
+    ThreeByteMap(const SparseEntry (&entries)[Count], bool immediate)
+    {
+        // unlisted opcodes keep the length: modrm and an immediate for the 0F 3A map
+        OpcodeEntry  unknown = { X86Unknown, F_MODRM, { immediate ? O_Ib : O_NONE } };
+
+        for (size_t i = 0; i < 256; ++i)
+            for (size_t j = 0; j < PrefixCount; ++j)
+                m_entries[i][j] = unknown;
+
+        for (size_t i = 0; i < Count; ++i)
+        {
+            OpcodeEntry  entry = entries[i].entry;
+            entry.flags |= F_MODRM | F_VEX;
+
+            if (entries[i].prefix == PrefixMmx)
+            {
+                entry.flags |= F_MMX;
+                m_entries[entries[i].opcode][PrefixNone] = entry;
+                m_entries[entries[i].opcode][Prefix66] = entry;
+            }
+            else
+            {
+                m_entries[entries[i].opcode][entries[i].prefix] = entry;
+            }
+        }
+    }
+
+    const OpcodeEntry& get(unsigned char opcode, PrefixKind prefix) const {
+        return m_entries[opcode][prefix];
+    }
+
+private:
+
+    OpcodeEntry  m_entries[256][PrefixCount];
+};
+
+const ThreeByteMap  map38(threeByteMap38, false);
+const ThreeByteMap  map3A(threeByteMap3A, true);
+
+///////////////////////////////////////////////////////////////////////////////
+
+// x87: memory forms by modrm reg, register forms by modrm reg and rm
+
+const OpcodeEntry  x87MemoryMap[8][8] = {
+    /* D8 */ { { X86Fadd, 0, { O_Md } }, { X86Fmul, 0, { O_Md } }, { X86Fcom, 0, { O_Md } }, { X86Fcomp, 0, { O_Md } },
+               { X86Fsub, 0, { O_Md } }, { X86Fsubr, 0, { O_Md } }, { X86Fdiv, 0, { O_Md } }, { X86Fdivr, 0, { O_Md } } },
+    /* D9 */ { { X86Fld, 0, { O_Md } }, BAD, { X86Fst, 0, { O_Md } }, { X86Fstp, 0, { O_Md } },
+               { X86Fldenv, 0, { O_M } }, { X86Fldcw, 0, { O_Mw } }, { X86Fnstenv, 0, { O_M } }, { X86Fnstcw, 0, { O_Mw } } },
+    /* DA */ { { X86Fiadd, 0, { O_Md } }, { X86Fimul, 0, { O_Md } }, { X86Ficom, 0, { O_Md } }, { X86Ficomp, 0, { O_Md } },
+               { X86Fisub, 0, { O_Md } }, { X86Fisubr, 0, { O_Md } }, { X86Fidiv, 0, { O_Md } }, { X86Fidivr, 0, { O_Md } } },
+    /* DB */ { { X86Fild, 0, { O_Md } }, { X86Fisttp, 0, { O_Md } }, { X86Fist, 0, { O_Md } }, { X86Fistp, 0, { O_Md } },
+               BAD, { X86Fld, 0, { O_Mt } }, BAD, { X86Fstp, 0, { O_Mt } } },
+    /* DC */ { { X86Fadd, 0, { O_Mq } }, { X86Fmul, 0, { O_Mq } }, { X86Fcom, 0, { O_Mq } }, { X86Fcomp, 0, { O_Mq } },
+               { X86Fsub, 0, { O_Mq } }, { X86Fsubr, 0, { O_Mq } }, { X86Fdiv, 0, { O_Mq } }, { X86Fdivr, 0, { O_Mq } } },
+    /* DD */ { { X86Fld, 0, { O_Mq } }, { X86Fisttp, 0, { O_Mq } }, { X86Fst, 0, { O_Mq } }, { X86Fstp, 0, { O_Mq } },
+               { X86Frstor, 0, { O_M } }, BAD, { X86Fnsave, 0, { O_M } }, { X86Fnstsw, 0, { O_Mw } } },
+    /* DE */ { { X86Fiadd, 0, { O_Mw } }, { X86Fimul, 0, { O_Mw } }, { X86Ficom, 0, { O_Mw } }, { X86Ficomp, 0, { O_Mw } },
+               { X86Fisub, 0, { O_Mw } }, { X86Fisubr, 0, { O_Mw } }, { X86Fidiv, 0, { O_Mw } }, { X86Fidivr, 0, { O_Mw } } },
+    /* DF */ { { X86Fild, 0, { O_Mw } }, { X86Fisttp, 0, { O_Mw } }, { X86Fist, 0, { O_Mw } }, { X86Fistp, 0, { O_Mw } },
+               { X86Fbld, 0, { O_Mt } }, { X86Fild, 0, { O_Mq } }, { X86Fbstp, 0, { O_Mt } }, { X86Fistp, 0, { O_Mq } } }
+};
+
+// register forms with st(i) operands, X86Unknown marks the rows selected by rm ( x87RmMap )
+
+const OpcodeEntry  x87RegisterMap[8][8] = {
+    /* D8 */ { { X86Fadd, 0, { O_ST0, O_STi } }, { X86Fmul, 0, { O_ST0, O_STi } }, { X86Fcom, 0, { O_STi } }, { X86Fcomp, 0, { O_STi } },
+               { X86Fsub, 0, { O_ST0, O_STi } }, { X86Fsubr, 0, { O_ST0, O_STi } }, { X86Fdiv, 0, { O_ST0, O_STi } }, { X86Fdivr, 0, { O_ST0, O_STi } } },
+    /* D9 */ { { X86Fld, 0, { O_STi } }, { X86Fxch, 0, { O_STi } }, { X86Unknown }, BAD,
+               { X86Unknown }, { X86Unknown }, { X86Unknown }, { X86Unknown } },
+    /* DA */ { { X86Fcmovb, 0, { O_ST0, O_STi } }, { X86Fcmove, 0, { O_ST0, O_STi } }, { X86Fcmovbe, 0, { O_ST0, O_STi } }, { X86Fcmovu, 0, { O_ST0, O_STi } },
+               BAD, { X86Unknown }, BAD, BAD },
+    /* DB */ { { X86Fcmovnb, 0, { O_ST0, O_STi } }, { X86Fcmovne, 0, { O_ST0, O_STi } }, { X86Fcmovnbe, 0, { O_ST0, O_STi } }, { X86Fcmovnu, 0, { O_ST0, O_STi } },
+               { X86Unknown }, { X86Fucomi, 0, { O_ST0, O_STi } }, { X86Fcomi, 0, { O_ST0, O_STi } }, BAD },
+    /* DC */ { { X86Fadd, 0, { O_STi, O_ST0 } }, { X86Fmul, 0, { O_STi, O_ST0 } }, { X86Fcom, 0, { O_STi } }, { X86Fcomp, 0, { O_STi } },
+               { X86Fsubr, 0, { O_STi, O_ST0 } }, { X86Fsub, 0, { O_STi, O_ST0 } }, { X86Fdivr, 0, { O_STi, O_ST0 } }, { X86Fdiv, 0, { O_STi, O_ST0 } } },
+    /* DD */ { { X86Ffree, 0, { O_STi } }, BAD, { X86Fst, 0, { O_STi } }, { X86Fstp, 0, { O_STi } },
+               { X86Fucom, 0, { O_STi } }, { X86Fucomp, 0, { O_STi } }, BAD, BAD },
+    /* DE */ { { X86Faddp, 0, { O_STi, O_ST0 } }, { X86Fmulp, 0, { O_STi, O_ST0 } }, BAD, { X86Unknown },
+               { X86Fsubrp, 0, { O_STi, O_ST0 } }, { X86Fsubp, 0, { O_STi, O_ST0 } }, { X86Fdivrp, 0, { O_STi, O_ST0 } }, { X86Fdivp, 0, { O_STi, O_ST0 } } },
+    /* DF */ { { X86Ffreep, 0, { O_STi } }, BAD, BAD, BAD,
+               { X86Unknown }, { X86Fucomip, 0, { O_ST0, O_STi } }, { X86Fcomip, 0, { O_ST0, O_STi } }, BAD }
+};
+
+struct X87RmEntry {
+    unsigned char  opcode;
+    unsigned char  modrm;
+    unsigned short  mnemonic;
+};
+
+const X87RmEntry  x87RmMap[] = {
+    { 0xD9, 0xD0, X86Fnop }, { 0xD9, 0xE0, X86Fchs }, { 0xD9, 0xE1, X86Fabs }, { 0xD9, 0xE4, X86Ftst }, { 0xD9, 0xE5, X86Fxam },
+    { 0xD9, 0xE8, X86Fld1 }, { 0xD9, 0xE9, X86Fldl2t }, { 0xD9, 0xEA, X86Fldl2e }, { 0xD9, 0xEB, X86Fldpi },
+    { 0xD9, 0xEC, X86Fldlg2 }, { 0xD9, 0xED, X86Fldln2 }, { 0xD9, 0xEE, X86Fldz },
+    { 0xD9, 0xF0, X86F2xm1 }, { 0xD9, 0xF1, X86Fyl2x }, { 0xD9, 0xF2, X86Fptan }, { 0xD9, 0xF3, X86Fpatan },
+    { 0xD9, 0xF4, X86Fxtract }, { 0xD9, 0xF5, X86Fprem1 }, { 0xD9, 0xF6, X86Fdecstp }, { 0xD9, 0xF7, X86Fincstp },
+    { 0xD9, 0xF8, X86Fprem }, { 0xD9, 0xF9, X86Fyl2xp1 }, { 0xD9, 0xFA, X86Fsqrt }, { 0xD9, 0xFB, X86Fsincos },
+    { 0xD9, 0xFC, X86Frndint }, { 0xD9, 0xFD, X86Fscale }, { 0xD9, 0xFE, X86Fsin }, { 0xD9, 0xFF, X86Fcos },
+    { 0xDA, 0xE9, X86Fucompp }, { 0xDB, 0xE2, X86Fnclex }, { 0xDB, 0xE3, X86Fninit },
+    { 0xDE, 0xD9, X86Fcompp }, { 0xDF, 0xE0, X86Fnstsw }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+// 0F 01 with mod == 3: the whole modrm byte selects the instruction
+
+struct ModrmEntry {
+    unsigned char  modrm;
+    unsigned short  mnemonic;
+};
+
+const ModrmEntry  group7RegisterMap[] = {
+    { 0xC1, X86Vmcall }, { 0xC2, X86Vmlaunch }, { 0xC3, X86Vmresume }, { 0xC4, X86Vmxoff },
+    { 0xC8, X86Monitor }, { 0xC9, X86Mwait }, { 0xCA, X86Clac }, { 0xCB, X86Stac },
+    { 0xD0, X86Xgetbv }, { 0xD1, X86Xsetbv }, { 0xD5, X86Xend }, { 0xD6, X86Xtest },
+    { 0xF8, X86Swapgs }, { 0xF9, X86Rdtscp }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline bool hasImmediate(const OpcodeEntry& entry)
+{
+    if (entry.flags & F_SSE)
+    {
+        for (size_t i = 0; i < PrefixCount; ++i)
+        {
+            if (sseMap[entry.mnemonic][i].operands[2] == O_Ib)
+                return true;
+        }
+        return false;
+    }
+
+    return entry.operands[1] == O_Ib || entry.operands[2] == O_Ib;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+inline bool isStringInstruction(unsigned short mnemonic)
+{
+    switch (mnemonic)
+    {
+    case X86Ins:
+    case X86Outs:
+    case X86Movs:
+    case X86Cmps:
+    case X86Stos:
+    case X86Lods:
+    case X86Scas:
+        return true;
+    }
+    return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+class InstructionDecoder
+{
+public:
+
+    InstructionDecoder(bool x64, const unsigned char* code, size_t size, MEMOFFSET_64 offset, X86Instruction& instruction) :
+        m_x64(x64),
+        m_code(code),
+        m_size(size),
+        m_pos(0),
+        m_result(X86DecodeOk),
+        m_instr(instruction)
+    {
+        memset(&m_instr, 0, sizeof(m_instr));
+        m_instr.offset = offset;
+    }
+
+    X86DecodeResult decode();
+
+private:
+
+    bool fetch(unsigned char& value)
+    {
+        if (m_pos >= maxX86InstructionLength)
+            return fail(X86DecodeInvalid);
+
+        if (m_pos >= m_size)
+            return fail(X86DecodeTruncated);
+
+        value = m_code[m_pos++];
+        return true;
+    }
+
+    bool fetchValue(size_t size, long long& value, bool signExtend);
+
+    bool peek(unsigned char& value) const
+    {
+        if (m_pos >= m_size)
+            return false;
+        value = m_code[m_pos];
+        return true;
+    }
+
+    bool fail(X86DecodeResult result)
+    {
+        if (m_result == X86DecodeOk)
+            m_result = result;
+        return false;
+    }
+
+    bool decodePrefixes();
+    bool decodeVex(unsigned char escape);
+    bool decodeOpcode(OpcodeEntry& entry);
+    bool decodeX87(unsigned char opcode, OpcodeEntry& entry);
+    bool decodeModrm();
+    bool decodeMemory16();
+    bool decodeOperand(unsigned char spec, X86Operand& operand);
+    void setFlags(const OpcodeEntry& entry);
+
+    static void setUnknownVex(OpcodeEntry& entry, bool immediate)
+    {
+        entry.mnemonic = X86Unknown;
+        entry.flags = 0;
+        entry.operands[0] = immediate ? O_Ib : O_NONE;
+        entry.operands[1] = entry.operands[2] = O_NONE;
+    }
+
+    bool isMemory() const {
+        return m_modrm < 0xC0;
+    }
+
+    unsigned char modrmReg() const {
+        return (m_modrm >> 3) & 7;
+    }
+
+    unsigned char modrmRm() const {
+        return m_modrm & 7;
+    }
+
+    PrefixKind mandatoryPrefix() const;
+
+    unsigned char vectorSize() const {
+        return static_cast<unsigned char>(16 << m_vexL);
+    }
+
+    X86Register vectorRegister(unsigned char number) const
+    {
+        X86Register  reg = { static_cast<X86RegisterClass>(X86RegXmm + m_vexL), number };
+        return reg;
+    }
+
+    X86Register gpr(unsigned char size, unsigned char number) const;
+
+    void setRegister(X86Operand& operand, const X86Register& reg, unsigned char size)
+    {
+        operand.type = X86OpRegister;
+        operand.reg = reg;
+        operand.size = size;
+    }
+
+    void setRegister(X86Operand& operand, X86RegisterClass regClass, unsigned char number, unsigned char size)
+    {
+        X86Register  reg = { regClass, number };
+        setRegister(operand, reg, size);
+    }
+
+    bool setRm(X86Operand& operand, X86RegisterClass regClass, unsigned char size, unsigned char memorySize);
+    bool setRmGpr(X86Operand& operand, unsigned char size, unsigned char memorySize);
+
+    void setStringOperand(X86Operand& operand, unsigned char size, unsigned char indexReg, bool destination);
+
+    const bool  m_x64;
+    const unsigned char*  m_code;
+    const size_t  m_size;
+    size_t  m_pos;
+    X86DecodeResult  m_result;
+    X86Instruction&  m_instr;
+
+    // prefixes
+    unsigned char  m_rex = 0;
+    bool  m_opsizePrefix = false;
+    bool  m_addrsizePrefix = false;
+    bool  m_lock = false;
+    unsigned char  m_rep = 0;
+    unsigned char  m_lastPrefix = 0;
+    X86Register  m_segment = {};
+
+    // vex, evex, xop
+    unsigned char  m_vex = 0;           // 0, 0xC4 ( vex ), 0x62 ( evex ), 0x8F ( xop )
+    unsigned char  m_vexMap = 0;
+    unsigned char  m_vexPrefix = 0;
+    unsigned char  m_vexL = 0;
+    bool  m_vexW = false;
+    unsigned char  m_vvvv = 0;
+    bool  m_evexBroadcast = false;
+    bool  m_evexRegHigh = false;        // EVEX.R'
+    bool  m_evexRmHigh = false;         // EVEX.X extends modrm.rm of a vector register
+
+    // operand state
+    unsigned char  m_opcode = 0;
+    unsigned char  m_map = 0;           // 0 - one byte, 1 - 0F, 2 - 0F 38, 3 - 0F 3A, 4 - 3DNow
+    bool  m_hasModrm = false;
+    unsigned char  m_modrm = 0;
+    unsigned char  m_opsize = 4;
+    unsigned char  m_addrsize = 4;
+    X86Operand  m_memory = {};
+    long long  m_relative = 0;
+    bool  m_hasRelative = false;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool InstructionDecoder::fetchValue(size_t size, long long& value, bool signExtend)
+{
+    unsigned long long  result = 0;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        unsigned char  byte;
+        if (!fetch(byte))
+            return false;
+        result |= static_cast<unsigned long long>(byte) << (8 * i);
+    }
+
+    if (signExtend && size < 8)
+    {
+        unsigned long long  signBit = 1ULL << (8 * size - 1);
+        result = (result ^ signBit) - signBit;
+    }
+
+    value = static_cast<long long>(result);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool InstructionDecoder::decodePrefixes()
+{
+    for (;;)
+    {
+        unsigned char  byte;
+        if (!peek(byte))
+            return fail(X86DecodeTruncated);
+
+        switch (byte)
+        {
+        case 0xF0:
+            m_lock = true;
+            break;
+
+        case 0xF2:
+        case 0xF3:
+            m_rep = byte;
+            break;
+
+        case 0x66:
+            m_opsizePrefix = true;
+            break;
+
+        case 0x67:
+            m_addrsizePrefix = true;
+            break;
+
+        case 0x26:
+        case 0x2E:
+        case 0x36:
+        case 0x3E:
+            // es, cs, ss, ds overrides are ignored in the long mode
+            if (!m_x64)
+            {
+                m_segment.regClass = X86RegSegment;
+                m_segment.number = (byte - 0x26) >> 3;
+            }
+            break;
+
+        case 0x64:
+        case 0x65:
+            m_segment.regClass = X86RegSegment;
+            m_segment.number = byte - 0x64 + 4;
+            break;
+
+        default:
+            if (m_x64 && (byte & 0xF0) == 0x40)
+            {
+                // rex is valid only just before the opcode
+                m_rex = byte;
+                ++m_pos;
+
+                if (!peek(byte))
+                    return fail(X86DecodeTruncated);
+
+                if ((byte & 0xF0) == 0x40)
+                    continue;
+
+                switch (byte)
+                {
+                case 0xF0: case 0xF2: case 0xF3: case 0x66: case 0x67:
+                case 0x26: case 0x2E: case 0x36: case 0x3E: case 0x64: case 0x65:
+                    m_rex = 0;
+                    continue;
+                }
+
+                return true;
+            }
+
+            return true;
+        }
+
+        m_lastPrefix = byte;
+
+        if (++m_pos >= maxX86InstructionLength)
+            return fail(X86DecodeInvalid);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+PrefixKind InstructionDecoder::mandatoryPrefix() const
+{
+    if (m_vex)
+        return static_cast<PrefixKind>(m_vexPrefix);
+
+    if (m_rep == 0xF3)
+        return PrefixF3;
+
+    if (m_rep == 0xF2)
+        return PrefixF2;
+
+    if (m_opsizePrefix)
+        return Prefix66;
+
+    return PrefixNone;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool InstructionDecoder::decodeVex(unsigned char escape)
+{
+    unsigned char  byte1, byte2, byte3;
+
+    if (!fetch(byte1))
+        return false;
+
+    if (m_rex || m_opsizePrefix || m_rep || m_lock)
+        return fail(X86DecodeInvalid);
+
+    m_vex = escape;
+
+    if (escape == 0xC5)
+    {
+        m_vex = 0xC4;
+        m_rex = m_x64 ? 0x40 | ((byte1 & 0x80) ? 0 : 4) : 0;
+        m_vexMap = 1;
+        m_vvvv = (~byte1 >> 3) & 0xF;
+        m_vexL = (byte1 >> 2) & 1;
+        m_vexPrefix = byte1 & 3;
+        return true;
+    }
+
+    if (!fetch(byte2))
+        return false;
+
+    m_rex = 0x40 | ((byte1 & 0x80) ? 0 : 4) | ((byte1 & 0x40) ? 0 : 2) | ((byte1 & 0x20) ? 0 : 1);
+    if (!m_x64)
+        m_rex = 0;
+
+    m_vexW = (byte2 & 0x80) != 0;
+    if (m_vexW && m_x64)
+        m_rex |= 8;
+    m_vvvv = (~byte2 >> 3) & 0xF;
+    m_vexPrefix = byte2 & 3;
+
+    if (escape == 0x62)
+    {
+        if (!fetch(byte3))
+            return false;
+
+        if ((byte2 & 4) == 0)
+            return fail(X86DecodeInvalid);
+
+        m_vexMap = byte1 & 7;
+        m_evexRegHigh = m_x64 && (byte1 & 0x10) == 0;
+        m_evexRmHigh = m_x64 && (byte1 & 0x40) == 0;
+        m_vexL = (byte3 >> 5) & 3;
+        m_evexBroadcast = (byte3 & 0x10) != 0;
+        if (m_x64 && (byte3 & 8) == 0)
+            m_vvvv |= 0x10;
+
+        if (m_vexMap == 0 || m_vexMap == 4 || m_vexMap == 7 || m_vexL == 3)
+            return fail(X86DecodeInvalid);
+
+        return true;
+    }
+
+    m_vexMap = byte1 & 0x1F;
+    m_vexL = (byte2 >> 2) & 1;
+
+    if (escape == 0xC4 && (m_vexMap == 0 || m_vexMap > 3))
+        return fail(X86DecodeInvalid);
+
+    if (escape == 0x8F && (m_vexMap < 8 || m_vexMap > 10))
+        return fail(X86DecodeInvalid);
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool InstructionDecoder::decodeModrm()
+{
+    if (!fetch(m_modrm))
+        return false;
+
+    m_hasModrm = true;
+
+    // mov to and from control and debug registers ignores modrm.mod
+    if (m_map == 1 && (m_opcode & 0xFC) == 0x20)
+        m_modrm |= 0xC0;
+
+    if (!isMemory())
+        return true;
+
+    m_memory.type = X86OpMemory;
+    m_memory.segment = m_segment;
+
+    if (m_addrsize == 2)
+        return decodeMemory16();
+
+    X86RegisterClass  addrClass = m_addrsize == 8 ? X86RegGpr64 : X86RegGpr32;
+    unsigned char  mod = m_modrm >> 6;
+    unsigned char  rm = modrmRm();
+    size_t  dispSize = mod == 1 ? 1 : mod == 2 ? 4 : 0;
+
+    if (rm == 4)
+    {
+        unsigned char  sib;
+        if (!fetch(sib))
+            return false;
+
+        unsigned char  index = ((sib >> 3) & 7) | ((m_rex & 2) << 2);
+        unsigned char  base = (sib & 7) | ((m_rex & 1) << 3);
+
+        if (index != 4)
+        {
+            m_memory.index.regClass = addrClass;
+            m_memory.index.number = index;
+            m_memory.scale = static_cast<unsigned char>(1 << (sib >> 6));
+        }
+
+        if ((sib & 7) == 5 && mod == 0)
+        {
+            dispSize = 4;
+        }
+        else
+        {
+            m_memory.reg.regClass = addrClass;
+            m_memory.reg.number = base;
+        }
+    }
+    else if (rm == 5 && mod == 0)
+    {
+        dispSize = 4;
+
+        if (m_x64)
+        {
+            m_memory.reg.regClass = X86RegIp;
+            m_memory.reg.number = m_addrsize == 8 ? 0 : 1;
+            m_instr.flags |= X86InstrRipRelative;
+        }
+    }
+    else
+    {
+        m_memory.reg.regClass = addrClass;
+        m_memory.reg.number = rm | ((m_rex & 1) << 3);
+    }
+
+    return dispSize == 0 || fetchValue(dispSize, m_memory.value, true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool InstructionDecoder::decodeMemory16()
+{
+    static const unsigned char  bases[] = { 3, 3, 5, 5, 6, 7, 5, 3 };     // bx, bx, bp, bp, si, di, bp, bx
+    static const unsigned char  indices[] = { 6, 7, 6, 7, 0, 0, 0, 0 };   // si, di, si, di
+
+    unsigned char  mod = m_modrm >> 6;
+    unsigned char  rm = modrmRm();
+    size_t  dispSize = mod == 1 ? 1 : mod == 2 ? 2 : 0;
+
+    if (mod == 0 && rm == 6)
+    {
+        dispSize = 2;
+    }
+    else
+    {
+        m_memory.reg.regClass = X86RegGpr16;
+        m_memory.reg.number = bases[rm];
+
+        if (rm < 4)
+        {
+            m_memory.index.regClass = X86RegGpr16;
+            m_memory.index.number = indices[rm];
+            m_memory.scale = 1;
+        }
+    }
+
+    return dispSize == 0 || fetchValue(dispSize, m_memory.value, true);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+X86Register InstructionDecoder::gpr(unsigned char size, unsigned char number) const
+{
+    X86Register  reg = { X86RegGpr32, number };
+
+    switch (size)
+    {
+    case 1:
+        if (!m_rex && number >= 4 && number < 8)
+        {
+            reg.regClass = X86RegGpr8High;
+            reg.number = number - 4;
+        }
+        else
+        {
+            reg.regClass = X86RegGpr8;
+        }
+        break;
+
+    case 2:
+        reg.regClass = X86RegGpr16;
+        break;
+
+    case 8:
+        reg.regClass = X86RegGpr64;
+        break;
+    }
+
+    return reg;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool InstructionDecoder::setRm(X86Operand& operand, X86RegisterClass regClass, unsigned char size, unsigned char memorySize)
+{
+    if (isMemory())
+    {
+        operand = m_memory;
+        operand.size = memorySize;
+        return true;
+    }
+
+    unsigned char  number = modrmRm() | ((m_rex & 1) << 3);
+    if (m_evexRmHigh && regClass >= X86RegXmm)
+        number |= 0x10;
+
+    setRegister(operand, regClass, number, size);
+    return true;
+}
+
+bool InstructionDecoder::setRmGpr(X86Operand& operand, unsigned char size, unsigned char memorySize)
+{
+    if (isMemory())
+    {
+        operand = m_memory;
+        operand.size = memorySize;
+        return true;
+    }
+
+    setRegister(operand, gpr(size, modrmRm() | ((m_rex & 1) << 3)), size);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InstructionDecoder::setStringOperand(X86Operand& operand, unsigned char size, unsigned char indexReg, bool destination)
+{
+    operand.type = X86OpMemory;
+    operand.size = size;
+    operand.reg.regClass = m_addrsize == 8 ? X86RegGpr64 : m_addrsize == 4 ? X86RegGpr32 : X86RegGpr16;
+    operand.reg.number = indexReg;
+
+    if (destination)
+    {
+        // stos, movs, scas, ins always write es:[edi], the segment is shown in the 32 bit mode only
+        if (!m_x64)
+        {
+            operand.segment.regClass = X86RegSegment;
+            operand.segment.number = 0;
+        }
+    }
+    else
+    {
+        operand.segment = m_segment;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool InstructionDecoder::decodeOperand(unsigned char spec, X86Operand& operand)
+{
+    unsigned char  reg = modrmReg() | ((m_rex & 4) << 1);
+    unsigned char  opsize64 = m_x64 && (m_rex & 8) ? 8 : 4;
+    bool  mmx = mandatoryPrefix() != Prefix66;
+
+    switch (spec)
+    {
+    case O_Eb: return setRmGpr(operand, 1, 1);
+    case O_Ew: return setRmGpr(operand, 2, 2);
+    case O_Ed: return setRmGpr(operand, 4, 4);
+    case O_Eq: return setRmGpr(operand, 8, 8);
+    case O_Ev: return setRmGpr(operand, m_opsize, m_opsize);
+    case O_Ey: return setRmGpr(operand, opsize64, opsize64);
+
+    case O_Gb: setRegister(operand, gpr(1, reg), 1); return true;
+    case O_Gw: setRegister(operand, gpr(2, reg), 2); return true;
+    case O_Gd: setRegister(operand, gpr(4, reg), 4); return true;
+    case O_Gv: setRegister(operand, gpr(m_opsize, reg), m_opsize); return true;
+    case O_Gy: setRegister(operand, gpr(opsize64, reg), opsize64); return true;
+
+    case O_Ry:
+        if (isMemory())
+            return fail(X86DecodeInvalid);
+        return setRmGpr(operand, m_x64 ? 8 : 4, 0);
+
+    case O_M:
+    case O_Mb:
+    case O_Mw:
+    case O_Md:
+    case O_Mq:
+    case O_Mt:
+    case O_Mv:
+    case O_Mp:
+    case O_Mx:
+        {
+            static const unsigned char  sizes[] = { 0, 1, 2, 4, 8, 10 };
+
+            if (!isMemory())
+                return fail(X86DecodeInvalid);
+
+            operand = m_memory;
+            operand.size = spec == O_Mv ? m_opsize :
+                spec == O_Mp ? m_opsize + 2 :
+                spec == O_Mx ? vectorSize() : sizes[spec - O_M];
+            return true;
+        }
+
+    case O_MwRv: return setRmGpr(operand, m_opsize, 2);
+    case O_MwRd: return setRmGpr(operand, 4, 2);
+    case O_MbRd: return setRmGpr(operand, 4, 1);
+
+    case O_Ib:
+    case O_Iw:
+        operand.type = X86OpImmediate;
+        operand.size = spec == O_Ib ? 1 : 2;
+        return fetchValue(operand.size, operand.value, false);
+
+    case O_Ibs:
+        operand.type = X86OpImmediate;
+        operand.size = m_opsize;
+        return fetchValue(1, operand.value, true);
+
+    case O_Iz:
+        operand.type = X86OpImmediate;
+        operand.size = m_opsize;
+        return fetchValue(m_opsize == 2 ? 2 : 4, operand.value, true);
+
+    case O_Iv:
+        operand.type = X86OpImmediate;
+        operand.size = m_opsize;
+        return fetchValue(m_opsize, operand.value, false);
+
+    case O_I1:
+        operand.type = X86OpImmediate;
+        operand.size = 1;
+        operand.value = 1;
+        return true;
+
+    case O_Jb:
+    case O_Jz:
+        operand.type = X86OpRelative;
+        operand.size = m_x64 ? 8 : m_opsize;
+        m_hasRelative = true;
+        return fetchValue(spec == O_Jb ? 1 : m_x64 || m_opsize != 2 ? 4 : 2, m_relative, true);
+
+    case O_Ob:
+    case O_Ov:
+        operand.type = X86OpMemory;
+        operand.size = spec == O_Ob ? 1 : m_opsize;
+        operand.segment = m_segment;
+        return fetchValue(m_addrsize, operand.value, false);
+
+    case O_Ap:
+        {
+            long long  selector;
+            operand.type = X86OpFar;
+            operand.size = m_opsize + 2;
+            if (!fetchValue(m_opsize, operand.value, false) || !fetchValue(2, selector, false))
+                return false;
+            operand.selector = static_cast<unsigned short>(selector);
+            return true;
+        }
+
+    case O_Sw:
+        if (modrmReg() > 5)
+            return fail(X86DecodeInvalid);
+        setRegister(operand, X86RegSegment, modrmReg(), 2);
+        return true;
+
+    case O_Cy:
+        setRegister(operand, X86RegControl, reg, m_x64 ? 8 : 4);
+        return true;
+
+    case O_Dy:
+        setRegister(operand, X86RegDebug, reg, m_x64 ? 8 : 4);
+        return true;
+
+    case O_Zb:
+        setRegister(operand, gpr(1, (m_opcode & 7) | ((m_rex & 1) << 3)), 1);
+        return true;
+
+    case O_Zv:
+        setRegister(operand, gpr(m_opsize, (m_opcode & 7) | ((m_rex & 1) << 3)), m_opsize);
+        return true;
+
+    case O_AL: setRegister(operand, X86RegGpr8, 0, 1); return true;
+    case O_CL: setRegister(operand, X86RegGpr8, 1, 1); return true;
+    case O_DX: setRegister(operand, X86RegGpr16, 2, 2); return true;
+    case O_AX: setRegister(operand, X86RegGpr16, 0, 2); return true;
+    case O_rAX: setRegister(operand, gpr(m_opsize, 0), m_opsize); return true;
+    case O_eAX: setRegister(operand, gpr(m_opsize == 2 ? 2 : 4, 0), m_opsize == 2 ? 2 : 4); return true;
+
+    case O_ES: case O_CS: case O_SS: case O_DS: case O_FS: case O_GS:
+        setRegister(operand, X86RegSegment, spec - O_ES, 2);
+        return true;
+
+    case O_Xb: setStringOperand(operand, 1, 6, false); return true;
+    case O_Xv: setStringOperand(operand, m_opsize, 6, false); return true;
+    case O_Xz: setStringOperand(operand, m_opsize == 2 ? 2 : 4, 6, false); return true;
+    case O_Yb: setStringOperand(operand, 1, 7, true); return true;
+    case O_Yv: setStringOperand(operand, m_opsize, 7, true); return true;
+    case O_Yz: setStringOperand(operand, m_opsize == 2 ? 2 : 4, 7, true); return true;
+    case O_XLAT: setStringOperand(operand, 1, 3, false); return true;
+
+    case O_V:
+        setRegister(operand, vectorRegister(reg | (m_evexRegHigh ? 0x10 : 0)), vectorSize());
+        return true;
+
+    case O_W:
+        return setRm(operand, static_cast<X86RegisterClass>(X86RegXmm + m_vexL), vectorSize(), vectorSize());
+
+    case O_Wd:
+        return setRm(operand, X86RegXmm, 16, 4);
+
+    case O_Wq:
+        return setRm(operand, X86RegXmm, 16, 8);
+
+    case O_U:
+        if (isMemory())
+            return fail(X86DecodeInvalid);
+        return setRm(operand, static_cast<X86RegisterClass>(X86RegXmm + m_vexL), vectorSize(), 0);
+
+    case O_H:
+        setRegister(operand, vectorRegister(m_vvvv), vectorSize());
+        return true;
+
+    case O_P:
+        setRegister(operand, X86RegMmx, modrmReg(), 8);
+        return true;
+
+    case O_Q:
+        if (isMemory())
+            return setRm(operand, X86RegMmx, 8, 8);
+        setRegister(operand, X86RegMmx, modrmRm(), 8);
+        return true;
+
+    case O_N:
+        if (isMemory())
+            return fail(X86DecodeInvalid);
+        setRegister(operand, X86RegMmx, modrmRm(), 8);
+        return true;
+
+    case O_Px: return decodeOperand(mmx ? O_P : O_V, operand);
+    case O_Qx: return decodeOperand(mmx ? O_Q : O_W, operand);
+    case O_Nx: return decodeOperand(mmx ? O_N : O_U, operand);
+
+    case O_ST0:
+        setRegister(operand, X86RegX87, 0, 10);
+        return true;
+
+    case O_STi:
+        setRegister(operand, X86RegX87, modrmRm(), 10);
+        return true;
+    }
+
+    return fail(X86DecodeInvalid);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool InstructionDecoder::decodeX87(unsigned char opcode, OpcodeEntry& entry)
+{
+    unsigned char  index = opcode - 0xD8;
+
+    if (isMemory())
+    {
+        entry = x87MemoryMap[index][modrmReg()];
+        return true;
+    }
+
+    entry = x87RegisterMap[index][modrmReg()];
+
+    if (entry.mnemonic != X86Unknown)
+        return true;
+
+    entry.mnemonic = X86Invalid;
+
+    for (size_t i = 0; i < sizeof(x87RmMap) / sizeof(x87RmMap[0]); ++i)
+    {
+        if (x87RmMap[i].opcode == opcode && x87RmMap[i].modrm == m_modrm)
+        {
+            entry.mnemonic = x87RmMap[i].mnemonic;
+            if (entry.mnemonic == X86Fnstsw)
+                entry.operands[0] = O_AX;
+            return true;
+        }
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool InstructionDecoder::decodeOpcode(OpcodeEntry& entry)
+{
+    unsigned char  byte;
+    if (!fetch(byte))
+        return false;
+
+    if (!m_vex && (byte == 0xC4 || byte == 0xC5 || byte == 0x62 || byte == 0x8F))
+    {
+        // les, lds, bound need a memory operand and pop needs modrm.reg == 0, so the encodings do not overlap
+        unsigned char  next;
+        if (!peek(next))
+            return fail(X86DecodeTruncated);
+
+        bool  escape = byte == 0x8F ? (next & 0x1F) >= 8 : m_x64 || next >= 0xC0;
+
+        if (escape)
+        {
+            if (!decodeVex(byte))
+                return false;
+
+            m_map = m_vexMap;
+
+            if (!fetch(m_opcode))
+                return false;
+
+            if (m_map > 3)
+            {
+                // evex maps 5, 6 and xop maps 8, 9, 0A are not decoded: modrm and
+                // an immediate for the xop maps 8 and 0A
+                entry.mnemonic = X86Unknown;
+                entry.flags = F_MODRM;
+                if (m_map == 8)
+                    entry.operands[0] = O_Ib;
+                else if (m_map == 10)
+                    entry.operands[0] = O_Iz;
+                return true;
+            }
+
+            if (m_map == 1 && m_opcode == 0x77 && m_vex == 0xC4)
+            {
+                entry.mnemonic = m_vexL ? X86Vzeroall : X86Vzeroupper;
+                return true;
+            }
+
+            byte = 0x0F;
+        }
+    }
+
+    if (byte != 0x0F)
+    {
+        m_opcode = byte;
+        entry = oneByteMap[byte];
+        return true;
+    }
+
+    if (!m_vex)
+    {
+        if (!fetch(byte))
+            return false;
+
+        switch (byte)
+        {
+        case 0x38:
+            m_map = 2;
+            break;
+
+        case 0x3A:
+            m_map = 3;
+            break;
+
+        case 0x0F:
+            // 3DNow!: modrm and the opcode byte after it
+            m_map = 4;
+            entry.mnemonic = X86Unknown;
+            entry.flags = F_MODRM;
+            entry.operands[0] = O_Ib;
+            return true;
+
+        default:
+            m_map = 1;
+            m_opcode = byte;
+            break;
+        }
+
+        if (m_map != 1 && !fetch(m_opcode))
+            return false;
+    }
+
+    switch (m_map)
+    {
+    case 1:
+        entry = twoByteMap[m_opcode];
+        break;
+
+    case 2:
+        entry = map38.get(m_opcode, mandatoryPrefix());
+        break;
+
+    case 3:
+        entry = map3A.get(m_opcode, mandatoryPrefix());
+        break;
+    }
+
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void InstructionDecoder::setFlags(const OpcodeEntry& entry)
+{
+    switch (m_instr.mnemonic)
+    {
+    case X86Call:
+    case X86CallFar:
+        m_instr.flags |= X86InstrCall;
+        break;
+
+    case X86Ret:
+    case X86Retf:
+    case X86Iret:
+    case X86Iretd:
+    case X86Iretq:
+        m_instr.flags |= X86InstrReturn;
+        break;
+
+    case X86Jmp:
+    case X86JmpFar:
+        m_instr.flags |= X86InstrBranch;
+        break;
+
+    case X86Loopne:
+    case X86Loope:
+    case X86Loop:
+    case X86Jcxz:
+    case X86Jecxz:
+    case X86Jrcxz:
+        m_instr.flags |= X86InstrBranch | X86InstrConditional;
+        break;
+
+    default:
+        if (m_instr.mnemonic >= X86Jo && m_instr.mnemonic <= X86Jg)
+            m_instr.flags |= X86InstrBranch | X86InstrConditional;
+        break;
+    }
+
+    if ((m_instr.flags & (X86InstrBranch | X86InstrCall)) && !m_hasRelative && m_instr.operandCount > 0 && m_instr.operands[0].type != X86OpFar)
+        m_instr.flags |= X86InstrIndirect;
+
+    if (m_lock)
+        m_instr.flags |= X86InstrLock;
+
+    if (m_rep && isStringInstruction(m_instr.mnemonic))
+        m_instr.flags |= m_rep == 0xF3 ? X86InstrRep : X86InstrRepne;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+X86DecodeResult InstructionDecoder::decode()
+{
+    OpcodeEntry  entry = {};
+
+    if (!decodePrefixes() || !decodeOpcode(entry))
+        return m_result;
+
+    if (m_vex == 0xC4)
+        m_instr.flags |= X86InstrVex;
+    else if (m_vex == 0x62)
+        m_instr.flags |= X86InstrEvex;
+
+    if (m_x64)
+    {
+        if (entry.flags & F_INV64)
+            entry.mnemonic = X86Invalid;
+
+        if (m_rex & 8)
+            m_opsize = 8;
+        else if (entry.flags & F_DEF64)
+            m_opsize = m_opsizePrefix ? 2 : 8;
+        else
+            m_opsize = m_opsizePrefix ? 2 : 4;
+
+        m_addrsize = m_addrsizePrefix ? 4 : 8;
+    }
+    else
+    {
+        m_opsize = m_opsizePrefix ? 2 : 4;
+        m_addrsize = m_addrsizePrefix ? 2 : 4;
+    }
+
+    // 63 is movsxd in the long mode
+    if (m_x64 && m_map == 0 && m_opcode == 0x63)
+    {
+        entry.mnemonic = X86Movsxd;
+        entry.operands[0] = O_Gv;
+        entry.operands[1] = O_Ed;
+    }
+
+    if ((entry.flags & F_MODRM) || (m_vex && entry.mnemonic != X86Vzeroupper && entry.mnemonic != X86Vzeroall))
+    {
+        if (!decodeModrm())
+            return m_result;
+    }
+
+    // vex and evex forms which are not in the tables ( avx2, avx512, bmi .. ) are
+    // reported as X86Unknown: the length is known, the operands are not decoded
+    const bool  vexImmediate = m_map == 3 || hasImmediate(entry);
+
+    if (m_vex && m_map <= 3 && !(entry.flags & (F_SSE | F_MMX | F_GROUP | F_VEX)) && entry.mnemonic != X86Vzeroupper && entry.mnemonic != X86Vzeroall)
+        setUnknownVex(entry, vexImmediate);
+
+    if (entry.flags & F_X87)
+    {
+        if (!decodeX87(m_opcode, entry))
+            return m_result;
+    }
+    else if (entry.flags & F_SSE)
+    {
+        const OpcodeEntry&  sseEntry = sseMap[entry.mnemonic][mandatoryPrefix()];
+
+        entry.mnemonic = sseEntry.mnemonic;
+        entry.flags = (entry.flags & ~F_SSE) | sseEntry.flags;
+        memcpy(entry.operands, sseEntry.operands, sizeof(entry.operands));
+
+        // register forms of movlps, movhps and the vex movss, movsd
+        if (!isMemory())
+        {
+            if (m_opcode == 0x12 && entry.mnemonic == X86Movlps)
+            {
+                entry.mnemonic = X86Movhlps;
+                entry.operands[1] = O_U;
+            }
+            else if (m_opcode == 0x16 && entry.mnemonic == X86Movhps)
+            {
+                entry.mnemonic = X86Movlhps;
+                entry.operands[1] = O_U;
+            }
+            else if (m_opcode <= 0x11 && (entry.mnemonic == X86Movss || entry.mnemonic == X86Movsd))
+            {
+                entry.flags |= F_NDS;
+            }
+        }
+    }
+    else if (entry.flags & F_GROUP)
+    {
+        unsigned short  group = entry.mnemonic;
+        const OpcodeEntry&  groupEntry = groupMap[group][modrmReg()];
+
+        entry.mnemonic = groupEntry.mnemonic;
+        entry.flags = (entry.flags & ~F_GROUP) | groupEntry.flags;
+        if (groupEntry.operands[0] != O_NONE)
+            memcpy(entry.operands, groupEntry.operands, sizeof(entry.operands));
+
+        if ((groupEntry.flags & F_DEF64) && m_x64 && !(m_rex & 8))
+            m_opsize = m_opsizePrefix ? 2 : 8;
+
+        if (!isMemory())
+        {
+            switch (group)
+            {
+            case G_11b:
+            case G_11v:
+                if (m_modrm == 0xF8)
+                {
+                    entry.mnemonic = m_opcode == 0xC6 ? X86Xabort : X86Xbegin;
+                    entry.operands[0] = m_opcode == 0xC6 ? O_Ib : O_Jz;
+                    entry.operands[1] = O_NONE;
+                }
+                break;
+
+            case G_7:
+                if (modrmReg() != 4 && modrmReg() != 6)
+                {
+                    entry.mnemonic = X86Unknown;
+                    entry.operands[0] = O_NONE;
+
+                    for (size_t i = 0; i < sizeof(group7RegisterMap) / sizeof(group7RegisterMap[0]); ++i)
+                    {
+                        if (group7RegisterMap[i].modrm == m_modrm)
+                            entry.mnemonic = group7RegisterMap[i].mnemonic;
+                    }
+
+                    if (entry.mnemonic == X86Swapgs && !m_x64)
+                        entry.mnemonic = X86Invalid;
+                }
+                break;
+
+            case G_9:
+                entry.operands[0] = O_Ev;
+                if (modrmReg() == 6)
+                    entry.mnemonic = X86Rdrand;
+                else if (modrmReg() == 7)
+                    entry.mnemonic = X86Rdseed;
+                else
+                    entry.mnemonic = X86Invalid;
+                break;
+
+            case G_15:
+                entry.operands[0] = O_NONE;
+                entry.mnemonic = modrmReg() == 5 ? X86Lfence : modrmReg() == 6 ? X86Mfence : modrmReg() == 7 ? X86Sfence : X86Unknown;
+                break;
+
+            case G_16:
+            case G_P:
+                if (entry.mnemonic != X86Nop)
+                {
+                    entry.mnemonic = X86Nop;
+                    entry.operands[0] = O_Ev;
+                }
+                break;
+            }
+        }
+        else if (group == G_9 && (modrmReg() == 6 || modrmReg() == 7))
+        {
+            if (mandatoryPrefix() == Prefix66 && modrmReg() == 6)
+                entry.mnemonic = X86Vmclear;
+            else if (mandatoryPrefix() == PrefixF3 && modrmReg() == 6)
+                entry.mnemonic = X86Vmxon;
+        }
+    }
+
+    if ((entry.flags & F_MMX) && mandatoryPrefix() != PrefixNone && mandatoryPrefix() != Prefix66)
+        entry.mnemonic = X86Invalid;
+
+    if (m_vex && (entry.flags & F_MMX) && mandatoryPrefix() != Prefix66)
+        entry.mnemonic = X86Invalid;
+
+    if (m_map == 1 && m_opcode == 0x1E && m_rep == 0xF3 && (m_modrm == 0xFA || m_modrm == 0xFB))
+    {
+        entry.mnemonic = m_modrm == 0xFA ? X86Endbr64 : X86Endbr32;
+        entry.operands[0] = O_NONE;
+    }
+
+    if (m_map == 0 && m_opcode == 0x90)
+    {
+        if (m_rex & 1)
+        {
+            entry.mnemonic = X86Xchg;
+            entry.operands[0] = O_Zv;
+            entry.operands[1] = O_rAX;
+        }
+        else if (m_rep == 0xF3)
+        {
+            entry.mnemonic = X86Pause;
+        }
+    }
+
+    if (entry.mnemonic == X86Invalid && m_vex && m_map <= 3)
+        setUnknownVex(entry, vexImmediate);
+
+    if (entry.mnemonic == X86Invalid)
+    {
+        fail(X86DecodeInvalid);
+        return m_result;
+    }
+
+    if (entry.flags & F_SIZED)
+        entry.mnemonic += m_opsize == 2 ? 0 : m_opsize == 4 ? 1 : 2;
+
+    if ((entry.flags & F_REXW) && (m_rex & 8))
+        entry.mnemonic += 1;
+
+    if (entry.mnemonic == X86Jcxz)
+        entry.mnemonic += m_addrsize == 2 ? 0 : m_addrsize == 4 ? 1 : 2;
+
+    m_instr.mnemonic = static_cast<X86Mnemonic>(entry.mnemonic);
+
+    // operands: vex adds the vvvv register
+    unsigned char  specs[4] = { entry.operands[0], entry.operands[1], entry.operands[2], O_NONE };
+
+    if (m_vex == 0xC4 || m_vex == 0x62)
+    {
+        if (entry.flags & F_NDS)
+        {
+            specs[3] = specs[2];
+            specs[2] = specs[1];
+            specs[1] = O_H;
+        }
+        else if (entry.flags & F_NDD)
+        {
+            specs[3] = specs[2];
+            specs[2] = specs[1];
+            specs[1] = specs[0];
+            specs[0] = O_H;
+        }
+    }
+
+    for (size_t i = 0; i < 4 && specs[i] != O_NONE; ++i)
+    {
+        if (!decodeOperand(specs[i], m_instr.operands[i]))
+            return m_result;
+        m_instr.operandCount++;
+    }
+
+    if (m_instr.mnemonic == X86Cmpxchg16b)
+        m_instr.operands[0].size = 16;
+
+    // evex compresses disp8: it is scaled by the memory operand size
+    if (m_vex == 0x62 && isMemory() && (m_modrm >> 6) == 1)
+    {
+        for (size_t i = 0; i < m_instr.operandCount; ++i)
+        {
+            X86Operand&  operand = m_instr.operands[i];
+            if (operand.type == X86OpMemory && operand.size)
+                operand.value *= m_evexBroadcast ? (m_vexW ? 8 : 4) : operand.size;
+        }
+    }
+
+    m_instr.length = static_cast<unsigned char>(m_pos);
+
+    if (m_hasRelative)
+    {
+        MEMOFFSET_64  target = m_instr.offset + m_pos + m_relative;
+
+        if (!m_x64)
+            target &= m_opsize == 2 ? 0xFFFF : 0xFFFFFFFF;
+
+        m_instr.target = target;
+
+        for (size_t i = 0; i < m_instr.operandCount; ++i)
+        {
+            if (m_instr.operands[i].type == X86OpRelative)
+                m_instr.operands[i].value = static_cast<long long>(target);
+        }
+    }
+
+    setFlags(entry);
+
+    return X86DecodeOk;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+const wchar_t* const gpr8Names[] = { L"al", L"cl", L"dl", L"bl", L"spl", L"bpl", L"sil", L"dil",
+    L"r8b", L"r9b", L"r10b", L"r11b", L"r12b", L"r13b", L"r14b", L"r15b" };
+const wchar_t* const gpr8HighNames[] = { L"ah", L"ch", L"dh", L"bh" };
+const wchar_t* const gpr16Names[] = { L"ax", L"cx", L"dx", L"bx", L"sp", L"bp", L"si", L"di",
+    L"r8w", L"r9w", L"r10w", L"r11w", L"r12w", L"r13w", L"r14w", L"r15w" };
+const wchar_t* const gpr32Names[] = { L"eax", L"ecx", L"edx", L"ebx", L"esp", L"ebp", L"esi", L"edi",
+    L"r8d", L"r9d", L"r10d", L"r11d", L"r12d", L"r13d", L"r14d", L"r15d" };
+const wchar_t* const gpr64Names[] = { L"rax", L"rcx", L"rdx", L"rbx", L"rsp", L"rbp", L"rsi", L"rdi",
+    L"r8", L"r9", L"r10", L"r11", L"r12", L"r13", L"r14", L"r15" };
+const wchar_t* const segmentNames[] = { L"es", L"cs", L"ss", L"ds", L"fs", L"gs" };
+
+void formatHex(unsigned long long value, std::wstring& text)
+{
+    if (value < 10)
+    {
+        text += static_cast<wchar_t>(L'0' + value);
+        return;
+    }
+
+    wchar_t  buffer[20];
+    size_t  pos = sizeof(buffer) / sizeof(buffer[0]);
+
+    buffer[--pos] = L'h';
+    for (; value; value >>= 4)
+        buffer[--pos] = L"0123456789ABCDEF"[value & 0xF];
+
+    if (buffer[pos] > L'9')
+        buffer[--pos] = L'0';
+
+    text.append(buffer + pos, sizeof(buffer) / sizeof(buffer[0]) - pos);
+}
+
+void formatAddress(MEMOFFSET_64 address, bool x64, std::wstring& text)
+{
+    static const wchar_t  digits[] = L"0123456789abcdef";
+
+    for (int i = x64 ? 15 : 7; i >= 0; --i)
+    {
+        text += digits[(address >> (i * 4)) & 0xF];
+        if (i == 8)
+            text += L'`';
+    }
+}
+
+void formatRegister(const X86Register& reg, std::wstring& text)
+{
+    static const wchar_t  digits[] = L"0123456789";
+
+    switch (reg.regClass)
+    {
+    case X86RegGpr8: text += gpr8Names[reg.number & 0xF]; return;
+    case X86RegGpr8High: text += gpr8HighNames[reg.number & 3]; return;
+    case X86RegGpr16: text += gpr16Names[reg.number & 0xF]; return;
+    case X86RegGpr32: text += gpr32Names[reg.number & 0xF]; return;
+    case X86RegGpr64: text += gpr64Names[reg.number & 0xF]; return;
+    case X86RegIp: text += reg.number ? L"eip" : L"rip"; return;
+    case X86RegSegment: text += segmentNames[reg.number % 6]; return;
+    case X86RegControl: text += L"cr"; break;
+    case X86RegDebug: text += L"dr"; break;
+    case X86RegX87: text += L"st("; text += digits[reg.number & 7]; text += L')'; return;
+    case X86RegMmx: text += L"mm"; break;
+    case X86RegXmm: text += L"xmm"; break;
+    case X86RegYmm: text += L"ymm"; break;
+    case X86RegZmm: text += L"zmm"; break;
+    case X86RegMask: text += L"k"; break;
+    default: return;
+    }
+
+    if (reg.number >= 10)
+        text += digits[reg.number / 10];
+    text += digits[reg.number % 10];
+}
+
+const wchar_t* memorySizeName(unsigned char size)
+{
+    switch (size)
+    {
+    case 1: return L"byte ptr ";
+    case 2: return L"word ptr ";
+    case 4: return L"dword ptr ";
+    case 6: return L"fword ptr ";
+    case 8: return L"qword ptr ";
+    case 10: return L"tbyte ptr ";
+    case 16: return L"xmmword ptr ";
+    case 32: return L"ymmword ptr ";
+    case 64: return L"zmmword ptr ";
+    }
+    return L"";
+}
+
+unsigned long long sizeMask(unsigned char size)
+{
+    return size >= 8 ? ~0ULL : (1ULL << (size * 8)) - 1;
+}
+
+void formatOperand(const X86Instruction& instruction, const X86Operand& operand, std::wstring& text)
+{
+    switch (operand.type)
+    {
+    case X86OpRegister:
+        formatRegister(operand.reg, text);
+        break;
+
+    case X86OpImmediate:
+        formatHex(static_cast<unsigned long long>(operand.value) & sizeMask(operand.size), text);
+        break;
+
+    case X86OpRelative:
+        formatAddress(static_cast<MEMOFFSET_64>(operand.value), operand.size == 8, text);
+        break;
+
+    case X86OpFar:
+        formatHex(operand.selector, text);
+        text += L':';
+        formatHex(static_cast<unsigned long long>(operand.value), text);
+        break;
+
+    case X86OpMemory:
+        {
+            text += memorySizeName(operand.size);
+
+            if (operand.segment.regClass == X86RegSegment)
+            {
+                formatRegister(operand.segment, text);
+                text += L':';
+            }
+
+            text += L'[';
+
+            MEMOFFSET_64  address;
+            if (operand.reg.regClass == X86RegIp && getX86StaticAddress(instruction, operand, address))
+            {
+                formatAddress(address, true, text);
+                text += L']';
+                break;
+            }
+
+            bool  empty = true;
+
+            if (operand.reg.regClass != X86RegNone)
+            {
+                formatRegister(operand.reg, text);
+                empty = false;
+            }
+
+            if (operand.index.regClass != X86RegNone)
+            {
+                if (!empty)
+                    text += L'+';
+                formatRegister(operand.index, text);
+                if (operand.scale > 1)
+                {
+                    text += L'*';
+                    text += static_cast<wchar_t>(L'0' + operand.scale);
+                }
+                empty = false;
+            }
+
+            if (empty)
+            {
+                formatHex(static_cast<unsigned long long>(operand.value), text);
+            }
+            else if (operand.value > 0)
+            {
+                text += L'+';
+                formatHex(static_cast<unsigned long long>(operand.value), text);
+            }
+            else if (operand.value < 0)
+            {
+                text += L'-';
+                formatHex(0 - static_cast<unsigned long long>(operand.value), text);
+            }
+
+            text += L']';
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // end nameless namespace
+
+///////////////////////////////////////////////////////////////////////////////
+
+const char* getX86MnemonicName(X86Mnemonic mnemonic)
+{
+    if (mnemonic >= X86MnemonicCount)
+        return mnemonicNames[X86Invalid];
+    return mnemonicNames[mnemonic];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+bool getX86StaticAddress(const X86Instruction& instruction, const X86Operand& operand, MEMOFFSET_64& address)
+{
+    if (operand.type != X86OpMemory || operand.index.regClass != X86RegNone)
+        return false;
+
+    if (operand.reg.regClass == X86RegIp)
+    {
+        address = instruction.offset + instruction.length + operand.value;
+        if (operand.reg.number != 0)
+            address &= 0xFFFFFFFF;
+        return true;
+    }
+
+    if (operand.reg.regClass != X86RegNone)
+        return false;
+
+    address = static_cast<MEMOFFSET_64>(operand.value);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+X86Decoder::X86Decoder(CPUType cpuMode)
+{
+    switch (cpuMode)
+    {
+    case CPU_I386:
+        m_x64 = false;
+        break;
+
+    case CPU_AMD64:
+        m_x64 = true;
+        break;
+
+    default:
+        throw DbgException("x86 decoder does not support the CPU mode");
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+X86DecodeResult X86Decoder::decode(const unsigned char* code, size_t size, MEMOFFSET_64 offset, X86Instruction& instruction) const
+{
+    return InstructionDecoder(m_x64, code, size, offset, instruction).decode();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+size_t X86Decoder::decode(const unsigned char* code, size_t size, MEMOFFSET_64 offset, std::vector<X86Instruction>& instructions) const
+{
+    size_t  pos = 0;
+
+    instructions.reserve(instructions.size() + size / 4);
+
+    while (pos < size)
+    {
+        instructions.push_back(X86Instruction());
+        X86Instruction&  instruction = instructions.back();
+
+        X86DecodeResult  result = decode(code + pos, size - pos, offset + pos, instruction);
+
+        if (result == X86DecodeTruncated)
+        {
+            instructions.pop_back();
+            break;
+        }
+
+        if (result == X86DecodeInvalid)
+        {
+            memset(&instruction, 0, sizeof(instruction));
+            instruction.offset = offset + pos;
+            instruction.mnemonic = X86Invalid;
+            instruction.length = 1;
+        }
+
+        pos += instruction.length;
+    }
+
+    return pos;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+void formatX86Instruction(const X86Instruction& instruction, std::wstring& text)
+{
+    const size_t  mnemonicWidth = 7;
+
+    size_t  start = text.size();
+
+    if (instruction.flags & X86InstrLock)
+        text += L"lock ";
+
+    if (instruction.flags & X86InstrRep)
+        text += instruction.mnemonic == X86Cmps || instruction.mnemonic == X86Scas ? L"repe " : L"rep ";
+
+    if (instruction.flags & X86InstrRepne)
+        text += L"repne ";
+
+    if ((instruction.flags & (X86InstrVex | X86InstrEvex)) && instruction.mnemonic > X86Unknown &&
+        instruction.mnemonic != X86Vzeroupper && instruction.mnemonic != X86Vzeroall)
+        text += L'v';
+
+    for (const char* name = getX86MnemonicName(instruction.mnemonic); *name; ++name)
+        text += static_cast<wchar_t>(*name);
+
+    if (instruction.operandCount == 0)
+        return;
+
+    do {
+        text += L' ';
+    } while (text.size() - start < mnemonicWidth + 1);
+
+    for (size_t i = 0; i < instruction.operandCount; ++i)
+    {
+        if (i > 0)
+            text += L',';
+        formatOperand(instruction, instruction.operands[i], text);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+std::wstring formatX86Instruction(const X86Instruction& instruction)
+{
+    std::wstring  text;
+    formatX86Instruction(instruction, text);
+    return text;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+} // kdlib namespace end
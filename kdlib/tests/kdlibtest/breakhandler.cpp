@@ -1,6 +1,9 @@
 #include <stdafx.h>
 
+#include <sstream>
+
 #include "kdlib/breakpoint.h"
+#include "kdlib/tracepoint.h"
 
 #include "procfixture.h"
 #include "eventhandlermock.h"
@@ -86,6 +89,224 @@ TEST_F( BreakPointTest, EnumBreak )
     EXPECT_THROW( getBreakpointByIndex(-1), IndexException );
 }
 
+TEST_F( BreakPointTest, ConditionFalse )
+{
+    EventHandlerMock    eventHandler;
+
+    DefaultValue<kdlib::DebugCallbackResult>::Set( DebugCallbackNoChange );
+
+    EXPECT_CALL(eventHandler, onCurrentThreadChange(_)).Times(AnyNumber());
+    EXPECT_CALL(eventHandler, onDebugOutput(_, _)).Times(AnyNumber());
+    EXPECT_CALL(eventHandler, onModuleLoad(_, _)).Times(AnyNumber());
+    EXPECT_CALL(eventHandler, onExecutionStatusChange(_)).Times(AnyNumber());
+    EXPECT_CALL(eventHandler, onProcessExit(_, ProcessExit, _)).Times(1);
+
+    EXPECT_CALL( eventHandler, onBreakpoint( _ ) ).Times( 0 );
+
+    ASSERT_NO_THROW( softwareBreakPointSet( m_targetModule->getSymbolVa( L"CdeclFunc" ), L"1 == 2" ) );
+
+    EXPECT_EQ( DebugStatusNoDebuggee, targetGo() );
+}
+
+TEST_F( BreakPointTest, ConditionTrue )
+{
+    MEMOFFSET_64  offset = m_targetModule->getSymbolVa( L"CdeclFunc" );
+
+    BreakpointPtr  bp;
+    ASSERT_NO_THROW( bp = softwareBreakPointSet( offset, L"sizeof(int) == 4" ) );
+
+    EXPECT_EQ( DebugStatusBreak, targetGo() );
+    EXPECT_EQ( offset, getInstructionOffset() );
+}
+
+namespace {
+
+// "rip == 0x7ff6..." or "eip == 0x..."
+std::wstring getIpCondition( const wchar_t* op, MEMOFFSET_64 offset )
+{
+    std::wstringstream  sstr;
+    sstr << ( getCPUMode() == CPU_AMD64 ? L"rip " : L"eip " ) << op << L" 0x" << std::hex << offset;
+    return sstr.str();
+}
+
+} // end nameless namespace
+
+TEST_F( BreakPointTest, ConditionRegister )
+{
+    MEMOFFSET_64  offset = m_targetModule->getSymbolVa( L"CdeclFunc" );
+
+    BreakpointPtr  bp;
+    ASSERT_NO_THROW( bp = softwareBreakPointSet( offset, getIpCondition( L"==", offset ) ) );
+
+    EXPECT_EQ( DebugStatusBreak, targetGo() );
+    EXPECT_EQ( offset, getInstructionOffset() );
+}
+
+TEST_F( BreakPointTest, ConditionRegisterFalse )
+{
+    MEMOFFSET_64  offset = m_targetModule->getSymbolVa( L"CdeclFunc" );
+
+    BreakpointPtr  bp;
+    ASSERT_NO_THROW( bp = softwareBreakPointSet( offset, getIpCondition( L"!=", offset ) ) );
+
+    EXPECT_EQ( DebugStatusNoDebuggee, targetGo() );
+}
+
+TEST_F( BreakPointTest, ConditionError )
+{
+    EXPECT_THROW( softwareBreakPointSet( m_targetModule->getSymbolVa( L"CdeclFunc" ), L"1 +" ), DbgException );
+    EXPECT_EQ( 0, getNumberBreakpoints() );
+}
+
+TEST_F( BreakPointTest, Tracepoint )
+{
+    MEMOFFSET_64  offset = m_targetModule->getSymbolVa( L"CdeclFunc" );
+
+    TracepointSet  tracepoints;
+    ASSERT_NO_THROW( tracepoints.add( offset ) );
+    EXPECT_EQ( 1, tracepoints.getCount() );
+
+    EXPECT_EQ( DebugStatusNoDebuggee, targetGo() );
+
+    std::vector<TracepointHits>  hits = tracepoints.getHits();
+    ASSERT_EQ( 1, hits.size() );
+    EXPECT_EQ( offset, hits[0].offset );
+    EXPECT_EQ( 1, hits[0].hitCount );
+
+    std::vector<TracepointSample>  samples;
+    tracepoints.readSamples( samples );
+    ASSERT_EQ( 1, samples.size() );
+    EXPECT_EQ( 0, samples[0].tracepoint );
+    EXPECT_EQ( offset, samples[0].ip );
+    EXPECT_EQ( 0, tracepoints.getDroppedSamples() );
+
+    samples.clear();
+    tracepoints.readSamples( samples );
+    EXPECT_EQ( 0, samples.size() );
+}
+
+TEST_F( BreakPointTest, TracepointRegisters )
+{
+    std::vector<std::wstring>  registerNames( maxTracepointRegisters + 1, L"eax" );
+    EXPECT_THROW( TracepointSet  tracepoints( registerNames ), DbgException );
+
+    EXPECT_THROW( TracepointSet  tracepoints( std::vector<std::wstring>( 1, L"notaregister" ) ), DbgException );
+}
+
+// the target calls CdeclFunc tracepointHitCount times
+const unsigned long long  tracepointHitCount = 10;
+
+class TracepointTest : public ProcessFixture
+{
+public:
+
+    TracepointTest() : ProcessFixture( L"tracepointtest" ) {}
+};
+
+TEST_F( TracepointTest, SampleRate )
+{
+    MEMOFFSET_64  offset = m_targetModule->getSymbolVa( L"CdeclFunc" );
+
+    TracepointSet  tracepoints( std::vector<std::wstring>(), 3 );
+    ASSERT_NO_THROW( tracepoints.add( offset ) );
+
+    EXPECT_EQ( DebugStatusNoDebuggee, targetGo() );
+
+    std::vector<TracepointHits>  hits = tracepoints.getHits();
+    ASSERT_EQ( 1, hits.size() );
+    EXPECT_EQ( tracepointHitCount, hits[0].hitCount );
+
+    // the hits 0, 3, 6 and 9
+    std::vector<TracepointSample>  samples;
+    tracepoints.readSamples( samples );
+    EXPECT_EQ( ( tracepointHitCount + 2 ) / 3, samples.size() );
+
+    for ( size_t i = 1; i < samples.size(); ++i )
+        EXPECT_LE( samples[i - 1].timestamp, samples[i].timestamp );
+
+    EXPECT_EQ( 0, tracepoints.getDroppedSamples() );
+    EXPECT_EQ( 0, tracepoints.getFailedSamples() );
+}
+
+TEST_F( TracepointTest, Dropped )
+{
+    MEMOFFSET_64  offset = m_targetModule->getSymbolVa( L"CdeclFunc" );
+
+    TracepointSet  tracepoints( std::vector<std::wstring>(), 1, 4 );
+    ASSERT_NO_THROW( tracepoints.add( offset ) );
+
+    EXPECT_EQ( DebugStatusNoDebuggee, targetGo() );
+
+    std::vector<TracepointSample>  samples;
+    tracepoints.readSamples( samples );
+    EXPECT_EQ( 4, samples.size() );
+    EXPECT_EQ( tracepointHitCount - 4, tracepoints.getDroppedSamples() );
+}
+
+TEST_F( TracepointTest, Registers )
+{
+    MEMOFFSET_64  offset = m_targetModule->getSymbolVa( L"CdeclFunc" );
+
+    std::vector<std::wstring>  registerNames;
+    if ( getCPUMode() == CPU_AMD64 )
+    {
+        registerNames.push_back( L"rip" );
+        registerNames.push_back( L"rsp" );
+    }
+    else
+    {
+        registerNames.push_back( L"eip" );
+        registerNames.push_back( L"esp" );
+    }
+
+    TracepointSet  tracepoints( registerNames );
+    ASSERT_NO_THROW( tracepoints.add( offset ) );
+
+    EXPECT_EQ( DebugStatusNoDebuggee, targetGo() );
+
+    std::vector<TracepointSample>  samples;
+    tracepoints.readSamples( samples );
+    ASSERT_EQ( tracepointHitCount, samples.size() );
+
+    for ( const auto& sample : samples )
+    {
+        EXPECT_EQ( offset, sample.registers[0] );
+        EXPECT_EQ( sample.ip, sample.registers[0] );
+        EXPECT_NE( 0, sample.registers[1] );
+        EXPECT_EQ( 0, sample.registers[2] );
+        EXPECT_EQ( 0, sample.registers[3] );
+    }
+
+    // the loop calls CdeclFunc from the same frame
+    EXPECT_EQ( samples.front().registers[1], samples.back().registers[1] );
+
+    EXPECT_EQ( 0, tracepoints.getFailedSamples() );
+}
+
+TEST_F( TracepointTest, NoBreakpointEvent )
+{
+    EventHandlerMock  eventHandler;
+
+    DefaultValue<kdlib::DebugCallbackResult>::Set( DebugCallbackNoChange );
+
+    EXPECT_CALL(eventHandler, onCurrentThreadChange(_)).Times(AnyNumber());
+    EXPECT_CALL(eventHandler, onDebugOutput(_, _)).Times(AnyNumber());
+    EXPECT_CALL(eventHandler, onModuleLoad(_, _)).Times(AnyNumber());
+    EXPECT_CALL(eventHandler, onExecutionStatusChange(_)).Times(AnyNumber());
+    EXPECT_CALL(eventHandler, onProcessExit(_, ProcessExit, _)).Times(1);
+
+    EXPECT_CALL( eventHandler, onBreakpoint( _ ) ).Times( 0 );
+
+    TracepointSet  tracepoints;
+    ASSERT_NO_THROW( tracepoints.add( m_targetModule->getSymbolVa( L"CdeclFunc" ) ) );
+
+    EXPECT_EQ( DebugStatusNoDebuggee, targetGo() );
+
+    std::vector<TracepointHits>  hits = tracepoints.getHits();
+    ASSERT_EQ( 1, hits.size() );
+    EXPECT_EQ( tracepointHitCount, hits[0].hitCount );
+}
+
 class BreakpointMock 
 {
 public:
@@ -371,6 +371,54 @@ TEST_F(ClangTest, Typedef)
     ASSERT_EQ(L"_Test**", typeProvider->getTypeByName(L"PPTEST")->getName());
 }
 
+TEST_F(ClangTest, ProviderCache)
+{
+    TypeInfoProviderPtr  baseProvider;
+    ASSERT_NO_THROW( baseProvider = getTypeInfoProviderFromSource(test_typedef_src) );
+    EXPECT_EQ( baseProvider, getTypeInfoProviderFromSource(test_typedef_src) );
+    EXPECT_NE( baseProvider, getTypeInfoProviderFromSource(test_typedef_src, L"-w") );
+
+    const std::wstring  extSrc = std::wstring(test_typedef_src) + L"struct TestExt { TEST  field1; PTEST  field2; };";
+
+    TypeInfoProviderPtr  extProvider;
+    ASSERT_NO_THROW( extProvider = getTypeInfoProviderFromSource(extSrc) );
+    EXPECT_NE( baseProvider, extProvider );
+
+    EXPECT_EQ( L"_Test", extProvider->getTypeByName(L"TEST")->getName() );
+    EXPECT_EQ( L"_Test", extProvider->getTypeByName(L"TestExt")->getElement(L"field1")->getName() );
+    EXPECT_EQ( L"_Test*", extProvider->getTypeByName(L"TestExt")->getElement(L"field2")->getName() );
+
+    TypeInfoProviderStatistics  stats = getTypeInfoProviderStatistics(extProvider);
+    EXPECT_EQ( wcslen(test_typedef_src), stats.precompiledSize );
+    EXPECT_LE( 0.0, stats.compileTime );
+    EXPECT_LE( 0.0, stats.typeCollectTime );
+
+    EXPECT_EQ( 0, getTypeInfoProviderStatistics(baseProvider).precompiledSize );
+    EXPECT_THROW( getTypeInfoProviderStatistics(getDefaultTypeInfoProvider()), TypeException );
+}
+
+TEST_F(ClangTest, ProviderCachePrefix)
+{
+    // the base source does not end a declaration: it is not a precompiled prefix
+    const std::string  namespaceSrc = "namespace NsBase { struct A { int x; }; }";
+    ASSERT_NO_THROW( getTypeInfoProviderFromSource(namespaceSrc) );
+
+    TypeInfoProviderPtr  extProvider;
+    ASSERT_NO_THROW( extProvider = getTypeInfoProviderFromSource(namespaceSrc + " struct NsExt { NsBase::A a; };") );
+    EXPECT_EQ( 0, getTypeInfoProviderStatistics(extProvider).precompiledSize );
+    EXPECT_EQ( 4, extProvider->getTypeByName(L"NsExt")->getSize() );
+
+    // the tail does not compile on top of the base: the whole source is compiled and not cached
+    const std::string  baseSrc = "struct TailBase { int x; };";
+    ASSERT_NO_THROW( getTypeInfoProviderFromSource(baseSrc) );
+
+    const std::string  errorSrc = baseSrc + " struct TailError { TailBase a; NotAType b; };";
+    ASSERT_NO_THROW( extProvider = getTypeInfoProviderFromSource(errorSrc) );
+    EXPECT_EQ( 0, getTypeInfoProviderStatistics(extProvider).precompiledSize );
+    EXPECT_EQ( 4, extProvider->getTypeByName(L"TailBase")->getSize() );
+    EXPECT_NE( extProvider, getTypeInfoProviderFromSource(errorSrc) );
+}
+
 TEST_F(ClangTest, TypeProviderEnum)
 {
    const std::wstring  src = L"#include \"../../../kdlib/include/test/testvars.h\"";
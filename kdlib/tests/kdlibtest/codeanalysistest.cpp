@@ -0,0 +1,203 @@
+#include <stdafx.h>
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdlib/codeanalysis.h"
+#include "kdlib/exceptions.h"
+
+#include "peimagefixture.h"
+
+using namespace kdlib;
+
+class CodeAnalysisTest : public PEImageFixture
+{
+protected:
+
+    // a mapped PE32+ image: .text at 0x1000, data at 0x2000, .pdata at 0x3000
+    //
+    // 1000: push rbx                   ; entry point, .pdata
+    // 1001: test ecx,ecx
+    // 1003: je 100A
+    // 1005: call 1020
+    // 100A: lea rax,[2000]
+    // 1011: pop rbx
+    // 1012: ret
+    // 1020: mov eax,1                  ; found by the call
+    // 1025: ret
+    // 1030: jmp 1020                   ; .pdata, a tail call
+    virtual void SetUp()
+    {
+        buildHeaders(0x4000, 2);
+
+        put<unsigned int>(ntHeader + 8, 0x5A000000);   // timestamp
+        put<unsigned int>(optHeader + 16, 0x1000);     // entry point
+        put<unsigned int>(optHeader + 56, 0x4000);     // image size
+        put<unsigned int>(optHeader + 64, 0x1234);     // checksum
+
+        setDataDirectory(3, 0x3000, 24);                // exception directory
+
+        setSection(0, ".text", 0x100, 0x1000, 0, 0, 0x60000020);     // code, execute, read
+        setSection(1, ".pdata", 0x100, 0x3000, 0, 0, 0x40000040);    // data, read
+
+        const unsigned char  code[] = {
+            0x53, 0x85, 0xC9, 0x74, 0x05, 0xE8, 0x16, 0x00, 0x00, 0x00,
+            0x48, 0x8D, 0x05, 0xEF, 0x0F, 0x00, 0x00, 0x5B, 0xC3
+        };
+        memcpy(&m_image[0x1000], code, sizeof(code));
+
+        const unsigned char  callee[] = { 0xB8, 0x01, 0x00, 0x00, 0x00, 0xC3 };
+        memcpy(&m_image[0x1020], callee, sizeof(callee));
+
+        const unsigned char  tailCall[] = { 0xE9, 0xEB, 0xFF, 0xFF, 0xFF };
+        memcpy(&m_image[0x1030], tailCall, sizeof(tailCall));
+
+        put<unsigned int>(0x3000, 0x1000);
+        put<unsigned int>(0x3004, 0x1013);
+        put<unsigned int>(0x300C, 0x1030);
+        put<unsigned int>(0x3010, 0x1035);
+    }
+
+    CodeIndexPtr analyze()
+    {
+        auto  reader = [this](MEMOFFSET_32 rva, void* buffer, size_t length) {
+            if (rva + length > m_image.size())
+                throw DbgException("out of the image");
+            memcpy(buffer, &m_image[rva], length);
+        };
+
+        return analyzeCode(reader, 0x140000000ULL, std::vector<CodeRange>());
+    }
+};
+
+TEST_F(CodeAnalysisTest, Functions)
+{
+    CodeIndexPtr  codeIndex;
+    ASSERT_NO_THROW( codeIndex = analyze() );
+
+    EXPECT_EQ( 0x5A000000, codeIndex->getTimeDataStamp() );
+    EXPECT_EQ( 0x1234, codeIndex->getCheckSum() );
+
+    const std::vector<CodeFunction>&  functions = codeIndex->getFunctions();
+    ASSERT_EQ( 3, functions.size() );
+
+    EXPECT_EQ( 0x1000, functions[0].rva );
+    EXPECT_EQ( 0x13, functions[0].size );
+    EXPECT_EQ( CodeFromEntry | CodeFromUnwind, functions[0].sources );
+    EXPECT_EQ( 3, functions[0].blockCount );
+
+    EXPECT_EQ( 0x1020, functions[1].rva );
+    EXPECT_EQ( CodeFromCall, functions[1].sources );
+    EXPECT_EQ( 1, functions[1].blockCount );
+
+    EXPECT_EQ( 0x1030, functions[2].rva );
+    EXPECT_EQ( CodeFromUnwind, functions[2].sources );
+    EXPECT_EQ( 5, functions[2].size );
+}
+
+TEST_F(CodeAnalysisTest, Blocks)
+{
+    CodeIndexPtr  codeIndex = analyze();
+
+    const CodeBlock*  block = codeIndex->findBlock(0x1006);
+    ASSERT_TRUE( block != 0 );
+    EXPECT_EQ( 0x1005, block->rva );
+    EXPECT_EQ( 5, block->size );
+
+    block = codeIndex->findBlock(0x1012);
+    ASSERT_TRUE( block != 0 );
+    EXPECT_EQ( 0x100A, block->rva );
+    EXPECT_EQ( 9, block->size );
+
+    const CodeFunction*  function = codeIndex->findFunction(0x1011);
+    ASSERT_TRUE( function != 0 );
+    EXPECT_EQ( 0x1000, function->rva );
+
+    EXPECT_TRUE( codeIndex->findBlock(0x1013) == 0 );
+    EXPECT_TRUE( codeIndex->findFunction(0x2000) == 0 );
+}
+
+TEST_F(CodeAnalysisTest, Refs)
+{
+    CodeIndexPtr  codeIndex = analyze();
+
+    std::vector<CodeRef>  refs = codeIndex->getRefsTo(0x1020);
+    ASSERT_EQ( 2, refs.size() );
+    EXPECT_EQ( 0x1005, refs[0].from );
+    EXPECT_EQ( CodeRefCall, refs[0].type );
+    EXPECT_EQ( 0x1030, refs[1].from );
+    EXPECT_EQ( CodeRefJump, refs[1].type );
+
+    refs = codeIndex->getRefsTo(0x2000);
+    ASSERT_EQ( 1, refs.size() );
+    EXPECT_EQ( 0x100A, refs[0].from );
+    EXPECT_EQ( CodeRefData, refs[0].type );
+
+    refs = codeIndex->getRefsFrom(codeIndex->getFunctions()[0]);
+    EXPECT_EQ( 3, refs.size() );
+}
+
+TEST_F(CodeAnalysisTest, SaveLoad)
+{
+    CodeIndexPtr  codeIndex = analyze();
+
+    std::vector<unsigned char>  data;
+    codeIndex->save(data);
+
+    CodeIndexPtr  loadedIndex;
+    ASSERT_NO_THROW( loadedIndex = CodeIndex::load(&data[0], data.size()) );
+
+    EXPECT_EQ( codeIndex->getTimeDataStamp(), loadedIndex->getTimeDataStamp() );
+    EXPECT_EQ( codeIndex->getCheckSum(), loadedIndex->getCheckSum() );
+    ASSERT_EQ( codeIndex->getFunctions().size(), loadedIndex->getFunctions().size() );
+    ASSERT_EQ( codeIndex->getBlocks().size(), loadedIndex->getBlocks().size() );
+    ASSERT_EQ( codeIndex->getRefs().size(), loadedIndex->getRefs().size() );
+
+    for (size_t i = 0; i < codeIndex->getBlocks().size(); ++i)
+    {
+        EXPECT_EQ( codeIndex->getBlocks()[i].rva, loadedIndex->getBlocks()[i].rva );
+        EXPECT_EQ( codeIndex->getBlocks()[i].function, loadedIndex->getBlocks()[i].function );
+    }
+
+    EXPECT_EQ( 2, loadedIndex->getRefsTo(0x1020).size() );
+
+    EXPECT_THROW( CodeIndex::load(&data[0], data.size() - 1), DbgException );
+
+    data[0] = 0;
+    EXPECT_THROW( CodeIndex::load(&data[0], data.size()), DbgException );
+}
+
+TEST_F(CodeAnalysisTest, Cache)
+{
+    CodeIndexPtr  codeIndex = analyze();
+
+    const PROCESS_DEBUG_ID  processId = 0x7FFF0000;
+    const MEMOFFSET_64  moduleBase = 0x140000000ULL;
+
+    EXPECT_FALSE( findCodeIndex(processId, moduleBase, L"codeanalysistest", 0x5A000000, 0x1234, false) );
+
+    insertCodeIndex(processId, moduleBase, L"codeanalysistest", codeIndex, false);
+
+    EXPECT_EQ( codeIndex, findCodeIndex(processId, moduleBase, L"codeanalysistest", 0x5A000000, 0x1234, false) );
+    EXPECT_FALSE( findCodeIndex(processId, moduleBase, L"codeanalysistest", 0x5A000000, 0x1235, false) );
+
+    // the index built without the symbols is not taken when they are loaded
+    EXPECT_FALSE( findCodeIndex(processId, moduleBase, L"codeanalysistest", 0x5A000000, 0x1234, true) );
+
+    // the same image in the other process or at the other base is not in the memory cache
+    EXPECT_FALSE( findCodeIndex(processId + 1, moduleBase, L"codeanalysistest", 0x5A000000, 0x1234, false) );
+    EXPECT_FALSE( findCodeIndex(processId, moduleBase + 0x10000, L"codeanalysistest", 0x5A000000, 0x1234, false) );
+
+    // the unload drops the entry
+    removeCodeIndex(processId, moduleBase);
+    EXPECT_FALSE( findCodeIndex(processId, moduleBase, L"codeanalysistest", 0x5A000000, 0x1234, false) );
+
+    // and so does the process exit
+    insertCodeIndex(processId, moduleBase, L"codeanalysistest", codeIndex, false);
+    insertCodeIndex(processId, moduleBase + 0x10000, L"codeanalysistest", codeIndex, true);
+    removeProcessCodeIndices(processId);
+    EXPECT_FALSE( findCodeIndex(processId, moduleBase, L"codeanalysistest", 0x5A000000, 0x1234, false) );
+    EXPECT_FALSE( findCodeIndex(processId, moduleBase + 0x10000, L"codeanalysistest", 0x5A000000, 0x1234, true) );
+}
@@ -1,5 +1,8 @@
 #include <stdafx.h>
 
+#include <set>
+#include <vector>
+
 #include "procfixture.h"
 #include "kdlib/cpucontext.h"
 
@@ -41,6 +44,143 @@ TEST_F( CPUContextTest, RestoreContext )
     EXPECT_EQ( reg2, getRegisterByName(L"eax") );
 }
 
+TEST_F( CPUContextTest, RegisterTable )
+{
+    CPUContextPtr  cpu;
+    ASSERT_NO_THROW( cpu = loadCPUContext() );
+
+    const std::wstring  spName = cpu->getCPUMode() == CPU_AMD64 ? L"rsp" : L"esp";
+    EXPECT_EQ( cpu->getSP(), cpu->getRegisterByName(spName).asULongLong() );
+    EXPECT_EQ( cpu->getRegisterByName(spName), cpu->getRegisterByName(cpu->getCPUMode() == CPU_AMD64 ? L"RSP" : L"ESP") );
+
+    std::vector<unsigned long>  indices;
+    std::vector<NumVariant>  values;
+    ASSERT_NO_THROW( cpu->getRegisters(indices, values) );
+
+    ASSERT_EQ( indices.size(), values.size() );
+    EXPECT_NE( 0, indices.size() );
+    EXPECT_GE( cpu->getRegisterNumber(), indices.size() );
+
+    for ( size_t i = 0; i < indices.size(); ++i )
+    {
+        EXPECT_EQ( values[i], cpu->getRegisterByIndex(indices[i]) );
+        EXPECT_EQ( values[i], cpu->getRegisterByName(cpu->getRegisterName(indices[i])) );
+    }
+
+    EXPECT_THROW( cpu->getRegisterByName(L"notexist"), DbgException );
+    EXPECT_THROW( cpu->getRegisterByIndex(0xFFFF), DbgException );
+}
+
+namespace {
+
+// CodeView register ids ( cvconst.h )
+const unsigned long  CV_REG_AL = 1;
+const unsigned long  CV_REG_AH = 5;
+const unsigned long  CV_REG_AX = 9;
+const unsigned long  CV_REG_EAX = 17;
+const unsigned long  CV_REG_ESP = 21;
+const unsigned long  CV_REG_EIP = 33;
+const unsigned long  CV_AMD64_RAX = 328;
+const unsigned long  CV_AMD64_RSP = 335;
+const unsigned long  CV_AMD64_R8 = 336;
+
+// a raw context with a distinct value in every byte of a register
+std::vector<unsigned char> makeRawContext()
+{
+    std::vector<unsigned char>  rawContext(0x1000);
+    for ( size_t i = 0; i < rawContext.size(); ++i )
+        rawContext[i] = static_cast<unsigned char>( i * 7 + 1 );
+    return rawContext;
+}
+
+void checkRegisterTable( const CPUContextPtr& cpu )
+{
+    std::vector<unsigned long>  indices;
+    std::vector<NumVariant>  values;
+    cpu->getRegisters(indices, values);
+
+    ASSERT_EQ( indices.size(), values.size() );
+    EXPECT_NE( 0, indices.size() );
+    EXPECT_GE( cpu->getRegisterNumber(), indices.size() );
+
+    for ( size_t i = 0; i < indices.size(); ++i )
+    {
+        std::wstring  name = cpu->getRegisterName(indices[i]);
+        EXPECT_EQ( values[i], cpu->getRegisterByIndex(indices[i]) );
+        EXPECT_EQ( values[i], cpu->getRegisterByName(name) );
+    }
+
+    // every register has its own index and name
+    std::set<unsigned long>  indexSet( indices.begin(), indices.end() );
+    EXPECT_EQ( indices.size(), indexSet.size() );
+
+    std::set<std::wstring>  nameSet;
+    for ( size_t i = 0; i < indices.size(); ++i )
+        nameSet.insert( cpu->getRegisterName(indices[i]) );
+    EXPECT_EQ( indices.size(), nameSet.size() );
+
+    EXPECT_THROW( cpu->getRegisterByName(L"notexist"), DbgException );
+    EXPECT_THROW( cpu->getRegisterByIndex(0xFFFF), DbgException );
+}
+
+} // end nameless namespace
+
+TEST( CPUContextTable, I386 )
+{
+    std::vector<unsigned char>  rawContext = makeRawContext();
+
+    CPUContextPtr  cpu;
+    ASSERT_NO_THROW( cpu = loadCPUContext( CPU_I386, &rawContext[0], rawContext.size() ) );
+    EXPECT_EQ( CPU_I386, cpu->getCPUMode() );
+
+    checkRegisterTable(cpu);
+
+    unsigned long long  eax = cpu->getRegisterByIndex(CV_REG_EAX).asULongLong();
+    EXPECT_EQ( L"eax", cpu->getRegisterName(CV_REG_EAX) );
+    EXPECT_EQ( eax, cpu->getRegisterByName(L"EAX").asULongLong() );
+    EXPECT_EQ( eax & 0xFFFF, cpu->getRegisterByIndex(CV_REG_AX).asULongLong() );
+    EXPECT_EQ( eax & 0xFF, cpu->getRegisterByIndex(CV_REG_AL).asULongLong() );
+    EXPECT_EQ( ( eax >> 8 ) & 0xFF, cpu->getRegisterByIndex(CV_REG_AH).asULongLong() );
+    EXPECT_GT( eax, 0xFFFF );
+
+    EXPECT_EQ( cpu->getIP(), cpu->getRegisterByIndex(CV_REG_EIP).asULongLong() );
+    EXPECT_EQ( cpu->getSP(), cpu->getRegisterByIndex(CV_REG_ESP).asULongLong() );
+    EXPECT_EQ( L"esp", cpu->getRegisterName(CV_REG_ESP) );
+
+    EXPECT_THROW( cpu->getRegisterByName(L"rax"), DbgException );
+    EXPECT_THROW( cpu->getRegisterByIndex(CV_AMD64_RAX), DbgException );
+
+    EXPECT_THROW( loadCPUContext( CPU_I386, &rawContext[0], 0x10 ), DbgException );
+}
+
+TEST( CPUContextTable, Amd64 )
+{
+    std::vector<unsigned char>  rawContext = makeRawContext();
+
+    CPUContextPtr  cpu;
+    ASSERT_NO_THROW( cpu = loadCPUContext( CPU_AMD64, &rawContext[0], rawContext.size() ) );
+    EXPECT_EQ( CPU_AMD64, cpu->getCPUMode() );
+
+    checkRegisterTable(cpu);
+
+    unsigned long long  rax = cpu->getRegisterByIndex(CV_AMD64_RAX).asULongLong();
+    EXPECT_EQ( L"rax", cpu->getRegisterName(CV_AMD64_RAX) );
+    EXPECT_EQ( rax, cpu->getRegisterByName(L"Rax").asULongLong() );
+    EXPECT_EQ( rax & 0xFFFFFFFF, cpu->getRegisterByName(L"eax").asULongLong() );
+    EXPECT_EQ( rax & 0xFFFF, cpu->getRegisterByName(L"ax").asULongLong() );
+    EXPECT_EQ( rax & 0xFF, cpu->getRegisterByName(L"al").asULongLong() );
+    EXPECT_EQ( ( rax >> 8 ) & 0xFF, cpu->getRegisterByName(L"ah").asULongLong() );
+    EXPECT_GT( rax, 0xFFFFFFFFULL );
+
+    EXPECT_EQ( cpu->getSP(), cpu->getRegisterByIndex(CV_AMD64_RSP).asULongLong() );
+    EXPECT_EQ( cpu->getIP(), cpu->getRegisterByName(L"rip").asULongLong() );
+    EXPECT_EQ( cpu->getFP(), cpu->getRegisterByName(L"rbp").asULongLong() );
+    EXPECT_EQ( L"r8", cpu->getRegisterName(CV_AMD64_R8) );
+    EXPECT_NE( rax, cpu->getRegisterByIndex(CV_AMD64_R8).asULongLong() );
+
+    EXPECT_THROW( loadCPUContext( CPU_AMD64, &rawContext[0], 0x10 ), DbgException );
+}
+
 TEST_F( CPUContextTest, GetStackRegs )
 {
     EXPECT_NO_THROW( getStackOffset() );
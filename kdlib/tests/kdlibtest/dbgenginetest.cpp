@@ -28,6 +28,40 @@ TEST_F(DbgEngineTest, DbgCommandUnicode)
     EXPECT_EQ(L"💩", kdlib::debugCommand(kdlib::debugCommand(L".printf \"💩\""), true));
 }
 
+namespace {
+
+class LineRecorder : public OutputLineSink
+{
+public:
+
+    virtual void onLine(const wchar_t* line, size_t length) {
+        m_lines.push_back(std::wstring(line, length));
+    }
+
+    std::vector<std::wstring>  m_lines;
+};
+
+} // end nameless namespace
+
+TEST_F(DbgEngineTest, DbgCommandSink)
+{
+    OutputChunks  chunks(4);
+    ASSERT_NO_THROW(kdlib::debugCommand(L".printf /on \"normal output\"", chunks, OutputFlag::Normal));
+    EXPECT_EQ(L"normal output", chunks.str());
+    EXPECT_LT(1, chunks.getChunkCount());
+
+    LineRecorder  lines;
+    ASSERT_NO_THROW(kdlib::debugCommand(L".printf \"first\\nsecond\\nthird\"", lines));
+    ASSERT_EQ(3, lines.m_lines.size());
+    EXPECT_EQ(L"first", lines.m_lines[0]);
+    EXPECT_EQ(L"second", lines.m_lines[1]);
+    EXPECT_EQ(L"third", lines.m_lines[2]);
+
+    OutputChunks  errors;
+    ASSERT_NO_THROW(kdlib::debugCommand(L".printf /oe \"error\"", errors, OutputFlag::Normal));
+    EXPECT_EQ(0, errors.size());
+}
+
 class MiniDump : public MemDumpFixture
 {
 public:
@@ -0,0 +1,152 @@
+#include <stdafx.h>
+
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "gtest/gtest.h"
+
+#include "kdlib/dbgout.h"
+
+using namespace kdlib;
+
+namespace {
+
+class RecordingOut : public DbgOut
+{
+public:
+
+    RecordingOut() :
+        m_writes(0)
+    {}
+
+    virtual void write( const std::wstring& str ) {
+        boost::mutex::scoped_lock  lock(m_lock);
+        m_text += str;
+        m_writes++;
+    }
+
+    virtual void writedml( const std::wstring& str ) {
+        boost::mutex::scoped_lock  lock(m_lock);
+        m_text += L"<" + str + L">";
+    }
+
+    std::wstring  m_text;
+    size_t  m_writes;
+
+private:
+
+    boost::mutex  m_lock;
+};
+
+void writeLines(BufferedDbgOut* out, int thread, int lineCount)
+{
+    for (int i = 0; i < lineCount; ++i)
+    {
+        std::wstringstream  sstr;
+        sstr << thread << L':' << i;
+        out->writeln(sstr.str());
+    }
+}
+
+} // end nameless namespace
+
+TEST(DbgOutTest, Threads)
+{
+    const int  threadCount = 8;
+    const int  lineCount = 10000;
+
+    RecordingOut  target;
+
+    {
+        BufferedDbgOut  out(&target, DbgOutFlushBySize, 0x100);
+
+        boost::thread_group  threads;
+        for (int i = 0; i < threadCount; ++i)
+            threads.create_thread(boost::bind(&writeLines, &out, i, lineCount));
+        threads.join_all();
+    }
+
+    std::wstringstream  sstr(target.m_text);
+    std::wstring  line;
+    std::map<int, int>  nextLine;
+    int  totalLines = 0;
+
+    while (std::getline(sstr, line))
+    {
+        ASSERT_FALSE(line.empty());
+        ASSERT_EQ(L'\r', line.back());
+
+        std::wstringstream  lineStream(line);
+        int  thread, index;
+        wchar_t  separator;
+        lineStream >> thread >> separator >> index;
+
+        ASSERT_EQ(nextLine[thread], index);
+        nextLine[thread] = index + 1;
+        totalLines++;
+    }
+
+    EXPECT_EQ(threadCount * lineCount, totalLines);
+    EXPECT_LT(target.m_writes, static_cast<size_t>(totalLines / 4));
+}
+
+TEST(DbgOutTest, FlushByNewline)
+{
+    RecordingOut  target;
+    BufferedDbgOut  out(&target, DbgOutFlushByNewline, 0x10);
+
+    out.write(L"ab");
+    EXPECT_EQ(L"", target.m_text);
+
+    out.write(L"c\nd");
+    EXPECT_EQ(L"abc\nd", target.m_text);
+
+    out.write(L"e");
+    out.writedml(L"dml");
+    EXPECT_EQ(L"abc\nde<dml>", target.m_text);
+
+    out.write(L"longer than the buffer");
+    EXPECT_EQ(L"abc\nde<dml>longer than the buffer", target.m_text);
+
+    out.write(L"0123456789");
+    out.write(L"0123456789");
+    EXPECT_EQ(L"abc\nde<dml>longer than the buffer0123456789", target.m_text);
+
+    out.flush();
+    EXPECT_EQ(L"abc\nde<dml>longer than the buffer01234567890123456789", target.m_text);
+}
+
+TEST(DbgOutTest, DefaultPolicy)
+{
+    RecordingOut  target;
+    BufferedDbgOut  out(&target);
+
+    out.write(L"prompt>");
+    EXPECT_EQ(L"", target.m_text);
+
+    out.flush();
+    EXPECT_EQ(L"prompt>", target.m_text);
+
+    // a line is not kept until the next write
+    out.write(L"line\n");
+    EXPECT_EQ(L"prompt>line\n", target.m_text);
+}
+
+TEST(DbgOutTest, FlushByTime)
+{
+    RecordingOut  target;
+    BufferedDbgOut  out(&target, DbgOutFlushByTime, 0x100, 20);
+
+    out.write(L"a");
+    EXPECT_EQ(L"", target.m_text);
+
+    boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+
+    out.write(L"b");
+    EXPECT_EQ(L"ab", target.m_text);
+}
@@ -0,0 +1,195 @@
+#include <stdafx.h>
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+
+#include "kdlib/demangle.h"
+
+using namespace kdlib;
+
+namespace {
+
+struct DemangleSample {
+    const char*  decorated;
+    const char*  nameOnly;
+    const char*  full;
+};
+
+const DemangleSample  demangleSamples[] = {
+    { "?x@@3HA", "x", "int x" },
+    { "?s@Foo@@2HA", "Foo::s", "public: static int Foo::s" },
+    { "?func@@YAHH@Z", "func", "int __cdecl func(int)" },
+    { "??0Foo@@QAE@XZ", "Foo::Foo", "public: __thiscall Foo::Foo(void)" },
+    { "??1Foo@@UAE@XZ", "Foo::~Foo", "public: virtual __thiscall Foo::~Foo(void)" },
+    { "?bar@Foo@@QAEXPBD@Z", "Foo::bar", "public: void __thiscall Foo::bar(char const *)" },
+    { "?bar@Foo@@QEAAXPEBD@Z", "Foo::bar", "public: void __cdecl Foo::bar(char const * __ptr64) __ptr64" },
+    { "??4Foo@@QAEAAV0@ABV0@@Z", "Foo::operator=", "public: class Foo & __thiscall Foo::operator=(class Foo const &)" },
+    { "??2@YAPAXI@Z", "operator new", "void * __cdecl operator new(unsigned int)" },
+    { "??BFoo@@QBEHXZ", "Foo::operator int", "public: __thiscall Foo::operator int(void) const" },
+    { "??_7Foo@@6B@", "Foo::`vftable'", "const Foo::`vftable'" },
+    { "??_GFoo@@UAEPAXI@Z", "Foo::`scalar deleting destructor'", "public: virtual void * __thiscall Foo::`scalar deleting destructor'(unsigned int)" },
+    { "??$max@H@std@@YAABHABH0@Z", "std::max<int>", "int const & __cdecl std::max<int>(int const &,int const &)" },
+    { "??0?$vector@HV?$allocator@H@std@@@std@@QAE@XZ",
+        "std::vector<int,class std::allocator<int> >::vector<int,class std::allocator<int> >",
+        "public: __thiscall std::vector<int,class std::allocator<int> >::vector<int,class std::allocator<int> >(void)" },
+    { "?printf@@YAHPBDZZ", "printf", "int __cdecl printf(char const *,...)" },
+    { "?cb@@YAXP6AHH@Z@Z", "cb", "void __cdecl cb(int (__cdecl*)(int))" },
+    { "?f@?A0x1234@@YAXXZ", "`anonymous namespace'::f", "void __cdecl `anonymous namespace'::f(void)" },
+    { "?g@@YAX$$QAH@Z", "g", "void __cdecl g(int &&)" },
+    { "?h@@YAXPAY09H@Z", "h", "void __cdecl h(int (*)[10])" },
+    { "??_EFoo@@UAEPAXI@Z", "Foo::`vector deleting destructor'", "public: virtual void * __thiscall Foo::`vector deleting destructor'(unsigned int)" },
+    { "??_8Foo@@7B@", "Foo::`vbtable'", "const Foo::`vbtable'" },
+    { "??_DFoo@@QAEXXZ", "Foo::`vbase destructor'", "public: void __thiscall Foo::`vbase destructor'(void)" },
+    { "??$f@$0A@@@YAXXZ", "f<0>", "void __cdecl f<0>(void)" },
+    { "?v@@3U?$pair@HH@std@@A", "v", "struct std::pair<int,int> v" },
+    { "?inst@?$S@H@@2V1@A", "S<int>::inst", "public: static class S<int> S<int>::inst" },
+};
+
+// the encodings MsvcDemangler rejects in the mode: they go to undecorateMsvcName
+struct FallbackSample {
+    const char*  decorated;
+    DemangleMode  mode;
+    const char*  part;      // a part of the DbgHelp result
+};
+
+const FallbackSample  fallbackSamples[] = {
+    { "??_R0?AVFoo@@@8", DemangleNameOnly, "RTTI Type Descriptor" },
+    { "??_R1A@?0A@EA@Foo@@8", DemangleNameOnly, "RTTI Base Class Descriptor" },
+    { "??_R2Foo@@8", DemangleNameOnly, "RTTI Base Class Array" },
+    { "??_R3Foo@@8", DemangleNameOnly, "RTTI Class Hierarchy Descriptor" },
+    { "??_R4Foo@@6B@", DemangleNameOnly, "RTTI Complete Object Locator" },
+    { "??_C@_05CJBACGMB@hello?$AA@", DemangleNameOnly, "`string'" },
+    { "?x@?1??f@@YAXXZ@4HA", DemangleNameOnly, "::x" },
+    { "??__EFoo@@YAXXZ", DemangleNameOnly, "dynamic initializer" },
+    { "?bar@Foo@@W3AEXXZ", DemangleFull, "adjustor{4}" },
+    { "??_9Foo@@$BA@AE", DemangleFull, "vcall" },
+    { "?f@@YAXP8Foo@@AEXXZ@Z", DemangleFull, "Foo::*" },
+};
+
+} // end nameless namespace
+
+TEST(DemangleTest, NameOnly)
+{
+    MsvcDemangler  demangler;
+    std::string  result;
+
+    for (const auto& sample : demangleSamples)
+    {
+        EXPECT_TRUE(demangler.demangle(sample.decorated, result, DemangleNameOnly)) << sample.decorated;
+        EXPECT_EQ(sample.nameOnly, result);
+    }
+}
+
+TEST(DemangleTest, Full)
+{
+    MsvcDemangler  demangler;
+    std::string  result;
+
+    for (const auto& sample : demangleSamples)
+    {
+        EXPECT_TRUE(demangler.demangle(sample.decorated, result, DemangleFull)) << sample.decorated;
+        EXPECT_EQ(sample.full, result);
+    }
+}
+
+TEST(DemangleTest, NotDecorated)
+{
+    MsvcDemangler  demangler;
+    std::string  result;
+
+    EXPECT_FALSE(demangler.demangle("NtCreateFile", result));
+    EXPECT_FALSE(demangler.demangle("_func@8", result));
+    EXPECT_FALSE(demangler.demangle("?broken@@YAH", result, DemangleFull));
+    EXPECT_FALSE(demangler.demangle("??_R0?AVFoo@@@8", result));
+
+    EXPECT_EQ("_func@8", demangleMsvcName("_func@8"));
+    EXPECT_EQ("Foo::bar", demangleMsvcName("?bar@Foo@@QAEXPBD@Z"));
+
+    EXPECT_FALSE(undecorateMsvcName("NtCreateFile", result));
+}
+
+TEST(DemangleTest, Fallback)
+{
+    MsvcDemangler  demangler;
+    std::string  result;
+
+    for (const auto& sample : fallbackSamples)
+    {
+        EXPECT_FALSE(demangler.demangle(sample.decorated, result, sample.mode)) << sample.decorated;
+
+        EXPECT_TRUE(undecorateMsvcName(sample.decorated, result, sample.mode)) << sample.decorated;
+        EXPECT_NE(std::string::npos, result.find(sample.part)) << result;
+
+        EXPECT_EQ(result, demangleMsvcName(sample.decorated, sample.mode));
+    }
+}
+
+TEST(DemangleTest, DeepNesting)
+{
+    MsvcDemangler  demangler;
+    std::string  result;
+
+    // "int * * ... *" and "A<A<...<int> > >": the nesting fails the demangling, not the stack
+    std::string  pointers = "?p@@3";
+    for (size_t i = 0; i < 1000; ++i)
+        pointers += "PA";
+    pointers += "HA";
+    EXPECT_FALSE(demangler.demangle(pointers, result, DemangleFull));
+
+    std::string  templates = "?t@@3";
+    for (size_t i = 0; i < 400; ++i)
+        templates += "V?$A@";
+    templates += "H";
+    for (size_t i = 0; i < 400; ++i)
+        templates += "@@";
+    templates += "A";
+    EXPECT_FALSE(demangler.demangle(templates, result, DemangleFull));
+
+    std::string  functions = "?f@@3";
+    for (size_t i = 0; i < 1000; ++i)
+        functions += "P6A";
+    functions += "XXZA";
+    EXPECT_FALSE(demangler.demangle(functions, result, DemangleFull));
+
+    EXPECT_FALSE(demangler.demangle("?bar@Foo@@QAEXPBD@Z" + std::string(0x1000, 'X'), result));
+
+    // the demangler is still usable and the moderate nesting is demangled
+    EXPECT_TRUE(demangler.demangle("?p@@3PAPAPAHA", result, DemangleFull));
+    EXPECT_EQ("int * * * p", result);
+}
+
+TEST(DemangleTest, Benchmark)
+{
+    const size_t  passCount = 10000;
+
+    MsvcDemangler  demangler;
+    std::string  result;
+
+    auto  start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < passCount; ++i)
+        for (const auto& sample : demangleSamples)
+            demangler.demangle(sample.decorated, result, DemangleNameOnly);
+    std::chrono::duration<double>  nameOnlyTime = std::chrono::high_resolution_clock::now() - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < passCount; ++i)
+        for (const auto& sample : demangleSamples)
+            demangler.demangle(sample.decorated, result, DemangleFull);
+    std::chrono::duration<double>  fullTime = std::chrono::high_resolution_clock::now() - start;
+
+    // the export directory path: the fast demangler, DbgHelp for the names it rejects
+    start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < passCount; ++i)
+        for (const auto& sample : fallbackSamples)
+            if (!demangler.demangle(sample.decorated, result, DemangleNameOnly))
+                undecorateMsvcName(sample.decorated, result, DemangleNameOnly);
+    std::chrono::duration<double>  fallbackTime = std::chrono::high_resolution_clock::now() - start;
+
+    const size_t  nameCount = passCount * _countof(demangleSamples);
+    const size_t  fallbackCount = passCount * _countof(fallbackSamples);
+
+    RecordProperty("nameOnlyPerSecond", static_cast<int>(nameCount / nameOnlyTime.count()));
+    RecordProperty("fullPerSecond", static_cast<int>(nameCount / fullTime.count()));
+    RecordProperty("fallbackPerSecond", static_cast<int>(fallbackCount / fallbackTime.count()));
+}
@@ -33,3 +33,30 @@ TEST_F(DisasmTest, disasm)
         dasm.disassemble();
     }
 }
+
+TEST_F(DisasmTest, decodeRange)
+{
+    Disasm   dasm;
+
+    std::vector<MEMOFFSET_64>  offsets;
+    std::vector<size_t>  lengths;
+
+    for (int i = 0; i < 100; ++i)
+    {
+        offsets.push_back(dasm.current());
+        lengths.push_back(dasm.length());
+        dasm.disassemble();
+    }
+
+    std::vector<X86Instruction>  instructions;
+    ASSERT_NO_THROW(decodeRange(offsets.front(), dasm.current(), instructions));
+
+    ASSERT_EQ(offsets.size(), instructions.size());
+
+    for (size_t i = 0; i < instructions.size(); ++i)
+    {
+        EXPECT_EQ(offsets[i], instructions[i].offset);
+        EXPECT_EQ(lengths[i], instructions[i].length);
+        EXPECT_NE(X86Invalid, instructions[i].mnemonic);
+    }
+}
@@ -7,6 +7,11 @@
 class EventHandlerMock : public kdlib::EventHandler 
 {
 public:
+
+    explicit EventHandlerMock(unsigned long eventsMask = kdlib::DebugEventAll) :
+        kdlib::EventHandler(eventsMask)
+    {}
+
     MOCK_METHOD1( onBreakpoint, kdlib::DebugCallbackResult ( kdlib::BREAKPOINT_ID bpId ) );
     MOCK_METHOD1( onException, kdlib::DebugCallbackResult ( kdlib::ExceptionInfo &exceptionInfo ) );
     MOCK_METHOD1( onExecutionStatusChange, void ( kdlib::ExecutionStatus executionStatus ) );
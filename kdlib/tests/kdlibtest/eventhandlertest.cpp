@@ -1,5 +1,12 @@
 #include <stdafx.h>
 
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+
 #include "basefixture.h"
 #include "eventhandlermock.h"
 #include "kdlib\dbgio.h"
@@ -34,6 +41,82 @@ private:
     std::wstring  m_symPath;
 };
 
+namespace {
+
+boost::atomic<int>  lateOutputCalls(0);
+
+// detach is the removing done by a destructor, the object itself stays valid to catch a late call
+class DetachedHandler : public EventHandler
+{
+public:
+
+    DetachedHandler() :
+        EventHandler(DebugEventOutput),
+        m_attached(true)
+    {}
+
+    void detach() {
+        removeEventsCallback(this);
+        m_attached = false;
+    }
+
+    virtual void onDebugOutput(const std::wstring& text, OutputFlag flag) {
+        if (!m_attached)
+            lateOutputCalls++;
+    }
+
+private:
+
+    boost::atomic<bool>  m_attached;
+};
+
+// the second call removes the handler while the first one still runs on the other thread:
+// the remove waits for the first call only
+class SelfRemovingHandler : public EventHandler
+{
+public:
+
+    SelfRemovingHandler() :
+        EventHandler(DebugEventOutput),
+        m_calls(0),
+        m_removing(false),
+        m_removed(false)
+    {}
+
+    virtual void onDebugOutput(const std::wstring& text, OutputFlag flag) {
+
+        if (text.find(L"selfremove") == std::wstring::npos)
+            return;
+
+        if (m_calls++ == 0)
+        {
+            // the engine may serialize the output: the wait is bounded
+            auto  deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+            while (!m_removing && std::chrono::steady_clock::now() < deadline)
+                boost::this_thread::sleep_for(boost::chrono::milliseconds(1));
+
+            boost::this_thread::sleep_for(boost::chrono::milliseconds(50));
+            return;
+        }
+
+        m_removing = true;
+        removeEventsCallback(this);
+        m_removed = true;
+    }
+
+    bool isRemoved() const {
+        return m_removed;
+    }
+
+private:
+
+    boost::atomic<int>  m_calls;
+    boost::atomic<bool>  m_removing;
+    boost::atomic<bool>  m_removed;
+};
+
+} // end nameless namespace
+
 
 TEST_F(EventHandlerTest, KillProcessTargetChanged)
 {
@@ -223,3 +306,104 @@ TEST_F(EventHandlerTest, DebugOutput)
     kdlib::debugCommand(L".printf /ov \"verbose\"");
     kdlib::debugCommand(L".printf /ow \"warning\"");
 }
+
+TEST_F(EventHandlerTest, EventsMask)
+{
+    ASSERT_NO_THROW(startProcess(L"targetapp.exe"));
+
+    StrictMock<EventHandlerMock>  outputHandler(DebugEventOutput);
+    StrictMock<EventHandlerMock>  statusHandler(DebugEventExecutionStatus | DebugEventLocalScope);
+
+    EXPECT_CALL(outputHandler, onDebugOutput(_, _)).Times(AtLeast(1));
+
+    EXPECT_NO_THROW( debugCommand(L".printf \"events mask\"") );
+}
+
+TEST_F(EventHandlerTest, DispatchBenchmark)
+{
+    ASSERT_NO_THROW(startProcess(L"targetapp.exe"));
+
+    // a lot of subscribers that are not interested in the output
+    std::vector< std::unique_ptr< StrictMock<EventHandlerMock> > >  handlers;
+    for (int i = 0; i < 100; ++i)
+        handlers.emplace_back(new StrictMock<EventHandlerMock>(DebugEventProcessExit | DebugEventModuleLoad));
+
+    NiceMock<EventHandlerMock>  outputHandler(DebugEventOutput);
+
+    size_t  outputCount = 0;
+    EXPECT_CALL(outputHandler, onDebugOutput(_, _)).WillRepeatedly(InvokeWithoutArgs([&outputCount]() { ++outputCount; }));
+
+    auto  start = std::chrono::high_resolution_clock::now();
+    EXPECT_NO_THROW( debugCommand(L".for (r $t0 = 0; @$t0 < 0n1000; r $t0 = @$t0 + 1) { .printf \"event\\n\" }") );
+    std::chrono::duration<double>  dispatchTime = std::chrono::high_resolution_clock::now() - start;
+
+    EXPECT_LE(1000, outputCount);
+
+    RecordProperty("outputEventsPerSecond", static_cast<int>(outputCount / dispatchTime.count()));
+}
+
+TEST_F(EventHandlerTest, RemoveInDispatch)
+{
+    ASSERT_NO_THROW(startProcess(L"targetapp.exe"));
+
+    std::unique_ptr< NiceMock<EventHandlerMock> >  removed;
+
+    NiceMock<EventHandlerMock>  remover(DebugEventOutput);
+    removed.reset(new NiceMock<EventHandlerMock>(DebugEventOutput));
+    NiceMock<EventHandlerMock>  self(DebugEventOutput);
+
+    // the snapshot of the dispatch still has the removed handler: it must be skipped
+    EXPECT_CALL(*removed, onDebugOutput(_, _)).Times(0);
+    EXPECT_CALL(remover, onDebugOutput(_, _)).WillRepeatedly(InvokeWithoutArgs([&removed]() { removed.reset(); }));
+    EXPECT_CALL(self, onDebugOutput(_, _)).Times(1).WillOnce(InvokeWithoutArgs([&self]() { removeEventsCallback(&self); }));
+
+    EXPECT_NO_THROW( debugCommand(L".printf \"remove\\n\"") );
+    EXPECT_NO_THROW( debugCommand(L".printf \"remove\\n\"") );
+}
+
+TEST_F(EventHandlerTest, RemoveFromOtherThread)
+{
+    ASSERT_NO_THROW(startProcess(L"targetapp.exe"));
+
+    lateOutputCalls = 0;
+
+    boost::atomic<bool>  stop(false);
+
+    // the handlers are registered and removed while the output is dispatched, so the dispatch
+    // runs over the snapshots taken before the other registrations
+    boost::thread  churn([&stop]() {
+        std::vector< std::unique_ptr<DetachedHandler> >  handlers;
+        while (!stop)
+        {
+            if (handlers.size() >= 0x400)
+                handlers.clear();
+
+            for (int i = 0; i < 4; ++i)
+                handlers.emplace_back(new DetachedHandler());
+            for (auto it = handlers.end() - 4; it != handlers.end(); ++it)
+                (*it)->detach();
+        }
+    });
+
+    EXPECT_NO_THROW( debugCommand(L".for (r $t0 = 0; @$t0 < 0n1000; r $t0 = @$t0 + 1) { .printf \"event\\n\" }") );
+
+    stop = true;
+    churn.join();
+
+    EXPECT_EQ(0, lateOutputCalls);
+}
+
+TEST_F(EventHandlerTest, SelfRemoveTwoThreads)
+{
+    ASSERT_NO_THROW(startProcess(L"targetapp.exe"));
+
+    SelfRemovingHandler  handler;
+
+    boost::thread  thread1([]() { dprintln(L"selfremove"); });
+    boost::thread  thread2([]() { dprintln(L"selfremove"); });
+
+    thread1.join();
+    thread2.join();
+
+    EXPECT_TRUE(handler.isRemoved());
+}
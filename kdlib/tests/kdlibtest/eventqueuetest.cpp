@@ -0,0 +1,231 @@
+#include <stdafx.h>
+
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "gtest/gtest.h"
+
+#include "kdlib/eventqueue.h"
+
+using namespace kdlib;
+
+namespace {
+
+class RecordingCallback : public DebugEventsCallback
+{
+public:
+
+    RecordingCallback() :
+        m_blocked(false),
+        m_entered(false)
+    {}
+
+    virtual DebugCallbackResult onBreakpoint( BREAKPOINT_ID bpId ) {
+        m_breakpoints.push_back(bpId);
+        return DebugCallbackBreak;
+    }
+
+    virtual DebugCallbackResult onException( const ExceptionInfo &exceptionInfo ) {
+        return DebugCallbackNoChange;
+    }
+
+    virtual void onExecutionStatusChange( ExecutionStatus executionStatus )
+    {}
+
+    virtual DebugCallbackResult onModuleLoad( MEMOFFSET_64 offset, const std::wstring &name ) {
+        wait();
+        m_modules.push_back(offset);
+        m_names.push_back(name);
+        return DebugCallbackBreak;
+    }
+
+    virtual DebugCallbackResult onModuleUnload( MEMOFFSET_64 offset, const std::wstring &name ) {
+        return DebugCallbackNoChange;
+    }
+
+    virtual DebugCallbackResult onProcessStart(PROCESS_DEBUG_ID processid) {
+        return DebugCallbackNoChange;
+    }
+
+    virtual DebugCallbackResult onProcessExit( PROCESS_DEBUG_ID processid, ProcessExitReason  reason, unsigned long exitCode ) {
+        return DebugCallbackNoChange;
+    }
+
+    virtual DebugCallbackResult onThreadStart() {
+        return DebugCallbackNoChange;
+    }
+
+    virtual DebugCallbackResult onThreadStop() {
+        return DebugCallbackNoChange;
+    }
+
+    virtual void onCurrentThreadChange(THREAD_DEBUG_ID threadid)
+    {}
+
+    virtual void onChangeLocalScope()
+    {}
+
+    virtual void onChangeSymbolPaths()
+    {}
+
+    virtual void onChangeBreakpoints()
+    {}
+
+    virtual void onDebugOutput(const std::wstring& text, OutputFlag flag) {
+        m_output += text;
+    }
+
+    virtual void onStartInput()
+    {}
+
+    virtual void onStopInput()
+    {}
+
+    // the consumer thread stops in the next onModuleLoad until release
+    void block() {
+        m_blocked = true;
+    }
+
+    void release() {
+        m_blocked = false;
+    }
+
+    bool entered() const {
+        return m_entered;
+    }
+
+    std::vector<MEMOFFSET_64>  m_modules;
+    std::vector<std::wstring>  m_names;
+    std::vector<BREAKPOINT_ID>  m_breakpoints;
+    std::wstring  m_output;
+
+private:
+
+    void wait() {
+        while (m_blocked)
+        {
+            m_entered = true;
+            boost::this_thread::yield();
+        }
+    }
+
+    boost::atomic<bool>  m_blocked;
+    boost::atomic<bool>  m_entered;
+};
+
+class ThrowingCallback : public RecordingCallback
+{
+public:
+
+    virtual void onDebugOutput(const std::wstring& text, OutputFlag flag) {
+        throw 1;
+    }
+};
+
+} // end nameless namespace
+
+TEST(EventQueueTest, Deliver)
+{
+    RecordingCallback  callback;
+
+    {
+        AsyncEventsCallback  asyncCallback(&callback, 0x100, EventQueueWait);
+
+        for (size_t i = 0; i < 1000; ++i)
+            EXPECT_EQ(DebugCallbackNoChange, asyncCallback.onModuleLoad(0x10000 * i, L"module"));
+
+        asyncCallback.onDebugOutput(L"output", OutputFlag::Normal);
+
+        asyncCallback.flush();
+
+        EventQueueStatistics  statistics = asyncCallback.getStatistics();
+        EXPECT_EQ(0x100, statistics.capacity);
+        EXPECT_EQ(1001, statistics.queued);
+        EXPECT_EQ(1001, statistics.delivered);
+        EXPECT_EQ(0, statistics.depth);
+        EXPECT_LE(statistics.maxDepth, 2 * statistics.capacity);
+        EXPECT_LE(1, statistics.batches);
+    }
+
+    ASSERT_EQ(1000, callback.m_modules.size());
+    for (size_t i = 0; i < callback.m_modules.size(); ++i)
+        EXPECT_EQ(0x10000 * i, callback.m_modules[i]);
+
+    EXPECT_EQ(L"module", callback.m_names.back());
+    EXPECT_EQ(L"output", callback.m_output);
+}
+
+TEST(EventQueueTest, Drop)
+{
+    RecordingCallback  callback;
+    AsyncEventsCallback  asyncCallback(&callback, 16, EventQueueDrop);
+
+    callback.block();
+    asyncCallback.onModuleLoad(0, L"first");
+
+    while (!callback.entered())
+        boost::this_thread::yield();
+
+    for (size_t i = 1; i <= 100; ++i)
+        asyncCallback.onModuleLoad(i, L"module");
+
+    EventQueueStatistics  statistics = asyncCallback.getStatistics();
+    EXPECT_EQ(84, statistics.dropped);
+    EXPECT_EQ(17, statistics.maxDepth);
+
+    callback.release();
+    asyncCallback.flush();
+
+    statistics = asyncCallback.getStatistics();
+    EXPECT_EQ(17, statistics.delivered);
+    EXPECT_EQ(17, callback.m_modules.size());
+}
+
+TEST(EventQueueTest, Wait)
+{
+    RecordingCallback  callback;
+
+    {
+        AsyncEventsCallback  asyncCallback(&callback, 4, EventQueueWait);
+
+        for (size_t i = 0; i < 10000; ++i)
+            asyncCallback.onModuleLoad(i, L"module");
+
+        asyncCallback.flush();
+
+        EventQueueStatistics  statistics = asyncCallback.getStatistics();
+        EXPECT_EQ(0, statistics.dropped);
+        EXPECT_EQ(10000, statistics.delivered);
+        EXPECT_LE(statistics.maxDepth, 2 * statistics.capacity);
+    }
+
+    ASSERT_EQ(10000, callback.m_modules.size());
+    EXPECT_EQ(9999, callback.m_modules.back());
+}
+
+TEST(EventQueueTest, NonStdException)
+{
+    ThrowingCallback  callback;
+    AsyncEventsCallback  asyncCallback(&callback);
+
+    asyncCallback.onDebugOutput(L"text", OutputFlag::Normal);
+    asyncCallback.onModuleLoad(1, L"module");
+    asyncCallback.flush();
+
+    EXPECT_EQ(2, asyncCallback.getStatistics().delivered);
+    EXPECT_EQ(1, callback.m_modules.size());
+}
+
+TEST(EventQueueTest, SyncEvents)
+{
+    RecordingCallback  callback;
+    AsyncEventsCallback  asyncCallback(&callback);
+
+    EXPECT_EQ(DebugCallbackBreak, asyncCallback.onBreakpoint(10));
+    ASSERT_EQ(1, callback.m_breakpoints.size());
+    EXPECT_EQ(10, callback.m_breakpoints[0]);
+
+    EXPECT_EQ(0, asyncCallback.getStatistics().queued);
+}
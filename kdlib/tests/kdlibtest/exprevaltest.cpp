@@ -1,5 +1,7 @@
 ﻿#include <stdafx.h>
 
+#include <chrono>
+
 #include "gtest/gtest.h"
 #include "kdlib/kdlib.h"
 
@@ -450,3 +452,78 @@ TEST_F(ExprEvalTarget, MultiArray)
     EXPECT_EQ(intMatrix[1][2], evalExpr(L"intMatrix[1][2]", m_targetModule->getScope()));
     EXPECT_EQ(intMatrix[0][1], evalExpr(L"intMatrix[0][1]", m_targetModule->getScope()));
 }
+
+TEST(CompiledExpr, Eval)
+{
+    EXPECT_EQ(2 + 2 * 2, compileExpr(L"2 + 2 * 2")->eval());
+    EXPECT_EQ(5 - 5 * 5 + 5, compileExpr(L"5 - 5 * 5  + 5")->eval());
+    EXPECT_EQ(2 > 3 ? 2 : 3 + 2, compileExpr("2 > 3 ? 2 : 3 + 2")->eval());
+    EXPECT_EQ(sizeof(int*[10]), compileExpr("sizeof(int*[10])")->eval());
+    EXPECT_EQ((int*)10 + 1, compileExpr("(int*)10 + 1")->eval());
+
+    EXPECT_THROW(compileExpr(L"5 */ 5"), DbgException);
+    EXPECT_THROW(compileExpr(L"(((("), DbgException);
+    EXPECT_THROW(compileExpr(L"0 ? : 5"), DbgException);
+}
+
+TEST(CompiledExpr, ScopeVar)
+{
+    auto  expr = compileExpr(L"a * b + arr[i]");
+
+    for (long i = 0; i < 4; ++i)
+    {
+        TypedValue  a = i * 10;
+        TypedValue  b = -20;
+        TypedValue  arr = makeArrayValue<long>({ 100, 200, 400, 500 });
+        long  arrOrig[] = { 100, 200, 400, 500 };
+
+        auto scope = makeScope({ { L"a", a },{ L"b", b },{ L"arr", arr },{ L"i", i } });
+
+        EXPECT_EQ(i * 10 * -20 + arrOrig[i], expr->eval(scope));
+    }
+
+    EXPECT_THROW(expr->eval(makeScope({ { L"a", TypedValue(1) } })), DbgException);
+}
+
+TEST(CompiledExpr, CastScopeVar)
+{
+    auto  expr = compileExpr(L"(char)a + (unsigned short)-b");
+
+    for (long i = 0; i < 4; ++i)
+    {
+        TypedValue  a = 0x100 + i;
+        TypedValue  b = i;
+
+        auto scope = makeScope({ { L"a", a },{ L"b", b } });
+
+        EXPECT_EQ((char)(0x100 + i) + (unsigned short)-i, expr->eval(scope));
+    }
+
+    EXPECT_THROW(expr->eval(), DbgException);
+}
+
+TEST(CompiledExpr, Benchmark)
+{
+    const size_t  evalCount = 10000;
+    const std::wstring  exprStr = L"(a + 10) * b > 100 ? a : b";
+
+    TypedValue   a = 10;
+    TypedValue   b = -20;
+    auto  scope = makeScope({ { L"a", a },{ L"b", b } });
+
+    auto  start = std::chrono::high_resolution_clock::now();
+    for (size_t i = 0; i < evalCount; ++i)
+        evalExpr(exprStr, scope);
+    std::chrono::duration<double>  evalExprTime = std::chrono::high_resolution_clock::now() - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    auto  compiledExpr = compileExpr(exprStr);
+    for (size_t i = 0; i < evalCount; ++i)
+        compiledExpr->eval(scope);
+    std::chrono::duration<double>  compiledExprTime = std::chrono::high_resolution_clock::now() - start;
+
+    EXPECT_EQ(evalExpr(exprStr, scope), compiledExpr->eval(scope));
+
+    RecordProperty("evalExprPerSecond", static_cast<int>(evalCount / evalExprTime.count()));
+    RecordProperty("compiledExprPerSecond", static_cast<int>(evalCount / compiledExprTime.count()));
+}
@@ -0,0 +1,222 @@
+#include <stdafx.h>
+
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "gtest/gtest.h"
+
+#include "kdlib/heap.h"
+#include "kdlib/typeinfo.h"
+
+using namespace kdlib;
+
+namespace {
+
+class MockHeapSource : public HeapObjectSource
+{
+public:
+
+    MockHeapSource(const std::vector<HeapObject>& objects, size_t& readCount) :
+        m_objects(objects),
+        m_pos(0),
+        m_readCount(readCount)
+    {}
+
+    virtual size_t read(HeapObject* objects, size_t maxCount)
+    {
+        ++m_readCount;
+
+        size_t  count = std::min(maxCount, m_objects.size() - m_pos);
+        std::copy(m_objects.begin() + m_pos, m_objects.begin() + m_pos + count, objects);
+        m_pos += count;
+
+        return count;
+    }
+
+private:
+
+    const std::vector<HeapObject>&  m_objects;
+    size_t  m_pos;
+    size_t&  m_readCount;
+};
+
+} // end nameless namespace
+
+class HeapEnumTest : public ::testing::Test
+{
+protected:
+
+    // 1000 objects of three types: the type resolver must be called once per type
+    virtual void SetUp()
+    {
+        m_typeNames[1] = L"managedapp.Class1";
+        m_typeNames[2] = L"managedapp.Class2";
+        m_typeNames[3] = L"System.String";
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            HeapObject  heapObject = { 0x10000 + i * 0x20, 0x10 + (i % 4) * 0x8, { i % 3 + 1, 0 } };
+            m_objects.push_back(heapObject);
+        }
+
+        m_resolveCount = 0;
+        m_readCount = 0;
+
+        m_typeCache = boost::make_shared<HeapTypeCache>([this](const HeapTypeId& typeId) {
+            ++m_resolveCount;
+            return defineStruct(m_typeNames[typeId.token1]);
+        });
+    }
+
+    HeapObjectSourceFactory getSourceFactory()
+    {
+        return [this]() { return HeapObjectSourcePtr(new MockHeapSource(m_objects, m_readCount)); };
+    }
+
+    std::map<unsigned long long, std::wstring>  m_typeNames;
+    std::vector<HeapObject>  m_objects;
+    HeapTypeCachePtr  m_typeCache;
+    size_t  m_resolveCount;
+    size_t  m_readCount;
+};
+
+TEST_F(HeapEnumTest, Enum)
+{
+    HeapObjectEnum  heapEnum(getSourceFactory(), m_typeCache, L"managedapp*");
+
+    MEMOFFSET_64  address;
+    std::wstring  typeName;
+    size_t  size;
+    size_t  count = 0;
+
+    while (heapEnum.next(address, typeName, size))
+    {
+        EXPECT_NE(L"System.String", typeName);
+        ++count;
+    }
+
+    EXPECT_EQ(667, count);
+    EXPECT_EQ(3, m_resolveCount);
+}
+
+TEST_F(HeapEnumTest, Count)
+{
+    EXPECT_EQ(1000, HeapObjectEnum(getSourceFactory(), m_typeCache).getCount());
+    EXPECT_EQ(0, m_resolveCount);
+
+    EXPECT_EQ(333, HeapObjectEnum(getSourceFactory(), m_typeCache, L"System.String").getCount());
+    EXPECT_EQ(250, HeapObjectEnum(getSourceFactory(), m_typeCache, L"", 0x28).getCount());
+    EXPECT_EQ(500, HeapObjectEnum(getSourceFactory(), m_typeCache, L"", 0x18, 0x20).getCount());
+    EXPECT_EQ(3, m_resolveCount);
+}
+
+TEST_F(HeapEnumTest, SharedCache)
+{
+    EXPECT_EQ(334, HeapObjectEnum(getSourceFactory(), m_typeCache, L"*Class1").getCount());
+    EXPECT_EQ(333, HeapObjectEnum(getSourceFactory(), m_typeCache, L"*Class2").getCount());
+
+    EXPECT_EQ(3, m_resolveCount);
+    EXPECT_EQ(3, m_typeCache->getSize());
+
+    HeapTypeId  typeId = { 3, 0 };
+    EXPECT_EQ(L"System.String", m_typeCache->getTypeName(typeId));
+    EXPECT_EQ(L"System.String", m_typeCache->getType(typeId)->getName());
+
+    m_typeCache->clear();
+    EXPECT_EQ(0, m_typeCache->getSize());
+
+    EXPECT_EQ(L"System.String", m_typeCache->getTypeName(typeId));
+    EXPECT_EQ(4, m_resolveCount);
+}
+
+TEST_F(HeapEnumTest, Batch)
+{
+    HeapObjectEnum  heapEnum(getSourceFactory(), m_typeCache, L"", 0x28, -1, 100);
+
+    std::vector<HeapObject>  heapObjects;
+    size_t  count = 0;
+
+    while (heapEnum.nextBatch(heapObjects))
+    {
+        EXPECT_FALSE(heapObjects.empty());
+        EXPECT_GE(100, heapObjects.size());
+
+        for (const auto& heapObject : heapObjects)
+            EXPECT_EQ(0x28, heapObject.size);
+
+        count += heapObjects.size();
+    }
+
+    EXPECT_EQ(250, count);
+    EXPECT_TRUE(heapObjects.empty());
+    EXPECT_EQ(11, m_readCount);
+
+    // only the size filter: no type is resolved
+    EXPECT_EQ(0, m_resolveCount);
+}
+
+TEST_F(HeapEnumTest, BatchAfterNext)
+{
+    HeapObjectEnum  heapEnum(getSourceFactory(), m_typeCache, L"*Class2", 0, -1, 300);
+
+    MEMOFFSET_64  address;
+    std::wstring  typeName;
+    size_t  size;
+
+    ASSERT_TRUE(heapEnum.next(address, typeName, size));
+    EXPECT_EQ(m_objects[1].address, address);
+    EXPECT_EQ(L"managedapp.Class2", typeName);
+
+    std::vector<HeapObject>  heapObjects;
+    size_t  count = 1;
+
+    while (heapEnum.nextBatch(heapObjects))
+    {
+        if (count == 1)
+            EXPECT_EQ(m_objects[4].address, heapObjects.front().address);
+        count += heapObjects.size();
+    }
+
+    EXPECT_EQ(333, count);
+    EXPECT_FALSE(heapEnum.next(address, typeName, size));
+}
+
+TEST_F(HeapEnumTest, Statistics)
+{
+    HeapStatistics  statistics = getHeapStatistics(getSourceFactory()(), m_typeCache);
+
+    EXPECT_EQ(3, m_resolveCount);
+    EXPECT_GE(2, m_readCount);
+
+    ASSERT_EQ(3, statistics.size());
+
+    // sorted by the total size
+    EXPECT_EQ(L"managedapp.Class2", statistics[0].typeName);
+    EXPECT_EQ(333, statistics[0].count);
+    EXPECT_EQ(L"managedapp.Class1", statistics[2].typeName);
+    EXPECT_EQ(334, statistics[2].count);
+
+    unsigned long long  totalSize = 0;
+    for (const auto& heapObject : m_objects)
+        totalSize += heapObject.size;
+
+    unsigned long long  statSize = 0;
+    for (const auto& typeStat : statistics)
+        statSize += typeStat.totalSize;
+
+    EXPECT_EQ(totalSize, statSize);
+}
+
+TEST_F(HeapEnumTest, StatisticsFilter)
+{
+    HeapStatistics  statistics = getHeapStatistics(getSourceFactory()(), m_typeCache, L"managedapp.*", 0x28);
+
+    ASSERT_EQ(2, statistics.size());
+
+    for (const auto& typeStat : statistics)
+    {
+        EXPECT_NE(std::wstring::npos, typeStat.typeName.find(L"managedapp."));
+        EXPECT_EQ(typeStat.count * 0x28, typeStat.totalSize);
+    }
+}
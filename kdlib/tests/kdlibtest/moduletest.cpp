@@ -155,6 +155,22 @@ TEST_F( ModuleTest, getSourceLine )
     //EXPECT_EQ( 0, displacement );
 }
 
+TEST_F( ModuleTest, getCodeIndex )
+{
+    CodeIndexPtr  codeIndex;
+    ASSERT_NO_THROW( codeIndex = m_targetModule->getCodeIndex() );
+
+    EXPECT_EQ( m_targetModule->getTimeDataStamp(), codeIndex->getTimeDataStamp() );
+    EXPECT_EQ( codeIndex, m_targetModule->getCodeIndex() );
+
+    MEMOFFSET_32  funcRva = m_targetModule->getSymbolRva(L"CdeclFunc");
+
+    const CodeFunction*  function = codeIndex->findFunction( funcRva + 2 );
+    ASSERT_TRUE( function != 0 );
+    EXPECT_EQ( funcRva, function->rva );
+    EXPECT_NE( 0, function->sources & CodeFromSymbol );
+    EXPECT_FALSE( codeIndex->getRefsTo( funcRva ).empty() );
+}
 
 TEST_F( ModuleTest, getFunction )
 {
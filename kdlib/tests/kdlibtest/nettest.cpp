@@ -41,6 +41,42 @@ TYPED_TEST(NetTest, NetHeap)
     EXPECT_TRUE( heapEnum->next(address, typeName, size) );
 }
 
+TYPED_TEST(NetTest, NetHeapBatch)
+{
+    kdlib::TargetHeapPtr  targetHeap;
+    ASSERT_NO_THROW(targetHeap = TargetProcess::getCurrent()->getManagedHeap());
+
+    kdlib::TargetHeapEnumPtr  heapEnum;
+    ASSERT_NO_THROW(heapEnum = targetHeap->getEnum(L"managedapp*"));
+
+    std::vector<kdlib::HeapObject>  heapObjects;
+    size_t  count = 0;
+
+    while (heapEnum->nextBatch(heapObjects))
+        count += heapObjects.size();
+
+    EXPECT_EQ(targetHeap->getCount(L"managedapp*"), count);
+}
+
+TYPED_TEST(NetTest, NetHeapStatistics)
+{
+    kdlib::TargetHeapPtr  targetHeap;
+    ASSERT_NO_THROW(targetHeap = TargetProcess::getCurrent()->getManagedHeap());
+
+    kdlib::HeapStatistics  statistics;
+    ASSERT_NO_THROW(statistics = targetHeap->getStatistics(L"managedapp*"));
+    ASSERT_FALSE(statistics.empty());
+
+    size_t  count = 0;
+    for (const auto& typeStat : statistics)
+    {
+        EXPECT_EQ(0, typeStat.typeName.find(L"managedapp"));
+        count += typeStat.count;
+    }
+
+    EXPECT_EQ(targetHeap->getCount(L"managedapp*"), count);
+}
+
 TYPED_TEST(NetTest, NetModuleEnumTypes)
 {
     auto types = m_targetModule->enumTypes();
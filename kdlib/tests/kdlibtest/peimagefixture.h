@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+// a hand-built PE32+ image for the PE parsing tests: the fixture fills the headers,
+// the test puts the sections data
+class PEImageFixture : public ::testing::Test
+{
+protected:
+
+    static const size_t  ntHeader = 0x80;
+    static const size_t  optHeader = ntHeader + 24;
+    static const size_t  sectionTable = optHeader + 240;
+
+    // DOS and NT headers of an AMD64 image with 16 data directories
+    void buildHeaders(size_t imageSize, unsigned short sectionCount)
+    {
+        m_image.assign(imageSize, 0);
+
+        m_image[0] = 'M';
+        m_image[1] = 'Z';
+        put<unsigned int>(0x3C, ntHeader);
+
+        m_image[ntHeader] = 'P';
+        m_image[ntHeader + 1] = 'E';
+        put<unsigned short>(ntHeader + 4, 0x8664);         // machine
+        put<unsigned short>(ntHeader + 6, sectionCount);
+        put<unsigned short>(ntHeader + 20, 240);           // optional header size
+
+        put<unsigned short>(optHeader, 0x20B);
+        put<unsigned int>(optHeader + 108, 16);            // data directory count
+    }
+
+    void setDataDirectory(size_t index, unsigned int rva, unsigned int size)
+    {
+        put<unsigned int>(optHeader + 112 + index * 8, rva);
+        put<unsigned int>(optHeader + 116 + index * 8, size);
+    }
+
+    void setSection(size_t index, const char* name, unsigned int virtualSize, unsigned int rva,
+        unsigned int rawSize, unsigned int rawOffset, unsigned int characteristics)
+    {
+        const size_t  section = sectionTable + index * 40;
+
+        memcpy(&m_image[section], name, strlen(name));
+        put<unsigned int>(section + 8, virtualSize);
+        put<unsigned int>(section + 12, rva);
+        put<unsigned int>(section + 16, rawSize);
+        put<unsigned int>(section + 20, rawOffset);
+        put<unsigned int>(section + 36, characteristics);
+    }
+
+    template<typename T>
+    void put(size_t offset, T value)
+    {
+        memcpy(&m_image[offset], &value, sizeof(value));
+    }
+
+    std::vector<unsigned char>  m_image;
+};
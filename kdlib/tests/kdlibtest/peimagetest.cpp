@@ -0,0 +1,142 @@
+#include <stdafx.h>
+
+#include <cstring>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+#include "kdlib/peimage.h"
+#include "kdlib/exceptions.h"
+
+#include "peimagefixture.h"
+
+using namespace kdlib;
+
+class PEImageTest : public PEImageFixture
+{
+protected:
+
+    // a minimal PE32+ file: headers in the first 0x400 bytes and one section
+    // ( rva 0x1000, raw offset 0x400 ) holding the export directory
+    virtual void SetUp()
+    {
+        buildHeaders(0x600, 1);
+
+        setDataDirectory(0, 0x1000, 0x100);             // export directory
+
+        setSection(0, ".edata", 0x200, 0x1000, 0x200, 0x400, 0);
+
+        const size_t  exportDir = 0x400;
+        put<unsigned int>(exportDir + 0x10, 1);        // ordinal base
+        put<unsigned int>(exportDir + 0x14, 3);        // functions
+        put<unsigned int>(exportDir + 0x18, 2);        // names
+        put<unsigned int>(exportDir + 0x1C, 0x1028);
+        put<unsigned int>(exportDir + 0x20, 0x1034);
+        put<unsigned int>(exportDir + 0x24, 0x103C);
+
+        put<unsigned int>(exportDir + 0x28, 0x2000);
+        put<unsigned int>(exportDir + 0x2C, 0x1050);   // forwarder
+        put<unsigned int>(exportDir + 0x30, 0x2010);
+
+        put<unsigned int>(exportDir + 0x34, 0x1040);
+        put<unsigned int>(exportDir + 0x38, 0x1048);
+        put<unsigned short>(exportDir + 0x3C, 2);
+        put<unsigned short>(exportDir + 0x3E, 1);
+
+        strcpy(reinterpret_cast<char*>(&m_image[exportDir + 0x40]), "Alpha");
+        strcpy(reinterpret_cast<char*>(&m_image[exportDir + 0x48]), "Beta");
+        strcpy(reinterpret_cast<char*>(&m_image[exportDir + 0x50]), "NTDLL.RtlBeta");
+    }
+};
+
+TEST_F(PEImageTest, FileLayout)
+{
+    PEExportDirectory  exportDir;
+    ASSERT_NO_THROW( exportDir = getPEExports(&m_image[0], m_image.size(), PEImageFile) );
+
+    EXPECT_EQ( 0x8664, exportDir.machine );
+    ASSERT_EQ( 2, exportDir.exports.size() );
+
+    EXPECT_EQ( "Alpha", exportDir.exports[0].name );
+    EXPECT_EQ( 0x2010, exportDir.exports[0].rva );
+    EXPECT_EQ( 2, exportDir.exports[0].ordinal );
+    EXPECT_FALSE( exportDir.exports[0].forwarded );
+
+    EXPECT_EQ( "Beta", exportDir.exports[1].name );
+    EXPECT_EQ( 0x1050, exportDir.exports[1].rva );
+    EXPECT_TRUE( exportDir.exports[1].forwarded );
+}
+
+TEST_F(PEImageTest, MappedLayout)
+{
+    std::vector<unsigned char>  mappedImage(0x1200, 0);
+    memcpy(&mappedImage[0], &m_image[0], 0x400);
+    memcpy(&mappedImage[0x1000], &m_image[0x400], 0x200);
+
+    size_t  readCount = 0;
+
+    auto  reader = [&](MEMOFFSET_32 offset, void* buffer, size_t length) {
+        ASSERT_LE( offset + length, mappedImage.size() );
+        memcpy(buffer, &mappedImage[offset], length);
+        ++readCount;
+    };
+
+    PEExportDirectory  exportDir;
+    ASSERT_NO_THROW( exportDir = getPEExports(reader, PEImageMapped) );
+
+    ASSERT_EQ( 2, exportDir.exports.size() );
+    EXPECT_EQ( "Alpha", exportDir.exports[0].name );
+    EXPECT_EQ( "Beta", exportDir.exports[1].name );
+
+    EXPECT_GE( 4, readCount );
+}
+
+TEST_F(PEImageTest, NameAtSectionEnd)
+{
+    // the name is out of the export directory block and ends with the section and the file
+    put<unsigned int>(0x400 + 0x38, 0x11FC);
+    strcpy(reinterpret_cast<char*>(&m_image[0x5FC]), "Zed");
+
+    PEExportDirectory  exportDir;
+    ASSERT_NO_THROW( exportDir = getPEExports(&m_image[0], m_image.size(), PEImageFile) );
+    ASSERT_EQ( 2, exportDir.exports.size() );
+    EXPECT_EQ( "Zed", exportDir.exports[1].name );
+
+    std::vector<unsigned char>  mappedImage(0x1200, 0);
+    memcpy(&mappedImage[0], &m_image[0], 0x400);
+    memcpy(&mappedImage[0x1000], &m_image[0x400], 0x200);
+
+    auto  reader = [&](MEMOFFSET_32 offset, void* buffer, size_t length) {
+        if (offset + length > mappedImage.size())
+            throw MemoryException(offset);
+        memcpy(buffer, &mappedImage[offset], length);
+    };
+
+    ASSERT_NO_THROW( exportDir = getPEExports(reader, PEImageMapped) );
+    ASSERT_EQ( 2, exportDir.exports.size() );
+    EXPECT_EQ( "Zed", exportDir.exports[1].name );
+}
+
+TEST_F(PEImageTest, CodeDirectory)
+{
+    PECodeDirectory  codeDir;
+    ASSERT_NO_THROW( codeDir = getPECode(&m_image[0], m_image.size(), PEImageFile) );
+
+    EXPECT_EQ( 0x8664, codeDir.machine );
+    EXPECT_EQ( 0, codeDir.entryPoint );
+    EXPECT_TRUE( codeDir.runtimeFunctions.empty() );
+
+    ASSERT_EQ( 1, codeDir.sections.size() );
+    EXPECT_EQ( ".edata", codeDir.sections[0].name );
+    EXPECT_EQ( 0x1000, codeDir.sections[0].rva );
+    EXPECT_EQ( 0x200, codeDir.sections[0].size );
+    EXPECT_FALSE( codeDir.sections[0].isExecutable() );
+}
+
+TEST_F(PEImageTest, Corrupted)
+{
+    EXPECT_THROW( getPEExports(&m_image[0], 0x100), SymbolException );
+
+    m_image[0] = 0;
+    EXPECT_THROW( getPEExports(&m_image[0], m_image.size()), SymbolException );
+}
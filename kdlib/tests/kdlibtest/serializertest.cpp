@@ -0,0 +1,56 @@
+#include <stdafx.h>
+
+#include "procfixture.h"
+
+#include "kdlib/kdlib.h"
+#include "kdlib/serializer.h"
+
+#include "test/testvars.h"
+
+using namespace kdlib;
+
+class SerializerTest : public ProcessFixture
+{
+public:
+
+    SerializerTest() : ProcessFixture( L"typedvartest" ) {}
+};
+
+TEST_F( SerializerTest, Json )
+{
+    std::string  json;
+
+    ASSERT_NO_THROW( json = serializeTypedVar( loadTypedVar(L"g_structTest") ) );
+    EXPECT_EQ( "{\"m_field0\":0,\"m_field1\":500,\"m_field2\":true,\"m_field3\":1,\"m_field4\":0}", json );
+
+    EXPECT_EQ( "\"Hello\"", serializeTypedVar( loadTypedVar(L"helloStr") ) );
+    EXPECT_EQ( "\"Hello\"", serializeTypedVar( loadTypedVar(L"helloWStr") ) );
+    EXPECT_EQ( "[0,255,32768,2147483648,4294967295]", serializeTypedVar( loadTypedVar(L"ulongArray") ) );
+    EXPECT_EQ( "[[0,1,2],[3,4,5]]", serializeTypedVar( loadTypedVar(L"intMatrix") ) );
+}
+
+TEST_F( SerializerTest, FollowPointers )
+{
+    SerializerOptions  options;
+    options.pointers = SerializerPointerFollowUdt;
+
+    std::string  json = serializeTypedVar( loadTypedVar(L"g_structTest1"), options );
+    EXPECT_NE( std::string::npos, json.find("\"m_field4\":{\"address\":") );
+    EXPECT_NE( std::string::npos, json.find("\"value\":{\"m_field0\":0,\"m_field1\":500,") );
+
+    options.maxDepth = 0;
+    json = serializeTypedVar( loadTypedVar(L"g_structTest1"), options );
+    EXPECT_EQ( std::string::npos, json.find("\"address\"") );
+}
+
+TEST_F( SerializerTest, Cbor )
+{
+    SerializerOptions  options;
+    options.format = SerializerCbor;
+
+    std::string  cbor = serializeTypedVar( loadTypedVar(L"g_structTest"), options );
+    ASSERT_FALSE( cbor.empty() );
+    EXPECT_EQ( '\xA5', cbor[0] );
+
+    EXPECT_EQ( std::string("\x65Hello"), serializeTypedVar( loadTypedVar(L"helloStr"), options ) );
+}
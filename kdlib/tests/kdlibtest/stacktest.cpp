@@ -484,3 +484,89 @@ TEST_F(DiaRegToRegRelativeAmd64Test, CV_ALLREG_VFRAME)
   for (unsigned long i = 0; i < localCount; ++i)
     ASSERT_NO_THROW(frame->getLocalVar(i));
 }
+
+
+class FakeCPUContext : public CPUContext
+{
+public:
+
+    virtual CPUType getCPUType() { return CPU_I386; }
+    virtual CPUType getCPUMode() { return CPU_I386; }
+
+    virtual NumVariant getRegisterByName(const std::wstring &name) { throw DbgException("not supported"); }
+    virtual void setRegisterByName(const std::wstring &name, const NumVariant& value) { throw DbgException("not supported"); }
+
+    virtual NumVariant getRegisterByIndex(unsigned long index) {
+        if (index == 252)
+            throw DbgException("unsupported registry type");
+        return index == 17 ? NumVariant(0x12345678UL) : NumVariant(1.5f);
+    }
+
+    virtual void setRegisterByIndex(unsigned long index, const NumVariant& value) { throw DbgException("not supported"); }
+
+    virtual std::wstring getRegisterName(unsigned long index) {
+        switch (index)
+        {
+        case 17: return L"eax";
+        case 154: return L"xmm0";
+        case 252: return L"ymm0";
+        }
+        throw DbgException("unsupported register index");
+    }
+
+    virtual unsigned long getRegisterNumber() { return 3; }
+
+    virtual MEMOFFSET_64 getIP() { return 0; }
+    virtual void setIP(MEMOFFSET_64 ip) {}
+    virtual MEMOFFSET_64 getSP() { return 0; }
+    virtual void setSP(MEMOFFSET_64 sp) {}
+    virtual MEMOFFSET_64 getFP() { return 0; }
+    virtual void setFP(MEMOFFSET_64 fp) {}
+
+    virtual void restore() {}
+};
+
+TEST(ContextRegisterAccessor, ReadSnapshot)
+{
+    CPUContextPtr  cpuContext(new FakeCPUContext());
+
+    DataAccessorPtr  eax = getRegisterAccessor(cpuContext, 17);
+
+    EXPECT_EQ(RegisterVar, eax->getStorageType());
+    EXPECT_EQ(L"eax", eax->getRegisterName());
+    EXPECT_EQ(L"@eax", eax->getLocationAsStr());
+    EXPECT_EQ(4, eax->getLength());
+
+    EXPECT_EQ(0x12345678, eax->readDWord());
+    EXPECT_EQ(0x1234, eax->readWord(1));
+    EXPECT_EQ(0x56, eax->readByte(1));
+
+    std::vector<unsigned char>  bytes;
+    eax->readBytes(bytes, 2, 2);
+    EXPECT_EQ(std::vector<unsigned char>({ 0x34, 0x12 }), bytes);
+
+    EXPECT_THROW(eax->readQWord(), DbgException);
+    EXPECT_THROW(eax->readBytes(bytes, 2, 3), DbgException);
+    EXPECT_THROW(eax->writeDWord(0, 0), DbgException);
+
+    DataAccessorPtr  xmm0 = getRegisterAccessor(cpuContext, 154);
+    EXPECT_FLOAT_EQ(1.5f, xmm0->readFloat());
+
+    // ymm0: a vector register of a frame is rejected at once
+    EXPECT_THROW(getRegisterAccessor(cpuContext, 252), DbgException);
+}
+
+TEST(ContextRegisterAccessor, DefaultGetRegisters)
+{
+    CPUContextPtr  cpuContext(new FakeCPUContext());
+
+    std::vector<unsigned long>  indices;
+    std::vector<NumVariant>  values;
+    ASSERT_NO_THROW(cpuContext->getRegisters(indices, values));
+
+    // ymm0 is skipped
+    EXPECT_EQ(std::vector<unsigned long>({ 17, 154 }), indices);
+    ASSERT_EQ(2, values.size());
+    EXPECT_EQ(0x12345678, values[0].asULong());
+    EXPECT_FLOAT_EQ(1.5f, values[1].asFloat());
+}
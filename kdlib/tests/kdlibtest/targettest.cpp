@@ -321,6 +321,44 @@ TEST_F(TargetTest, IpFrameStackOffset)
 }
 
 
+TEST_F(TargetTest, RegisterSnapshot)
+{
+    ASSERT_NO_THROW(startProcess(L"targetapp.exe multithread"));
+    ASSERT_NO_THROW(targetGo());
+
+    TargetProcessPtr  targetProcess;
+    ASSERT_NO_THROW(targetProcess = TargetProcess::getCurrent());
+
+    THREAD_DEBUG_ID  currentThreadId = getCurrentThreadId();
+
+    RegisterSnapshot  snapshot;
+    ASSERT_NO_THROW(snapshot = targetProcess->getRegisterSnapshot());
+
+    EXPECT_EQ(targetProcess->getNumberThreads(), snapshot.getThreadCount());
+    EXPECT_NE(0, snapshot.getRegisterCount());
+    EXPECT_EQ(currentThreadId, getCurrentThreadId());
+
+    const std::wstring  ipName = getCPUMode() == CPU_AMD64 ? L"rip" : L"eip";
+
+    const unsigned long long*  ipColumn = 0;
+    ASSERT_NO_THROW(ipColumn = snapshot.getColumn(ipName));
+
+    for (size_t i = 0; i < snapshot.getThreadCount(); ++i)
+    {
+        TargetThreadPtr  thread = targetProcess->getThreadById(snapshot.getThreads()[i]);
+        EXPECT_EQ(thread->getInstructionOffset(), ipColumn[i]);
+        EXPECT_EQ(thread->getRegisterByName(ipName).asULongLong(), ipColumn[i]);
+    }
+
+    RegisterSnapshot  selected;
+    ASSERT_NO_THROW(selected = targetProcess->getRegisterSnapshot(std::vector<std::wstring>(1, ipName), snapshot.getThreads()));
+    EXPECT_EQ(1, selected.getRegisterCount());
+    for (size_t i = 0; i < selected.getThreadCount(); ++i)
+        EXPECT_EQ(ipColumn[i], selected.getValue(i, 0));
+
+    EXPECT_THROW(snapshot.getColumn(L"notexist"), DbgException);
+}
+
 TEST_F(KernelDumpTest, LoadDump)
 {
     loadDump();
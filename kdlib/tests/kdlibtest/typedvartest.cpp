@@ -1,5 +1,8 @@
 #include <stdafx.h>
 
+#include <chrono>
+#include <iomanip>
+
 #include "procfixture.h"
 
 #include "kdlib/kdlib.h"
@@ -412,6 +415,26 @@ TEST_F(TypedVarTest, FunctionCall)
     //EXPECT_DOUBLE_EQ( -2.9 + 13.1, funcptr->call(2, -2.9, 13.1).asDouble() );
 }
 
+TEST_F(TypedVarTest, FunctionCallSite)
+{
+    MEMOFFSET_64  ip = getInstructionOffset();
+    MEMOFFSET_64  sp = getStackOffset();
+
+    {
+        FunctionCallSite  callSite( loadTypedVar( L"CdeclFuncReturn" ) );
+
+        for ( int i = 0; i < 100; ++i )
+            EXPECT_EQ( i + 5, callSite.call( { i, loadTypedVar(L"helloStr") } ) );
+
+        EXPECT_EQ( 1, getNumberBreakpoints() );
+    }
+
+    EXPECT_EQ( ip, getInstructionOffset() );
+    EXPECT_EQ( sp, getStackOffset() );
+    EXPECT_EQ( 0, getNumberBreakpoints() );
+
+    EXPECT_THROW( FunctionCallSite( loadTypedVar( L"helloStr" ) ), TypeException );
+}
 
 TEST_F(TypedVarTest, CustomDefineFunctionCall)
 {
@@ -797,3 +820,100 @@ TEST_F(TypedVarTest, StructNestedEnum)
     std::wstring  s;
     EXPECT_NO_THROW(s = loadTypedVar(L"g_structWithNested")->str());
 }
+
+TEST_F(TypedVarTest, FunctionParams)
+{
+    TypedVarPtr  funcVar;
+    ASSERT_NO_THROW( funcVar = loadTypedVar(L"StdcallFuncRet") );
+
+    EXPECT_EQ( L"a", funcVar->getElementName(0) );
+    EXPECT_EQ( L"b", funcVar->getElementName(1) );
+    EXPECT_THROW( funcVar->getElementName(2), IndexException );
+
+    EXPECT_EQ( 0, funcVar->getElementIndex(L"a") );
+    EXPECT_EQ( 1, funcVar->getElementIndex(L"b") );
+    EXPECT_THROW( funcVar->getElementIndex(L"c"), DbgException );
+
+    for ( size_t i = 0; i < 2; ++i )
+    {
+        std::wstring  paramName = funcVar->getElementName(i);
+
+        EXPECT_EQ( funcVar->getElementStorage(i), funcVar->getElementStorage(paramName) );
+
+        if ( funcVar->getElementStorage(i) == MemoryVar )
+        {
+            EXPECT_EQ( funcVar->getElementOffset(i), funcVar->getElementOffset(paramName) );
+            EXPECT_EQ( funcVar->getElementOffsetRelativeReg(i), funcVar->getElementOffsetRelativeReg(paramName) );
+        }
+    }
+}
+
+namespace {
+
+// the fields of TypedVarUdt::str formatted through a stream as before StrBuffer
+std::wstring streamFields(const TypedVarPtr& var)
+{
+    std::wstringstream  sstr;
+
+    for (size_t i = 0; i < var->getElementCount(); ++i)
+    {
+        TypedVarPtr  fieldVar = var->getElement(i);
+        unsigned long long  value = fieldVar->getValue().asULongLong();
+
+        sstr << L"   +" << std::noshowbase << std::right << std::setw(4) << std::setfill(L'0') << std::hex << var->getElementOffset(i);
+        sstr << L" " << std::left << std::setw(24) << std::setfill(L' ') << var->getElementName(i) << L':';
+        sstr << L" " << fieldVar->getType()->getName();
+        sstr << L"   " << std::showbase << value << L" (" << std::dec << value << L")" << std::endl;
+    }
+
+    return sstr.str();
+}
+
+} // end nameless namespace
+
+TEST_F(TypedVarTest, StrBenchmark)
+{
+    const size_t  elementCount = 100000;
+
+    TypeInfoPtr  structType = defineStruct(L"BenchStruct");
+    structType->appendField(L"field1", loadType(L"UInt1B"));
+    structType->appendField(L"field2", loadType(L"UInt2B"));
+    structType->appendField(L"field3", loadType(L"UInt4B"));
+    structType->appendField(L"field4", loadType(L"UInt8B"));
+
+    std::vector<char>  buffer(structType->getSize() * elementCount);
+    for (size_t i = 0; i < buffer.size(); ++i)
+        buffer[i] = static_cast<char>(i * 7);
+
+    TypedVarPtr  arrayVar = loadTypedVar(structType->arrayOf(elementCount), getCacheAccessor(buffer));
+
+    std::vector<TypedVarPtr>  elements(elementCount);
+    for (size_t i = 0; i < elementCount; ++i)
+        elements[i] = arrayVar->getElement(i);
+
+    StrBuffer  strBuffer(0x1000);
+
+    for (size_t i = 0; i < 0x10; ++i)
+    {
+        strBuffer.clear();
+        elements[i]->str(strBuffer);
+        std::wstring  desc = strBuffer.str();
+        EXPECT_EQ(streamFields(elements[i]), desc.substr(desc.find(L'\n') + 1));
+    }
+
+    auto  start = std::chrono::high_resolution_clock::now();
+    for (const auto& element : elements)
+        streamFields(element);
+    std::chrono::duration<double>  streamTime = std::chrono::high_resolution_clock::now() - start;
+
+    start = std::chrono::high_resolution_clock::now();
+    for (const auto& element : elements)
+    {
+        strBuffer.clear();
+        element->str(strBuffer);
+    }
+    std::chrono::duration<double>  bufferTime = std::chrono::high_resolution_clock::now() - start;
+
+    RecordProperty("streamPerSecond", static_cast<int>(elementCount / streamTime.count()));
+    RecordProperty("bufferPerSecond", static_cast<int>(elementCount / bufferTime.count()));
+}
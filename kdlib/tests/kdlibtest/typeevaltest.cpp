@@ -1,5 +1,7 @@
 #include <stdafx.h>
 
+#include <chrono>
+
 #include "gtest/gtest.h"
 #include "kdlib/kdlib.h"
 
@@ -614,3 +616,53 @@ TEST(TypeEvalTest, TemplateWcharT)
 
     EXPECT_EQ(L"TestStruct<wchar_t>", evalType("TestStruct<wchar_t>", typeProvider)->getName());
 }
+
+TEST(TypeEvalTest, NestedTemplateStress)
+{
+    const size_t  depth = 16;
+
+    std::string  typeName = "int";
+    for (size_t i = 0; i < depth; ++i)
+        typeName = "TestStruct<int," + typeName + ">";
+
+    std::string  sourceCode = "                                \
+    template<typename T1, typename T2>                          \
+    struct TestStruct {                                         \
+        T1     field1;                                          \
+        T2     field2;                                          \
+    };";
+    sourceCode += typeName + " testVal;";
+
+    TypeInfoProviderPtr  typeProvider = getTypeInfoProviderFromSource(sourceCode);
+
+    TypeInfoPtr  typeInfo;
+
+    auto  start = std::chrono::high_resolution_clock::now();
+    ASSERT_NO_THROW(typeInfo = evalType(typeName, typeProvider));
+    std::chrono::duration<double>  evalTime = std::chrono::high_resolution_clock::now() - start;
+
+    EXPECT_EQ((depth + 1) * sizeof(int), typeInfo->getSize());
+    EXPECT_EQ(typeProvider->getTypeByName(typeInfo->getName())->getName(), typeInfo->getName());
+
+    std::wstring  name = typeInfo->getName();
+    EXPECT_EQ(0, name.find(L"TestStruct<int,"));
+
+    size_t  nestedCount = 0;
+    for (size_t pos = name.find(L"TestStruct<"); pos != std::wstring::npos; pos = name.find(L"TestStruct<", pos + 1))
+        nestedCount++;
+    EXPECT_EQ(depth, nestedCount);
+
+    TypeInfoPtr  innerType = typeInfo;
+    for (size_t i = 0; i < depth; ++i)
+    {
+        EXPECT_EQ(L"Int4B", innerType->getElement(0)->getName());
+        innerType = innerType->getElement(1);
+    }
+    EXPECT_EQ(L"Int4B", innerType->getName());
+
+    // the template arguments are matched once: an exponential backtracking takes minutes
+    EXPECT_GT(1.0, evalTime.count());
+
+    RecordProperty("nestedTemplateDepth", static_cast<int>(depth));
+    RecordProperty("evalTypeMicroseconds", static_cast<int>(evalTime.count() * 1000000));
+}
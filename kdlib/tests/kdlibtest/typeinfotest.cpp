@@ -109,6 +109,17 @@ TEST_F( TypeInfoTest, ComplexTypeArray )
     EXPECT_THROW( loadType( L"structTest[2][-1]"), SymbolException);
 }
 
+TEST_F( TypeInfoTest, TypeExprCache )
+{
+    TypeInfoPtr  typeInfo = loadType( L"targetapp!structTest*[4]" );
+    EXPECT_EQ( L"structTest*[4]", typeInfo->getName() );
+    EXPECT_EQ( typeInfo, loadType( L"targetapp!structTest*[4]" ) );
+    EXPECT_EQ( typeInfo, loadType( L" targetapp ! structTest * [4] " ) );
+
+    m_targetModule->reloadSymbols();
+    EXPECT_NE( typeInfo, loadType( L"targetapp!structTest*[4]" ) );
+}
+
 
 TEST_F( TypeInfoTest, BaseTypePointer )
 {
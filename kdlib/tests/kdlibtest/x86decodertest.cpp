@@ -0,0 +1,166 @@
+#include <stdafx.h>
+
+#include <chrono>
+
+#include "gtest/gtest.h"
+
+#include "kdlib/x86decoder.h"
+
+using namespace kdlib;
+
+namespace {
+
+struct X86Sample {
+    CPUType  mode;
+    const char*  code;
+    size_t  length;
+    X86Mnemonic  mnemonic;
+    const wchar_t*  text;
+};
+
+const X86Sample  x86Samples[] = {
+    { CPU_AMD64, "\x48\x8b\xc4", 3, X86Mov, L"mov     rax,rsp" },
+    { CPU_AMD64, "\x48\x83\xec\x28", 4, X86Sub, L"sub     rsp,28h" },
+    { CPU_AMD64, "\xc3", 1, X86Ret, L"ret" },
+    { CPU_AMD64, "\xcc", 1, X86Int3, L"int 3" },
+    { CPU_AMD64, "\x4c\x8b\x54\x24\x08", 5, X86Mov, L"mov     r10,qword ptr [rsp+8]" },
+    { CPU_AMD64, "\x48\x8d\x0d\x10\x00\x00\x00", 7, X86Lea, L"lea     rcx,[00000000`00001017]" },
+    { CPU_AMD64, "\xff\x15\xf0\xff\x00\x00", 6, X86Call, L"call    qword ptr [00000000`00010ff6]" },
+    { CPU_AMD64, "\xe8\xfb\xff\xff\xff", 5, X86Call, L"call    00000000`00001000" },
+    { CPU_AMD64, "\xf3\xaa", 2, X86Stos, L"rep stos byte ptr [rdi],al" },
+    { CPU_AMD64, "\xf0\x48\x0f\xb1\x0a", 5, X86Cmpxchg, L"lock cmpxchg qword ptr [rdx],rcx" },
+    { CPU_AMD64, "\x48\xb8\xef\xcd\xab\x89\x67\x45\x23\x01", 10, X86Mov, L"mov     rax,123456789ABCDEFh" },
+    { CPU_AMD64, "\x66\x0f\x6f\x04\x24", 5, X86Movdqa, L"movdqa  xmm0,xmmword ptr [rsp]" },
+    { CPU_AMD64, "\xc5\xfd\x6f\x0e", 4, X86Movdqa, L"vmovdqa ymm1,ymmword ptr [rsi]" },
+    { CPU_AMD64, "\x66\x0f\x3a\x22\xc0\x01", 6, X86Pinsrd, L"pinsrd  xmm0,eax,1" },
+    { CPU_AMD64, "\xf3\x0f\x1e\xfa", 4, X86Endbr64, L"endbr64" },
+    { CPU_AMD64, "\xd9\xc9", 2, X86Fxch, L"fxch    st(1)" },
+    { CPU_AMD64, "\x9c", 1, X86Pushfq, L"pushfq" },
+    { CPU_I386, "\x8b\xff", 2, X86Mov, L"mov     edi,edi" },
+    { CPU_I386, "\x8b\xec", 2, X86Mov, L"mov     ebp,esp" },
+    { CPU_I386, "\x6a\x08", 2, X86Push, L"push    8" },
+    { CPU_I386, "\xc2\x08\x00", 3, X86Ret, L"ret     8" },
+    { CPU_I386, "\xe9\xfb\xff\xff\xff", 5, X86Jmp, L"jmp     00001000" },
+    { CPU_I386, "\xff\x25\x00\x10\x40\x00", 6, X86Jmp, L"jmp     dword ptr [401000h]" },
+    { CPU_I386, "\xf3\xa5", 2, X86Movs, L"rep movs dword ptr es:[edi],dword ptr [esi]" },
+    { CPU_I386, "\x64\xa1\x18\x00\x00\x00", 6, X86Mov, L"mov     eax,dword ptr fs:[18h]" },
+    { CPU_I386, "\x0f\xb6\xc0", 3, X86Movzx, L"movzx   eax,al" }
+};
+
+const MEMOFFSET_64  sampleOffset = 0x1000;
+
+} // end nameless namespace
+
+TEST(X86DecoderTest, Decode)
+{
+    for (const auto& sample : x86Samples)
+    {
+        X86Decoder  decoder(sample.mode);
+        X86Instruction  instruction;
+
+        ASSERT_EQ(X86DecodeOk, decoder.decode(reinterpret_cast<const unsigned char*>(sample.code), sample.length, sampleOffset, instruction)) << sample.text;
+
+        EXPECT_EQ(sample.length, instruction.length) << sample.text;
+        EXPECT_EQ(sample.mnemonic, instruction.mnemonic) << sample.text;
+        EXPECT_EQ(std::wstring(sample.text), formatX86Instruction(instruction));
+    }
+}
+
+TEST(X86DecoderTest, Operands)
+{
+    X86Decoder  decoder(CPU_AMD64);
+    X86Instruction  instruction;
+
+    // mov eax, dword ptr [rcx+rdx*4-10h]
+    const unsigned char  movCode[] = { 0x8b, 0x44, 0x91, 0xf0 };
+    ASSERT_EQ(X86DecodeOk, decoder.decode(movCode, sizeof(movCode), sampleOffset, instruction));
+    ASSERT_EQ(2, instruction.operandCount);
+    EXPECT_EQ(X86OpRegister, instruction.operands[0].type);
+    EXPECT_EQ(X86RegGpr32, instruction.operands[0].reg.regClass);
+    EXPECT_EQ(0, instruction.operands[0].reg.number);
+    EXPECT_EQ(X86OpMemory, instruction.operands[1].type);
+    EXPECT_EQ(4, instruction.operands[1].size);
+    EXPECT_EQ(X86RegGpr64, instruction.operands[1].reg.regClass);
+    EXPECT_EQ(1, instruction.operands[1].reg.number);
+    EXPECT_EQ(2, instruction.operands[1].index.number);
+    EXPECT_EQ(4, instruction.operands[1].scale);
+    EXPECT_EQ(-0x10, instruction.operands[1].value);
+
+    // jne +0x10
+    const unsigned char  jccCode[] = { 0x75, 0x10 };
+    ASSERT_EQ(X86DecodeOk, decoder.decode(jccCode, sizeof(jccCode), sampleOffset, instruction));
+    EXPECT_EQ(X86Jne, instruction.mnemonic);
+    EXPECT_EQ(sampleOffset + 0x12, instruction.target);
+    EXPECT_EQ(X86InstrBranch | X86InstrConditional, instruction.flags);
+
+    // call qword ptr [rip+0FFF0h]
+    const unsigned char  callCode[] = { 0xff, 0x15, 0xf0, 0xff, 0x00, 0x00 };
+    ASSERT_EQ(X86DecodeOk, decoder.decode(callCode, sizeof(callCode), sampleOffset, instruction));
+    EXPECT_EQ(X86InstrCall | X86InstrIndirect | X86InstrRipRelative, instruction.flags);
+
+    MEMOFFSET_64  address = 0;
+    EXPECT_TRUE(getX86StaticAddress(instruction, instruction.operands[0], address));
+    EXPECT_EQ(sampleOffset + sizeof(callCode) + 0xfff0, address);
+}
+
+TEST(X86DecoderTest, Batch)
+{
+    X86Decoder  decoder(CPU_AMD64);
+
+    // push rbp; mov rbp,rsp; (bad); ret; truncated mov eax,imm32
+    const unsigned char  code[] = { 0x55, 0x48, 0x8b, 0xec, 0x06, 0xc3, 0xb8, 0x01, 0x02 };
+
+    std::vector<X86Instruction>  instructions;
+    size_t  decoded = decoder.decode(code, sizeof(code), sampleOffset, instructions);
+
+    EXPECT_EQ(6, decoded);
+    ASSERT_EQ(4, instructions.size());
+
+    EXPECT_EQ(X86Push, instructions[0].mnemonic);
+    EXPECT_EQ(X86Mov, instructions[1].mnemonic);
+    EXPECT_EQ(X86Invalid, instructions[2].mnemonic);
+    EXPECT_EQ(1, instructions[2].length);
+    EXPECT_EQ(sampleOffset + 4, instructions[2].offset);
+    EXPECT_EQ(X86Ret, instructions[3].mnemonic);
+    EXPECT_EQ(X86InstrReturn, instructions[3].flags);
+
+    X86Instruction  instruction;
+    EXPECT_EQ(X86DecodeTruncated, decoder.decode(code + 6, 3, sampleOffset + 6, instruction));
+}
+
+TEST(X86DecoderTest, UnsupportedMode)
+{
+    EXPECT_THROW(X86Decoder  decoder(CPU_ARM64), DbgException);
+}
+
+TEST(X86DecoderTest, Benchmark)
+{
+    std::vector<unsigned char>  code;
+    for (size_t i = 0; i < 0x10000; ++i)
+    {
+        const X86Sample&  sample = x86Samples[i % _countof(x86Samples)];
+        if (sample.mode == CPU_AMD64)
+            code.insert(code.end(), sample.code, sample.code + sample.length);
+    }
+
+    X86Decoder  decoder(CPU_AMD64);
+    std::vector<X86Instruction>  instructions;
+
+    auto  start = std::chrono::high_resolution_clock::now();
+    size_t  decoded = decoder.decode(code.data(), code.size(), sampleOffset, instructions);
+    std::chrono::duration<double>  decodeTime = std::chrono::high_resolution_clock::now() - start;
+
+    EXPECT_EQ(code.size(), decoded);
+
+    std::wstring  text;
+    start = std::chrono::high_resolution_clock::now();
+    for (const auto& instruction : instructions)
+    {
+        text.clear();
+        formatX86Instruction(instruction, text);
+    }
+    std::chrono::duration<double>  formatTime = std::chrono::high_resolution_clock::now() - start;
+
+    RecordProperty("decodePerSecond", static_cast<int>(instructions.size() / decodeTime.count()));
+    RecordProperty("formatPerSecond", static_cast<int>(instructions.size() / formatTime.count()));
+}
@@ -17,6 +17,7 @@
 
 int breakOnRun();
 int breakpointTestRun();
+int tracepointTestRun();
 int memTestRun();
 int stackTestRun();
 int loadUnloadModuleRun();
@@ -63,6 +64,9 @@ int _tmain(int argc, _TCHAR* argv[])
     if ( testGroup == L"breakhandlertest" )
         return breakpointTestRun();
 
+    if ( testGroup == L"tracepointtest" )
+        return tracepointTestRun();
+
     if ( testGroup == L"stacktest" )
         return stackTestRun();
 
@@ -117,6 +121,16 @@ int breakpointTestRun()
     return 0;
 }
 
+int tracepointTestRun()
+{
+    __debugbreak();
+
+    for ( int i = 0; i < 10; ++i )
+        CdeclFunc( i, 10.0f );
+
+    return 0;
+}
+
 
 class stackTestClass
 {